@@ -35,43 +35,123 @@ BufferPoolManager::~BufferPoolManager() {
 }
 
 Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
-  // 1.     Search the page table for the requested page (P).
-  // 1.1    If P exists, pin it and return it immediately.
-  // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
-  //        Note that pages are always found from the free list first.
-  // 2.     If R is dirty, write it back to the disk.
-  // 3.     Delete R from the page table and insert P.
-  // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
-  return nullptr;
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = page_table_.find(page_id);
+  if (it != page_table_.end()) {
+    Page *page = &pages_[it->second];
+    page->pin_count_++;
+    replacer_->Pin(it->second);
+    return page;
+  }
+  frame_id_t frame_id;
+  if (!FindVictimFrame(&frame_id)) {
+    return nullptr;
+  }
+  Page *page = &pages_[frame_id];
+  page_table_[page_id] = frame_id;
+  page->page_id_ = page_id;
+  page->pin_count_ = 1;
+  page->is_dirty_ = false;
+  disk_manager_->ReadPage(page_id, page->GetData());
+  return page;
 }
 
-bool BufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) { return false; }
+bool BufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = page_table_.find(page_id);
+  if (it == page_table_.end()) {
+    return false;
+  }
+  Page *page = &pages_[it->second];
+  if (page->pin_count_ <= 0) {
+    return false;
+  }
+  page->is_dirty_ = page->is_dirty_ || is_dirty;
+  if (--page->pin_count_ == 0) {
+    replacer_->Unpin(it->second);
+  }
+  return true;
+}
 
 bool BufferPoolManager::FlushPageImpl(page_id_t page_id) {
-  // Make sure you call DiskManager::WritePage!
-  return false;
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = page_table_.find(page_id);
+  if (page_id == INVALID_PAGE_ID || it == page_table_.end()) {
+    return false;
+  }
+  Page *page = &pages_[it->second];
+  WritePage(page);
+  page->is_dirty_ = false;
+  return true;
 }
 
 Page *BufferPoolManager::NewPageImpl(page_id_t *page_id) {
-  // 0.   Make sure you call DiskManager::AllocatePage!
-  // 1.   If all the pages in the buffer pool are pinned, return nullptr.
-  // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
-  // 3.   Update P's metadata, zero out memory and add P to the page table.
-  // 4.   Set the page ID output parameter. Return a pointer to P.
-  return nullptr;
+  std::lock_guard<std::mutex> guard(latch_);
+  frame_id_t frame_id;
+  if (!FindVictimFrame(&frame_id)) {
+    return nullptr;
+  }
+  *page_id = disk_manager_->AllocatePage();
+  Page *page = &pages_[frame_id];
+  page_table_[*page_id] = frame_id;
+  page->page_id_ = *page_id;
+  page->pin_count_ = 1;
+  page->is_dirty_ = false;
+  page->ResetMemory();
+  return page;
 }
 
 bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
-  // 0.   Make sure you call DiskManager::DeallocatePage!
-  // 1.   Search the page table for the requested page (P).
-  // 1.   If P does not exist, return true.
-  // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
-  // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
-  return false;
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = page_table_.find(page_id);
+  if (it == page_table_.end()) {
+    disk_manager_->DeallocatePage(page_id);
+    return true;
+  }
+  Page *page = &pages_[it->second];
+  if (page->pin_count_ > 0) {
+    return false;
+  }
+  disk_manager_->DeallocatePage(page_id);
+  replacer_->Pin(it->second);
+  free_list_.push_back(it->second);
+  page_table_.erase(it);
+  page->page_id_ = INVALID_PAGE_ID;
+  page->is_dirty_ = false;
+  page->ResetMemory();
+  return true;
 }
 
 void BufferPoolManager::FlushAllPagesImpl() {
-  // You can do it!
+  std::lock_guard<std::mutex> guard(latch_);
+  for (const auto &[page_id, frame_id] : page_table_) {
+    WritePage(&pages_[frame_id]);
+    pages_[frame_id].is_dirty_ = false;
+  }
+}
+
+bool BufferPoolManager::FindVictimFrame(frame_id_t *frame_id) {
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    return true;
+  }
+  if (!replacer_->Victim(frame_id)) {
+    return false;
+  }
+  Page *victim = &pages_[*frame_id];
+  if (victim->is_dirty_) {
+    WritePage(victim);
+  }
+  page_table_.erase(victim->page_id_);
+  return true;
+}
+
+void BufferPoolManager::WritePage(Page *page) {
+  if (enable_logging && log_manager_ != nullptr && page->GetLSN() > log_manager_->GetPersistentLSN()) {
+    log_manager_->Flush();
+  }
+  disk_manager_->WritePage(page->page_id_, page->GetData());
 }
 
 }  // namespace bustub
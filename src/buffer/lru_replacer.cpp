@@ -14,16 +14,43 @@
 
 namespace bustub {
 
-LRUReplacer::LRUReplacer(size_t num_pages) {}
+LRUReplacer::LRUReplacer(size_t num_pages) : capacity_(num_pages) {}
 
 LRUReplacer::~LRUReplacer() = default;
 
-bool LRUReplacer::Victim(frame_id_t *frame_id) { return false; }
-
-void LRUReplacer::Pin(frame_id_t frame_id) {}
-
-void LRUReplacer::Unpin(frame_id_t frame_id) {}
-
-size_t LRUReplacer::Size() { return 0; }
+bool LRUReplacer::Victim(frame_id_t *frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (lru_list_.empty()) {
+    return false;
+  }
+  *frame_id = lru_list_.front();
+  lru_list_.pop_front();
+  frames_.erase(*frame_id);
+  return true;
+}
+
+void LRUReplacer::Pin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = frames_.find(frame_id);
+  if (it == frames_.end()) {
+    return;
+  }
+  lru_list_.erase(it->second);
+  frames_.erase(it);
+}
+
+void LRUReplacer::Unpin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  // a frame that is already unpinned keeps its position
+  if (frames_.count(frame_id) != 0 || frames_.size() >= capacity_) {
+    return;
+  }
+  frames_[frame_id] = lru_list_.insert(lru_list_.end(), frame_id);
+}
+
+size_t LRUReplacer::Size() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return frames_.size();
+}
 
 }  // namespace bustub
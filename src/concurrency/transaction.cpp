@@ -0,0 +1,45 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// transaction.cpp
+//
+// Identification: src/concurrency/transaction.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "concurrency/transaction.h"
+
+#include "container/hash/hash_slot_owners.h"
+#include "storage/table/free_space_map.h"
+
+namespace bustub {
+
+Transaction::~Transaction() {
+  ReleaseInsertPages();
+  ReleaseHashSlots();
+}
+
+void Transaction::ReleaseInsertPages() {
+  for (const auto &[table, insert_page] : *insert_page_set_) {
+    // A table that is gone has no pages to release.
+    if (auto free_space_map = insert_page.free_space_map_.lock()) {
+      free_space_map->ReleasePage(insert_page.page_id_);
+    }
+  }
+  insert_page_set_->clear();
+}
+
+void Transaction::ReleaseHashSlots() {
+  for (const auto &slot_owners : *hash_slot_owners_set_) {
+    // A table that is gone has no slots to give up.
+    if (auto owners = slot_owners.lock()) {
+      owners->Release(this);
+    }
+  }
+  hash_slot_owners_set_->clear();
+}
+
+}  // namespace bustub
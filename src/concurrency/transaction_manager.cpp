@@ -30,6 +30,11 @@ Transaction *TransactionManager::Begin(Transaction *txn, IsolationLevel isolatio
     txn = new Transaction(next_txn_id_++, isolation_level);
   }
 
+  if (enable_logging && log_manager_ != nullptr) {
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::BEGIN);
+    txn->SetPrevLSN(log_manager_->AppendLogRecord(&log_record));
+  }
+
   txn_map[txn->GetTransactionId()] = txn;
   return txn;
 }
@@ -45,13 +50,24 @@ void TransactionManager::Commit(Transaction *txn) {
     if (item.wtype_ == WType::DELETE) {
       // Note that this also releases the lock when holding the page latch.
       table->ApplyDelete(item.rid_, txn);
+    } else if (item.wtype_ == WType::UPDATE) {
+      table->ApplyUpdate(item.tuple_);
     }
     write_set->pop_back();
   }
   write_set->clear();
 
-  // Release all the locks.
+  // The transaction is committed once its commit record is on disk.
+  if (enable_logging && log_manager_ != nullptr) {
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::COMMIT);
+    txn->SetPrevLSN(log_manager_->AppendLogRecord(&log_record));
+    log_manager_->Flush();
+  }
+
+  // Release all the locks, the pages claimed for inserts, and the hash table slots written.
   ReleaseLocks(txn);
+  txn->ReleaseInsertPages();
+  txn->ReleaseHashSlots();
   // Release the global transaction latch.
   global_txn_latch_.RUnlock();
 }
@@ -67,9 +83,11 @@ void TransactionManager::Abort(Transaction *txn) {
       table->RollbackDelete(item.rid_, txn);
     } else if (item.wtype_ == WType::INSERT) {
       // Note that this also releases the lock when holding the page latch.
-      table->ApplyDelete(item.rid_, txn);
+      for (uint32_t i = 0; i < item.count_; i++) {
+        table->ApplyDelete(RID(item.rid_.GetPageId(), item.rid_.GetSlotNum() + i), txn);
+      }
     } else if (item.wtype_ == WType::UPDATE) {
-      table->UpdateTuple(item.tuple_, item.rid_, txn);
+      table->RollbackUpdate(item.tuple_, item.rid_, txn);
     }
     table_write_set->pop_back();
   }
@@ -100,8 +118,16 @@ void TransactionManager::Abort(Transaction *txn) {
   table_write_set->clear();
   index_write_set->clear();
 
-  // Release all the locks.
+  // The rollback has logged its own changes, so recovery leaves the transaction alone.
+  if (enable_logging && log_manager_ != nullptr) {
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::ABORT);
+    txn->SetPrevLSN(log_manager_->AppendLogRecord(&log_record));
+  }
+
+  // Release all the locks, the pages claimed for inserts, and the hash table slots written.
   ReleaseLocks(txn);
+  txn->ReleaseInsertPages();
+  txn->ReleaseHashSlots();
   // Release the global transaction latch.
   global_txn_latch_.RUnlock();
 }
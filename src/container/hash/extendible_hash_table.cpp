@@ -0,0 +1,331 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table.cpp
+//
+// Identification: src/container/hash/extendible_hash_table.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "container/hash/extendible_hash_table.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+EXTENDIBLE_HASH_TABLE_TYPE::ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
+                                                const KeyComparator &comparator, HashFunction<KeyType, Hasher> hash_fn)
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  Page *page = buffer_pool_manager_->NewPage(&directory_page_id_);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate a hash table directory page.");
+  }
+  page_id_t bucket_page_id;
+  if (buffer_pool_manager_->NewPage(&bucket_page_id) == nullptr) {
+    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate a hash table bucket page.");
+  }
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  // global depth 0: the one slot of the directory points at the one bucket
+  auto *directory = reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
+  directory->SetPageId(directory_page_id_);
+  directory->SetBucketPageId(0, bucket_page_id);
+  directory->SetLocalDepth(0, 0);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+bool EXTENDIBLE_HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key,
+                                          std::vector<ValueType> *result) {
+  uint32_t hash = Hash(key);
+  Page *page = LatchBucket(hash, false);
+  auto *bucket = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+  bool found = false;
+  // only the slots whose tags match the key's are compared, up to the end of the occupied prefix
+  uint32_t empty = 0;
+  for (slot_offset_t group = 0; group < BLOCK_ARRAY_SIZE && empty == 0; group += BLOCK_GROUP_SIZE) {
+    uint32_t match = bucket->MatchGroup(group, hash, &empty);
+    size_t group_size = std::min<size_t>(BLOCK_GROUP_SIZE, BLOCK_ARRAY_SIZE - group);
+    uint32_t in_group = group_size == BLOCK_GROUP_SIZE ? ~0U : (1U << group_size) - 1;
+    empty &= in_group;
+    for (match &= empty == 0 ? in_group : (empty & -empty) - 1; match != 0; match &= match - 1) {
+      auto offset = static_cast<slot_offset_t>(group + __builtin_ctz(match));
+      if (comparator_(bucket->KeyAt(offset), key) == 0) {
+        result->push_back(bucket->ValueAt(offset));
+        found = true;
+      }
+    }
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return found;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+bool EXTENDIBLE_HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  uint32_t hash = Hash(key);
+  while (true) {
+    Page *page = LatchBucket(hash, true);
+    auto *bucket = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+    // the same key & value pair may only be stored once; otherwise take the first free slot, which may be a tombstone
+    slot_offset_t free_slot = BLOCK_ARRAY_SIZE;
+    slot_offset_t offset = 0;
+    for (; offset < BLOCK_ARRAY_SIZE && bucket->IsOccupied(offset); offset++) {
+      if (!bucket->IsReadable(offset)) {
+        free_slot = std::min(free_slot, offset);
+      } else if (comparator_(bucket->KeyAt(offset), key) == 0 && bucket->ValueAt(offset) == value) {
+        page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+        return false;
+      }
+    }
+    free_slot = std::min(free_slot, offset);
+    if (free_slot < BLOCK_ARRAY_SIZE) {
+      bucket->Insert(free_slot, key, value, hash);
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+      return true;
+    }
+    // the bucket is full: split it and try again
+    bool split;
+    try {
+      split = SplitBucket(page, hash);
+    } catch (...) {
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      throw;
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    if (!split) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "The hash table cannot grow any further.");
+    }
+  }
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+bool EXTENDIBLE_HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  Page *page = LatchBucket(Hash(key), true);
+  auto *bucket = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+  bool removed = false;
+  for (slot_offset_t offset = 0; offset < BLOCK_ARRAY_SIZE && bucket->IsOccupied(offset) && !removed; offset++) {
+    if (bucket->IsReadable(offset) && comparator_(bucket->KeyAt(offset), key) == 0 &&
+        bucket->ValueAt(offset) == value) {
+      bucket->Remove(offset);
+      removed = true;
+    }
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), removed);
+  return removed;
+}
+
+/*****************************************************************************
+ * SPLIT
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+bool EXTENDIBLE_HASH_TABLE_TYPE::SplitBucket(Page *bucket_page, uint32_t hash) {
+  Page *directory_page = FetchTablePage(directory_page_id_);
+  auto *directory = reinterpret_cast<HashTableDirectoryPage *>(directory_page->GetData());
+  directory_page->WLatch();
+  uint32_t slot = hash & directory->GetGlobalDepthMask();
+  HashTableDirectoryPage *slot_page = GetDirectoryPage(directory, slot);
+  uint32_t local_depth = slot_page->GetLocalDepth(slot % HashTableDirectoryPage::DIRECTORY_ARRAY_SIZE);
+  ReleaseDirectoryPage(directory, slot_page, false);
+  if (local_depth == directory->GetGlobalDepth()) {
+    if (local_depth == HashTableDirectoryPage::MAX_DEPTH) {
+      directory_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+      return false;
+    }
+    try {
+      GrowDirectory(directory);
+    } catch (...) {
+      directory_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+      throw;
+    }
+  }
+  page_id_t new_page_id;
+  Page *new_page = buffer_pool_manager_->NewPage(&new_page_id);
+  if (new_page == nullptr) {
+    directory_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate a hash table bucket page.");
+  }
+  // nobody can reach the new bucket before the directory points at it, and then only once it is filled
+  new_page->WLatch();
+  uint32_t split_bit = 1U << local_depth;
+  // the slots that point at the bucket are the ones whose low local depth bits are those of the hash
+  for (uint32_t i = hash & (split_bit - 1); i < directory->Size(); i += split_bit) {
+    HashTableDirectoryPage *page = GetDirectoryPage(directory, i);
+    page->SetLocalDepth(i % HashTableDirectoryPage::DIRECTORY_ARRAY_SIZE, local_depth + 1);
+    if ((i & split_bit) != 0) {
+      page->SetBucketPageId(i % HashTableDirectoryPage::DIRECTORY_ARRAY_SIZE, new_page_id);
+    }
+    ReleaseDirectoryPage(directory, page, true);
+  }
+  directory_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+
+  auto *bucket = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(bucket_page->GetData());
+  auto *new_bucket = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(new_page->GetData());
+  // the pairs that stay are packed at the front, and every other slot is emptied, tombstones included
+  slot_offset_t next = 0;
+  slot_offset_t kept = 0;
+  for (slot_offset_t offset = 0; offset < BLOCK_ARRAY_SIZE && bucket->IsOccupied(offset); offset++) {
+    if (bucket->IsReadable(offset)) {
+      KeyType key = bucket->KeyAt(offset);
+      ValueType value = bucket->ValueAt(offset);
+      uint32_t pair_hash = Hash(key);
+      if ((pair_hash & split_bit) != 0) {
+        new_bucket->Insert(next++, key, value, pair_hash);
+      } else if (kept++ == offset) {
+        continue;
+      } else {
+        bucket->Insert(kept - 1, key, value, pair_hash);
+      }
+    }
+    bucket->Clear(offset);
+  }
+  new_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+  return true;
+}
+
+/*****************************************************************************
+ * GETGLOBALDEPTH
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+uint32_t EXTENDIBLE_HASH_TABLE_TYPE::GetGlobalDepth() {
+  Page *page = FetchTablePage(directory_page_id_);
+  page->RLatch();
+  uint32_t global_depth = reinterpret_cast<HashTableDirectoryPage *>(page->GetData())->GetGlobalDepth();
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  return global_depth;
+}
+
+/*****************************************************************************
+ * UTILITIES
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+uint32_t EXTENDIBLE_HASH_TABLE_TYPE::Hash(const KeyType &key) {
+  return static_cast<uint32_t>(hash_fn_.GetHash(key));
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+Page *EXTENDIBLE_HASH_TABLE_TYPE::LatchBucket(uint32_t hash, bool exclusive) {
+  Page *directory_page = FetchTablePage(directory_page_id_);
+  auto *directory = reinterpret_cast<HashTableDirectoryPage *>(directory_page->GetData());
+  while (true) {
+    directory_page->RLatch();
+    page_id_t bucket_page_id = GetBucketPageId(directory, hash);
+    directory_page->RUnlatch();
+    Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+    if (page == nullptr) {
+      buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch a hash table bucket page.");
+    }
+    exclusive ? page->WLatch() : page->RLatch();
+    // the bucket may have split between reading the directory and latching it
+    directory_page->RLatch();
+    bool current = GetBucketPageId(directory, hash) == bucket_page_id;
+    directory_page->RUnlatch();
+    if (current) {
+      buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+      return page;
+    }
+    exclusive ? page->WUnlatch() : page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+page_id_t EXTENDIBLE_HASH_TABLE_TYPE::GetBucketPageId(HashTableDirectoryPage *directory, uint32_t hash) {
+  uint32_t slot = hash & directory->GetGlobalDepthMask();
+  HashTableDirectoryPage *page = GetDirectoryPage(directory, slot);
+  page_id_t bucket_page_id = page->GetBucketPageId(slot % HashTableDirectoryPage::DIRECTORY_ARRAY_SIZE);
+  ReleaseDirectoryPage(directory, page, false);
+  return bucket_page_id;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+HashTableDirectoryPage *EXTENDIBLE_HASH_TABLE_TYPE::GetDirectoryPage(HashTableDirectoryPage *directory,
+                                                                     uint32_t slot) {
+  uint32_t page_idx = slot / HashTableDirectoryPage::DIRECTORY_ARRAY_SIZE;
+  if (page_idx == 0) {
+    return directory;
+  }
+  return reinterpret_cast<HashTableDirectoryPage *>(
+      FetchTablePage(directory->GetDirectoryPageId(page_idx))->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+void EXTENDIBLE_HASH_TABLE_TYPE::ReleaseDirectoryPage(HashTableDirectoryPage *directory, HashTableDirectoryPage *page,
+                                                      bool is_dirty) {
+  if (page != directory) {
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+void EXTENDIBLE_HASH_TABLE_TYPE::GrowDirectory(HashTableDirectoryPage *directory) {
+  if (directory->Size() >= HashTableDirectoryPage::DIRECTORY_ARRAY_SIZE) {
+    // the new upper half of the directory starts out as a copy of its pages
+    uint32_t num_pages = directory->NumPages();
+    for (uint32_t i = 0; i < num_pages; i++) {
+      page_id_t page_id;
+      Page *page = buffer_pool_manager_->NewPage(&page_id);
+      if (page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate a hash table directory page.");
+      }
+      HashTableDirectoryPage *source = GetDirectoryPage(directory, i * HashTableDirectoryPage::DIRECTORY_ARRAY_SIZE);
+      memcpy(page->GetData(), source, PAGE_SIZE);
+      ReleaseDirectoryPage(directory, source, false);
+      reinterpret_cast<HashTableDirectoryPage *>(page->GetData())->SetPageId(page_id);
+      directory->SetDirectoryPageId(num_pages + i, page_id);
+      buffer_pool_manager_->UnpinPage(page_id, true);
+    }
+  }
+  directory->IncrGlobalDepth();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+Page *EXTENDIBLE_HASH_TABLE_TYPE::FetchTablePage(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch a hash table page.");
+  }
+  return page;
+}
+
+template class ExtendibleHashTable<int, int, IntComparator>;
+template class ExtendibleHashTable<int, int, IntComparator, Murmur3Hasher>;
+
+template class ExtendibleHashTable<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExtendibleHashTable<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExtendibleHashTable<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_slot_owners.cpp
+//
+// Identification: src/container/hash/hash_slot_owners.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "container/hash/hash_slot_owners.h"
+
+#include "concurrency/transaction.h"
+
+namespace bustub {
+
+void HashSlotOwners::SetOwner(Transaction *txn, page_id_t page_id, slot_offset_t offset) {
+  std::lock_guard<std::recursive_mutex> guard(latch_);
+  uint64_t slot = SlotOf(page_id, offset);
+  if (txn == nullptr) {
+    owners_.erase(slot);
+    return;
+  }
+  auto [it, first_slot] = slots_.try_emplace(txn);
+  if (first_slot) {
+    txn->GetHashSlotOwnersSet()->push_back(weak_from_this());
+  }
+  it->second.push_back(slot);
+  owners_[slot] = txn;
+}
+
+Transaction *HashSlotOwners::GetOwner(page_id_t page_id, slot_offset_t offset) {
+  std::lock_guard<std::recursive_mutex> guard(latch_);
+  auto it = owners_.find(SlotOf(page_id, offset));
+  return it == owners_.end() ? nullptr : it->second;
+}
+
+void HashSlotOwners::Release(Transaction *txn) {
+  std::lock_guard<std::recursive_mutex> guard(latch_);
+  auto it = slots_.find(txn);
+  if (it == slots_.end()) {
+    return;
+  }
+  Transaction *owner = nullptr;
+  if (txn->GetState() != TransactionState::COMMITTED && txn->GetState() != TransactionState::ABORTED) {
+    orphans_.push_back(std::make_unique<Transaction>(txn->GetTransactionId()));
+    owner = orphans_.back().get();
+    owner->SetPrevLSN(txn->GetPrevLSN());
+  }
+  std::vector<uint64_t> owned;
+  for (uint64_t slot : it->second) {
+    auto owner_it = owners_.find(slot);
+    if (owner_it == owners_.end() || owner_it->second != txn) {
+      continue;
+    }
+    if (owner == nullptr) {
+      owners_.erase(owner_it);
+    } else {
+      owner_it->second = owner;
+      owned.push_back(slot);
+    }
+  }
+  slots_.erase(it);
+  if (owner != nullptr) {
+    slots_.emplace(owner, std::move(owned));
+  }
+}
+
+}  // namespace bustub
@@ -10,8 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
@@ -19,53 +21,615 @@
 #include "common/logger.h"
 #include "common/rid.h"
 #include "container/hash/linear_probe_hash_table.h"
+#include "storage/page/header_page.h"
 
 namespace bustub {
 
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
 HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                       const KeyComparator &comparator, size_t num_buckets,
-                                      HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {}
+                                      HashFunction<KeyType, Hasher> hash_fn, HashTableConcurrencyMode mode)
+    : name_(name),
+      buffer_pool_manager_(buffer_pool_manager),
+      log_manager_(buffer_pool_manager->GetLogManager()),
+      comparator_(comparator),
+      mode_(mode),
+      hash_fn_(std::move(hash_fn)) {
+  recorded_ = enable_logging && log_manager_ != nullptr;
+  if (recorded_) {
+    page_id_t header_page_id;
+    auto *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+    if (header_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch the header page.");
+    }
+    bool found = header_page->GetRootId(name_, &header_page_id);
+    buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, false);
+    if (found) {
+      OpenTable(header_page_id);
+      return;
+    }
+  }
+  header_page_id_ = NewTable(std::max<size_t>(num_buckets, 1), INVALID_PAGE_ID);
+  if (recorded_) {
+    UpdateHeaderPageRecord(true);
+  }
+}
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
 bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) {
-  return false;
+  uint64_t hash = hash_fn_.GetHash(key);
+  if (mode_ == HashTableConcurrencyMode::OPTIMISTIC) {
+    // lookups leave the migration to the writers, so as not to take the table latch
+    size_t num_results = result->size();
+    for (int attempt = 0; attempt < OPTIMISTIC_ATTEMPTS; attempt++) {
+      bool valid = OptimisticLookup(key, hash, [&](const KeyType &other, const ValueType &value) {
+        if (comparator_(other, key) == 0) {
+          result->push_back(value);
+        }
+        return false;
+      });
+      if (valid) {
+        return result->size() > num_results;
+      }
+      result->resize(num_results);
+      std::this_thread::yield();
+    }
+  } else {
+    MigrateSome();
+  }
+  table_latch_.RLock();
+  bool found = false;
+  auto visit = [&](Page *page, HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset) {
+    if (comparator_(block->KeyAt(offset), key) == 0) {
+      result->push_back(block->ValueAt(offset));
+      found = true;
+    }
+    return false;
+  };
+  ProbeMatches(header_page_id_, hash, ProbeLatch::SHARED, visit);
+  // the pairs that are still to be migrated
+  if (migrating_) {
+    ProbeMatches(old_header_page_id_, hash, ProbeLatch::SHARED, visit, migrated_);
+  }
+  table_latch_.RUnlock();
+  return found;
 }
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
 bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+  uint64_t hash = hash_fn_.GetHash(key);
+  MigrateSome();
+  while (true) {
+    table_latch_.RLock();
+    // the same key & value pair may only be stored once, in either table
+    bool duplicate = false;
+    bool checked = false;
+    for (int attempt = 0; mode_ == HashTableConcurrencyMode::OPTIMISTIC && attempt < OPTIMISTIC_ATTEMPTS && !checked;
+         attempt++) {
+      duplicate = false;
+      checked = OptimisticLookup(key, hash, [&](const KeyType &other, const ValueType &other_value) {
+        duplicate = duplicate || (comparator_(other, key) == 0 && other_value == value);
+        return duplicate;
+      });
+    }
+    if (!checked) {
+      auto visit = [&](Page *page, HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset) {
+        duplicate = comparator_(block->KeyAt(offset), key) == 0 && block->ValueAt(offset) == value;
+        return duplicate;
+      };
+      ProbeMatches(header_page_id_, hash, ProbeLatch::SHARED, visit);
+      if (!duplicate && migrating_) {
+        ProbeMatches(old_header_page_id_, hash, ProbeLatch::SHARED, visit, migrated_);
+      }
+    }
+    if (duplicate) {
+      table_latch_.RUnlock();
+      return false;
+    }
+    // take the first free slot of the run, which may be a tombstone
+    bool inserted;
+    if (mode_ == HashTableConcurrencyMode::OPTIMISTIC) {
+      inserted = Probe(header_page_id_, hash, ProbeLatch::NONE, [&](Page *page, HASH_TABLE_BLOCK_TYPE *block,
+                                                                    slot_offset_t offset) {
+        if (block->IsReadable(offset)) {
+          return false;
+        }
+        page->WLatch();
+        bool done = InsertAt(block, offset, key, value, hash, transaction);
+        page->WUnlatch();
+        return done;
+      });
+    } else {
+      inserted = Probe(header_page_id_, hash, ProbeLatch::EXCLUSIVE,
+                       [&](Page *page, HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset) {
+                         return InsertAt(block, offset, key, value, hash, transaction);
+                       });
+    }
+    size_t size = GetSizeOf(header_page_id_);
+    table_latch_.RUnlock();
+    if (!inserted) {
+      // every slot is taken: grow the table and try again
+      Resize(size);
+      continue;
+    }
+    // a migration under way frees up room faster than the inserts that go with it fill it
+    if (num_occupied_ > size * MAX_LOAD_FACTOR && !migrating_) {
+      Resize(size);
+    }
+    return true;
+  }
 }
 
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
 bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+  uint64_t hash = hash_fn_.GetHash(key);
+  MigrateSome();
+  table_latch_.RLock();
+  bool removed = false;
+  if (mode_ == HashTableConcurrencyMode::OPTIMISTIC) {
+    // only the page of a pair that might be the one gets latched, to check it again and remove it
+    auto visit = [&](Page *page, HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset) {
+      uint64_t version = page->GetVersion();
+      KeyType other = block->KeyAt(offset);
+      ValueType other_value = block->ValueAt(offset);
+      if (page->ValidateVersion(version) && (comparator_(other, key) != 0 || !(other_value == value))) {
+        return false;
+      }
+      page->WLatch();
+      removed = block->IsReadable(offset) && comparator_(block->KeyAt(offset), key) == 0 &&
+                block->ValueAt(offset) == value;
+      if (removed) {
+        RemoveAt(block, offset, transaction);
+      }
+      page->WUnlatch();
+      return removed;
+    };
+    ProbeMatches(header_page_id_, hash, ProbeLatch::NONE, visit, 0, true);
+    if (!removed && migrating_) {
+      ProbeMatches(old_header_page_id_, hash, ProbeLatch::NONE, visit, migrated_, true);
+    }
+  } else {
+    auto visit = [&](Page *page, HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset) {
+      removed = comparator_(block->KeyAt(offset), key) == 0 && block->ValueAt(offset) == value;
+      if (removed) {
+        RemoveAt(block, offset, transaction);
+      }
+      return removed;
+    };
+    ProbeMatches(header_page_id_, hash, ProbeLatch::EXCLUSIVE, visit);
+    if (!removed && migrating_) {
+      ProbeMatches(old_header_page_id_, hash, ProbeLatch::EXCLUSIVE, visit, migrated_);
+    }
+  }
+  table_latch_.RUnlock();
+  return removed;
 }
 
 /*****************************************************************************
  * RESIZE
  *****************************************************************************/
-template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Resize(size_t initial_size) {}
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+void HASH_TABLE_TYPE::Resize(size_t initial_size) {
+  // the new table of an earlier resize filled up before the old one was migrated: finish the migration a step at a
+  // time, so that the other operations go on in between
+  while (migrating_) {
+    MigrateStep();
+  }
+  table_latch_.WLock();
+  table_version_++;
+  try {
+    // another thread may have grown the table while this one waited for the latch
+    if (!migrating_ && GetSizeOf(header_page_id_) < 2 * initial_size) {
+      old_header_page_id_ = header_page_id_.load();
+      header_page_id_ = NewTable(2 * initial_size, old_header_page_id_);
+      num_occupied_ = 0;
+      migrated_ = 0;
+      migrating_ = true;
+      if (recorded_) {
+        UpdateHeaderPageRecord(false);
+      }
+    }
+  } catch (...) {
+    table_version_++;
+    table_latch_.WUnlock();
+    throw;
+  }
+  table_version_++;
+  table_latch_.WUnlock();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+void HASH_TABLE_TYPE::MigrateSome() {
+  if (migrating_ && ++migration_ops_ % MIGRATION_INTERVAL == 0) {
+    MigrateStep();
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+void HASH_TABLE_TYPE::MigrateStep() {
+  table_latch_.WLock();
+  table_version_++;
+  try {
+    // another thread may have migrated the last batch while this one waited for the latch
+    if (migrating_) {
+      MigrateBuckets(MIGRATION_INTERVAL * MIGRATION_BATCH);
+    }
+  } catch (...) {
+    table_version_++;
+    table_latch_.WUnlock();
+    throw;
+  }
+  table_version_++;
+  table_latch_.WUnlock();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+void HASH_TABLE_TYPE::MigrateBuckets(size_t num_buckets) {
+  // the owners of the pairs are logged for, so they must not end meanwhile
+  auto owners_lock = slot_owners_->Lock();
+  HashTableHeaderPage *old_header = FetchHeaderPage(old_header_page_id_);
+  size_t old_size = old_header->GetSize();
+  size_t end = old_size - migrated_ <= num_buckets ? old_size : migrated_ + num_buckets;
+  HASH_TABLE_BLOCK_TYPE *block = nullptr;
+  page_id_t block_page_id = INVALID_PAGE_ID;
+  for (; migrated_ < end; migrated_++) {
+    if (block == nullptr || migrated_ % BLOCK_ARRAY_SIZE == 0) {
+      if (block != nullptr) {
+        buffer_pool_manager_->UnpinPage(block_page_id, true);
+      }
+      block_page_id = old_header->GetBlockPageId(migrated_ / BLOCK_ARRAY_SIZE);
+      block = FetchBlockPage(block_page_id);
+    }
+    auto offset = static_cast<slot_offset_t>(migrated_ % BLOCK_ARRAY_SIZE);
+    Transaction *owner = IsLogged() ? slot_owners_->GetOwner(block_page_id, offset) : nullptr;
+    bool readable = block->IsReadable(offset);
+    // a tombstone moves along only if recovery may have to restore the pair in it
+    if (!readable && owner == nullptr) {
+      continue;
+    }
+    KeyType key = block->KeyAt(offset);
+    ValueType value = block->ValueAt(offset);
+    uint64_t hash = hash_fn_.GetHash(key);
+    bool moved = false;
+    if (resumed_migration_) {
+      ProbeMatches(header_page_id_, hash, ProbeLatch::SHARED,
+                   [&](Page *page, HASH_TABLE_BLOCK_TYPE *new_block, slot_offset_t new_offset) {
+                     moved = comparator_(new_block->KeyAt(new_offset), key) == 0 &&
+                             new_block->ValueAt(new_offset) == value;
+                     return moved;
+                   });
+    }
+    if (!moved) {
+      // the move is logged on behalf of the owner, so that undoing the owner's write undoes it in the new table
+      Probe(header_page_id_, hash, ProbeLatch::EXCLUSIVE,
+            [&](Page *page, HASH_TABLE_BLOCK_TYPE *new_block, slot_offset_t new_offset) {
+              if (!InsertAt(new_block, new_offset, key, value, hash, readable ? owner : nullptr)) {
+                return false;
+              }
+              if (!readable) {
+                RemoveAt(new_block, new_offset, owner);
+              }
+              return true;
+            });
+    }
+    // a tombstone, so that probes of the old table go on past the pair
+    if (readable) {
+      block->Remove(offset, nullptr, log_manager_);
+    } else {
+      block->MarkMoved(offset, log_manager_);
+    }
+    if (owner != nullptr) {
+      slot_owners_->SetOwner(nullptr, block_page_id, offset);
+    }
+  }
+  if (block != nullptr) {
+    buffer_pool_manager_->UnpinPage(block_page_id, true);
+  }
+  if (migrated_ < old_size) {
+    buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+    return;
+  }
+  // every pair has moved: free the old table, once the new one no longer refers to it
+  HashTableHeaderPage *header = FetchHeaderPage(header_page_id_);
+  header->SetOldPageId(INVALID_PAGE_ID);
+  if (enable_logging && log_manager_ != nullptr) {
+    LogRecord log_record(INVALID_TXN_ID, INVALID_LSN, LogRecordType::HASH_FREETABLE, old_header_page_id_,
+                         header_page_id_);
+    header->SetLSN(log_manager_->AppendLogRecord(&log_record));
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id_, true);
+  for (size_t i = 0; i < old_header->NumBlocks(); i++) {
+    buffer_pool_manager_->DeletePage(old_header->GetBlockPageId(i));
+  }
+  buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+  buffer_pool_manager_->DeletePage(old_header_page_id_);
+  old_header_page_id_ = INVALID_PAGE_ID;
+  migrating_ = false;
+  resumed_migration_ = false;
+}
 
 /*****************************************************************************
  * GETSIZE
  *****************************************************************************/
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
 size_t HASH_TABLE_TYPE::GetSize() {
-  return 0;
+  table_latch_.RLock();
+  size_t size = GetSizeOf(header_page_id_);
+  table_latch_.RUnlock();
+  return size;
+}
+
+/*****************************************************************************
+ * UTILITIES
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+page_id_t HASH_TABLE_TYPE::NewTable(size_t num_buckets, page_id_t old_header_page_id) {
+  size_t num_blocks = (num_buckets - 1) / BLOCK_ARRAY_SIZE + 1;
+  if (num_blocks > HashTableHeaderPage::MAX_BLOCKS) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "The hash table cannot grow any further.");
+  }
+  page_id_t header_page_id;
+  Page *page = buffer_pool_manager_->NewPage(&header_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate a hash table header page.");
+  }
+  auto *header = reinterpret_cast<HashTableHeaderPage *>(page->GetData());
+  header->SetPageId(header_page_id);
+  header->SetOldPageId(old_header_page_id);
+  header->SetSize(num_buckets);
+  std::vector<page_id_t> block_page_ids;
+  for (size_t i = 0; i < num_blocks; i++) {
+    page_id_t block_page_id;
+    Page *block_page = buffer_pool_manager_->NewPage(&block_page_id);
+    if (block_page == nullptr) {
+      buffer_pool_manager_->UnpinPage(header_page_id, true);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate a hash table block page.");
+    }
+    reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(block_page->GetData())->SetPageId(block_page_id);
+    header->AddBlockPageId(block_page_id);
+    block_page_ids.push_back(block_page_id);
+    buffer_pool_manager_->UnpinPage(block_page_id, true);
+  }
+  if (enable_logging && log_manager_ != nullptr) {
+    LogRecord log_record(INVALID_TXN_ID, INVALID_LSN, LogRecordType::HASH_NEWTABLE, old_header_page_id,
+                         header_page_id, num_buckets, std::move(block_page_ids));
+    header->SetLSN(log_manager_->AppendLogRecord(&log_record));
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id, true);
+  return header_page_id;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+void HASH_TABLE_TYPE::OpenTable(page_id_t header_page_id) {
+  header_page_id_ = header_page_id;
+  HashTableHeaderPage *header = FetchHeaderPage(header_page_id);
+  page_id_t old_header_page_id = header->GetOldPageId();
+  size_t num_occupied = 0;
+  for (size_t i = 0; i < header->NumBlocks(); i++) {
+    page_id_t block_page_id = header->GetBlockPageId(i);
+    HASH_TABLE_BLOCK_TYPE *block = FetchBlockPage(block_page_id);
+    for (slot_offset_t offset = 0; offset < BLOCK_ARRAY_SIZE; offset++) {
+      num_occupied += block->IsOccupied(offset) ? 1 : 0;
+    }
+    buffer_pool_manager_->UnpinPage(block_page_id, false);
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id, false);
+  num_occupied_ = num_occupied;
+  if (old_header_page_id != INVALID_PAGE_ID) {
+    old_header_page_id_ = old_header_page_id;
+    migrated_ = 0;
+    migrating_ = true;
+    resumed_migration_ = true;
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+void HASH_TABLE_TYPE::UpdateHeaderPageRecord(bool insert_record) {
+  // the record must not point at a table that the log on disk knows nothing of
+  log_manager_->Flush();
+  Page *page = buffer_pool_manager_->FetchPage(HEADER_PAGE_ID);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch the header page.");
+  }
+  auto *header_page = static_cast<HeaderPage *>(page);
+  page->WLatch();
+  if (insert_record) {
+    header_page->InsertRecord(name_, header_page_id_);
+  } else {
+    header_page->UpdateRecord(name_, header_page_id_);
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+  buffer_pool_manager_->FlushPage(HEADER_PAGE_ID);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+template <typename Visitor>
+bool HASH_TABLE_TYPE::Walk(page_id_t header_page_id, uint64_t hash, ProbeLatch latch, bool dirty, Visitor &&visit,
+                           size_t first_bucket) {
+  HashTableHeaderPage *header = FetchHeaderPage(header_page_id);
+  size_t size = header->GetSize();
+  // a lookup that takes no latch may read the header of a table that has just been freed
+  if (size == 0) {
+    buffer_pool_manager_->UnpinPage(header_page_id, false);
+    return false;
+  }
+  size_t bucket = std::max<size_t>(hash % size, first_bucket);
+  bool stopped = false;
+  for (size_t remaining = size; remaining > 0 && !stopped;) {
+    auto offset = static_cast<slot_offset_t>(bucket % BLOCK_ARRAY_SIZE);
+    size_t count = std::min({BLOCK_ARRAY_SIZE - offset, size - bucket, remaining});
+    page_id_t block_page_id = header->GetBlockPageId(bucket / BLOCK_ARRAY_SIZE);
+    Page *page = buffer_pool_manager_->FetchPage(block_page_id);
+    if (page == nullptr) {
+      buffer_pool_manager_->UnpinPage(header_page_id, false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch a hash table block page.");
+    }
+    if (latch != ProbeLatch::NONE) {
+      latch == ProbeLatch::EXCLUSIVE ? page->WLatch() : page->RLatch();
+    }
+    stopped = visit(page, reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData()), offset, count);
+    if (latch != ProbeLatch::NONE) {
+      latch == ProbeLatch::EXCLUSIVE ? page->WUnlatch() : page->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(block_page_id, dirty);
+    remaining -= count;
+    bucket = (bucket + count) % size;
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id, false);
+  return stopped;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+template <typename Visitor>
+bool HASH_TABLE_TYPE::Probe(page_id_t header_page_id, uint64_t hash, ProbeLatch latch, Visitor &&visit) {
+  return Walk(header_page_id, hash, latch, latch != ProbeLatch::SHARED,
+              [&](Page *page, HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset, size_t count) {
+                for (size_t i = 0; i < count; i++) {
+                  if (visit(page, block, static_cast<slot_offset_t>(offset + i))) {
+                    return true;
+                  }
+                }
+                return false;
+              },
+              0);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+template <typename Visitor>
+bool HASH_TABLE_TYPE::ProbeMatches(page_id_t header_page_id, uint64_t hash, ProbeLatch latch, Visitor &&visit,
+                                   size_t first_bucket, bool dirty) {
+  bool run_ended = false;
+  bool stopped =
+      Walk(header_page_id, hash, latch, dirty || latch == ProbeLatch::EXCLUSIVE,
+           [&](Page *page, HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset, size_t count) {
+             for (size_t group = 0; group < count; group += BLOCK_GROUP_SIZE) {
+               auto group_offset = static_cast<slot_offset_t>(offset + group);
+               size_t group_size = std::min<size_t>(BLOCK_GROUP_SIZE, count - group);
+               uint32_t empty;
+               uint32_t match = block->MatchGroup(group_offset, hash, &empty);
+               uint32_t in_group = group_size == BLOCK_GROUP_SIZE ? ~0U : (1U << group_size) - 1;
+               // the run ends at the first empty slot; the matches after it belong to other runs
+               empty &= in_group;
+               uint32_t in_run = empty == 0 ? in_group : (empty & -empty) - 1;
+               for (match &= in_run; match != 0; match &= match - 1) {
+                 if (visit(page, block, static_cast<slot_offset_t>(group_offset + __builtin_ctz(match)))) {
+                   return true;
+                 }
+               }
+               if (empty != 0) {
+                 run_ended = true;
+                 return true;
+               }
+             }
+             return false;
+           },
+           first_bucket);
+  return stopped && !run_ended;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+template <typename Visitor>
+bool HASH_TABLE_TYPE::ReadProbe(page_id_t header_page_id, uint64_t hash, Visitor &&visit, size_t first_bucket) {
+  bool valid = true;
+  ProbeMatches(header_page_id, hash, ProbeLatch::NONE,
+               [&](Page *page, HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset) {
+                 // the pair may be torn by a writer that reuses the slot, so it is only looked at if the version holds
+                 uint64_t version = page->GetVersion();
+                 bool readable = block->IsReadable(offset);
+                 KeyType key = block->KeyAt(offset);
+                 ValueType value = block->ValueAt(offset);
+                 if (!page->ValidateVersion(version)) {
+                   valid = false;
+                   return true;
+                 }
+                 return readable && visit(key, value);
+               },
+               first_bucket);
+  return valid;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+template <typename Visitor>
+bool HASH_TABLE_TYPE::OptimisticLookup(const KeyType &key, uint64_t hash, Visitor &&visit) {
+  uint64_t version = table_version_.load();
+  if (version % 2 == 1) {
+    return false;
+  }
+  // a pair that a migration step moves between the two probes shows up as a new table version
+  size_t migrated = migrated_;
+  page_id_t old_header_page_id = old_header_page_id_;
+  bool valid = ReadProbe(header_page_id_, hash, visit);
+  if (valid && old_header_page_id != INVALID_PAGE_ID) {
+    valid = ReadProbe(old_header_page_id, hash, visit, migrated);
+  }
+  return valid && table_version_.load() == version;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+bool HASH_TABLE_TYPE::InsertAt(HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset, const KeyType &key,
+                               const ValueType &value, uint64_t hash, Transaction *transaction) {
+  bool empty = !block->IsOccupied(offset);
+  if (!empty && IsLogged() && !block->IsReadable(offset) &&
+      slot_owners_->GetOwner(block->GetPageId(), offset) != nullptr) {
+    return false;
+  }
+  if (!block->Insert(offset, key, value, hash, transaction, log_manager_)) {
+    return false;
+  }
+  if (empty) {
+    num_occupied_++;
+  }
+  if (transaction != nullptr && IsLogged()) {
+    slot_owners_->SetOwner(transaction, block->GetPageId(), offset);
+  }
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+void HASH_TABLE_TYPE::RemoveAt(HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset, Transaction *transaction) {
+  block->Remove(offset, transaction, log_manager_);
+  // a remove that belongs to no transaction is never undone, so nor is the insert of the pair
+  if (IsLogged()) {
+    slot_owners_->SetOwner(transaction, block->GetPageId(), offset);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+size_t HASH_TABLE_TYPE::GetSizeOf(page_id_t header_page_id) {
+  size_t size = FetchHeaderPage(header_page_id)->GetSize();
+  buffer_pool_manager_->UnpinPage(header_page_id, false);
+  return size;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+HashTableHeaderPage *HASH_TABLE_TYPE::FetchHeaderPage(page_id_t header_page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(header_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch the hash table header page.");
+  }
+  return reinterpret_cast<HashTableHeaderPage *>(page->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher>
+HASH_TABLE_BLOCK_TYPE *HASH_TABLE_TYPE::FetchBlockPage(page_id_t block_page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(block_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch a hash table block page.");
+  }
+  return reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
 }
 
 template class LinearProbeHashTable<int, int, IntComparator>;
+template class LinearProbeHashTable<int, int, IntComparator, Murmur3Hasher>;
 
 template class LinearProbeHashTable<GenericKey<4>, RID, GenericComparator<4>>;
 template class LinearProbeHashTable<GenericKey<8>, RID, GenericComparator<8>>;
@@ -18,12 +18,47 @@ namespace bustub {
 
 AggregationExecutor::AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
                                          std::unique_ptr<AbstractExecutor> &&child)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      child_(std::move(child)),
+      aht_(plan->GetAggregates(), plan->GetAggregateTypes(), exec_ctx->GetPool()),
+      aht_iterator_(aht_.Begin()) {}
 
 const AbstractExecutor *AggregationExecutor::GetChildExecutor() const { return child_.get(); }
 
-void AggregationExecutor::Init() {}
+void AggregationExecutor::Init() {
+  child_->Init();
+  aht_.Clear();
+  TupleView tuple;
+  RID rid;
+  AggregateKey key;
+  AggregateValue val;
+  while (child_->NextView(&tuple, &rid)) {
+    MakeKey(&*tuple, &key);
+    MakeVal(&*tuple, &val);
+    aht_.InsertCombine(key, val);
+  }
+  aht_iterator_ = aht_.Begin();
+}
 
-bool AggregationExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+bool AggregationExecutor::Next(Tuple *tuple, RID *rid) {
+  const AbstractExpression *having = plan_->GetHaving();
+  for (; aht_iterator_ != aht_.End(); ++aht_iterator_) {
+    const auto &group_bys = aht_iterator_.Key().group_bys_;
+    const auto &aggregates = aht_iterator_.Val().aggregates_;
+    if (having != nullptr && !having->EvaluateAggregate(group_bys, aggregates).GetAs<bool>()) {
+      continue;
+    }
+    values_.clear();
+    for (const auto &col : GetOutputSchema()->GetColumns()) {
+      values_.push_back(col.GetExpr()->EvaluateAggregate(group_bys, aggregates));
+    }
+    tuple->SetValues(values_, GetOutputSchema());
+    *rid = RID();
+    ++aht_iterator_;
+    return true;
+  }
+  return false;
+}
 
 }  // namespace bustub
@@ -9,14 +9,362 @@
 // Copyright (c) 2015-19, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
 #include "execution/executors/index_scan_executor.h"
 
+#include "concurrency/lock_manager.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/conjunction_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "type/value_factory.h"
+
 namespace bustub {
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void IndexScanExecutor::Init() {
+  Catalog *catalog = exec_ctx_->GetCatalog();
+  index_info_ = catalog->GetIndex(plan_->GetIndexOid());
+  table_info_ = catalog->GetTable(index_info_->table_name_);
+  lo_.reset();
+  hi_.reset();
+  empty_range_ = false;
+  cursor_.reset();
+  rids_.clear();
+  rid_idx_ = 0;
+  entries_.clear();
+
+  // a query that reads only the columns stored in the index entries never needs the table heap
+  Index *index = index_info_->index_.get();
+  index_only_ = index->SupportsIndexOnlyScans() && IsCovered(plan_->GetPredicate());
+  for (const auto &col : GetOutputSchema()->GetColumns()) {
+    index_only_ = index_only_ && col.GetExpr() != nullptr && IsCovered(col.GetExpr());
+  }
+  if (index_only_) {
+    row_values_.clear();
+    for (const auto &col : table_info_->schema_.GetColumns()) {
+      row_values_.push_back(col.GetType() == TypeId::VARCHAR ? ValueFactory::GetVarcharValue("")
+                                                             : ValueFactory::GetNullValueByType(col.GetType()));
+    }
+  }
+
+  // bounds on the leading key column only make a key range if it is the only one
+  if (plan_->GetPredicate() != nullptr && index_info_->index_->GetKeyAttrs().size() == 1) {
+    ExtractKeyRange(plan_->GetPredicate());
+  }
+  if (empty_range_) {
+    return;
+  }
+
+  Transaction *txn = exec_ctx_->GetTransaction();
+  if (lo_.has_value() && hi_.has_value() && lo_->inclusive_ && hi_->inclusive_ &&
+      lo_->value_.CompareEquals(hi_->value_) == CmpBool::CmpTrue) {
+    // a point lookup, which every index supports
+    if (index_only_) {
+      index->ScanKeyEntries(MakeKey(*lo_), &rids_, &entries_, txn);
+    } else {
+      index->ScanKey(MakeKey(*lo_), &rids_, txn);
+    }
+    return;
+  }
+  std::optional<Tuple> lo_key;
+  std::optional<Tuple> hi_key;
+  if (lo_.has_value()) {
+    lo_key = MakeKey(*lo_);
+  }
+  if (hi_.has_value()) {
+    hi_key = MakeKey(*hi_);
+  }
+  cursor_ = index->ScanRange(lo_key.has_value() ? &*lo_key : nullptr, lo_.has_value() && lo_->inclusive_,
+                             hi_key.has_value() ? &*hi_key : nullptr, hi_.has_value() && hi_->inclusive_,
+                             plan_->GetDirection(), txn);
+}
+
+bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) {
+  TupleView view;
+  if (!NextView(&view, rid)) {
+    return false;
+  }
+  *tuple = view.ToTuple();
+  return true;
+}
+
+bool IndexScanExecutor::NextView(TupleView *view, RID *rid) {
+  const Schema *schema = &table_info_->schema_;
+  const AbstractExpression *predicate = plan_->GetPredicate();
+  while (true) {
+    if (rid_idx_ == rids_.size()) {
+      rids_.clear();
+      rid_idx_ = 0;
+      entries_.clear();
+      if (cursor_ == nullptr ||
+          !(index_only_ ? cursor_->NextEntryBatch(&rids_, &entries_) : cursor_->NextBatch(&rids_))) {
+        return false;
+      }
+    }
+    RID table_rid = rids_[rid_idx_++];
+    Transaction *txn = exec_ctx_->GetTransaction();
+    if (index_only_) {
+      // take the shared lock that reading the tuple from the heap would have taken
+      if (enable_logging && !txn->IsSharedLocked(table_rid) && !txn->IsExclusiveLocked(table_rid) &&
+          !exec_ctx_->GetLockManager()->LockShared(txn, table_rid)) {
+        continue;
+      }
+      EntryToRow(entries_[rid_idx_ - 1], &table_tuple_);
+    } else if (!table_info_->table_->GetTuple(table_rid, &table_tuple_, txn)) {
+      continue;
+    }
+    if (predicate != nullptr && !predicate->Evaluate(&table_tuple_, schema).GetAs<bool>()) {
+      continue;
+    }
+    values_.clear();
+    for (const auto &col : GetOutputSchema()->GetColumns()) {
+      values_.push_back(col.GetExpr()->EvaluateView(&table_tuple_, schema));
+    }
+    output_.SetValues(values_, GetOutputSchema());
+    *view = TupleView(output_);
+    *rid = table_rid;
+    return true;
+  }
+}
+
+void IndexScanExecutor::ExtractKeyRange(const AbstractExpression *expr) {
+  if (const auto *conjunction = dynamic_cast<const ConjunctionExpression *>(expr)) {
+    if (conjunction->GetConjunctionType() == ConjunctionType::And) {
+      ExtractKeyRange(conjunction->GetChildAt(0));
+      ExtractKeyRange(conjunction->GetChildAt(1));
+    }
+    return;
+  }
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(expr);
+  if (comparison == nullptr) {
+    return;
+  }
+  ComparisonType comp_type = comparison->GetComparisonType();
+  const auto *column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0));
+  const auto *constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(1));
+  if (column == nullptr || constant == nullptr) {
+    // (constant op column) is (column op' constant) with the operator mirrored
+    column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1));
+    constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(0));
+    switch (comp_type) {
+      case ComparisonType::LessThan:
+        comp_type = ComparisonType::GreaterThan;
+        break;
+      case ComparisonType::LessThanOrEqual:
+        comp_type = ComparisonType::GreaterThanOrEqual;
+        break;
+      case ComparisonType::GreaterThan:
+        comp_type = ComparisonType::LessThan;
+        break;
+      case ComparisonType::GreaterThanOrEqual:
+        comp_type = ComparisonType::LessThanOrEqual;
+        break;
+      default:
+        break;
+    }
+  }
+  if (column == nullptr || constant == nullptr || column->GetColIdx() != index_info_->index_->GetKeyAttrs()[0]) {
+    return;
+  }
+  Value value = constant->Evaluate(nullptr, nullptr);
+  if (value.IsNull()) {
+    // a comparison with NULL is never true
+    empty_range_ = true;
+    return;
+  }
+  if (!ToKeyType(&comp_type, &value)) {
+    return;
+  }
+  TightenKeyRange(comp_type, value);
+}
+
+bool IndexScanExecutor::ToKeyType(ComparisonType *comp_type, Value *value) {
+  TypeId key_type = index_info_->index_->GetKeySchema()->GetColumn(0).GetType();
+  TypeId type = value->GetTypeId();
+  if (type == key_type) {
+    return true;
+  }
+  bool is_integer = type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER ||
+                    type == TypeId::BIGINT;
+  if (key_type == TypeId::DECIMAL) {
+    // an integer is a decimal as it is, up to the 53 bits of the mantissa
+    if (!is_integer || std::abs(value->CastAs(TypeId::BIGINT).GetAs<int64_t>()) > (int64_t{1} << 53)) {
+      return false;
+    }
+    *value = value->CastAs(TypeId::DECIMAL);
+    return true;
+  }
+  int64_t min;
+  int64_t max;
+  switch (key_type) {
+    case TypeId::TINYINT:
+      min = BUSTUB_INT8_MIN;
+      max = BUSTUB_INT8_MAX;
+      break;
+    case TypeId::SMALLINT:
+      min = BUSTUB_INT16_MIN;
+      max = BUSTUB_INT16_MAX;
+      break;
+    case TypeId::INTEGER:
+      min = BUSTUB_INT32_MIN;
+      max = BUSTUB_INT32_MAX;
+      break;
+    case TypeId::BIGINT:
+      min = BUSTUB_INT64_MIN;
+      max = BUSTUB_INT64_MAX;
+      break;
+    default:
+      // no other types convert into each other without changing their order, so leave the range to the predicate
+      return false;
+  }
+
+  // the bound as an integer, which may lie outside of the key type
+  int64_t bound;
+  bool is_above = false;
+  bool is_below = false;
+  if (is_integer) {
+    bound = value->CastAs(TypeId::BIGINT).GetAs<int64_t>();
+  } else if (type == TypeId::DECIMAL) {
+    auto decimal = value->GetAs<double>();
+    if (std::isnan(decimal)) {
+      return false;
+    }
+    // round toward the keys the comparison lets through: column < 5.5 is column < 6, column > 5.5 is column > 5
+    double rounded = decimal;
+    switch (*comp_type) {
+      case ComparisonType::Equal:
+        if (std::floor(decimal) != decimal) {
+          empty_range_ = true;
+          return false;
+        }
+        break;
+      case ComparisonType::LessThan:
+      case ComparisonType::GreaterThanOrEqual:
+        rounded = std::ceil(decimal);
+        break;
+      case ComparisonType::LessThanOrEqual:
+      case ComparisonType::GreaterThan:
+        rounded = std::floor(decimal);
+        break;
+      default:
+        return false;
+    }
+    // 2^63, the first double past the largest BIGINT
+    constexpr double int64_limit = 9223372036854775808.0;
+    is_above = rounded >= int64_limit;
+    is_below = rounded < -int64_limit;
+    bound = is_above || is_below ? 0 : static_cast<int64_t>(rounded);
+  } else {
+    return false;
+  }
+  is_above = is_above || (!is_below && bound > max);
+  is_below = is_below || (!is_above && bound < min);
+
+  // a bound beyond every key either lets all keys through, which leaves the range open, or none
+  bool is_upper = *comp_type == ComparisonType::LessThan || *comp_type == ComparisonType::LessThanOrEqual;
+  bool is_lower = *comp_type == ComparisonType::GreaterThan || *comp_type == ComparisonType::GreaterThanOrEqual;
+  if (!is_upper && !is_lower && *comp_type != ComparisonType::Equal) {
+    return false;
+  }
+  if ((is_above && is_upper) || (is_below && is_lower)) {
+    return false;
+  }
+  if (is_above || is_below) {
+    empty_range_ = true;
+    return false;
+  }
+  switch (key_type) {
+    case TypeId::TINYINT:
+      *value = ValueFactory::GetTinyIntValue(static_cast<int8_t>(bound));
+      break;
+    case TypeId::SMALLINT:
+      *value = ValueFactory::GetSmallIntValue(static_cast<int16_t>(bound));
+      break;
+    case TypeId::INTEGER:
+      *value = ValueFactory::GetIntegerValue(static_cast<int32_t>(bound));
+      break;
+    default:
+      *value = ValueFactory::GetBigIntValue(bound);
+      break;
+  }
+  return true;
+}
+
+void IndexScanExecutor::TightenKeyRange(ComparisonType comp_type, const Value &value) {
+  bool tighten_lo = false;
+  bool tighten_hi = false;
+  bool inclusive = true;
+  switch (comp_type) {
+    case ComparisonType::Equal:
+      tighten_lo = tighten_hi = true;
+      break;
+    case ComparisonType::LessThan:
+      tighten_hi = true;
+      inclusive = false;
+      break;
+    case ComparisonType::LessThanOrEqual:
+      tighten_hi = true;
+      break;
+    case ComparisonType::GreaterThan:
+      tighten_lo = true;
+      inclusive = false;
+      break;
+    case ComparisonType::GreaterThanOrEqual:
+      tighten_lo = true;
+      break;
+    default:
+      return;
+  }
+  // keep the larger lower bound and the smaller upper bound; on a tie the exclusive one is tighter
+  if (tighten_lo && (!lo_.has_value() || value.CompareGreaterThan(lo_->value_) == CmpBool::CmpTrue ||
+                     (value.CompareEquals(lo_->value_) == CmpBool::CmpTrue && !inclusive))) {
+    lo_ = KeyBound{value, inclusive};
+  }
+  if (tighten_hi && (!hi_.has_value() || value.CompareLessThan(hi_->value_) == CmpBool::CmpTrue ||
+                     (value.CompareEquals(hi_->value_) == CmpBool::CmpTrue && !inclusive))) {
+    hi_ = KeyBound{value, inclusive};
+  }
+  if (lo_.has_value() && hi_.has_value()) {
+    CmpBool cmp = lo_->value_.CompareGreaterThan(hi_->value_);
+    bool same = lo_->value_.CompareEquals(hi_->value_) == CmpBool::CmpTrue;
+    empty_range_ = empty_range_ || cmp == CmpBool::CmpTrue || (same && !(lo_->inclusive_ && hi_->inclusive_));
+  }
+}
+
+bool IndexScanExecutor::IsCovered(const AbstractExpression *expr) const {
+  if (expr == nullptr) {
+    return true;
+  }
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(expr)) {
+    const auto &entry_attrs = index_info_->index_->GetEntryAttrs();
+    return std::find(entry_attrs.begin(), entry_attrs.end(), column->GetColIdx()) != entry_attrs.end();
+  }
+  for (const auto *child : expr->GetChildren()) {
+    if (!IsCovered(child)) {
+      return false;
+    }
+  }
+  return true;
+}
 
-void IndexScanExecutor::Init() {}
+void IndexScanExecutor::EntryToRow(const Tuple &entry, Tuple *row) {
+  Schema *entry_schema = index_info_->index_->GetEntrySchema();
+  const auto &entry_attrs = index_info_->index_->GetEntryAttrs();
+  for (uint32_t i = 0; i < entry_attrs.size(); i++) {
+    row_values_[entry_attrs[i]] = entry.GetValue(entry_schema, i);
+  }
+  row->SetValues(row_values_, &table_info_->schema_);
+}
 
-bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+Tuple IndexScanExecutor::MakeKey(const KeyBound &bound) const {
+  // ExtractKeyRange has turned the bound into a value of the key type
+  const Schema *key_schema = index_info_->index_->GetKeySchema();
+  std::vector<Value> values{bound.value_};
+  return Tuple(values, key_schema);
+}
 
 }  // namespace bustub
@@ -1,26 +1,73 @@
-//===----------------------------------------------------------------------===//
-//
-//                         BusTub
-//
-// insert_executor.cpp
-//
-// Identification: src/execution/insert_executor.cpp
-//
-// Copyright (c) 2015-19, Carnegie Mellon University Database Group
-//
-//===----------------------------------------------------------------------===//
-#include <memory>
-
-#include "execution/executors/insert_executor.h"
-
-namespace bustub {
-
-InsertExecutor::InsertExecutor(ExecutorContext *exec_ctx, const InsertPlanNode *plan,
-                               std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
-
-void InsertExecutor::Init() {}
-
-bool InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) { return false; }
-
-}  // namespace bustub
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// insert_executor.cpp
+//
+// Identification: src/execution/insert_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include <memory>
+#include <utility>
+
+#include "execution/executors/insert_executor.h"
+
+namespace bustub {
+
+InsertExecutor::InsertExecutor(ExecutorContext *exec_ctx, const InsertPlanNode *plan,
+                               std::unique_ptr<AbstractExecutor> &&child_executor)
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+
+void InsertExecutor::Init() {
+  Catalog *catalog = exec_ctx_->GetCatalog();
+  table_info_ = catalog->GetTable(plan_->TableOid());
+  indexes_ = catalog->GetTableIndexes(table_info_->name_);
+  raw_idx_ = 0;
+  done_ = false;
+  if (child_executor_ != nullptr) {
+    child_executor_->Init();
+  }
+}
+
+bool InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) {
+  if (done_) {
+    return false;
+  }
+  done_ = true;
+  Transaction *txn = exec_ctx_->GetTransaction();
+  for (NextBatch(); !batch_.empty(); NextBatch()) {
+    if (!table_info_->table_->InsertTuples(batch_, &rids_, txn)) {
+      return false;
+    }
+    for (auto *index_info : indexes_) {
+      Index *index = index_info->index_.get();
+      for (size_t i = 0; i < batch_.size(); i++) {
+        Tuple entry = batch_[i].KeyFromTuple(table_info_->schema_, *index->GetEntrySchema(), index->GetEntryAttrs());
+        index->InsertEntry(entry, rids_[i], txn);
+        txn->GetIndexWriteSet()->emplace_back(rids_[i], table_info_->oid_, WType::INSERT, batch_[i],
+                                              index_info->index_oid_, exec_ctx_->GetCatalog());
+      }
+    }
+  }
+  return true;
+}
+
+void InsertExecutor::NextBatch() {
+  batch_.clear();
+  if (plan_->IsRawInsert()) {
+    const auto &raw_values = plan_->RawValues();
+    for (; batch_.size() < BATCH_SIZE && raw_idx_ < raw_values.size(); raw_idx_++) {
+      batch_.emplace_back(raw_values[raw_idx_], &table_info_->schema_);
+    }
+    return;
+  }
+  Tuple tuple;
+  RID rid;
+  while (batch_.size() < BATCH_SIZE && child_executor_->Next(&tuple, &rid)) {
+    batch_.push_back(std::move(tuple));
+  }
+}
+
+}  // namespace bustub
@@ -17,10 +17,60 @@ namespace bustub {
 NestedLoopJoinExecutor::NestedLoopJoinExecutor(ExecutorContext *exec_ctx, const NestedLoopJoinPlanNode *plan,
                                                std::unique_ptr<AbstractExecutor> &&left_executor,
                                                std::unique_ptr<AbstractExecutor> &&right_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      left_executor_(std::move(left_executor)),
+      right_executor_(std::move(right_executor)) {}
 
-void NestedLoopJoinExecutor::Init() {}
+void NestedLoopJoinExecutor::Init() {
+  left_executor_->Init();
+  right_executor_->Init();
+  right_tuples_.clear();
+  TupleView right_tuple;
+  RID right_rid;
+  while (right_executor_->NextView(&right_tuple, &right_rid)) {
+    right_tuples_.push_back(right_tuple.ToTuple(exec_ctx_->GetPool()));
+  }
+  has_left_tuple_ = false;
+  right_idx_ = 0;
+}
 
-bool NestedLoopJoinExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+bool NestedLoopJoinExecutor::Next(Tuple *tuple, RID *rid) {
+  TupleView view;
+  if (!NextView(&view, rid)) {
+    return false;
+  }
+  *tuple = view.ToTuple();
+  return true;
+}
+
+bool NestedLoopJoinExecutor::NextView(TupleView *view, RID *rid) {
+  const Schema *left_schema = left_executor_->GetOutputSchema();
+  const Schema *right_schema = right_executor_->GetOutputSchema();
+  const AbstractExpression *predicate = plan_->Predicate();
+  RID left_rid;
+  while (true) {
+    if (!has_left_tuple_ || right_idx_ == right_tuples_.size()) {
+      if (right_tuples_.empty() || !left_executor_->NextView(&left_tuple_, &left_rid)) {
+        return false;
+      }
+      has_left_tuple_ = true;
+      right_idx_ = 0;
+    }
+    const Tuple *right_tuple = &right_tuples_[right_idx_++];
+    if (predicate != nullptr &&
+        !predicate->EvaluateJoin(&*left_tuple_, left_schema, right_tuple, right_schema).GetAs<bool>()) {
+      continue;
+    }
+    values_.clear();
+    for (const auto &col : GetOutputSchema()->GetColumns()) {
+      values_.emplace_back(col.GetExpr()->EvaluateJoinView(&*left_tuple_, left_schema, right_tuple, right_schema));
+    }
+    output_.SetValues(values_, GetOutputSchema());
+    *view = TupleView(output_);
+    *rid = RID();
+    return true;
+  }
+}
 
 }  // namespace bustub
@@ -1,22 +1,240 @@
-//===----------------------------------------------------------------------===//
-//
-//                         BusTub
-//
-// seq_scan_executor.cpp
-//
-// Identification: src/execution/seq_scan_executor.cpp
-//
-// Copyright (c) 2015-19, Carnegie Mellon University Database Group
-//
-//===----------------------------------------------------------------------===//
-#include "execution/executors/seq_scan_executor.h"
-
-namespace bustub {
-
-SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan) : AbstractExecutor(exec_ctx) {}
-
-void SeqScanExecutor::Init() {}
-
-bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) { return false; }
-
-}  // namespace bustub
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// seq_scan_executor.cpp
+//
+// Identification: src/execution/seq_scan_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include "execution/executors/seq_scan_executor.h"
+
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+
+namespace bustub {
+
+SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void SeqScanExecutor::Init() {
+  table_info_ = exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid());
+  scan_ = std::make_unique<TableScan>(table_info_->table_.get(), exec_ctx_->GetTransaction());
+  is_identity_ = IsIdentity();
+  column_scan_.reset();
+  selection_.clear();
+  selection_row_ = 0;
+  if (is_identity_ || table_info_->table_->GetFormat() != TableFormat::PAX) {
+    return;
+  }
+  // Read only the columns that the predicate and the output columns need, if that leaves any out.
+  const Schema *schema = &table_info_->schema_;
+  std::vector<bool> columns(schema->GetColumnCount());
+  CollectColumns(plan_->GetPredicate(), &columns);
+  for (const auto &col : GetOutputSchema()->GetColumns()) {
+    CollectColumns(col.GetExpr(), &columns);
+  }
+  std::vector<uint32_t> column_ids;
+  for (uint32_t i = 0; i < columns.size(); i++) {
+    if (columns[i]) {
+      column_ids.push_back(i);
+    }
+  }
+  if (column_ids.size() < columns.size()) {
+    column_scan_ = std::make_unique<ColumnScan>(table_info_->table_.get(), schema, std::move(column_ids),
+                                                exec_ctx_->GetTransaction());
+    InitFilter();
+  }
+}
+
+void SeqScanExecutor::InitFilter() {
+  filter_column_ = INVALID_FILTER_COLUMN;
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(plan_->GetPredicate());
+  if (comparison == nullptr) {
+    return;
+  }
+  const auto *column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0));
+  const auto *constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(1));
+  filter_type_ = comparison->GetComparisonType();
+  if (column == nullptr) {
+    // A constant on the left compares the other way around.
+    column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1));
+    constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(0));
+    switch (filter_type_) {
+      case ComparisonType::LessThan:
+        filter_type_ = ComparisonType::GreaterThan;
+        break;
+      case ComparisonType::LessThanOrEqual:
+        filter_type_ = ComparisonType::GreaterThanOrEqual;
+        break;
+      case ComparisonType::GreaterThan:
+        filter_type_ = ComparisonType::LessThan;
+        break;
+      case ComparisonType::GreaterThanOrEqual:
+        filter_type_ = ComparisonType::LessThanOrEqual;
+        break;
+      default:
+        break;
+    }
+  }
+  if (column == nullptr || constant == nullptr) {
+    return;
+  }
+  filter_constant_ = constant->Evaluate(nullptr, nullptr);
+  TypeId type = table_info_->schema_.GetColumn(column->GetColIdx()).GetType();
+  bool is_integer = type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER ||
+                    type == TypeId::BIGINT;
+  if (is_integer && filter_constant_.GetTypeId() == type && !filter_constant_.IsNull()) {
+    filter_column_ = column->GetColIdx();
+  }
+}
+
+bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) {
+  TupleView view;
+  if (!NextView(&view, rid)) {
+    return false;
+  }
+  *tuple = view.ToTuple();
+  return true;
+}
+
+bool SeqScanExecutor::NextView(TupleView *view, RID *rid) {
+  if (column_scan_ != nullptr) {
+    return NextBatchView(view, rid);
+  }
+  const Schema *schema = &table_info_->schema_;
+  const AbstractExpression *predicate = plan_->GetPredicate();
+  TupleView table_tuple;
+  while (scan_->Next(&table_tuple)) {
+    if (predicate != nullptr && !predicate->Evaluate(&*table_tuple, schema).GetAs<bool>()) {
+      continue;
+    }
+    *rid = table_tuple->GetRid();
+    if (is_identity_) {
+      *view = table_tuple;
+      return true;
+    }
+    // The values may point into the table tuple, which output_ copies them out of.
+    values_.clear();
+    for (const auto &col : GetOutputSchema()->GetColumns()) {
+      values_.push_back(col.GetExpr()->EvaluateView(&*table_tuple, schema));
+    }
+    output_.SetValues(values_, GetOutputSchema());
+    *view = TupleView(output_);
+    return true;
+  }
+  return false;
+}
+
+bool SeqScanExecutor::NextBatchView(TupleView *view, RID *rid) {
+  while (selection_row_ == selection_.size()) {
+    if (!column_scan_->Next(&batch_)) {
+      return false;
+    }
+    SelectRows();
+    selection_row_ = 0;
+  }
+  uint32_t row = selection_[selection_row_++];
+  *rid = batch_.GetRid(row);
+  // The values may point into the batch, which output_ copies them out of.
+  values_.clear();
+  for (const auto &col : GetOutputSchema()->GetColumns()) {
+    values_.push_back(col.GetExpr()->EvaluateBatch(batch_, row));
+  }
+  output_.SetValues(values_, GetOutputSchema());
+  *view = TupleView(output_);
+  return true;
+}
+
+void SeqScanExecutor::SelectRows() {
+  selection_.clear();
+  const AbstractExpression *predicate = plan_->GetPredicate();
+  if (filter_column_ != INVALID_FILTER_COLUMN) {
+    switch (filter_constant_.GetTypeId()) {
+      case TypeId::TINYINT:
+        return SelectCompared(filter_constant_.GetAs<int8_t>());
+      case TypeId::SMALLINT:
+        return SelectCompared(filter_constant_.GetAs<int16_t>());
+      case TypeId::INTEGER:
+        return SelectCompared(filter_constant_.GetAs<int32_t>());
+      case TypeId::BIGINT:
+        return SelectCompared(filter_constant_.GetAs<int64_t>());
+      default:
+        BUSTUB_ASSERT(false, "Only integer columns are compared a batch at a time.");
+    }
+  }
+  for (uint32_t row = 0; row < batch_.GetSize(); row++) {
+    if (predicate == nullptr || predicate->EvaluateBatch(batch_, row).GetAs<bool>()) {
+      selection_.push_back(row);
+    }
+  }
+}
+
+template <typename T>
+void SeqScanExecutor::SelectCompared(T constant) {
+  switch (filter_type_) {
+    case ComparisonType::Equal:
+      return SelectIf<T>([constant](T entry) { return entry == constant; });
+    case ComparisonType::NotEqual:
+      return SelectIf<T>([constant](T entry) { return entry != constant; });
+    case ComparisonType::LessThan:
+      return SelectIf<T>([constant](T entry) { return entry < constant; });
+    case ComparisonType::LessThanOrEqual:
+      return SelectIf<T>([constant](T entry) { return entry <= constant; });
+    case ComparisonType::GreaterThan:
+      return SelectIf<T>([constant](T entry) { return entry > constant; });
+    case ComparisonType::GreaterThanOrEqual:
+      return SelectIf<T>([constant](T entry) { return entry >= constant; });
+    default:
+      BUSTUB_ASSERT(false, "Unsupported comparison type.");
+  }
+}
+
+template <typename T, typename Compare>
+void SeqScanExecutor::SelectIf(Compare compare) {
+  auto i = static_cast<size_t>(batch_.GetPosition(filter_column_));
+  const T *entries = batch_.GetArray<T>(i);
+  for (uint32_t row = 0; row < batch_.GetSize(); row++) {
+    // A null compares as the predicate says it does, which only the predicate knows.
+    bool holds = batch_.IsNull(i, row) ? plan_->GetPredicate()->EvaluateBatch(batch_, row).GetAs<bool>()
+                                       : compare(entries[row]);
+    if (holds) {
+      selection_.push_back(row);
+    }
+  }
+}
+
+void SeqScanExecutor::CollectColumns(const AbstractExpression *expr, std::vector<bool> *columns) {
+  if (expr == nullptr) {
+    return;
+  }
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(expr); column != nullptr) {
+    (*columns)[column->GetColIdx()] = true;
+  }
+  for (const auto *child : expr->GetChildren()) {
+    CollectColumns(child, columns);
+  }
+}
+
+bool SeqScanExecutor::IsIdentity() const {
+  const Schema *schema = &table_info_->schema_;
+  const Schema *output_schema = plan_->OutputSchema();
+  if (output_schema->GetColumnCount() != schema->GetColumnCount()) {
+    return false;
+  }
+  for (uint32_t i = 0; i < output_schema->GetColumnCount(); i++) {
+    const auto *column = dynamic_cast<const ColumnValueExpression *>(output_schema->GetColumn(i).GetExpr());
+    if (column == nullptr || column->GetTupleIdx() != 0 || column->GetColIdx() != i ||
+        output_schema->GetColumn(i).GetType() != schema->GetColumn(i).GetType()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace bustub
@@ -9,7 +9,9 @@
 // Copyright (c) 2015-20, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <algorithm>
 #include <memory>
+#include <utility>
 
 #include "execution/executors/update_executor.h"
 
@@ -17,9 +19,56 @@ namespace bustub {
 
 UpdateExecutor::UpdateExecutor(ExecutorContext *exec_ctx, const UpdatePlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
 
-void UpdateExecutor::Init() {}
+void UpdateExecutor::Init() {
+  Catalog *catalog = exec_ctx_->GetCatalog();
+  table_info_ = catalog->GetTable(plan_->TableOid());
+  updated_indexes_.clear();
+  for (auto *index_info : catalog->GetTableIndexes(table_info_->name_)) {
+    const auto &attrs = index_info->index_->GetEntryAttrs();
+    auto is_updated = [&](uint32_t attr) { return plan_->GetUpdateAttr()->count(attr) > 0; };
+    if (std::any_of(attrs.begin(), attrs.end(), is_updated)) {
+      updated_indexes_.push_back(index_info);
+    }
+  }
+  done_ = false;
+  child_executor_->Init();
+}
+
+bool UpdateExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) {
+  if (done_) {
+    return false;
+  }
+  done_ = true;
+  Transaction *txn = exec_ctx_->GetTransaction();
+  TableHeap *table = table_info_->table_.get();
+  const Schema &schema = table_info_->schema_;
+  TupleView child_tuple;
+  RID child_rid;
+  while (child_executor_->NextView(&child_tuple, &child_rid)) {
+    // The child may have projected columns away, so read the whole tuple.
+    Tuple old_tuple;
+    if (!table->GetTuple(child_rid, &old_tuple, txn)) {
+      return false;
+    }
+    Tuple new_tuple = GenerateUpdatedTuple(old_tuple);
+    if (!table->UpdateTuple(new_tuple, child_rid, txn)) {
+      return false;
+    }
+    for (auto *index_info : updated_indexes_) {
+      Index *index = index_info->index_.get();
+      index->DeleteEntry(old_tuple.KeyFromTuple(schema, *index->GetEntrySchema(), index->GetEntryAttrs()), child_rid,
+                         txn);
+      index->InsertEntry(new_tuple.KeyFromTuple(schema, *index->GetEntrySchema(), index->GetEntryAttrs()), child_rid,
+                         txn);
+      IndexWriteRecord index_write_record(child_rid, table_info_->oid_, WType::UPDATE, new_tuple,
+                                          index_info->index_oid_, exec_ctx_->GetCatalog());
+      index_write_record.old_tuple_ = old_tuple;
+      txn->GetIndexWriteSet()->push_back(index_write_record);
+    }
+  }
+  return true;
+}
 
-bool UpdateExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) { return false; }
 }  // namespace bustub
@@ -97,6 +97,9 @@ class BufferPoolManager {
   /** @return size of the buffer pool */
   size_t GetPoolSize() { return pool_size_; }
 
+  /** @return the log manager, nullptr if logging is disabled */
+  LogManager *GetLogManager() { return log_manager_; }
+
  protected:
   /**
    * Grading function. Do not modify!
@@ -152,21 +155,35 @@ class BufferPoolManager {
    */
   void FlushAllPagesImpl();
 
+  /**
+   * Picks a frame for a page that is about to be brought in, from the free list first, then from the replacer.
+   * A dirty victim is written back and removed from the page table. The caller must hold latch_.
+   * @param[out] frame_id the frame that can be reused
+   * @return false if every frame is pinned
+   */
+  bool FindVictimFrame(frame_id_t *frame_id);
+
+  /**
+   * Writes a page back to disk. While logging is enabled, the log is flushed first if the page carries the LSN of a
+   * record that is not persistent yet, so that no change reaches the disk before its log record does.
+   */
+  void WritePage(Page *page);
+
   /** Number of pages in the buffer pool. */
   size_t pool_size_;
   /** Array of buffer pool pages. */
   Page *pages_;
   /** Pointer to the disk manager. */
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_;
   /** Pointer to the log manager. */
-  LogManager *log_manager_ __attribute__((__unused__));
+  LogManager *log_manager_;
   /** Page table for keeping track of buffer pool pages. */
   std::unordered_map<page_id_t, frame_id_t> page_table_;
   /** Replacer to find unpinned pages for replacement. */
   Replacer *replacer_;
   /** List of free pages. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /** This latch protects the page table, the free list and the book-keeping fields of every page. */
   std::mutex latch_;
 };
 }  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <list>
 #include <mutex>  // NOLINT
+#include <unordered_map>
 #include <vector>
 
 #include "buffer/replacer.h"
@@ -46,7 +47,14 @@ class LRUReplacer : public Replacer {
   size_t Size() override;
 
  private:
-  // TODO(student): implement me!
+  /** Unpinned frames, least recently unpinned first. */
+  std::list<frame_id_t> lru_list_;
+  /** The position of each unpinned frame in lru_list_. */
+  std::unordered_map<frame_id_t, std::list<frame_id_t>::iterator> frames_;
+  /** The maximum number of frames the replacer tracks. */
+  size_t capacity_;
+  /** Protects lru_list_ and frames_. */
+  std::mutex latch_;
 };
 
 }  // namespace bustub
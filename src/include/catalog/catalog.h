@@ -8,6 +8,7 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
+#include "common/util/parallel_util.h"
 #include "storage/index/b_plus_tree_index.h"
 #include "storage/index/index.h"
 #include "storage/table/table_heap.h"
@@ -73,18 +74,27 @@ class Catalog {
    * @param txn the transaction in which the table is being created
    * @param table_name the name of the new table
    * @param schema the schema of the new table
+   * @param format the page format of the new table, PAX for a table that analytical queries scan a few columns of
    * @return a pointer to the metadata of the new table
    */
-  TableMetadata *CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema) {
+  TableMetadata *CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema,
+                             TableFormat format = TableFormat::ROW) {
     BUSTUB_ASSERT(names_.count(table_name) == 0, "Table names should be unique!");
-    return nullptr;
+    table_oid_t table_oid = next_table_oid_++;
+    tables_[table_oid] = std::make_unique<TableMetadata>(schema, table_name, nullptr, table_oid);
+    const Schema *stored_schema = &tables_[table_oid]->schema_;
+    tables_[table_oid]->table_ = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, txn,
+                                                             format == TableFormat::PAX ? stored_schema : nullptr);
+    tables_[table_oid]->table_->EnableOverflow(stored_schema);
+    names_[table_name] = table_oid;
+    return tables_[table_oid].get();
   }
 
-  /** @return table metadata by name */
-  TableMetadata *GetTable(const std::string &table_name) { return nullptr; }
+  /** @return table metadata by name, throws std::out_of_range if there is no such table */
+  TableMetadata *GetTable(const std::string &table_name) { return GetTable(names_.at(table_name)); }
 
-  /** @return table metadata by oid */
-  TableMetadata *GetTable(table_oid_t table_oid) { return nullptr; }
+  /** @return table metadata by oid, throws std::out_of_range if there is no such table */
+  TableMetadata *GetTable(table_oid_t table_oid) { return tables_.at(table_oid).get(); }
 
   /**
    * Create a new index, populate existing data of the table and return its metadata.
@@ -95,25 +105,77 @@ class Catalog {
    * @param key_schema the schema of the key
    * @param key_attrs key attributes
    * @param keysize size of the key
+   * @param is_unique whether a key maps to at most one row; a non-unique index keeps posting lists of RIDs
+   * @param build_threads the number of threads that build the index, 0 for one per hardware thread
+   * @param bloom_filter whether point lookups first check an in-memory Bloom filter over the keys
+   * @param included_attrs the columns the index stores next to the key, so that queries that need only those and the
+   * key columns skip the table; they must fit in keysize along with the key, and need a unique index
    * @return a pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   IndexInfo *CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
                          const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
-                         size_t keysize) {
-    return nullptr;
+                         size_t keysize, bool is_unique = true, size_t build_threads = 0,
+                         bool bloom_filter = false, const std::vector<uint32_t> &included_attrs = {}) {
+    BUSTUB_ASSERT(index_names_[table_name].count(index_name) == 0, "Index names should be unique within a table!");
+    index_oid_t index_oid = next_index_oid_++;
+    auto *metadata =
+        new IndexMetadata(index_name, table_name, &schema, key_attrs, is_unique, bloom_filter, included_attrs);
+    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(metadata, bpm_);
+
+    // populate the index with the tuples that are already in the table
+    index->BuildFromTable(GetTable(table_name)->table_.get(), schema, txn,
+                          build_threads == 0 ? ParallelUtil::HardwareThreads() : build_threads);
+
+    indexes_[index_oid] =
+        std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
+    index_names_[table_name][index_name] = index_oid;
+    return indexes_[index_oid].get();
   }
 
-  IndexInfo *GetIndex(const std::string &index_name, const std::string &table_name) { return nullptr; }
+  /** @return index metadata by index and table name, throws std::out_of_range if there is no such index */
+  IndexInfo *GetIndex(const std::string &index_name, const std::string &table_name) {
+    return GetIndex(index_names_.at(table_name).at(index_name));
+  }
 
-  IndexInfo *GetIndex(index_oid_t index_oid) { return nullptr; }
+  /** @return index metadata by oid, throws std::out_of_range if there is no such index */
+  IndexInfo *GetIndex(index_oid_t index_oid) { return indexes_.at(index_oid).get(); }
+
+  /** @return the metadata of every index on the table */
+  std::vector<IndexInfo *> GetTableIndexes(const std::string &table_name) {
+    std::vector<IndexInfo *> result;
+    auto it = index_names_.find(table_name);
+    if (it != index_names_.end()) {
+      for (const auto &[name, index_oid] : it->second) {
+        result.push_back(indexes_.at(index_oid).get());
+      }
+    }
+    return result;
+  }
 
-  std::vector<IndexInfo *> GetTableIndexes(const std::string &table_name) { return std::vector<IndexInfo *>(); }
+  /**
+   * Vacuum a table, see TableHeap::Vacuum, moving the entries of its indexes along with the tuples.
+   * @param txn the transaction performing the vacuum
+   * @param table_name the name of the table
+   * @return the number of pages unlinked from the table
+   */
+  size_t VacuumTable(Transaction *txn, const std::string &table_name) {
+    TableMetadata *table_metadata = GetTable(table_name);
+    std::vector<IndexInfo *> indexes = GetTableIndexes(table_name);
+    return table_metadata->table_->Vacuum(txn, [&](const Tuple &tuple, const RID &old_rid, const RID &new_rid) {
+      for (IndexInfo *index_info : indexes) {
+        Index *index = index_info->index_.get();
+        Tuple key = tuple.KeyFromTuple(table_metadata->schema_, *index->GetEntrySchema(), index->GetEntryAttrs());
+        index->DeleteEntry(key, old_rid, txn);
+        index->InsertEntry(key, new_rid, txn);
+      }
+    });
+  }
 
  private:
-  [[maybe_unused]] BufferPoolManager *bpm_;
-  [[maybe_unused]] LockManager *lock_manager_;
-  [[maybe_unused]] LogManager *log_manager_;
+  BufferPoolManager *bpm_;
+  LockManager *lock_manager_;
+  LogManager *log_manager_;
 
   /** tables_ : table identifiers -> table metadata. Note that tables_ owns all table metadata. */
   std::unordered_map<table_oid_t, std::unique_ptr<TableMetadata>> tables_;
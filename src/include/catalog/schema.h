@@ -77,9 +77,18 @@ class Schema {
   /** @return the number of non-inlined columns */
   uint32_t GetUnlinedColumnCount() const { return static_cast<uint32_t>(uninlined_columns_.size()); }
 
-  /** @return the number of bytes used by one tuple */
+  /** @return the number of bytes of the fixed-size part of the columns, see Column::GetFixedLength */
   inline uint32_t GetLength() const { return length_; }
 
+  /** @return the offset of a column in the tuple, the same as Column::GetOffset without going through the Column */
+  inline uint32_t GetOffset(uint32_t col_idx) const { return offsets_[col_idx]; }
+
+  /** @return the offset of the null bitmap of a tuple, which follows the fixed-size part of the columns */
+  inline uint32_t GetNullBitmapOffset() const { return length_; }
+
+  /** @return the number of bytes of a tuple before the values of its uninlined columns, null bitmap included */
+  inline uint32_t GetFixedLength() const { return length_ + (GetColumnCount() + 7) / 8; }
+
   /** @return true if all columns are inlined, false otherwise */
   inline bool IsInlined() const { return tuple_is_inlined_; }
 
@@ -93,6 +102,9 @@ class Schema {
   /** All the columns in the schema, inlined and uninlined. */
   std::vector<Column> columns_;
 
+  /** The offsets of the columns, packed together for the typed accessors of Tuple. */
+  std::vector<uint32_t> offsets_;
+
   /** True if all the columns are inlined, false otherwise. */
   bool tuple_is_inlined_;
 
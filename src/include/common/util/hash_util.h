@@ -12,8 +12,15 @@
 
 #pragma once
 
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <string>
 
@@ -24,27 +31,104 @@ namespace bustub {
 
 using hash_t = std::size_t;
 
+/** The lookup table of the bytewise CRC32C, the CRC with the reflected Castagnoli polynomial 0x82F63B78. */
+inline constexpr std::array<uint32_t, 256> CRC32C_TABLE = [] {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < table.size(); i++) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ ((crc & 1) != 0 ? 0x82F63B78U : 0);
+    }
+    table[i] = crc;
+  }
+  return table;
+}();
+
 class HashUtil {
  private:
   static const hash_t prime_factor = 10000019;
 
+  // the constants of wyhash
+  static constexpr uint64_t WY_0 = 0xa0761d6478bd642fULL;
+  static constexpr uint64_t WY_1 = 0xe7037ed1a0b428dbULL;
+
+  /** @return the 128-bit product of a and b, folded to 64 bits */
+  static inline uint64_t Mix(uint64_t a, uint64_t b) {
+    __uint128_t product = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+  }
+
+  static inline uint64_t Read64(const char *bytes) {
+    uint64_t word;
+    memcpy(&word, bytes, sizeof(word));
+    return word;
+  }
+
+  static inline uint64_t Read32(const char *bytes) {
+    uint32_t word;
+    memcpy(&word, bytes, sizeof(word));
+    return word;
+  }
+
  public:
+  /**
+   * Hashes a byte string in the style of wyhash: 16 bytes at a time go through a 64x64->128-bit multiply, and the
+   * tail is read as (possibly overlapping) words rather than byte by byte.
+   */
   static inline hash_t HashBytes(const char *bytes, size_t length) {
-    // https://github.com/greenplum-db/gpos/blob/b53c1acd6285de94044ff91fbee91589543feba1/libgpos/src/utils.cpp#L126
-    hash_t hash = length;
-    for (size_t i = 0; i < length; ++i) {
-      hash = ((hash << 5) ^ (hash >> 27)) ^ bytes[i];
+    uint64_t seed = length ^ WY_0;
+    size_t i = 0;
+    for (; i + 16 < length; i += 16) {
+      seed = Mix(Read64(bytes + i) ^ WY_1, Read64(bytes + i + 8) ^ seed);
+    }
+    size_t rest = length - i;
+    uint64_t a = 0;
+    uint64_t b = 0;
+    if (rest > 8) {
+      a = Read64(bytes + i);
+      b = Read64(bytes + length - 8);
+    } else if (rest >= 4) {
+      a = Read32(bytes + i);
+      b = Read32(bytes + length - 4);
+    } else if (rest > 0) {
+      a = static_cast<uint64_t>(static_cast<uint8_t>(bytes[i])) << 16 |
+          static_cast<uint64_t>(static_cast<uint8_t>(bytes[i + rest / 2])) << 8 |
+          static_cast<uint8_t>(bytes[length - 1]);
     }
-    return hash;
+    return Mix(WY_1 ^ length, Mix(a ^ WY_1, b ^ seed));
   }
 
-  static inline hash_t CombineHashes(hash_t l, hash_t r) {
-    hash_t both[2];
-    both[0] = l;
-    both[1] = r;
-    return HashBytes(reinterpret_cast<char *>(both), sizeof(hash_t) * 2);
+  /**
+   * @return the CRC32C of the 8 bytes of value, least significant first, going on from crc without inverting it before
+   * or after, as the SSE4.2 instruction computes it; a byte at a time from CRC32C_TABLE, on any target
+   */
+  static inline uint32_t Crc32cPortable(uint32_t crc, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+      crc = CRC32C_TABLE[(crc ^ value) & 0xFF] ^ (crc >> 8);
+      value >>= 8;
+    }
+    return crc;
+  }
+
+  /** @return the same as Crc32cPortable, with the CRC32C instruction when the build targets SSE4.2 */
+  static inline uint32_t Crc32c(uint32_t crc, uint64_t value) {
+#if defined(__SSE4_2__)
+    return static_cast<uint32_t>(_mm_crc32_u64(crc, value));
+#else
+    return Crc32cPortable(crc, value);
+#endif
   }
 
+  /**
+   * Hashes an integer of up to 64 bits with CRC32C, which gives the same hash whether or not the build targets SSE4.2,
+   * so that hash tables stay readable by any build. The multiply spreads the 32 bits of the CRC over the whole hash.
+   */
+  static inline hash_t HashInt(uint64_t value) {
+    return static_cast<uint64_t>(Crc32c(static_cast<uint32_t>(WY_0), value)) * 0x9E3779B97F4A7C15ULL;
+  }
+
+  static inline hash_t CombineHashes(hash_t l, hash_t r) { return Mix(l ^ WY_0, r ^ WY_1) ^ r; }
+
   static inline hash_t SumHashes(hash_t l, hash_t r) { return (l % prime_factor + r % prime_factor) % prime_factor; }
 
   template <typename T>
@@ -60,39 +144,29 @@ class HashUtil {
   /** @return the hash of the value */
   static inline hash_t HashValue(const Value *val) {
     switch (val->GetTypeId()) {
-      case TypeId::TINYINT: {
-        auto raw = static_cast<int64_t>(val->GetAs<int8_t>());
-        return Hash<int64_t>(&raw);
-      }
-      case TypeId::SMALLINT: {
-        auto raw = static_cast<int64_t>(val->GetAs<int16_t>());
-        return Hash<int64_t>(&raw);
-      }
-      case TypeId::INTEGER: {
-        auto raw = static_cast<int64_t>(val->GetAs<int32_t>());
-        return Hash<int64_t>(&raw);
-      }
-      case TypeId::BIGINT: {
-        auto raw = static_cast<int64_t>(val->GetAs<int64_t>());
-        return Hash<int64_t>(&raw);
-      }
-      case TypeId::BOOLEAN: {
-        auto raw = val->GetAs<bool>();
-        return Hash<bool>(&raw);
-      }
+      case TypeId::TINYINT:
+        return HashInt(static_cast<int64_t>(val->GetAs<int8_t>()));
+      case TypeId::SMALLINT:
+        return HashInt(static_cast<int64_t>(val->GetAs<int16_t>()));
+      case TypeId::INTEGER:
+        return HashInt(static_cast<int64_t>(val->GetAs<int32_t>()));
+      case TypeId::BIGINT:
+        return HashInt(static_cast<int64_t>(val->GetAs<int64_t>()));
+      case TypeId::BOOLEAN:
+        return HashInt(static_cast<uint64_t>(val->GetAs<bool>()));
       case TypeId::DECIMAL: {
         auto raw = val->GetAs<double>();
-        return Hash<double>(&raw);
+        uint64_t bits;
+        memcpy(&bits, &raw, sizeof(bits));
+        return HashInt(bits);
       }
       case TypeId::VARCHAR: {
         auto raw = val->GetData();
         auto len = val->GetLength();
         return HashBytes(raw, len);
       }
-      case TypeId::TIMESTAMP: {
-        auto raw = val->GetAs<uint64_t>();
-        return Hash<uint64_t>(&raw);
-      }
+      case TypeId::TIMESTAMP:
+        return HashInt(val->GetAs<uint64_t>());
       default: {
         BUSTUB_ASSERT(false, "Unsupported type.");
       }
@@ -0,0 +1,63 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_util.h
+//
+// Identification: src/include/common/util/parallel_util.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <exception>
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace bustub {
+
+/**
+ * ParallelUtil runs the parts of a divisible task on their own threads.
+ */
+class ParallelUtil {
+ public:
+  /** @return the number of hardware threads, at least 1 */
+  static inline size_t HardwareThreads() { return std::max<size_t>(std::thread::hardware_concurrency(), 1); }
+
+  /**
+   * Calls task(i) for every i in [0, num_tasks), each on its own thread, and waits for all of them. The calling
+   * thread runs task(0) itself. If tasks throw, the first exception is rethrown once every thread has finished.
+   */
+  template <typename Task>
+  static void ParallelFor(size_t num_tasks, Task &&task) {
+    std::vector<std::exception_ptr> errors(num_tasks);
+    auto run = [&](size_t i) {
+      try {
+        task(i);
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(num_tasks);
+    for (size_t i = 1; i < num_tasks; i++) {
+      threads.emplace_back(run, i);
+    }
+    if (num_tasks > 0) {
+      run(0);
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    for (const auto &error : errors) {
+      if (error != nullptr) {
+        std::rethrow_exception(error);
+      }
+    }
+  }
+};
+
+}  // namespace bustub
@@ -17,7 +17,9 @@
 #include <memory>
 #include <string>
 #include <thread>  // NOLINT
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "common/config.h"
 #include "common/logger.h"
@@ -55,16 +57,27 @@ enum class WType { INSERT = 0, DELETE, UPDATE };
 
 class TableHeap;
 class Catalog;
+class FreeSpaceMap;
+class HashSlotOwners;
 using table_oid_t = uint32_t;
 using index_oid_t = uint32_t;
 
+/**
+ * InsertPage is the page of a table that a transaction has claimed to insert into, see TableHeap::InsertTuple.
+ */
+struct InsertPage {
+  page_id_t page_id_;
+  /** The free space map of the table, which the page goes back to; it expires with the table. */
+  std::weak_ptr<FreeSpaceMap> free_space_map_;
+};
+
 /**
  * WriteRecord tracks information related to a write.
  */
 class TableWriteRecord {
  public:
-  TableWriteRecord(RID rid, WType wtype, const Tuple &tuple, TableHeap *table)
-      : rid_(rid), wtype_(wtype), tuple_(tuple), table_(table) {}
+  TableWriteRecord(RID rid, WType wtype, const Tuple &tuple, TableHeap *table, uint32_t count = 1)
+      : rid_(rid), wtype_(wtype), tuple_(tuple), table_(table), count_(count) {}
 
   RID rid_;
   WType wtype_;
@@ -72,6 +85,8 @@ class TableWriteRecord {
   Tuple tuple_;
   /** The table heap specifies which table this write record is for. */
   TableHeap *table_;
+  /** The number of consecutive slots from rid_ on that the write covers, only ever more than one for inserts. */
+  uint32_t count_;
 };
 
 /**
@@ -161,9 +176,13 @@ class Transaction {
     index_write_set_ = std::make_shared<std::deque<IndexWriteRecord>>();
     page_set_ = std::make_shared<std::deque<bustub::Page *>>();
     deleted_page_set_ = std::make_shared<std::unordered_set<page_id_t>>();
+    insert_page_set_ = std::make_shared<std::unordered_map<TableHeap *, InsertPage>>();
+    hash_slot_owners_set_ = std::make_shared<std::vector<std::weak_ptr<HashSlotOwners>>>();
   }
 
-  ~Transaction() = default;
+  /** Releases the pages still claimed for inserts and the hash table slots, if the transaction never committed or
+   * aborted. */
+  ~Transaction();
 
   DISALLOW_COPY(Transaction);
 
@@ -216,6 +235,20 @@ class Transaction {
    */
   inline void AddIntoDeletedPageSet(page_id_t page_id) { deleted_page_set_->insert(page_id); }
 
+  /** @return the page that this transaction inserts into, for each table it has inserted into */
+  inline std::shared_ptr<std::unordered_map<TableHeap *, InsertPage>> GetInsertPageSet() { return insert_page_set_; }
+
+  /** Releases the pages claimed for inserts, so that other transactions can claim them, see GetInsertPageSet. */
+  void ReleaseInsertPages();
+
+  /** @return the owners of the hash table slots that this transaction has written, see HashSlotOwners */
+  inline std::shared_ptr<std::vector<std::weak_ptr<HashSlotOwners>>> GetHashSlotOwnersSet() {
+    return hash_slot_owners_set_;
+  }
+
+  /** Gives up the hash table slots that this transaction has written, see HashSlotOwners::Release. */
+  void ReleaseHashSlots();
+
   /** @return the set of resources under a shared lock */
   inline std::shared_ptr<std::unordered_set<RID>> GetSharedLockSet() { return shared_lock_set_; }
 
@@ -268,6 +301,11 @@ class Transaction {
   /** Concurrent index: the page IDs that were deleted during index operation.*/
   std::shared_ptr<std::unordered_set<page_id_t>> deleted_page_set_;
 
+  /** TableHeap: the page claimed for the inserts of this transaction into each table, see TableHeap::InsertTuple. */
+  std::shared_ptr<std::unordered_map<TableHeap *, InsertPage>> insert_page_set_;
+  /** Hash tables: the owners of the slots written by this transaction, see HashSlotOwners. */
+  std::shared_ptr<std::vector<std::weak_ptr<HashSlotOwners>>> hash_slot_owners_set_;
+
   /** LockManager: the set of shared-locked tuples held by this transaction. */
   std::shared_ptr<std::unordered_set<RID>> shared_lock_set_;
   /** LockManager: the set of exclusive-locked tuples held by this transaction. */
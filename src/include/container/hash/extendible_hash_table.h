@@ -0,0 +1,140 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table.h
+//
+// Identification: src/include/container/hash/extendible_hash_table.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "concurrency/transaction.h"
+#include "container/hash/hash_function.h"
+#include "container/hash/hash_table.h"
+#include "storage/index/generic_key.h"
+#include "storage/page/hash_table_block_page.h"
+#include "storage/page/hash_table_directory_page.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+
+#define EXTENDIBLE_HASH_TABLE_TYPE ExtendibleHashTable<KeyType, ValueType, KeyComparator, Hasher>
+
+/**
+ * Implementation of extendible hashing that is backed by a buffer pool
+ * manager. Non-unique keys are supported. Supports insert and delete. The
+ * table grows one bucket at a time.
+ *
+ * A directory page maps the low bits of a hash to bucket pages, which are block pages whose occupied slots always
+ * form a prefix. A full bucket splits in two: the directory slots that pointed at it are shared out between it and a
+ * new bucket, doubling the directory first if the bucket is the only one its slots point at. Unlike
+ * LinearProbeHashTable::Resize, a split only latches the bucket being split, plus the directory for as long as it
+ * takes to repoint its slots. The pairs that stay are packed at the front of the bucket, so a split also clears out
+ * its tombstones. Buckets are never merged, and there are no overflow pages: all the values of a key have to fit in
+ * one bucket.
+ *
+ * The directory spans more pages as it doubles past one page, see HashTableDirectoryPage; the latch of its first page
+ * stands for the whole directory.
+ *
+ * Every operation latches the bucket of its key, then checks that the directory still points at it, since a split
+ * may have moved the key's half of the bucket to a new page in between. The hasher is a template argument, as for
+ * LinearProbeHashTable.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher = DefaultHasher<KeyType>>
+class ExtendibleHashTable : public HashTable<KeyType, ValueType, KeyComparator> {
+ public:
+  /**
+   * Creates a new ExtendibleHashTable with a single bucket
+   *
+   * @param buffer_pool_manager buffer pool manager to be used
+   * @param comparator comparator for keys
+   * @param hash_fn the hash function
+   */
+  explicit ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
+                               const KeyComparator &comparator, HashFunction<KeyType, Hasher> hash_fn);
+
+  /**
+   * Inserts a key-value pair into the hash table.
+   * @param transaction the current transaction
+   * @param key the key to create
+   * @param value the value to be associated with the key
+   * @return true if insert succeeded, false otherwise
+   */
+  bool Insert(Transaction *transaction, const KeyType &key, const ValueType &value) override;
+
+  /**
+   * Deletes the associated value for the given key.
+   * @param transaction the current transaction
+   * @param key the key to delete
+   * @param value the value to delete
+   * @return true if remove succeeded, false otherwise
+   */
+  bool Remove(Transaction *transaction, const KeyType &key, const ValueType &value) override;
+
+  /**
+   * Performs a point query on the hash table.
+   * @param transaction the current transaction
+   * @param key the key to look up
+   * @param[out] result the value(s) associated with a given key
+   * @return the value(s) associated with the given key
+   */
+  bool GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) override;
+
+  /**
+   * @return the global depth of the directory
+   */
+  uint32_t GetGlobalDepth();
+
+ private:
+  /** @return the bits of the hash of the key that the directory picks buckets by */
+  uint32_t Hash(const KeyType &key);
+
+  /**
+   * Latches the bucket page that the directory points the hash at, shared or exclusive.
+   * @return the pinned and latched bucket page
+   */
+  Page *LatchBucket(uint32_t hash, bool exclusive);
+
+  /** @return the page id of the bucket that the directory, latched by the caller, points the hash at */
+  page_id_t GetBucketPageId(HashTableDirectoryPage *directory, uint32_t hash);
+
+  /**
+   * @return the page of the directory that holds the slot, which is pinned unless it is the first page, see
+   * ReleaseDirectoryPage
+   */
+  HashTableDirectoryPage *GetDirectoryPage(HashTableDirectoryPage *directory, uint32_t slot);
+
+  /** Unpins a page that GetDirectoryPage returned. */
+  void ReleaseDirectoryPage(HashTableDirectoryPage *directory, HashTableDirectoryPage *page, bool is_dirty);
+
+  /** Doubles the directory, which the caller holds latched exclusive, copying its pages once it fills the first. */
+  void GrowDirectory(HashTableDirectoryPage *directory);
+
+  /**
+   * Splits the full bucket that the hash maps to, which the caller holds latched exclusive, moving the pairs whose
+   * next hash bit is set to a new bucket.
+   * @return false if the directory cannot grow any further
+   */
+  bool SplitBucket(Page *bucket_page, uint32_t hash);
+
+  Page *FetchTablePage(page_id_t page_id);
+
+  // member variable
+  page_id_t directory_page_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+
+  // Hash function
+  HashFunction<KeyType, Hasher> hash_fn_;
+};
+
+}  // namespace bustub
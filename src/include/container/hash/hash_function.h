@@ -13,24 +13,58 @@
 #pragma once
 
 #include <cstdint>
+#include <type_traits>
 
+#include "common/util/hash_util.h"
 #include "murmur3/MurmurHash3.h"
 
 namespace bustub {
 
+/** Hashes the bytes of a key with MurmurHash3_x64_128, keeping the lower half. */
+struct Murmur3Hasher {
+  template <typename KeyType>
+  static uint64_t Hash(const KeyType &key) {
+    uint64_t hash[2];
+    murmur3::MurmurHash3_x64_128(reinterpret_cast<const void *>(&key), static_cast<int>(sizeof(KeyType)), 0,
+                                 reinterpret_cast<void *>(&hash));
+    return hash[0];
+  }
+};
+
+/** Hashes an integer key of up to 64 bits with CRC32C, see HashUtil::HashInt. */
+struct Crc32cHasher {
+  template <typename KeyType>
+  static uint64_t Hash(const KeyType &key) {
+    static_assert(std::is_integral_v<KeyType> && sizeof(KeyType) <= sizeof(uint64_t), "CRC32C hashes integers.");
+    return HashUtil::HashInt(static_cast<uint64_t>(key));
+  }
+};
+
+/** Hashes the bytes of a key in the style of wyhash, see HashUtil::HashBytes. */
+struct WyHasher {
+  template <typename KeyType>
+  static uint64_t Hash(const KeyType &key) {
+    return HashUtil::HashBytes(reinterpret_cast<const char *>(&key), sizeof(KeyType));
+  }
+};
+
+/** The hasher that a HashFunction uses unless told otherwise: CRC32C for integers, wyhash for everything else. */
 template <typename KeyType>
+using DefaultHasher =
+    std::conditional_t<std::is_integral_v<KeyType> && sizeof(KeyType) <= sizeof(uint64_t), Crc32cHasher, WyHasher>;
+
+/**
+ * The hash function of the hash tables. The hasher is picked at compile time, so GetHash is not virtual and inlines
+ * into the probe loops.
+ */
+template <typename KeyType, typename Hasher = DefaultHasher<KeyType>>
 class HashFunction {
  public:
   /**
    * @param key the key to be hashed
    * @return the hashed value
    */
-  virtual uint64_t GetHash(KeyType key) {
-    uint64_t hash[2];
-    murmur3::MurmurHash3_x64_128(reinterpret_cast<const void *>(&key), static_cast<int>(sizeof(KeyType)), 0,
-                                 reinterpret_cast<void *>(&hash));
-    return hash[0];
-  }
+  uint64_t GetHash(const KeyType &key) const { return Hasher::Hash(key); }
 };
 
 }  // namespace bustub
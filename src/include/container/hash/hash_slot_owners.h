@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_slot_owners.h
+//
+// Identification: src/include/container/hash/hash_slot_owners.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+class Transaction;
+
+/**
+ * HashSlotOwners tracks the unfinished transaction that wrote each slot of a hash table last, so that the table can
+ * keep what recovery needs to undo the write: an insert or remove is undone in the slot it was logged for, which must
+ * still hold the pair as the transaction left it.
+ *
+ * A migration that moves such a pair to the new table logs the move on behalf of its owner, so that the owner's undo
+ * follows the pair, and a tombstone that such a transaction left moves along with its pair. Inserts do not reuse such
+ * a tombstone either.
+ *
+ * A transaction gives up its slots when it commits or aborts. One that is destroyed unfinished never logs its end, so
+ * recovery undoes it; its slots stay owned, by a stand-in with the same id that carries on its log record chain.
+ */
+class HashSlotOwners : public std::enable_shared_from_this<HashSlotOwners> {
+ public:
+  /**
+   * Records the last writer of a slot.
+   * @param txn the transaction that wrote the slot, nullptr for a write that belongs to no transaction
+   * @param page_id the block page of the slot
+   * @param offset the offset of the slot in the block page
+   */
+  void SetOwner(Transaction *txn, page_id_t page_id, slot_offset_t offset);
+
+  /** @return the unfinished transaction that wrote the slot last, nullptr if there is none */
+  Transaction *GetOwner(page_id_t page_id, slot_offset_t offset);
+
+  /**
+   * Gives up the slots of a transaction, once it commits or aborts, or is destroyed, see the class comment.
+   * @param txn the transaction
+   */
+  void Release(Transaction *txn);
+
+  /** @return the latch to hold while logging for the owners, so that they do not end meanwhile */
+  std::unique_lock<std::recursive_mutex> Lock() { return std::unique_lock<std::recursive_mutex>(latch_); }
+
+ private:
+  static uint64_t SlotOf(page_id_t page_id, slot_offset_t offset) {
+    return static_cast<uint64_t>(page_id) << 32 | static_cast<uint32_t>(offset);
+  }
+
+  std::recursive_mutex latch_;
+  /** The owner of each slot. */
+  std::unordered_map<uint64_t, Transaction *> owners_;
+  /** The slots of each owner, some of which it may have lost to a later writer since. */
+  std::unordered_map<Transaction *, std::vector<uint64_t>> slots_;
+  /** The stand-ins of the transactions that were destroyed unfinished. */
+  std::vector<std::unique_ptr<Transaction>> orphans_;
+};
+
+}  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <queue>
 #include <string>
 #include <vector>
@@ -19,6 +20,7 @@
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/transaction.h"
 #include "container/hash/hash_function.h"
+#include "container/hash/hash_slot_owners.h"
 #include "container/hash/hash_table.h"
 #include "storage/page/hash_table_block_page.h"
 #include "storage/page/hash_table_header_page.h"
@@ -26,26 +28,69 @@
 
 namespace bustub {
 
-#define HASH_TABLE_TYPE LinearProbeHashTable<KeyType, ValueType, KeyComparator>
+#define HASH_TABLE_TYPE LinearProbeHashTable<KeyType, ValueType, KeyComparator, Hasher>
+
+/** How the operations of a LinearProbeHashTable keep out of each other's way. */
+enum class HashTableConcurrencyMode {
+  /** Every operation holds the table latch shared and latches each block page it probes. */
+  LATCHED,
+  /**
+   * Lookups take no latch at all: they read the bitmaps of the block pages with atomic loads and check the versions
+   * of the pages and of the table afterwards, retrying if a writer got in between. Inserts and removes still hold
+   * the table latch shared, but write latch only the block page they modify.
+   */
+  OPTIMISTIC,
+};
 
 /**
  * Implementation of linear probing hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table dynamically grows once full.
+ *
+ * The hasher is a template argument, see HashFunction, so that hashing inlines into the probes.
+ *
+ * The table doubles once more than MAX_LOAD_FACTOR of its buckets are occupied, tombstones included, so that probes
+ * keep running into empty buckets.
+ *
+ * A resize only allocates the new, larger table; the pairs move over a few buckets at a time. Until they all have,
+ * the old table stays around: every MIGRATION_INTERVAL-th operation first takes the table latch exclusive to migrate
+ * the next MIGRATION_BATCH buckets for each of them, inserts go to the new table, and lookups and removes check
+ * both. A migrated pair leaves a tombstone behind, so probes of the old table still walk past it. Only the buckets
+ * from the migration point on can still hold pairs, so probes of the old table skip the migrated ones. The next
+ * resize only starts once the migration is done, which it finishes a step at a time if need be.
+ *
+ * While logging is enabled, every change to a block page is logged by the page, and the creation and the dropping of
+ * a table by the hash table, so that LogRecovery can redo and undo them. The header page of the table is recorded
+ * under its name in the header page of the database, as B+ trees record their roots, and a table created with a name
+ * that is already recorded reopens the recovered table instead of starting an empty one. A migration moves the pairs
+ * that unfinished transactions have written on their behalf, see HashSlotOwners, so that recovery can still undo them.
  */
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename Hasher = DefaultHasher<KeyType>>
 class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator> {
  public:
+  /** The number of buckets of the old table that are migrated for every operation while a resize is under way. */
+  static constexpr size_t MIGRATION_BATCH = 16;
+  /** The number of operations that one migration step migrates for, see MigrateSome. */
+  static constexpr size_t MIGRATION_INTERVAL = 8;
+  /** The fraction of the buckets that may be occupied before the table grows. */
+  static constexpr double MAX_LOAD_FACTOR = 0.5;
+  /** The number of times an optimistic lookup is retried before it falls back on latches. */
+  static constexpr int OPTIMISTIC_ATTEMPTS = 8;
+
   /**
-   * Creates a new LinearProbeHashTable
+   * Creates a new LinearProbeHashTable, or reopens the one recorded under the name while logging is enabled
    *
+   * @param name the name the table is recorded under
    * @param buffer_pool_manager buffer pool manager to be used
    * @param comparator comparator for keys
    * @param num_buckets initial number of buckets contained by this hash table
    * @param hash_fn the hash function
+   * @param mode how concurrent operations synchronize
    */
   explicit LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
-                                const KeyComparator &comparator, size_t num_buckets, HashFunction<KeyType> hash_fn);
+                                const KeyComparator &comparator, size_t num_buckets,
+                                HashFunction<KeyType, Hasher> hash_fn,
+                                HashTableConcurrencyMode mode = HashTableConcurrencyMode::LATCHED);
 
   /**
    * Inserts a key-value pair into the hash table.
@@ -75,7 +120,8 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
   bool GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) override;
 
   /**
-   * Resizes the table to at least twice the initial size provided.
+   * Resizes the table to at least twice the initial size provided. The pairs are migrated by the operations that
+   * follow; a resize that is still migrating is finished first, one step at a time.
    * @param initial_size the initial size of the hash table
    */
   void Resize(size_t initial_size);
@@ -87,16 +133,134 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
   size_t GetSize();
 
  private:
+  /**
+   * Allocates the header page and the block pages of a table with the given number of buckets, logging them.
+   * @param old_header_page_id the table the new one replaces, INVALID_PAGE_ID if none
+   * @return the page id of the header page
+   */
+  page_id_t NewTable(size_t num_buckets, page_id_t old_header_page_id);
+
+  /**
+   * Picks up the recovered table with the given header page: a migration that was under way resumes from the start
+   * of the old table, and the occupied buckets are counted again.
+   */
+  void OpenTable(page_id_t header_page_id);
+
+  /**
+   * Records the header page of the table under its name in the header page of the database, once the log that
+   * creates the table is on disk.
+   * @param insert_record true to add the record, false to update it
+   */
+  void UpdateHeaderPageRecord(bool insert_record);
+
+  /** How a walk over the buckets latches the block pages it visits. */
+  enum class ProbeLatch { SHARED, EXCLUSIVE, NONE };
+
+  /**
+   * Walks the buckets of the table, starting at the bucket the hash maps to and wrapping around at the end, one
+   * stretch of a block page at a time: visit(page, block, offset, count) sees the count buckets from offset on, until
+   * it returns true. The block pages are latched as asked, and unpinned dirty if dirty is set. A walk that would start
+   * below first_bucket starts at first_bucket instead.
+   * @return true if the visitor stopped the walk, false if it saw every bucket
+   */
+  template <typename Visitor>
+  bool Walk(page_id_t header_page_id, uint64_t hash, ProbeLatch latch, bool dirty, Visitor &&visit,
+            size_t first_bucket);
+
+  /**
+   * Calls visit(page, block, offset) on every bucket from the one the hash maps to on, until it returns true. Pages
+   * that are not latched shared are unpinned dirty; with ProbeLatch::NONE the visitor latches what it modifies.
+   * @return true if the visitor stopped the probe, false if it saw every bucket
+   */
+  template <typename Visitor>
+  bool Probe(page_id_t header_page_id, uint64_t hash, ProbeLatch latch, Visitor &&visit);
+
+  /**
+   * Calls visit(page, block, offset) on the buckets of the hash's run whose control bytes carry the tag of the hash,
+   * until it returns true. The control bytes are compared a group at a time, and the run ends at the first bucket
+   * that has never been occupied.
+   * @return true if the visitor stopped the probe
+   */
+  template <typename Visitor>
+  bool ProbeMatches(page_id_t header_page_id, uint64_t hash, ProbeLatch latch, Visitor &&visit,
+                    size_t first_bucket = 0, bool dirty = false);
+
+  /**
+   * Calls visit(key, value) on the live pairs of the hash's run in the table, without latching, until it returns
+   * true. Every pair is copied out of the page and checked against the page version before it is visited.
+   * @return false if a writer modified a page under the probe, in which case it has to be repeated
+   */
+  template <typename Visitor>
+  bool ReadProbe(page_id_t header_page_id, uint64_t hash, Visitor &&visit, size_t first_bucket = 0);
+
+  /**
+   * Calls visit(key, value) on the live pairs of the key's run in both the new and the old table, without latching.
+   * @return false if a writer modified a page or the table under the lookup, in which case it has to be repeated
+   */
+  template <typename Visitor>
+  bool OptimisticLookup(const KeyType &key, uint64_t hash, Visitor &&visit);
+
+  /**
+   * Migrates the next num_buckets buckets of the old table to the new one, and frees the old table once they all are.
+   * The caller holds table_latch_ exclusive.
+   */
+  void MigrateBuckets(size_t num_buckets);
+
+  /** Counts an operation towards the next migration step, and takes the step once MIGRATION_INTERVAL have added up. */
+  void MigrateSome();
+
+  /** Migrates the buckets of MIGRATION_INTERVAL operations under table_latch_ exclusive, if a resize is under way. */
+  void MigrateStep();
+
+  /**
+   * Inserts the pair into the bucket if it is free, counting it as occupied if it was empty. A tombstone that an
+   * unfinished transaction left is not free, see HashSlotOwners.
+   */
+  bool InsertAt(HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset, const KeyType &key, const ValueType &value,
+                uint64_t hash, Transaction *transaction);
+
+  /** Turns the pair in the bucket into a tombstone, which is the transaction's until it ends. */
+  void RemoveAt(HASH_TABLE_BLOCK_TYPE *block, slot_offset_t offset, Transaction *transaction);
+
+  /** @return the number of buckets of the table with the given header page */
+  size_t GetSizeOf(page_id_t header_page_id);
+
+  /** @return whether the changes to the block pages are logged, which makes them owned by their transactions */
+  bool IsLogged() const { return enable_logging && log_manager_ != nullptr; }
+
+  HashTableHeaderPage *FetchHeaderPage(page_id_t header_page_id);
+
+  HASH_TABLE_BLOCK_TYPE *FetchBlockPage(page_id_t block_page_id);
+
   // member variable
-  page_id_t header_page_id_;
+  std::string name_;
+  std::atomic<page_id_t> header_page_id_;
+  // the number of occupied buckets of the table
+  std::atomic<size_t> num_occupied_{0};
+  // the table being migrated to header_page_id_, and the number of its buckets that are done
+  std::atomic<page_id_t> old_header_page_id_{INVALID_PAGE_ID};
+  std::atomic<size_t> migrated_{0};
+  std::atomic<bool> migrating_{false};
+  // the operations counted towards migration steps
+  std::atomic<size_t> migration_ops_{0};
+  // set when a recovered migration resumes, whose last pairs may have reached the new table without leaving the old
+  bool resumed_migration_{false};
+  // the unfinished transactions that wrote the buckets last, while logging is enabled
+  std::shared_ptr<HashSlotOwners> slot_owners_{std::make_shared<HashSlotOwners>()};
   BufferPoolManager *buffer_pool_manager_;
+  LogManager *log_manager_;
+  // whether the table is recorded in the header page of the database
+  bool recorded_{false};
   KeyComparator comparator_;
+  HashTableConcurrencyMode mode_;
 
-  // Readers includes inserts and removes, writer is only resize
+  // Readers includes inserts and removes, writers are resize and migration
   ReaderWriterLatch table_latch_;
+  // odd while a resize or a migration step moves pairs between the tables, for the lookups that take no latch
+  std::atomic<uint64_t> table_version_{0};
 
   // Hash function
-  HashFunction<KeyType> hash_fn_;
+  HashFunction<KeyType, Hasher> hash_fn_;
 };
 
 }  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
@@ -43,13 +44,17 @@ class ExecutionEngine {
       RID rid;
       while (executor->Next(&tuple, &rid)) {
         if (result_set != nullptr) {
-          result_set->push_back(tuple);
+          result_set->push_back(std::move(tuple));
         }
       }
     } catch (Exception &e) {
       // TODO(student): handle exceptions
     }
 
+    // The result set owns its tuples, so the memory that the executors kept is freed with them.
+    executor.reset();
+    exec_ctx->GetPool()->Reset();
+
     return true;
   }
 
@@ -19,6 +19,7 @@
 #include "catalog/catalog.h"
 #include "concurrency/transaction.h"
 #include "storage/page/tmp_tuple_page.h"
+#include "type/arena_pool.h"
 
 namespace bustub {
 /**
@@ -60,12 +61,19 @@ class ExecutorContext {
   /** @return the transaction manager */
   TransactionManager *GetTransactionManager() { return txn_mgr_; }
 
+  /**
+   * @return the pool of the memory that the executors keep for the rest of the query, e.g. the tuples that a join
+   * buffers, which is freed all at once when the query is done, see ExecutionEngine::Execute
+   */
+  ArenaPool *GetPool() { return &pool_; }
+
  private:
   Transaction *transaction_;
   Catalog *catalog_;
   BufferPoolManager *bpm_;
   TransactionManager *txn_mgr_;
   LockManager *lock_mgr_;
+  ArenaPool pool_;
 };
 
 }  // namespace bustub
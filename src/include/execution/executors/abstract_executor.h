@@ -38,12 +38,29 @@ class AbstractExecutor {
 
   /**
    * Produces the next tuple from this executor.
-   * @param[out] tuple the next tuple produced by this executor
+   * @param[out] tuple the next tuple produced by this executor, which owns its data, and may be kept after the query
    * @param[out] rid the next tuple rid produced by this executor
    * @return true if a tuple was produced, false if there are no more tuples
    */
   virtual bool Next(Tuple *tuple, RID *rid) = 0;
 
+  /**
+   * Produces the next tuple from this executor as a view, which saves copying it when the caller only reads it.
+   * The view is valid until the next call to Next, NextView or Init on this executor; TupleView::ToTuple keeps it.
+   * Scans hand out views of the pages they read, see TableScan; by default, the view is of a tuple that Next produces
+   * into, and which this executor keeps.
+   * @param[out] view a view of the next tuple produced by this executor
+   * @param[out] rid the next tuple rid produced by this executor
+   * @return true if a tuple was produced, false if there are no more tuples
+   */
+  virtual bool NextView(TupleView *view, RID *rid) {
+    if (!Next(&view_tuple_, rid)) {
+      return false;
+    }
+    *view = TupleView(view_tuple_);
+    return true;
+  }
+
   /** @return the schema of the tuples that this executor produces */
   virtual const Schema *GetOutputSchema() = 0;
 
@@ -52,5 +69,9 @@ class AbstractExecutor {
 
  protected:
   ExecutorContext *exec_ctx_;
+
+ private:
+  /** The tuple that the default NextView produces into. */
+  Tuple view_tuple_;
 };
 }  // namespace bustub
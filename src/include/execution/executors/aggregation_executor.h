@@ -36,10 +36,11 @@ class SimpleAggregationHashTable {
    * Create a new simplified aggregation hash table.
    * @param agg_exprs the aggregation expressions
    * @param agg_types the types of aggregations
+   * @param pool if not null, the pool that the VARCHAR data of the keys is copied into, see ExecutorContext::GetPool
    */
   SimpleAggregationHashTable(const std::vector<const AbstractExpression *> &agg_exprs,
-                             const std::vector<AggregationType> &agg_types)
-      : agg_exprs_{agg_exprs}, agg_types_{agg_types} {}
+                             const std::vector<AggregationType> &agg_types, AbstractPool *pool = nullptr)
+      : agg_exprs_{agg_exprs}, agg_types_{agg_types}, pool_{pool} {}
 
   /** @return the initial aggregrate value for this aggregation executor */
   AggregateValue GenerateInitialAggregateValue() {
@@ -93,16 +94,25 @@ class SimpleAggregationHashTable {
 
   /**
    * Inserts a value into the hash table and then combines it with the current aggregation.
-   * @param agg_key the key to be inserted
+   * @param agg_key the key to be inserted, which is copied if it is new, so its values may point into a tuple
    * @param agg_val the value to be inserted
    */
   void InsertCombine(const AggregateKey &agg_key, const AggregateValue &agg_val) {
-    if (ht.count(agg_key) == 0) {
-      ht.insert({agg_key, GenerateInitialAggregateValue()});
+    auto it = ht.find(agg_key);
+    if (it == ht.end()) {
+      AggregateKey key;
+      key.group_bys_.reserve(agg_key.group_bys_.size());
+      for (const auto &value : agg_key.group_bys_) {
+        key.group_bys_.push_back(ValueFactory::Clone(value, pool_));
+      }
+      it = ht.emplace(std::move(key), GenerateInitialAggregateValue()).first;
     }
-    CombineAggregateValues(&ht[agg_key], agg_val);
+    CombineAggregateValues(&it->second, agg_val);
   }
 
+  /** Removes all the keys from the hash table. */
+  void Clear() { ht.clear(); }
+
   /**
    * An iterator through the simplified aggregation hash table.
    */
@@ -147,10 +157,15 @@ class SimpleAggregationHashTable {
   const std::vector<const AbstractExpression *> &agg_exprs_;
   /** The types of aggregations that we have. */
   const std::vector<AggregationType> &agg_types_;
+  /** The pool of the VARCHAR data of the keys, if any. */
+  AbstractPool *pool_;
 };
 
 /**
  * AggregationExecutor executes an aggregation operation (e.g. COUNT, SUM, MIN, MAX) on the tuples of a child executor.
+ *
+ * The child is read through views, and the key and value of each tuple are built in place, reusing their vectors;
+ * only the keys of new groups are copied, into the pool of the query, see ExecutorContext::GetPool.
  */
 class AggregationExecutor : public AbstractExecutor {
  public:
@@ -172,22 +187,20 @@ class AggregationExecutor : public AbstractExecutor {
 
   bool Next(Tuple *tuple, RID *rid) override;
 
-  /** @return the tuple as an AggregateKey */
-  AggregateKey MakeKey(const Tuple *tuple) {
-    std::vector<Value> keys;
+  /** Build the AggregateKey of a tuple, whose values may point into the tuple. */
+  void MakeKey(const Tuple *tuple, AggregateKey *key) {
+    key->group_bys_.clear();
     for (const auto &expr : plan_->GetGroupBys()) {
-      keys.emplace_back(expr->Evaluate(tuple, child_->GetOutputSchema()));
+      key->group_bys_.emplace_back(expr->EvaluateView(tuple, child_->GetOutputSchema()));
     }
-    return {keys};
   }
 
-  /** @return the tuple as an AggregateValue */
-  AggregateValue MakeVal(const Tuple *tuple) {
-    std::vector<Value> vals;
+  /** Build the AggregateValue of a tuple. */
+  void MakeVal(const Tuple *tuple, AggregateValue *val) {
+    val->aggregates_.clear();
     for (const auto &expr : plan_->GetAggregates()) {
-      vals.emplace_back(expr->Evaluate(tuple, child_->GetOutputSchema()));
+      val->aggregates_.emplace_back(expr->Evaluate(tuple, child_->GetOutputSchema()));
     }
-    return {vals};
   }
 
  private:
@@ -196,8 +209,10 @@ class AggregationExecutor : public AbstractExecutor {
   /** The child executor whose tuples we are aggregating. */
   std::unique_ptr<AbstractExecutor> child_;
   /** Simple aggregation hash table. */
-  // Uncomment me! SimpleAggregationHashTable aht_;
+  SimpleAggregationHashTable aht_;
   /** Simple aggregation hash table iterator. */
-  // Uncomment me! SimpleAggregationHashTable::Iterator aht_iterator_;
+  SimpleAggregationHashTable::Iterator aht_iterator_;
+  /** The values of the output tuple being produced. */
+  std::vector<Value> values_;
 };
 }  // namespace bustub
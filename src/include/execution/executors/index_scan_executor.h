@@ -12,11 +12,14 @@
 
 #pragma once
 
+#include <memory>
+#include <optional>
 #include <vector>
 
 #include "common/rid.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/expressions/comparison_expression.h"
 #include "execution/plans/index_scan_plan.h"
 #include "storage/table/tuple.h"
 
@@ -41,8 +44,67 @@ class IndexScanExecutor : public AbstractExecutor {
 
   bool Next(Tuple *tuple, RID *rid) override;
 
+  bool NextView(TupleView *view, RID *rid) override;
+
  private:
+  /** One side of the key range that the predicate allows. */
+  struct KeyBound {
+    Value value_;
+    bool inclusive_;
+  };
+
+  /**
+   * Narrows the key range with the comparisons in the predicate that constrain the indexed column.
+   * Only comparisons between that column and a constant, possibly joined by AND, are pushed into the index; the
+   * predicate is still evaluated on every tuple the index returns.
+   */
+  void ExtractKeyRange(const AbstractExpression *expr);
+
+  /**
+   * Turns the constant of (column comp_type value) into a value of the key type, rounding a fractional bound toward
+   * the keys that the comparison lets through, e.g. column < 5.5 into column < 6.
+   * @return false if the comparison does not narrow the key range, which it sets empty if the comparison never holds,
+   * e.g. for a constant beyond the range of the key type, or one that the key type cannot hold without reordering
+   */
+  bool ToKeyType(ComparisonType *comp_type, Value *value);
+
+  /** Intersects the key range with (column comp_type value). */
+  void TightenKeyRange(ComparisonType comp_type, const Value &value);
+
+  /** @return a key tuple holding the bound value */
+  Tuple MakeKey(const KeyBound &bound) const;
+
+  /** @return true if every column the expression reads is stored in the index entries */
+  bool IsCovered(const AbstractExpression *expr) const;
+
+  /** Fill a tuple of the table schema with the columns of an index entry; the other columns are placeholders. */
+  void EntryToRow(const Tuple &entry, Tuple *row);
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
+  /** The index being scanned. */
+  IndexInfo *index_info_{nullptr};
+  /** The table the index points into. */
+  TableMetadata *table_info_{nullptr};
+  /** The lower and upper bounds of the key range, unset if that side is open. */
+  std::optional<KeyBound> lo_;
+  std::optional<KeyBound> hi_;
+  /** True if the predicate can never hold, e.g. colA < 5 AND colA > 10. */
+  bool empty_range_{false};
+  /** The range scan, null for point lookups. */
+  std::unique_ptr<IndexCursor> cursor_;
+  /** True if the query reads only columns the index stores, so that the table heap is never touched. */
+  bool index_only_{false};
+  /** The current batch of RIDs and the position in it. */
+  std::vector<RID> rids_;
+  size_t rid_idx_{0};
+  /** The index entries of the current batch, in an index-only scan. */
+  std::vector<Tuple> entries_;
+  /** The values of the row being rebuilt from an index entry. */
+  std::vector<Value> row_values_;
+  /** The table tuple being read, and the output tuple and values it is projected to, reused from one to the next. */
+  Tuple table_tuple_;
+  std::vector<Value> values_;
+  Tuple output_;
 };
 }  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
@@ -24,6 +25,9 @@ namespace bustub {
 /**
  * InsertExecutor executes an insert into a table.
  * Inserted values can either be embedded in the plan itself ("raw insert") or come from a child executor.
+ *
+ * The tuples are inserted BATCH_SIZE at a time through TableHeap::InsertTuples, which packs each page under a single
+ * latch and log record, and then added to the indexes of the table.
  */
 class InsertExecutor : public AbstractExecutor {
  public:
@@ -45,7 +49,25 @@ class InsertExecutor : public AbstractExecutor {
   bool Next([[maybe_unused]] Tuple *tuple, RID *rid) override;
 
  private:
+  /** The number of tuples handed to the table heap at once. */
+  static constexpr size_t BATCH_SIZE = 1024;
+
+  /** Fills the batch with the next tuples to insert, up to BATCH_SIZE. */
+  void NextBatch();
+
   /** The insert plan node to be executed. */
   const InsertPlanNode *plan_;
+  /** The child executor providing the tuples of an insert from a query, null for a raw insert. */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  /** The table being inserted into, and its indexes. */
+  TableMetadata *table_info_{nullptr};
+  std::vector<IndexInfo *> indexes_;
+  /** The position in the raw values of the plan. */
+  size_t raw_idx_{0};
+  /** True once the inserts have run. */
+  bool done_{false};
+  /** The current batch of tuples, and the rids they are inserted at. */
+  std::vector<Tuple> batch_;
+  std::vector<RID> rids_;
 };
 }  // namespace bustub
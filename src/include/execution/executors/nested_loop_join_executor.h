@@ -14,6 +14,7 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
@@ -24,6 +25,9 @@ namespace bustub {
 /**
  * NestedLoopJoinExecutor joins two tables using nested loop.
  * The child executor can either be a sequential scan
+ *
+ * The right side is read once, in Init, into tuples whose data lives in the pool of the query, see
+ * ExecutorContext::GetPool, and every left tuple is joined with all of them. The left side is read through views.
  */
 class NestedLoopJoinExecutor : public AbstractExecutor {
  public:
@@ -45,8 +49,21 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
 
   bool Next(Tuple *tuple, RID *rid) override;
 
+  bool NextView(TupleView *view, RID *rid) override;
+
  private:
   /** The NestedLoop plan node to be executed. */
   const NestedLoopJoinPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> left_executor_;
+  std::unique_ptr<AbstractExecutor> right_executor_;
+  /** The tuples of the right side. */
+  std::vector<Tuple> right_tuples_;
+  /** The left tuple being joined, if any, and the next right tuple to join it with. */
+  TupleView left_tuple_;
+  bool has_left_tuple_{false};
+  size_t right_idx_{0};
+  /** The values of the output tuple being produced, and the tuple they go to. */
+  std::vector<Value> values_;
+  Tuple output_;
 };
 }  // namespace bustub
@@ -12,17 +12,30 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/expressions/comparison_expression.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "storage/table/column_scan.h"
+#include "storage/table/table_scan.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
  * SeqScanExecutor executes a sequential scan over a table.
+ *
+ * The predicate is evaluated on views of the tuples in the pages that the scan reads, see TableScan, so that a tuple
+ * that fails it is never copied. NextView hands out such views as they are if the output schema is that of the table,
+ * or else views of the output tuple that the executor projects into, reusing its data from one tuple to the next.
+ *
+ * A projection of a PAX table, see TableFormat, that needs only some of its columns reads just those, see ColumnScan,
+ * and evaluates the predicate and the output columns on the batches that the column scan reads, without putting the
+ * tuples of the table back together. A predicate that compares an integer column with a constant is evaluated on the
+ * array of the column, a batch at a time.
  */
 class SeqScanExecutor : public AbstractExecutor {
  public:
@@ -37,10 +50,53 @@ class SeqScanExecutor : public AbstractExecutor {
 
   bool Next(Tuple *tuple, RID *rid) override;
 
+  bool NextView(TupleView *view, RID *rid) override;
+
   const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
 
  private:
+  /** @return true if the output columns are the columns of the table, in order, so that tuples need no projection */
+  bool IsIdentity() const;
+
+  /** NextView for a scan that reads through the column scan. */
+  bool NextBatchView(TupleView *view, RID *rid);
+
+  /** Find out whether the predicate compares an integer column with a constant, see SelectCompared. */
+  void InitFilter();
+
+  /** Collect the tuples of the batch that the predicate holds for. */
+  void SelectRows();
+
+  /** SelectRows for a comparison of the filter column with a constant of its type. */
+  template <typename T>
+  void SelectCompared(T constant);
+
+  template <typename T, typename Compare>
+  void SelectIf(Compare compare);
+
+  /** Flag the columns of the table that an expression reads. */
+  static void CollectColumns(const AbstractExpression *expr, std::vector<bool> *columns);
+
   /** The sequential scan plan node to be executed. */
   const SeqScanPlanNode *plan_;
+  /** The table being scanned. */
+  TableMetadata *table_info_{nullptr};
+  std::unique_ptr<TableScan> scan_;
+  /** The scan of the columns that the plan reads, if it reads some columns of a PAX table, and its current batch. */
+  std::unique_ptr<ColumnScan> column_scan_;
+  ColumnBatch batch_;
+  /** The tuples of the batch that the predicate holds for, and the next of them to output. */
+  std::vector<uint32_t> selection_;
+  size_t selection_row_{0};
+  /** The column that the predicate compares with filter_constant_, if it is of an integer type, see InitFilter. */
+  static constexpr uint32_t INVALID_FILTER_COLUMN = UINT32_MAX;
+  uint32_t filter_column_{INVALID_FILTER_COLUMN};
+  ComparisonType filter_type_{ComparisonType::Equal};
+  Value filter_constant_;
+  /** True if the output tuples are the tuples of the table. */
+  bool is_identity_{false};
+  /** The values of the output tuple being projected, and the tuple they go to. */
+  std::vector<Value> values_;
+  Tuple output_;
 };
 }  // namespace bustub
@@ -27,6 +27,9 @@ namespace bustub {
 /**
  * UpdateExecutor executes an update in a table.
  * Updated values from a child executor.
+ *
+ * The tuples are updated in place through TableHeap::UpdateTuple, which keeps their RIDs even when they outgrow their
+ * page. So only the indexes over an updated column, or storing one, need new entries; the others are left alone.
  */
 class UpdateExecutor : public AbstractExecutor {
   friend class UpdatePlanNode;
@@ -79,8 +82,12 @@ class UpdateExecutor : public AbstractExecutor {
   /** The update plan node to be executed. */
   const UpdatePlanNode *plan_;
   /** Metadata identifying the table that should be updated. */
-  const TableMetadata *table_info_;
+  const TableMetadata *table_info_{nullptr};
   /** The child executor to obtain value from. */
   std::unique_ptr<AbstractExecutor> child_executor_;
+  /** The indexes of the table whose entries the update changes. */
+  std::vector<IndexInfo *> updated_indexes_;
+  /** True once the updates have run. */
+  bool done_{false};
 };
 }  // namespace bustub
@@ -19,6 +19,9 @@
 #include "storage/table/tuple.h"
 
 namespace bustub {
+
+class ColumnBatch;
+
 /**
  * AbstractExpression is the base class of all the expressions in the system.
  * Expressions are modeled as trees, i.e. every expression may have a variable number of children.
@@ -39,6 +42,20 @@ class AbstractExpression {
   /** @return the value obtained by evaluating the tuple with the given schema */
   virtual Value Evaluate(const Tuple *tuple, const Schema *schema) const = 0;
 
+  /**
+   * Like Evaluate, but a VARCHAR value may point into the tuple or the expression instead of being copied, so that it
+   * is only valid as long as both are, e.g. to be compared right away.
+   */
+  virtual Value EvaluateView(const Tuple *tuple, const Schema *schema) const { return Evaluate(tuple, schema); }
+
+  /**
+   * Like EvaluateView, but on a tuple of a batch that a ColumnScan has read, see SeqScanExecutor, so that a VARCHAR
+   * value may point into the batch. The scanned columns include those that the expression reads.
+   * @param batch the batch
+   * @param row the tuple of the batch
+   */
+  virtual Value EvaluateBatch(const ColumnBatch &batch, size_t row) const = 0;
+
   /**
    * Returns the value obtained by evaluating a join.
    * @param left_tuple the left tuple
@@ -50,6 +67,12 @@ class AbstractExpression {
   virtual Value EvaluateJoin(const Tuple *left_tuple, const Schema *left_schema, const Tuple *right_tuple,
                              const Schema *right_schema) const = 0;
 
+  /** Like EvaluateJoin, but a VARCHAR value may point into the tuples or the expression, see EvaluateView. */
+  virtual Value EvaluateJoinView(const Tuple *left_tuple, const Schema *left_schema, const Tuple *right_tuple,
+                                 const Schema *right_schema) const {
+    return EvaluateJoin(left_tuple, left_schema, right_tuple, right_schema);
+  }
+
   /**
    * Returns the value obtained by evaluating the aggregates.
    * @param group_bys the group by values
@@ -12,10 +12,12 @@
 
 #pragma once
 
+#include <string_view>
 #include <vector>
 
 #include "catalog/schema.h"
 #include "execution/expressions/abstract_expression.h"
+#include "storage/table/column_scan.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -35,12 +37,29 @@ class ColumnValueExpression : public AbstractExpression {
 
   Value Evaluate(const Tuple *tuple, const Schema *schema) const override { return tuple->GetValue(schema, col_idx_); }
 
+  Value EvaluateView(const Tuple *tuple, const Schema *schema) const override {
+    if (schema->GetColumn(col_idx_).GetType() != TypeId::VARCHAR || tuple->IsNull(schema, col_idx_)) {
+      return tuple->GetValue(schema, col_idx_);
+    }
+    std::string_view view = tuple->GetStringView(schema, col_idx_);
+    return Value(TypeId::VARCHAR, view.data(), static_cast<uint32_t>(view.size()) + 1, false);
+  }
+
+  Value EvaluateBatch(const ColumnBatch &batch, size_t row) const override {
+    return batch.GetValueView(batch.GetPosition(col_idx_), row);
+  }
+
   Value EvaluateJoin(const Tuple *left_tuple, const Schema *left_schema, const Tuple *right_tuple,
                      const Schema *right_schema) const override {
     return tuple_idx_ == 0 ? left_tuple->GetValue(left_schema, col_idx_)
                            : right_tuple->GetValue(right_schema, col_idx_);
   }
 
+  Value EvaluateJoinView(const Tuple *left_tuple, const Schema *left_schema, const Tuple *right_tuple,
+                         const Schema *right_schema) const override {
+    return tuple_idx_ == 0 ? EvaluateView(left_tuple, left_schema) : EvaluateView(right_tuple, right_schema);
+  }
+
   Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const override {
     BUSTUB_ASSERT(false, "Aggregation should only refer to group-by and aggregates.");
   }
@@ -35,15 +35,21 @@ class ComparisonExpression : public AbstractExpression {
       : AbstractExpression({left, right}, TypeId::BOOLEAN), comp_type_{comp_type} {}
 
   Value Evaluate(const Tuple *tuple, const Schema *schema) const override {
-    Value lhs = GetChildAt(0)->Evaluate(tuple, schema);
-    Value rhs = GetChildAt(1)->Evaluate(tuple, schema);
+    Value lhs = GetChildAt(0)->EvaluateView(tuple, schema);
+    Value rhs = GetChildAt(1)->EvaluateView(tuple, schema);
+    return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
+  }
+
+  Value EvaluateBatch(const ColumnBatch &batch, size_t row) const override {
+    Value lhs = GetChildAt(0)->EvaluateBatch(batch, row);
+    Value rhs = GetChildAt(1)->EvaluateBatch(batch, row);
     return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
   }
 
   Value EvaluateJoin(const Tuple *left_tuple, const Schema *left_schema, const Tuple *right_tuple,
                      const Schema *right_schema) const override {
-    Value lhs = GetChildAt(0)->EvaluateJoin(left_tuple, left_schema, right_tuple, right_schema);
-    Value rhs = GetChildAt(1)->EvaluateJoin(left_tuple, left_schema, right_tuple, right_schema);
+    Value lhs = GetChildAt(0)->EvaluateJoinView(left_tuple, left_schema, right_tuple, right_schema);
+    Value rhs = GetChildAt(1)->EvaluateJoinView(left_tuple, left_schema, right_tuple, right_schema);
     return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
   }
 
@@ -53,6 +59,9 @@ class ComparisonExpression : public AbstractExpression {
     return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
   }
 
+  /** @return the type of comparison this expression performs */
+  ComparisonType GetComparisonType() const { return comp_type_; }
+
  private:
   CmpBool PerformComparison(const Value &lhs, const Value &rhs) const {
     switch (comp_type_) {
@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// conjunction_expression.h
+//
+// Identification: src/include/expression/conjunction_expression.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/expressions/abstract_expression.h"
+#include "storage/table/tuple.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** ConjunctionType represents the logical operator that joins the two expressions. */
+enum class ConjunctionType { And, Or };
+
+/**
+ * ConjunctionExpression represents two boolean expressions joined by AND or OR, with SQL's three-valued logic.
+ */
+class ConjunctionExpression : public AbstractExpression {
+ public:
+  /** Creates a new conjunction expression representing (left conj_type right). */
+  ConjunctionExpression(const AbstractExpression *left, const AbstractExpression *right, ConjunctionType conj_type)
+      : AbstractExpression({left, right}, TypeId::BOOLEAN), conj_type_{conj_type} {}
+
+  Value Evaluate(const Tuple *tuple, const Schema *schema) const override {
+    Value lhs = GetChildAt(0)->Evaluate(tuple, schema);
+    Value rhs = GetChildAt(1)->Evaluate(tuple, schema);
+    return ValueFactory::GetBooleanValue(PerformConjunction(lhs, rhs));
+  }
+
+  Value EvaluateBatch(const ColumnBatch &batch, size_t row) const override {
+    Value lhs = GetChildAt(0)->EvaluateBatch(batch, row);
+    Value rhs = GetChildAt(1)->EvaluateBatch(batch, row);
+    return ValueFactory::GetBooleanValue(PerformConjunction(lhs, rhs));
+  }
+
+  Value EvaluateJoin(const Tuple *left_tuple, const Schema *left_schema, const Tuple *right_tuple,
+                     const Schema *right_schema) const override {
+    Value lhs = GetChildAt(0)->EvaluateJoin(left_tuple, left_schema, right_tuple, right_schema);
+    Value rhs = GetChildAt(1)->EvaluateJoin(left_tuple, left_schema, right_tuple, right_schema);
+    return ValueFactory::GetBooleanValue(PerformConjunction(lhs, rhs));
+  }
+
+  Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const override {
+    Value lhs = GetChildAt(0)->EvaluateAggregate(group_bys, aggregates);
+    Value rhs = GetChildAt(1)->EvaluateAggregate(group_bys, aggregates);
+    return ValueFactory::GetBooleanValue(PerformConjunction(lhs, rhs));
+  }
+
+  /** @return the logical operator of this conjunction */
+  ConjunctionType GetConjunctionType() const { return conj_type_; }
+
+ private:
+  static CmpBool ToCmpBool(const Value &val) {
+    if (val.IsNull()) {
+      return CmpBool::CmpNull;
+    }
+    return val.GetAs<bool>() ? CmpBool::CmpTrue : CmpBool::CmpFalse;
+  }
+
+  CmpBool PerformConjunction(const Value &lhs, const Value &rhs) const {
+    CmpBool l = ToCmpBool(lhs);
+    CmpBool r = ToCmpBool(rhs);
+    switch (conj_type_) {
+      case ConjunctionType::And:
+        if (l == CmpBool::CmpFalse || r == CmpBool::CmpFalse) {
+          return CmpBool::CmpFalse;
+        }
+        return l == CmpBool::CmpTrue && r == CmpBool::CmpTrue ? CmpBool::CmpTrue : CmpBool::CmpNull;
+      case ConjunctionType::Or:
+        if (l == CmpBool::CmpTrue || r == CmpBool::CmpTrue) {
+          return CmpBool::CmpTrue;
+        }
+        return l == CmpBool::CmpFalse && r == CmpBool::CmpFalse ? CmpBool::CmpFalse : CmpBool::CmpNull;
+      default:
+        BUSTUB_ASSERT(false, "Unsupported conjunction type.");
+    }
+  }
+
+  ConjunctionType conj_type_;
+};
+}  // namespace bustub
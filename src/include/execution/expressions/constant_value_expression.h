@@ -27,11 +27,25 @@ class ConstantValueExpression : public AbstractExpression {
 
   Value Evaluate(const Tuple *tuple, const Schema *schema) const override { return val_; }
 
+  Value EvaluateView(const Tuple *tuple, const Schema *schema) const override {
+    if (val_.GetTypeId() != TypeId::VARCHAR || val_.IsNull()) {
+      return val_;
+    }
+    return Value(TypeId::VARCHAR, val_.GetData(), val_.GetLength(), false);
+  }
+
+  Value EvaluateBatch(const ColumnBatch &batch, size_t row) const override { return EvaluateView(nullptr, nullptr); }
+
   Value EvaluateJoin(const Tuple *left_tuple, const Schema *left_schema, const Tuple *right_tuple,
                      const Schema *right_schema) const override {
     return val_;
   }
 
+  Value EvaluateJoinView(const Tuple *left_tuple, const Schema *left_schema, const Tuple *right_tuple,
+                         const Schema *right_schema) const override {
+    return EvaluateView(left_tuple, left_schema);
+  }
+
   Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const override {
     return val_;
   }
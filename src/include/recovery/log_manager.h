@@ -16,6 +16,7 @@
 #include <condition_variable>  // NOLINT
 #include <future>              // NOLINT
 #include <mutex>               // NOLINT
+#include <thread>              // NOLINT
 
 #include "recovery/log_record.h"
 #include "storage/disk/disk_manager.h"
@@ -46,13 +47,19 @@ class LogManager {
 
   lsn_t AppendLogRecord(LogRecord *log_record);
 
+  /** Writes the log buffer to disk, returning once every record appended so far is persistent. */
+  void Flush();
+
   inline lsn_t GetNextLSN() { return next_lsn_; }
+  /** Sets the next LSN, so that the records appended after recovery follow the ones already in the log file. */
+  inline void SetNextLSN(lsn_t lsn) { next_lsn_ = lsn; }
   inline lsn_t GetPersistentLSN() { return persistent_lsn_; }
   inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
   inline char *GetLogBuffer() { return log_buffer_; }
 
  private:
-  // TODO(students): you may add your own member variables
+  /** Swaps the buffers and writes out the records in the log buffer. The caller holds latch_. */
+  void FlushBuffer();
 
   /** The atomic counter which records the next log sequence number. */
   std::atomic<lsn_t> next_lsn_;
@@ -61,14 +68,17 @@ class LogManager {
 
   char *log_buffer_;
   char *flush_buffer_;
+  /** The number of bytes of records in the log buffer. */
+  int offset_{0};
 
   std::mutex latch_;
 
-  std::thread *flush_thread_ __attribute__((__unused__));
+  std::thread *flush_thread_{nullptr};
+  bool stop_flush_thread_{false};
 
   std::condition_variable cv_;
 
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_;
 };
 
 }  // namespace bustub
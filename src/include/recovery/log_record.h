@@ -14,6 +14,8 @@
 
 #include <cassert>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "storage/table/tuple.h"
@@ -32,6 +34,16 @@ enum class LogRecordType {
   ABORT,
   /** Creating a new page in the table heap. */
   NEWPAGE,
+  /** Storing a pair in a slot of a hash table block page. */
+  HASH_INSERT,
+  /** Turning the pair in a slot of a hash table block page into a tombstone. */
+  HASH_REMOVE,
+  /** Creating the header and block pages of a linear probing hash table, possibly one that replaces a smaller one. */
+  HASH_NEWTABLE,
+  /** Dropping the smaller table that a resized linear probing hash table has finished migrating. */
+  HASH_FREETABLE,
+  /** Inserting a batch of tuples into one table page at once. */
+  BULKINSERT,
 };
 
 /**
@@ -42,21 +54,40 @@ enum class LogRecordType {
  * | size | LSN | transID | prevLSN | LogType |
  *---------------------------------------------
  * For insert type log record
- *---------------------------------------------------------------
- * | HEADER | tuple_rid | tuple_size | tuple_data(char[] array) |
- *---------------------------------------------------------------
+ *-------------------------------------------------------------------------------
+ * | HEADER | tuple_rid | tuple_flags | tuple_size | tuple_data(char[] array) |
+ *-------------------------------------------------------------------------------
  * For delete type (including markdelete, rollbackdelete, applydelete)
- *----------------------------------------------------------------
- * | HEADER | tuple_rid | tuple_size | tuple_data(char[] array) |
- *---------------------------------------------------------------
+ *-------------------------------------------------------------------------------
+ * | HEADER | tuple_rid | tuple_flags | tuple_size | tuple_data(char[] array) |
+ *-------------------------------------------------------------------------------
  * For update type log record
- *-----------------------------------------------------------------------------------
- * | HEADER | tuple_rid | tuple_size | old_tuple_data | tuple_size | new_tuple_data |
- *-----------------------------------------------------------------------------------
- * For new page type log record
- *--------------------------
- * | HEADER | prev_page_id |
- *--------------------------
+ *-----------------------------------------------------------------------------------------------------------
+ * | HEADER | tuple_rid | old_flags | new_flags | tuple_size | old_tuple_data | tuple_size | new_tuple_data |
+ *-----------------------------------------------------------------------------------------------------------
+ * The flags are those of the slot of the tuple in its table page, besides its size, see TablePage.
+ *
+ * For new page type log record, whose PAX part is empty for a row page
+ *----------------------------------------------------------------------------------------
+ * | HEADER | prev_page_id | page_id | pax_capacity | pax_column_count | pax_widths (2 each) |
+ *----------------------------------------------------------------------------------------
+ * For hash slot type log record (hash insert, hash remove), which records the control byte of the slot before and
+ * after, and the image of its pair, at their offsets within the block page
+ *---------------------------------------------------------------------------------------------------------
+ * | HEADER | page_id | ctrl_offset | pair_offset | pair_size | old_ctrl (1) | new_ctrl (1) | pair_data |
+ *---------------------------------------------------------------------------------------------------------
+ * For hash new table type log record
+ *-------------------------------------------------------------------------------------------
+ * | HEADER | header_page_id | old_header_page_id | size (8) | num_blocks | block_page_ids |
+ *-------------------------------------------------------------------------------------------
+ * For hash free table type log record
+ *------------------------------------------------
+ * | HEADER | old_header_page_id | header_page_id |
+ *------------------------------------------------
+ * For bulk insert type log record
+ *-------------------------------------------------------------------------------------
+ * | HEADER | page_id | tuple_flags | count | tuple_slot_1 | tuple_size_1 | tuple_data_1 | ... |
+ *-------------------------------------------------------------------------------------
  */
 class LogRecord {
   friend class LogManager;
@@ -70,8 +101,9 @@ class LogRecord {
       : size_(HEADER_SIZE), txn_id_(txn_id), prev_lsn_(prev_lsn), log_record_type_(log_record_type) {}
 
   // constructor for INSERT/DELETE type
-  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, const RID &rid, const Tuple &tuple)
-      : txn_id_(txn_id), prev_lsn_(prev_lsn), log_record_type_(log_record_type) {
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, const RID &rid, const Tuple &tuple,
+            uint32_t tuple_flags = 0)
+      : txn_id_(txn_id), prev_lsn_(prev_lsn), log_record_type_(log_record_type), tuple_flags_(tuple_flags) {
     if (log_record_type == LogRecordType::INSERT) {
       insert_rid_ = rid;
       insert_tuple_ = tuple;
@@ -82,32 +114,94 @@ class LogRecord {
       delete_tuple_ = tuple;
     }
     // calculate log record size
-    size_ = HEADER_SIZE + sizeof(RID) + sizeof(int32_t) + tuple.GetLength();
+    size_ = HEADER_SIZE + sizeof(RID) + sizeof(uint32_t) + sizeof(int32_t) + tuple.GetLength();
   }
 
   // constructor for UPDATE type
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, const RID &update_rid,
-            const Tuple &old_tuple, const Tuple &new_tuple)
+            const Tuple &old_tuple, const Tuple &new_tuple, uint32_t old_flags = 0, uint32_t new_flags = 0)
       : txn_id_(txn_id),
         prev_lsn_(prev_lsn),
         log_record_type_(log_record_type),
         update_rid_(update_rid),
         old_tuple_(old_tuple),
-        new_tuple_(new_tuple) {
+        new_tuple_(new_tuple),
+        tuple_flags_(old_flags),
+        new_flags_(new_flags) {
     // calculate log record size
-    size_ = HEADER_SIZE + sizeof(RID) + old_tuple.GetLength() + new_tuple.GetLength() + 2 * sizeof(int32_t);
+    size_ = HEADER_SIZE + sizeof(RID) + 2 * sizeof(uint32_t) + old_tuple.GetLength() + new_tuple.GetLength() +
+            2 * sizeof(int32_t);
   }
 
-  // constructor for NEWPAGE type
-  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, page_id_t prev_page_id, page_id_t page_id)
+  // constructor for NEWPAGE type, and for HASH_FREETABLE type, which takes no PAX part
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, page_id_t prev_page_id, page_id_t page_id,
+            std::vector<uint16_t> pax_widths = {}, uint32_t pax_capacity = 0)
       : size_(HEADER_SIZE),
         txn_id_(txn_id),
         prev_lsn_(prev_lsn),
         log_record_type_(log_record_type),
         prev_page_id_(prev_page_id),
-        page_id_(page_id) {
-    // calculate log record size, header size + sizeof(prev_page_id) + sizeof(page_id)
+        page_id_(page_id),
+        pax_widths_(std::move(pax_widths)),
+        pax_capacity_(pax_capacity) {
+    // calculate log record size, header size + sizeof(prev_page_id) + sizeof(page_id), and the PAX part of NEWPAGE
     size_ = HEADER_SIZE + sizeof(page_id_t) * 2;
+    if (log_record_type == LogRecordType::NEWPAGE) {
+      size_ += sizeof(uint32_t) * 2 + sizeof(uint16_t) * pax_widths_.size();
+    } else {
+      assert(log_record_type == LogRecordType::HASH_FREETABLE && pax_widths_.empty());
+    }
+  }
+
+  // constructor for HASH_INSERT/HASH_REMOVE type
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, page_id_t page_id, uint32_t ctrl_offset,
+            uint8_t old_ctrl, uint8_t new_ctrl, uint32_t pair_offset, const char *pair_data, uint32_t pair_size)
+      : txn_id_(txn_id),
+        prev_lsn_(prev_lsn),
+        log_record_type_(log_record_type),
+        page_id_(page_id),
+        ctrl_offset_(ctrl_offset),
+        old_ctrl_(old_ctrl),
+        new_ctrl_(new_ctrl),
+        pair_offset_(pair_offset),
+        pair_data_(pair_data, pair_data + pair_size) {
+    assert(log_record_type == LogRecordType::HASH_INSERT || log_record_type == LogRecordType::HASH_REMOVE);
+    // calculate log record size
+    size_ = HEADER_SIZE + sizeof(page_id_t) + 3 * sizeof(uint32_t) + 2 * sizeof(uint8_t) + pair_size;
+  }
+
+  // constructor for HASH_NEWTABLE type
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, page_id_t old_header_page_id,
+            page_id_t header_page_id, uint64_t hash_table_size, std::vector<page_id_t> block_page_ids)
+      : txn_id_(txn_id),
+        prev_lsn_(prev_lsn),
+        log_record_type_(log_record_type),
+        prev_page_id_(old_header_page_id),
+        page_id_(header_page_id),
+        hash_table_size_(hash_table_size),
+        block_page_ids_(std::move(block_page_ids)) {
+    assert(log_record_type == LogRecordType::HASH_NEWTABLE);
+    // calculate log record size
+    size_ = HEADER_SIZE + sizeof(page_id_t) * 2 + sizeof(uint64_t) + sizeof(uint32_t) +
+            sizeof(page_id_t) * block_page_ids_.size();
+  }
+
+  // constructor for BULKINSERT type
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, page_id_t page_id,
+            std::vector<uint32_t> insert_slots, std::vector<Tuple> insert_tuples, uint32_t tuple_flags = 0)
+      : txn_id_(txn_id),
+        prev_lsn_(prev_lsn),
+        log_record_type_(log_record_type),
+        tuple_flags_(tuple_flags),
+        page_id_(page_id),
+        insert_slots_(std::move(insert_slots)),
+        insert_tuples_(std::move(insert_tuples)) {
+    assert(log_record_type == LogRecordType::BULKINSERT && insert_slots_.size() == insert_tuples_.size());
+    // calculate log record size
+    size_ = HEADER_SIZE + sizeof(page_id_t) + 2 * sizeof(uint32_t);
+    for (const auto &tuple : insert_tuples_) {
+      size_ += sizeof(uint32_t) + sizeof(int32_t) + tuple.GetLength();
+    }
   }
 
   ~LogRecord() = default;
@@ -120,14 +214,50 @@ class LogRecord {
 
   inline RID &GetInsertRID() { return insert_rid_; }
 
+  inline std::vector<uint32_t> &GetInsertSlots() { return insert_slots_; }
+
+  inline std::vector<Tuple> &GetInsertTuples() { return insert_tuples_; }
+
   inline Tuple &GetOriginalTuple() { return old_tuple_; }
 
   inline Tuple &GetUpdateTuple() { return new_tuple_; }
 
+  /** @return the flags of the slot of the inserted or deleted tuples, or those of the original tuple of an update */
+  inline uint32_t GetTupleFlags() { return tuple_flags_; }
+
+  /** @return the flags of the slot of the updated tuple */
+  inline uint32_t GetUpdateFlags() { return new_flags_; }
+
   inline RID &GetUpdateRID() { return update_rid_; }
 
   inline page_id_t GetNewPageRecord() { return prev_page_id_; }
 
+  /** @return the page that the record modifies: the table page of NEWPAGE and BULKINSERT, or the hash table page of the
+   * HASH types */
+  inline page_id_t GetPageId() { return page_id_; }
+
+  /** @return the previous page of NEWPAGE, or the replaced hash table of HASH_NEWTABLE and HASH_FREETABLE */
+  inline page_id_t GetPrevPageId() { return prev_page_id_; }
+
+  inline uint32_t GetCtrlOffset() { return ctrl_offset_; }
+
+  inline uint8_t GetOldCtrl() { return old_ctrl_; }
+
+  inline uint8_t GetNewCtrl() { return new_ctrl_; }
+
+  inline uint32_t GetPairOffset() { return pair_offset_; }
+
+  inline std::vector<char> &GetPairData() { return pair_data_; }
+
+  /** @return the widths of the minipages of a new PAX page, see PaxPage, or none for a row page */
+  inline std::vector<uint16_t> &GetPaxWidths() { return pax_widths_; }
+
+  inline uint32_t GetPaxCapacity() { return pax_capacity_; }
+
+  inline uint64_t GetHashTableSize() { return hash_table_size_; }
+
+  inline std::vector<page_id_t> &GetBlockPageIds() { return block_page_ids_; }
+
   inline int32_t GetSize() { return size_; }
 
   inline lsn_t GetLSN() { return lsn_; }
@@ -173,9 +303,30 @@ class LogRecord {
   Tuple old_tuple_;
   Tuple new_tuple_;
 
-  // case4: for new page operation
+  // the flags of the slot of the tuples of case1, case2 and case7, and of the old and new tuple of case3
+  uint32_t tuple_flags_{0};
+  uint32_t new_flags_{0};
+
+  // case4: for new page operation, and the hash table operations
   page_id_t prev_page_id_{INVALID_PAGE_ID};
   page_id_t page_id_{INVALID_PAGE_ID};
+  std::vector<uint16_t> pax_widths_;
+  uint32_t pax_capacity_{0};
+
+  // case5: for hash slot operation
+  uint32_t ctrl_offset_{0};
+  uint8_t old_ctrl_{0};
+  uint8_t new_ctrl_{0};
+  uint32_t pair_offset_{0};
+  std::vector<char> pair_data_;
+
+  // case6: for hash new table operation
+  uint64_t hash_table_size_{0};
+  std::vector<page_id_t> block_page_ids_;
+
+  // case7: for bulk insert operation, into page_id_
+  std::vector<uint32_t> insert_slots_;
+  std::vector<Tuple> insert_tuples_;
   static const int HEADER_SIZE = 20;
 };  // namespace bustub
 
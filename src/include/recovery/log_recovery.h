@@ -18,17 +18,33 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/lock_manager.h"
+#include "recovery/log_manager.h"
 #include "recovery/log_record.h"
+#include "storage/page/table_page.h"
 
 namespace bustub {
 
 /**
  * Read log file from disk, redo and undo.
+ *
+ * The records of hash table pages are physiological: they name the page, and the bytes within it that change, so
+ * recovery can apply them without knowing the types of the keys. The records of table pages name the slot of the
+ * tuple, and keep the flags of the slot besides the tuple, see TablePage. A record is redone if the page has not seen
+ * it, going by the LSN of the page, and undone if its transaction neither committed nor aborted before the log ends.
+ * A hash table record is undone only in a slot that still holds its pair as the record left it, see HashSlotOwners.
+ *
+ * An undo is logged as the record of the change that undoes, on behalf of the transaction, which recovery aborts once
+ * all of its records are undone, so that a crash during recovery redoes the undos done so far, and undoes the rest.
  */
 class LogRecovery {
  public:
-  LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager)
-      : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), offset_(0) {
+  /**
+   * @param log_manager the log manager that appends to the log after recovery, which is told where the LSNs of the
+   * log leave off, and logs the undos; nullptr if none, in which case the undos are not logged, and the log must not
+   * be recovered again
+   */
+  LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, LogManager *log_manager = nullptr)
+      : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), log_manager_(log_manager), offset_(0) {
     log_buffer_ = new char[LOG_BUFFER_SIZE];
   }
 
@@ -42,15 +58,37 @@ class LogRecovery {
   bool DeserializeLogRecord(const char *data, LogRecord *log_record);
 
  private:
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  /** Applies the change of a record to its page, if the page does not have it yet. */
+  void RedoLogRecord(LogRecord *log_record);
+
+  /** Reverts the change of a record of an unfinished transaction. */
+  void UndoLogRecord(LogRecord *log_record);
+
+  /** Reverts the change of a record of a table page, see UndoLogRecord. */
+  void UndoTableLogRecord(LogRecord *log_record);
+
+  /** Applies the change of a record to the table page that it names, which has not seen it yet. */
+  void ApplyLogRecord(LogRecord *log_record, TablePage *page);
+
+  /** Logs an undo that is applied to a page, on behalf of the transaction of the undo, see LogRecovery. */
+  void LogUndo(LogRecord *undo, Page *page);
+
+  /** @return the table page that a record of a table page names */
+  static page_id_t GetTablePageId(LogRecord *log_record);
+
+  /** @return the pinned page, which the caller unpins */
+  Page *FetchPage(page_id_t page_id);
+
+  DiskManager *disk_manager_;
+  BufferPoolManager *buffer_pool_manager_;
+  LogManager *log_manager_;
 
   /** Maintain active transactions and its corresponding latest lsn. */
   std::unordered_map<txn_id_t, lsn_t> active_txn_;
   /** Mapping the log sequence number to log file offset for undos. */
   std::unordered_map<lsn_t, int> lsn_mapping_;
 
-  int offset_ __attribute__((__unused__));
+  int offset_;
   char *log_buffer_;
 };
 
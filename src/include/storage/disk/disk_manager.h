@@ -76,6 +76,12 @@ class DiskManager {
    */
   page_id_t AllocatePage();
 
+  /**
+   * Makes sure that AllocatePage never hands out a page that the log refers to, even if it was never written.
+   * @param page_id id of the page
+   */
+  void ReservePage(page_id_t page_id);
+
   /**
    * Deallocate a page on disk.
    * @param page_id id of the page to deallocate
@@ -10,12 +10,17 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
+#include <mutex>  // NOLINT
 #include <queue>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "concurrency/transaction.h"
 #include "storage/index/index_iterator.h"
+#include "storage/index/posting_list.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
@@ -23,15 +28,42 @@ namespace bustub {
 
 #define BPLUSTREE_TYPE BPlusTree<KeyType, ValueType, KeyComparator>
 
+/**
+ * How full a B+ tree keeps its nodes, as fractions of their max size.
+ *
+ * The fill factors apply where the tree can tell that keys arrive in order: a bulk load fills its nodes that far, and
+ * a key appended past the end of the rightmost node splits it there instead of in half, so that ascending keys leave
+ * the nodes behind them nearly full rather than half empty. A node only merges with or borrows from a neighbour once
+ * it drops below the merge threshold (at most the usual half), so a run of deletes does not keep coalescing and
+ * redistributing the same nodes.
+ */
+struct BPlusTreeFillFactors {
+  double leaf_ = 0.9;
+  double internal_ = 0.9;
+  double merge_threshold_ = 0.25;
+};
+
 /**
  * Main class providing the API for the Interactive B+ Tree.
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) Keys are unique unless the tree is created non-unique, in which case
+ *     the values of a repeated key are kept in a posting list
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * Leaves are linked in both directions, so range scans can run forward or backward from either bound.
+ * See PostingList for how a non-unique tree stores the values of a repeated key.
+ *
+ * A tree created with cached_levels > 0 keeps its top levels of internal pages pinned, and descends through them
+ * without the buffer pool; see FindLeaf. It then holds pins until it is destroyed, which must happen before the
+ * buffer pool manager is.
+ *
+ * The tree is latched as a whole rather than page by page: Insert, Remove and BulkLoad take tree_latch_ in exclusive
+ * mode, GetValue and the start of a scan in shared mode, so any number of lookups run alongside each other and one
+ * writer runs alone. An iterator walks the leaves after the latch is released, so a scan must not overlap writers.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
@@ -40,7 +72,17 @@ class BPlusTree {
 
  public:
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     bool unique_keys = true, const BPlusTreeFillFactors &fill_factors = BPlusTreeFillFactors(),
+                     int cached_levels = 0);
+
+  ~BPlusTree();
+
+  /** The share of the buffer pool, as a divisor of its size, that the cached top levels may take at most. */
+  static constexpr size_t CACHED_POOL_FRACTION = 16;
+
+  /** The most full shared posting pages a new small list tries before it starts a new page of its own. */
+  static constexpr int SHARED_PAGE_PROBES = 4;
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
@@ -48,17 +90,34 @@ class BPlusTree {
   // Insert a key-value pair into this B+ tree.
   bool Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
-  // Remove a key and its value from this B+ tree.
+  // Remove a key and all of its values from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
-  // return the value associated with a given key
+  // Remove a key-value pair from this B+ tree, keeping the other values of the key.
+  void Remove(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // return the values associated with a given key
   bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
 
+  /**
+   * Builds the tree bottom-up from key & value pairs sorted by key, and by value among equal keys. The tree must be
+   * empty. The leaves are built on num_threads threads, the internal levels on the calling thread once they are done.
+   * A unique tree keeps the first value of a repeated key.
+   */
+  void BulkLoad(const std::vector<MappingType> &entries, size_t num_threads = 1);
+
   // index iterator
   INDEXITERATOR_TYPE begin();
   INDEXITERATOR_TYPE Begin(const KeyType &key);
   INDEXITERATOR_TYPE end();
 
+  /**
+   * Range scan over the keys between lo and hi. A null bound leaves that side of the range open.
+   * A forward scan starts at lo and stops after hi, a backward scan starts at hi and stops after lo.
+   */
+  INDEXITERATOR_TYPE ScanRange(const KeyType *lo, bool lo_inclusive, const KeyType *hi, bool hi_inclusive,
+                               ScanDirection direction = ScanDirection::FORWARD);
+
   void Print(BufferPoolManager *bpm) {
     ToString(reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(root_page_id_)->GetData()), bpm);
   }
@@ -80,15 +139,43 @@ class BPlusTree {
   Page *FindLeafPage(const KeyType &key, bool leftMost = false);
 
  private:
+  // fetch a page of this tree, throwing if the buffer pool is exhausted
+  Page *FetchTreePage(page_id_t page_id);
+
+  // find the leaf that contains key, or the left/right most leaf if key is nullptr; the leaf is returned pinned
+  Page *FindLeaf(const KeyType *key, bool right_most = false);
+
+  // pin the top levels again if the tree changed shape since they were cached
+  void RefreshTopLevels();
+
+  // unpin the cached top levels and move on to the next epoch, before a cached page goes away or the root moves
+  void InvalidateTopLevels();
+
+  // unpin the cached top levels; the caller holds top_latch_
+  void ReleaseTopLevels();
+
+  // delete a page of this tree, dropping it from the cached top levels first
+  void DeleteTreePage(page_id_t page_id);
+
   void StartNewTree(const KeyType &key, const ValueType &value);
 
   bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
-  void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
+  // a shared posting page with room for a new small list of the key at index, near the lists of its neighbours
+  page_id_t FindSharedPostingPage(LeafPage *leaf, int index);
+
+  // append tells that new_node took a key appended past the end of the tree
+  void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node, bool append = false,
                         Transaction *transaction = nullptr);
 
   template <typename N>
-  N *Split(N *node);
+  N *Split(N *node, bool append = false);
+
+  // the number of entries a split leaves in node; an append past the end of the tree keeps it filled to its factor
+  int SplitPoint(const BPlusTreePage *node, bool append) const;
+
+  // the size below which a node merges with or borrows from a neighbour
+  int MergeThreshold(const BPlusTreePage *node) const;
 
   template <typename N>
   bool CoalesceOrRedistribute(N *node, Transaction *transaction = nullptr);
@@ -102,6 +189,15 @@ class BPlusTree {
 
   bool AdjustRoot(BPlusTreePage *node);
 
+  // merge the values of each key into one leaf entry, on num_threads threads
+  std::vector<MappingType> GroupByKey(const std::vector<MappingType> &entries, size_t num_threads);
+
+  // spread count entries as evenly as possible over as few nodes of the given capacity as will hold them
+  static std::vector<int> NodeSizes(size_t count, int capacity);
+
+  // remove a key and all of its values; the caller holds tree_latch_ in exclusive mode
+  void RemoveKey(const KeyType &key, Transaction *transaction);
+
   void UpdateRootPageId(int insert_record = 0);
 
   /* Debug Routines for FREE!! */
@@ -116,6 +212,22 @@ class BPlusTree {
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  bool unique_keys_;
+  BPlusTreeFillFactors fill_factors_;
+
+  // the number of levels from the root down to keep pinned, and the most pages they may take
+  int cached_levels_;
+  size_t max_cached_pages_;
+  // the pinned internal pages of the top levels by page id, and the number of levels they make up
+  std::unordered_map<page_id_t, Page *> top_pages_;
+  int top_depth_{0};
+  // the epoch moves on whenever the top levels change shape; they are cached for top_epoch_ and stale if it differs
+  std::atomic<uint64_t> epoch_{1};
+  std::atomic<uint64_t> top_epoch_{0};
+  std::mutex top_latch_;
+
+  // shared by lookups and the start of scans, exclusive to writers
+  ReaderWriterLatch tree_latch_;
 };
 
 }  // namespace bustub
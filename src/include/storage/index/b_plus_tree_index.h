@@ -12,19 +12,72 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "storage/index/b_plus_tree.h"
 #include "storage/index/index.h"
+#include "storage/table/table_heap.h"
 
 namespace bustub {
 
 #define BPLUSTREE_INDEX_TYPE BPlusTreeIndex<KeyType, ValueType, KeyComparator>
 
+/**
+ * Range scan cursor over a B+ tree index, returning one leaf page of RIDs per batch.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeIndexCursor : public IndexCursor {
+ public:
+  BPlusTreeIndexCursor(INDEXITERATOR_TYPE &&iterator, Schema *entry_schema)
+      : iterator_(std::move(iterator)), entry_schema_(entry_schema) {}
+
+  bool NextBatch(std::vector<RID> *result) override { return iterator_.NextBatch(result) > 0; }
+
+  bool NextEntryBatch(std::vector<RID> *result, std::vector<Tuple> *entries) override {
+    keys_.clear();
+    if (iterator_.NextBatch(result, &keys_) == 0) {
+      return false;
+    }
+    for (const auto &key : keys_) {
+      entries->push_back(ToEntry(key, entry_schema_));
+    }
+    return true;
+  }
+
+  /** @return the index entry stored in a key, as a tuple of the entry schema */
+  static Tuple ToEntry(const KeyType &key, Schema *entry_schema) {
+    std::vector<Value> values;
+    values.reserve(entry_schema->GetColumnCount());
+    for (uint32_t i = 0; i < entry_schema->GetColumnCount(); i++) {
+      values.push_back(key.ToValue(entry_schema, i));
+    }
+    return Tuple(values, entry_schema);
+  }
+
+ private:
+  INDEXITERATOR_TYPE iterator_;
+  Schema *entry_schema_;
+  /** The keys of the current batch, reused across batches. */
+  std::vector<KeyType> keys_;
+};
+
+/**
+ * BPlusTreeIndex stores every index entry whole in the key of its leaf entry: the key columns first, then the
+ * included columns, which the comparator ignores. A covering index can thus answer a query from its leaves alone.
+ *
+ * With NormalizedKey keys, which need a key of fixed-width columns and no included columns, every key comparison of
+ * the tree is a single memcmp.
+ */
+
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
+  /** The number of levels, from the root down, that the tree keeps pinned for point lookups and scans. */
+  static constexpr int CACHED_LEVELS = 3;
+
   BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager);
 
   void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
@@ -33,13 +86,41 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  bool SupportsIndexOnlyScans() const override { return true; }
+
+  void ScanKeyEntries(const Tuple &key, std::vector<RID> *result, std::vector<Tuple> *entries,
+                      Transaction *transaction) override;
+
+  std::unique_ptr<IndexCursor> ScanRange(const Tuple *lo, bool lo_inclusive, const Tuple *hi, bool hi_inclusive,
+                                         ScanDirection direction, Transaction *transaction) override;
+
+  /**
+   * Fills the empty index with the rows of a table. The pages of the table are split among the threads, each of
+   * which extracts and sorts the keys of its pages; the sorted runs are then merged in parallel and bulk loaded.
+   * @param table the table
+   * @param schema the schema of the table
+   * @param transaction the transaction that builds the index
+   * @param num_threads the number of threads; with logging enabled the build is single-threaded, since it takes the
+   * tuple locks through the transaction
+   */
+  void BuildFromTable(TableHeap *table, const Schema &schema, Transaction *transaction, size_t num_threads);
+
   INDEXITERATOR_TYPE GetBeginIterator();
 
   INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
 
   INDEXITERATOR_TYPE GetEndIterator();
 
+  INDEXITERATOR_TYPE GetRangeIterator(const KeyType *lo, bool lo_inclusive, const KeyType *hi, bool hi_inclusive,
+                                      ScanDirection direction = ScanDirection::FORWARD);
+
  protected:
+  /** @return the hash the Bloom filter keeps for a stored key, which covers only its key columns */
+  uint64_t FilterHash(const KeyType &key) const;
+
+  BufferPoolManager *buffer_pool_manager_;
+  // layout of the key schema, which a NormalizedKey is encoded with
+  KeyLayout layout_;
   // comparator for key
   KeyComparator comparator_;
   // container
@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter.h
+//
+// Identification: src/include/storage/index/bloom_filter.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace bustub {
+
+/**
+ * BloomFilter answers "is this key definitely absent?" for an index without touching its pages.
+ *
+ * It is a split block Bloom filter: a key hashes to one 32-byte block, and sets one bit in each of the eight 32-bit
+ * words of that block. A probe is then one cache line, and the eight words are checked with a single AVX2 test when
+ * the build targets it.
+ *
+ * Keys are never removed, so deleted keys only add to the false positives. The filter grows as keys arrive: once a
+ * layer holds as many keys as it was sized for, a new layer four times as large takes the inserts, and probes check
+ * every layer. Inserts and probes may run concurrently.
+ */
+class BloomFilter {
+ public:
+  /** The number of keys the first layer is sized for, unless the caller knows better. */
+  static constexpr size_t DEFAULT_EXPECTED_KEYS = 1024;
+  /** Bits per key of every layer; about 0.15% false positives when a layer is full. */
+  static constexpr size_t BITS_PER_KEY = 16;
+  /** The number of layers the filter can grow to. */
+  static constexpr size_t MAX_LAYERS = 16;
+
+  /** @param expected_keys the number of keys the first layer is sized for */
+  explicit BloomFilter(size_t expected_keys = DEFAULT_EXPECTED_KEYS);
+
+  /** @return the hash of a key as the filter expects it */
+  static uint64_t Hash(const void *data, size_t size);
+
+  /** Adds the key with the given hash. */
+  void Insert(uint64_t hash);
+
+  /** @return false if the key with the given hash was never inserted, true if it may have been */
+  bool MayContain(uint64_t hash) const;
+
+  /** @return the memory taken by the bits of the filter */
+  size_t GetSizeInBytes() const;
+
+ private:
+  /** One cache-line-sized group of bits; every key sets a bit in each word of its block. */
+  struct alignas(32) Block {
+    uint32_t words_[8];
+  };
+
+  struct Layer {
+    explicit Layer(size_t capacity);
+
+    /** The number of keys the layer is sized for. */
+    size_t capacity_;
+    size_t num_blocks_;
+    std::unique_ptr<Block[]> blocks_;
+    std::atomic<size_t> num_keys_{0};
+  };
+
+  static void InsertIntoBlock(Block *block, uint32_t hash);
+
+  static bool BlockContains(const Block *block, uint32_t hash);
+
+  /** @return the block of a layer that the hash maps to */
+  static Block *BlockOf(const Layer &layer, uint64_t hash);
+
+  std::unique_ptr<Layer> layers_[MAX_LAYERS];
+  /** The number of layers that are ready to be probed; only the last one takes inserts. */
+  std::atomic<size_t> num_layers_{0};
+};
+
+}  // namespace bustub
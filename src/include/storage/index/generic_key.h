@@ -12,8 +12,11 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstring>
+#include <memory>
 
+#include "storage/index/key_layout.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -32,9 +35,13 @@ class GenericKey {
   inline void SetFromKey(const Tuple &tuple) {
     // intialize to 0
     memset(data_, 0, KeySize);
-    memcpy(data_, tuple.GetData(), tuple.GetLength());
+    // the null bitmap of the key tuple may not fit, and is left out then
+    memcpy(data_, tuple.GetData(), std::min<size_t>(tuple.GetLength(), KeySize));
   }
 
+  // the raw format needs no layout, this only matches the interface of NormalizedKey
+  inline void SetFromKey(const Tuple &tuple, const KeyLayout & /*layout*/) { SetFromKey(tuple); }
+
   // NOTE: for test purpose only
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
@@ -72,11 +79,17 @@ class GenericKey {
 
 /**
  * Function object returns true if lhs < rhs, used for trees
+ *
+ * Keys made only of fixed-width columns are compared through the KeyLayout compiled from the key schema, which reads
+ * the columns in place. Keys with a VARCHAR column are compared Value by Value.
  */
 template <size_t KeySize>
 class GenericComparator {
  public:
   inline int operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const {
+    if (layout_->IsFixedWidth()) {
+      return layout_->Compare(lhs.data_, rhs.data_);
+    }
     uint32_t column_count = key_schema_->GetColumnCount();
 
     for (uint32_t i = 0; i < column_count; i++) {
@@ -94,13 +107,19 @@ class GenericComparator {
     return 0;
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
+  /** @return true if the keys are a single BIGINT column, which B+ tree pages search as an int64_t array */
+  inline bool IsInteger() const { return KeySize == sizeof(int64_t) && layout_->IsInteger(); }
+
+  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_}, layout_{other.layout_} {}
 
   // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+  explicit GenericComparator(Schema *key_schema)
+      : key_schema_(key_schema), layout_(std::make_shared<const KeyLayout>(key_schema)) {}
 
  private:
   Schema *key_schema_;
+  // compiled once per index and shared by every copy of the comparator
+  std::shared_ptr<const KeyLayout> layout_;
 };
 
 }  // namespace bustub
@@ -18,6 +18,8 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "common/exception.h"
+#include "storage/index/bloom_filter.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -37,12 +39,28 @@ class IndexMetadata {
   IndexMetadata() = delete;
 
   IndexMetadata(std::string index_name, std::string table_name, const Schema *tuple_schema,
-                std::vector<uint32_t> key_attrs)
-      : name_(std::move(index_name)), table_name_(std::move(table_name)), key_attrs_(std::move(key_attrs)) {
+                std::vector<uint32_t> key_attrs, bool is_unique = true, bool bloom_filter = false,
+                const std::vector<uint32_t> &included_attrs = {})
+      : name_(std::move(index_name)),
+        table_name_(std::move(table_name)),
+        key_attrs_(std::move(key_attrs)),
+        is_unique_(is_unique),
+        has_bloom_filter_(bloom_filter),
+        num_included_(static_cast<uint32_t>(included_attrs.size())) {
     key_schema_ = Schema::CopySchema(tuple_schema, key_attrs_);
+    entry_attrs_ = key_attrs_;
+    entry_attrs_.insert(entry_attrs_.end(), included_attrs.begin(), included_attrs.end());
+    entry_schema_ = Schema::CopySchema(tuple_schema, entry_attrs_);
+    // the filter hashes the bytes of a key, but 0.0 and -0.0 are equal DECIMAL keys with different bytes
+    for (const auto &column : key_schema_->GetColumns()) {
+      has_bloom_filter_ = has_bloom_filter_ && column.GetType() != TypeId::DECIMAL;
+    }
   }
 
-  ~IndexMetadata() { delete key_schema_; }
+  ~IndexMetadata() {
+    delete key_schema_;
+    delete entry_schema_;
+  }
 
   inline const std::string &GetName() const { return name_; }
 
@@ -60,6 +78,22 @@ class IndexMetadata {
   //  columns
   inline const std::vector<uint32_t> &GetKeyAttrs() const { return key_attrs_; }
 
+  // Returns a schema object pointer that represents an index entry: the key columns
+  // followed by the included columns
+  inline Schema *GetEntrySchema() const { return entry_schema_; }
+
+  // Returns the base table columns of an index entry, key columns first
+  inline const std::vector<uint32_t> &GetEntryAttrs() const { return entry_attrs_; }
+
+  // Returns whether the index stores columns besides the key columns
+  inline bool IsCovering() const { return num_included_ > 0; }
+
+  // Returns whether a key maps to at most one RID
+  inline bool IsUnique() const { return is_unique_; }
+
+  // Returns whether point lookups go through a Bloom filter over the keys first
+  inline bool HasBloomFilter() const { return has_bloom_filter_; }
+
   // Get a string representation for debugging
   std::string ToString() const {
     std::stringstream os;
@@ -67,6 +101,9 @@ class IndexMetadata {
     os << "IndexMetadata["
        << "Name = " << name_ << ", "
        << "Type = B+Tree, "
+       << "Unique = " << is_unique_ << ", "
+       << "Bloom filter = " << has_bloom_filter_ << ", "
+       << "Included columns = " << num_included_ << ", "
        << "Table name = " << table_name_ << "] :: ";
     os << key_schema_->ToString();
 
@@ -78,8 +115,41 @@ class IndexMetadata {
   std::string table_name_;
   // The mapping relation between key schema and tuple schema
   const std::vector<uint32_t> key_attrs_;
+  // whether a key maps to at most one RID
+  bool is_unique_;
+  // whether the index keeps a Bloom filter over its keys
+  bool has_bloom_filter_;
+  // the number of columns an entry stores after the key columns
+  uint32_t num_included_;
+  // The key columns followed by the included columns
+  std::vector<uint32_t> entry_attrs_;
   // schema of the indexed key
   Schema *key_schema_;
+  // schema of an index entry
+  Schema *entry_schema_;
+};
+
+/** The order in which a range scan visits the keys. */
+enum class ScanDirection { FORWARD, BACKWARD };
+
+/**
+ * class IndexCursor - Hands out the RIDs of an index range scan
+ *
+ * The RIDs come in batches, e.g. one leaf page worth of them for a B+ tree,
+ * so that callers pay the per-call overhead once per batch.
+ */
+class IndexCursor {
+ public:
+  virtual ~IndexCursor() = default;
+
+  // Appends the next batch of RIDs to result; returns false once the scan is exhausted
+  virtual bool NextBatch(std::vector<RID> *result) = 0;
+
+  // Like NextBatch, but also appends the index entry of every RID to entries, as a tuple
+  // of the entry schema. Only indexes that support index-only scans implement it.
+  virtual bool NextEntryBatch(std::vector<RID> *result, std::vector<Tuple> *entries) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "The index does not support index-only scans.");
+  }
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -102,7 +172,11 @@ class IndexMetadata {
  */
 class Index {
  public:
-  explicit Index(IndexMetadata *metadata) : metadata_(metadata) {}
+  explicit Index(IndexMetadata *metadata) : metadata_(metadata) {
+    if (metadata_->HasBloomFilter()) {
+      bloom_filter_ = std::make_unique<BloomFilter>();
+    }
+  }
 
   virtual ~Index() { delete metadata_; }
 
@@ -117,6 +191,10 @@ class Index {
 
   const std::vector<uint32_t> &GetKeyAttrs() const { return metadata_->GetKeyAttrs(); }
 
+  Schema *GetEntrySchema() const { return metadata_->GetEntrySchema(); }
+
+  const std::vector<uint32_t> &GetEntryAttrs() const { return metadata_->GetEntryAttrs(); }
+
   // Get a string representation for debugging
   std::string ToString() const {
     std::stringstream os;
@@ -129,7 +207,8 @@ class Index {
   ///////////////////////////////////////////////////////////////////
   // Point Modification
   ///////////////////////////////////////////////////////////////////
-  // designed for secondary indexes.
+  // designed for secondary indexes. The key tuple is an index entry, i.e. it has the
+  // included columns after the key columns; build it with the entry schema and attributes.
   virtual void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) = 0;
 
   // delete the index entry linked to given tuple
@@ -137,6 +216,35 @@ class Index {
 
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  ///////////////////////////////////////////////////////////////////
+  // Index-only Scan
+  ///////////////////////////////////////////////////////////////////
+  // whether the index hands out its entries, so that queries that need only the
+  // columns of the entry schema can skip the table heap
+  virtual bool SupportsIndexOnlyScans() const { return false; }
+
+  // Like ScanKey, but also appends the index entry of every RID to entries
+  virtual void ScanKeyEntries(const Tuple &key, std::vector<RID> *result, std::vector<Tuple> *entries,
+                              Transaction *transaction) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "The index does not support index-only scans.");
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  // Range Scan
+  ///////////////////////////////////////////////////////////////////
+  // scan the keys between lo and hi; a null bound leaves that side of the
+  // range open. Only indexes that keep their keys in order support it.
+  virtual std::unique_ptr<IndexCursor> ScanRange(const Tuple *lo, bool lo_inclusive, const Tuple *hi,
+                                                 bool hi_inclusive, ScanDirection direction,
+                                                 Transaction *transaction) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "The index does not support range scans.");
+  }
+
+ protected:
+  // Bloom filter over the keys of the index, or nullptr if it has none. Subclasses add
+  // every inserted key, and skip the lookup of a key the filter rules out.
+  std::unique_ptr<BloomFilter> bloom_filter_;
+
  private:
   //===--------------------------------------------------------------------===//
   //  Data members
@@ -13,17 +13,48 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <vector>
+
+#include "common/macros.h"
+#include "storage/index/index.h"
+#include "storage/index/posting_list.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+/**
+ * IndexIterator walks the leaf level of a B+ tree, in either direction, until it runs off the last leaf or passes an
+ * optional stop key. It keeps the current leaf pinned, so it is move-only.
+ *
+ * An entry that refers to a posting list yields every RID of the list, one posting page at a time.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
  public:
-  // you may define your own constructor based on your member variables
+  /** Creates an iterator that is already at the end. */
   IndexIterator();
+
+  /**
+   * Creates an iterator positioned at the given slot of a leaf page. The position may be one past either end of the
+   * leaf, in which case the iterator moves on to the neighbouring leaf in the scan direction.
+   * @param buffer_pool_manager the buffer pool manager of the tree
+   * @param page the leaf page, pinned by the caller; the iterator takes over the pin
+   * @param index the slot to start at
+   * @param comparator the key comparator of the tree, which must outlive the iterator
+   * @param direction the scan direction
+   * @param stop_key the last key of the scan in the scan direction, or nullptr to scan to the end of the tree
+   * @param stop_inclusive whether stop_key itself is part of the scan
+   */
+  IndexIterator(BufferPoolManager *buffer_pool_manager, Page *page, int index, const KeyComparator *comparator,
+                ScanDirection direction = ScanDirection::FORWARD, const KeyType *stop_key = nullptr,
+                bool stop_inclusive = true);
+
+  IndexIterator(IndexIterator &&other) noexcept;
+  IndexIterator &operator=(IndexIterator &&other) noexcept;
+  DISALLOW_COPY(IndexIterator);
+
   ~IndexIterator();
 
   bool isEnd();
@@ -32,12 +63,63 @@ class IndexIterator {
 
   IndexIterator &operator++();
 
-  bool operator==(const IndexIterator &itr) const { throw std::runtime_error("unimplemented"); }
+  /**
+   * Appends the values of every remaining entry of the current leaf to result and moves on to the next leaf, so that
+   * a scan costs one call per leaf instead of one per entry. Posting lists are appended whole.
+   * @param[out] result the vector the values are appended to
+   * @param[out] keys if not null, the key of every appended value is appended to it
+   * @return the number of values appended, 0 once the iterator is at the end
+   */
+  int NextBatch(std::vector<ValueType> *result, std::vector<KeyType> *keys = nullptr);
+
+  bool operator==(const IndexIterator &itr) const {
+    return page_id_ == itr.page_id_ &&
+           (page_id_ == INVALID_PAGE_ID || (index_ == itr.index_ && posting_index_ == itr.posting_index_ &&
+                                            posting_next_id_ == itr.posting_next_id_));
+  }
 
-  bool operator!=(const IndexIterator &itr) const { throw std::runtime_error("unimplemented"); }
+  bool operator!=(const IndexIterator &itr) const { return !(*this == itr); }
 
  private:
-  // add your own private member variables here
+  using LeafPage = B_PLUS_TREE_LEAF_PAGE_TYPE;
+
+  /** Moves over to the neighbouring leaves until index_ is a slot within the scan, or to the end if there is none. */
+  void Settle();
+
+  /** Makes the given pinned leaf the current one and finds where the scan stops within it. */
+  void Enter(Page *page);
+
+  /** Unpins the current leaf and moves the iterator to the end. */
+  void Release();
+
+  /** Loads the small list, or the first posting page in scan order, of the current entry if it refers to one. */
+  void LoadPostings();
+
+  /** Decodes a posting page into postings_, in scan order. */
+  void LoadPostingPage(page_id_t page_id);
+
+  /** Appends the RIDs of the given leaf value to result, in scan order. */
+  void AppendValue(const ValueType &value, std::vector<ValueType> *result);
+
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  Page *page_{nullptr};
+  LeafPage *leaf_{nullptr};
+  page_id_t page_id_{INVALID_PAGE_ID};
+  int index_{0};
+  /** The first slot of the current leaf, in scan order, that is past the stop key or past the end of the leaf. */
+  int stop_index_{0};
+  const KeyComparator *comparator_{nullptr};
+  ScanDirection direction_{ScanDirection::FORWARD};
+  KeyType stop_key_{};
+  bool has_stop_key_{false};
+  bool stop_inclusive_{true};
+  /** The RIDs of the current posting page in scan order, empty unless the current entry is a posting list. */
+  std::vector<ValueType> postings_;
+  int posting_index_{0};
+  /** The posting page after the current one in scan order. */
+  page_id_t posting_next_id_{INVALID_PAGE_ID};
+  /** The pair operator* hands out while the iterator is within a posting list. */
+  MappingType current_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// int_key_search.h
+//
+// Identification: src/include/storage/index/int_key_search.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#include <cstdint>
+#include <cstring>
+
+namespace bustub {
+
+/**
+ * Search routines over a sorted, contiguous array of int64_t keys, as the B+ tree pages store keys that are a single
+ * BIGINT column (see GenericComparator::IsInteger()).
+ *
+ * A branch-free binary search narrows the range down to SEARCH_WINDOW keys, which are then counted with vector
+ * compares (AVX-512 or AVX2 when the build targets them, scalar otherwise). Keeping the keys apart from the values
+ * means the window is a few cache lines instead of one cache line per probe.
+ */
+class IntKeySearch {
+ public:
+  /** @return the BIGINT that an 8 byte key in the raw tuple format holds */
+  template <typename KeyType>
+  static inline int64_t ToInteger(const KeyType &key) {
+    static_assert(sizeof(KeyType) == sizeof(int64_t), "Only 8 byte keys hold a single BIGINT.");
+    int64_t integer;
+    memcpy(&integer, &key, sizeof(int64_t));
+    return integer;
+  }
+
+  /** Number of keys that are compared with vector instructions at the end of the search. */
+  static constexpr int SEARCH_WINDOW = 32;
+
+  /** @return the first index i such that keys[i] >= key, or size if there is none */
+  static inline int LowerBound(const int64_t *keys, int size, int64_t key) {
+    int n = size;
+    int base = Narrow(keys, &n, key, false);
+    return base + CountLess(keys + base, n, key, false);
+  }
+
+  /** @return the first index i such that keys[i] > key, or size if there is none */
+  static inline int UpperBound(const int64_t *keys, int size, int64_t key) {
+    int n = size;
+    int base = Narrow(keys, &n, key, true);
+    return base + CountLess(keys + base, n, key, true);
+  }
+
+ private:
+  /**
+   * Branch-free binary search. The bound stays within [base, base + n] while n shrinks to fit the window.
+   * @param[in,out] n the number of keys to search, then the size of the window
+   * @return the start of the window, which contains the bound
+   */
+  static inline int Narrow(const int64_t *keys, int *n, int64_t key, bool or_equal) {
+    int base = 0;
+    while (*n > SEARCH_WINDOW) {
+      int half = *n / 2;
+      int64_t probe = keys[base + half];
+      base = (probe < key || (or_equal && probe == key)) ? base + half : base;
+      *n -= half;
+    }
+    return base;
+  }
+
+  /** @return the number of keys in keys[0, n) that are < key (or <= key if or_equal) */
+  static inline int CountLess(const int64_t *keys, int n, int64_t key, bool or_equal) {
+    // keys[i] <= key is keys[i] < key + 1, unless key + 1 overflows, in which case every key qualifies
+    if (or_equal) {
+      if (key == INT64_MAX) {
+        return n;
+      }
+      key++;
+    }
+    int count = 0;
+    int i = 0;
+#if defined(__AVX512F__)
+    __m512i needle = _mm512_set1_epi64(key);
+    for (; i + 8 <= n; i += 8) {
+      __m512i block = _mm512_loadu_si512(reinterpret_cast<const void *>(keys + i));
+      count += __builtin_popcount(_mm512_cmplt_epi64_mask(block, needle));
+    }
+#elif defined(__AVX2__)
+    __m256i needle = _mm256_set1_epi64x(key);
+    for (; i + 4 <= n; i += 4) {
+      __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+      __m256i less = _mm256_cmpgt_epi64(needle, block);
+      count += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(less)));
+    }
+#endif
+    for (; i < n; i++) {
+      count += static_cast<int>(keys[i] < key);
+    }
+    return count;
+  }
+};
+
+}  // namespace bustub
@@ -0,0 +1,151 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_layout.h
+//
+// Identification: src/include/storage/index/key_layout.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/macros.h"
+#include "type/type_id.h"
+
+namespace bustub {
+
+/**
+ * KeyLayout is a key schema compiled down to (type, offset, size) triples.
+ *
+ * It lets index comparators read fixed-width key columns straight out of the serialized key bytes instead of
+ * materializing a Value per column and dispatching through Type::GetInstance on every comparison. It also knows how
+ * to rewrite a key into its normalized form, in which two keys can be ordered with a single memcmp:
+ *  - integers are stored big-endian with the sign bit flipped,
+ *  - decimals have their IEEE-754 bits flipped so that negative numbers order before positive ones; -0.0 is stored
+ *    as 0.0 and every NaN as the same NaN, which orders after every number,
+ *  - timestamps are stored big-endian.
+ *
+ * BusTub encodes NULL as a per-type sentinel (see type/limits.h). Those sentinels are the smallest representable
+ * value for the integer, boolean and decimal types and the largest for timestamps, so NULLs order first for the
+ * former and last for the latter, in both the raw and the normalized comparison.
+ *
+ * Keys that contain a VARCHAR column are not fixed-width and cannot be compiled; callers must fall back to the
+ * Value-based comparison for them.
+ */
+class KeyLayout {
+ public:
+  /**
+   * Compiles the layout of the given key schema.
+   * @param key_schema the schema of the index key
+   */
+  explicit KeyLayout(const Schema *key_schema);
+
+  /** @return true if every key column is fixed-width, i.e. Compare() and Normalize() may be used */
+  inline bool IsFixedWidth() const { return fixed_width_; }
+
+  /** @return true if the key is a single BIGINT column, which can be compared as an int64_t */
+  inline bool IsInteger() const { return columns_.size() == 1 && columns_[0].type_ == TypeId::BIGINT; }
+
+  /** @return the number of bytes in the normalized (and the raw) key */
+  inline uint32_t GetLength() const { return length_; }
+
+  /**
+   * Compares two keys serialized in the raw tuple format.
+   * @param lhs the left key bytes
+   * @param rhs the right key bytes
+   * @return < 0 if lhs < rhs, 0 if lhs == rhs, > 0 if lhs > rhs
+   */
+  inline int Compare(const char *lhs, const char *rhs) const {
+    for (const auto &col : columns_) {
+      int res;
+      switch (col.type_) {
+        case TypeId::BOOLEAN:
+        case TypeId::TINYINT:
+          res = CompareAs<int8_t>(lhs + col.offset_, rhs + col.offset_);
+          break;
+        case TypeId::SMALLINT:
+          res = CompareAs<int16_t>(lhs + col.offset_, rhs + col.offset_);
+          break;
+        case TypeId::INTEGER:
+          res = CompareAs<int32_t>(lhs + col.offset_, rhs + col.offset_);
+          break;
+        case TypeId::BIGINT:
+          res = CompareAs<int64_t>(lhs + col.offset_, rhs + col.offset_);
+          break;
+        case TypeId::DECIMAL:
+          res = CompareAs<double>(lhs + col.offset_, rhs + col.offset_);
+          break;
+        case TypeId::TIMESTAMP:
+          res = CompareAs<uint64_t>(lhs + col.offset_, rhs + col.offset_);
+          break;
+        default:
+          UNREACHABLE("Cannot compare a key column that is not fixed-width.");
+      }
+      if (res != 0) {
+        return res;
+      }
+    }
+    return 0;
+  }
+
+  /**
+   * Rewrites a raw key into its memcmp-comparable normalized form.
+   * @param raw the key bytes in the raw tuple format
+   * @param[out] out destination of GetLength() normalized bytes
+   */
+  void Normalize(const char *raw, char *out) const;
+
+  /**
+   * Encodes a BIGINT the way Normalize() does.
+   * @param value the integer to encode
+   * @param[out] out destination of 8 normalized bytes
+   */
+  static void NormalizeBigint(int64_t value, char *out);
+
+  /**
+   * Decodes a column produced by Normalize() back into the raw tuple format.
+   * @param type the type of the column
+   * @param size the size of the column in bytes
+   * @param in the normalized bytes of the column
+   * @param[out] out destination of size raw bytes
+   */
+  static void DenormalizeColumn(TypeId type, uint32_t size, const char *in, char *out);
+
+  /**
+   * Decodes a BIGINT produced by NormalizeBigint().
+   * @param in 8 normalized bytes
+   * @return the decoded integer
+   */
+  static int64_t DenormalizeBigint(const char *in);
+
+ private:
+  template <typename T>
+  static inline int CompareAs(const char *lhs, const char *rhs) {
+    T l;
+    T r;
+    memcpy(&l, lhs, sizeof(T));
+    memcpy(&r, rhs, sizeof(T));
+    return (l > r) - (l < r);
+  }
+
+  /** A fixed-width key column. */
+  struct KeyColumn {
+    TypeId type_;
+    uint32_t offset_;
+    uint32_t size_;
+  };
+
+  std::vector<KeyColumn> columns_;
+  bool fixed_width_{true};
+  uint32_t length_{0};
+};
+
+}  // namespace bustub
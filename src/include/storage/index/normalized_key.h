@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// normalized_key.h
+//
+// Identification: src/include/storage/index/normalized_key.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+#include <type_traits>
+
+#include "storage/index/key_layout.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * Normalized key is a fixed length key whose bytes order the same way as the key they encode.
+ *
+ * Unlike GenericKey, which keeps the key in the raw tuple format, the data is rewritten by KeyLayout::Normalize() so
+ * that the comparator needs neither the key schema nor any per-column dispatch. Only keys made of fixed-width
+ * columns can be normalized, and BPlusTreeIndex stores no included columns in them.
+ */
+template <size_t KeySize>
+class NormalizedKey {
+ public:
+  inline void SetFromKey(const Tuple &tuple, const KeyLayout &layout) {
+    BUSTUB_ASSERT(layout.GetLength() <= KeySize, "Key does not fit.");
+    // intialize to 0, the padding then compares equal
+    memset(data_, 0, KeySize);
+    layout.Normalize(tuple.GetData(), data_);
+  }
+
+  inline Value ToValue(Schema *schema, uint32_t column_idx) const {
+    const auto &col = schema->GetColumn(column_idx);
+    BUSTUB_ASSERT(col.IsInlined(), "Normalized keys have no variable-length columns.");
+    char raw[sizeof(int64_t)];
+    KeyLayout::DenormalizeColumn(col.GetType(), col.GetFixedLength(), data_ + col.GetOffset(), raw);
+    return Value::DeserializeFrom(raw, col.GetType());
+  }
+
+  // NOTE: for test purpose only
+  // encodes a single BIGINT column
+  inline void SetFromInteger(int64_t key) {
+    memset(data_, 0, KeySize);
+    KeyLayout::NormalizeBigint(key, data_);
+  }
+
+  // NOTE: for test purpose only
+  // decode the first 8 bytes as a BIGINT column
+  inline int64_t ToString() const { return KeyLayout::DenormalizeBigint(data_); }
+
+  // NOTE: for test purpose only
+  // decode the first 8 bytes as a BIGINT column
+  friend std::ostream &operator<<(std::ostream &os, const NormalizedKey &key) {
+    os << key.ToString();
+    return os;
+  }
+
+  // actual location of data, extends past the end.
+  char data_[KeySize];
+};
+
+/**
+ * Function object return is > 0 if lhs > rhs, < 0 if lhs < rhs, = 0 if lhs = rhs .
+ *
+ * 8 byte keys, e.g. a single BIGINT, are compared as one big-endian integer; wider keys with a single memcmp.
+ */
+template <size_t KeySize>
+class NormalizedComparator {
+ public:
+  NormalizedComparator() = default;
+
+  // the normalized bytes order on their own, the key schema is not needed
+  explicit NormalizedComparator(Schema * /*key_schema*/) {}
+
+  // the keys are big-endian, so they are never searched as an int64_t array
+  inline bool IsInteger() const { return false; }
+
+  inline int operator()(const NormalizedKey<KeySize> &lhs, const NormalizedKey<KeySize> &rhs) const {
+    if constexpr (KeySize == sizeof(uint64_t)) {
+      uint64_t l;
+      uint64_t r;
+      memcpy(&l, lhs.data_, sizeof(uint64_t));
+      memcpy(&r, rhs.data_, sizeof(uint64_t));
+      l = __builtin_bswap64(l);
+      r = __builtin_bswap64(r);
+      return (l > r) - (l < r);
+    }
+    return memcmp(lhs.data_, rhs.data_, KeySize);
+  }
+};
+
+/** IsNormalizedKey<KeyType>::value is true if the index key type is a NormalizedKey. */
+template <typename KeyType>
+struct IsNormalizedKey : std::false_type {};
+
+template <size_t KeySize>
+struct IsNormalizedKey<NormalizedKey<KeySize>> : std::true_type {};
+
+}  // namespace bustub
@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// posting_list.h
+//
+// Identification: src/include/storage/index/posting_list.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rid.h"
+#include "storage/page/b_plus_tree_posting_page.h"
+
+namespace bustub {
+
+/**
+ * PostingList manages the RIDs of a key in a non-unique B+ tree.
+ *
+ * The leaf entry of a key holds its RID inline as long as there is just one. Once a second RID arrives, the RIDs move
+ * to a small list in a slot of a shared posting page, which packs the lists of many keys. A list that outgrows its
+ * slot moves on to a chain of posting pages of its own. Either way the leaf entry holds a reference instead of a RID:
+ * the page id of the shared page or of the head of the chain, and a slot number no table page can reach, which is
+ * SMALL_LIST_SLOT plus the slot of a small list or REFERENCE_SLOT for a chain. When the list shrinks back to a single
+ * RID, that RID moves back inline and the slot or the chain is freed.
+ */
+class PostingList {
+ public:
+  /** The slot number that marks a leaf value as a reference to a posting list. */
+  static constexpr uint32_t REFERENCE_SLOT = UINT32_MAX;
+
+  /** The slot number that marks a leaf value as a reference to the small list in slot 0 of a shared posting page. */
+  static constexpr uint32_t SMALL_LIST_SLOT = REFERENCE_SLOT - static_cast<uint32_t>(SHARED_POSTING_PAGE_SLOTS);
+
+  /** @return true if the leaf value refers to a posting list instead of being a RID itself */
+  static bool IsReference(const RID &value) { return value.GetSlotNum() >= SMALL_LIST_SLOT; }
+
+  /** @return true if the leaf value refers to a small list in a shared posting page */
+  static bool IsSmallList(const RID &value) { return IsReference(value) && value.GetSlotNum() != REFERENCE_SLOT; }
+
+  /**
+   * Adds a RID to the RIDs of a key.
+   * @param bpm the buffer pool manager of the tree
+   * @param[in,out] value the leaf value of the key, an inline RID or a reference, updated if the list moves
+   * @param rid the RID to add
+   * @param[in,out] shared_page_id the shared posting page to try first for a new small list, or INVALID_PAGE_ID;
+   * set to the page the list went to
+   * @return false if the key already has the RID
+   */
+  static bool Insert(BufferPoolManager *bpm, RID *value, const RID &rid, page_id_t *shared_page_id);
+
+  /**
+   * Removes a RID from a posting list, moving the last remaining RID back inline.
+   * @param bpm the buffer pool manager of the tree
+   * @param[in,out] value the leaf value of the key, which must be a reference; updated if the head page changes
+   * @param rid the RID to remove
+   * @return false if the list does not have the RID
+   */
+  static bool Remove(BufferPoolManager *bpm, RID *value, const RID &rid);
+
+  /**
+   * Stores the RIDs of a key: a small list in a shared posting page if there are a few, a chain of packed posting
+   * pages if there are more.
+   * @param bpm the buffer pool manager of the tree
+   * @param rids the RIDs in strictly ascending order
+   * @param count the number of RIDs, at least 1
+   * @param[in,out] shared_page_id as for Insert
+   * @return the leaf value of the key: the only RID, or a reference to the posting list
+   */
+  static RID Build(BufferPoolManager *bpm, const RID *rids, int count, page_id_t *shared_page_id);
+
+  /**
+   * Appends every RID of a posting list to result, in ascending order.
+   * @param bpm the buffer pool manager of the tree
+   * @param value the leaf value of the key, which must be a reference
+   * @param[out] result the vector the RIDs are appended to
+   */
+  static void Read(BufferPoolManager *bpm, const RID &value, std::vector<RID> *result);
+
+  /** @return true if the shared posting page has a free slot for a small list */
+  static bool HasFreeSlot(BufferPoolManager *bpm, page_id_t shared_page_id);
+
+  /** Frees every page of a posting list, or the slot of a small list. */
+  static void Destroy(BufferPoolManager *bpm, const RID &value);
+
+  /**
+   * Fetches a posting page, throwing an "out of memory" exception if the buffer pool is exhausted.
+   * @return the pinned page
+   */
+  static BPlusTreePostingPage *FetchPostingPage(BufferPoolManager *bpm, page_id_t page_id);
+
+ private:
+  static RID MakeReference(page_id_t head_page_id) { return RID(head_page_id, REFERENCE_SLOT); }
+
+  static RID MakeSmallList(page_id_t page_id, int slot) { return RID(page_id, SMALL_LIST_SLOT + slot); }
+
+  static int SlotOf(const RID &value) { return static_cast<int>(value.GetSlotNum() - SMALL_LIST_SLOT); }
+
+  static BPlusTreePostingPage *NewPostingPage(BufferPoolManager *bpm);
+
+  static BPlusTreeSharedPostingPage *FetchSharedPage(BufferPoolManager *bpm, page_id_t page_id);
+
+  /** Stores RIDs as a small list, on the given shared page if it has a free slot and on a new one otherwise. */
+  static RID BuildSmallList(BufferPoolManager *bpm, const RID *rids, int count, page_id_t *shared_page_id);
+
+  /** Stores RIDs in a new chain of posting pages. */
+  static RID BuildChain(BufferPoolManager *bpm, const RID *rids, int count);
+
+  /** Frees the slot of a small list, and its shared page once no list is left on it. */
+  static void FreeSmallList(BufferPoolManager *bpm, const RID &value);
+
+  /** Insert and Remove for a small list. */
+  static bool InsertIntoSmallList(BufferPoolManager *bpm, RID *value, const RID &rid);
+  static bool RemoveFromSmallList(BufferPoolManager *bpm, RID *value, const RID &rid);
+
+  /** @return the first page of the chain whose last RID is >= rid, or the tail if there is none; returned pinned */
+  static BPlusTreePostingPage *FindPage(BufferPoolManager *bpm, BPlusTreePostingPage *head, const RID &rid);
+};
+
+}  // namespace bustub
@@ -28,9 +28,11 @@ namespace bustub {
  * should ignore the first key.
  *
  * Internal page format (keys are stored in increasing order):
- *  --------------------------------------------------------------------------
- * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
- *  --------------------------------------------------------------------------
+ *  ----------------------------------------------------------------------------
+ * | HEADER | KEY(1) | KEY(2) | ... | KEY(n) | ... | PAGE_ID(1) | ... | PAGE_ID(n) |
+ *  ----------------------------------------------------------------------------
+ * The keys and the child page ids are kept in two arrays of INTERNAL_PAGE_SIZE entries each, so a lookup only touches
+ * the keys. Keys that are a single BIGINT column are searched with vector compares, see IntKeySearch.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
@@ -45,6 +47,7 @@ class BPlusTreeInternalPage : public BPlusTreePage {
 
   ValueType Lookup(const KeyType &key, const KeyComparator &comparator) const;
   void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
+  void PopulateFrom(const MappingType *items, int size);
   int InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
   void Remove(int index);
   ValueType RemoveAndReturnOnlyChild();
@@ -52,15 +55,25 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   // Split and Merge utility methods
   void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key, BufferPoolManager *buffer_pool_manager);
   void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
+  void MoveTailTo(BPlusTreeInternalPage *recipient, int keep, BufferPoolManager *buffer_pool_manager);
   void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                         BufferPoolManager *buffer_pool_manager);
   void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                          BufferPoolManager *buffer_pool_manager);
 
  private:
-  void CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
+  KeyType *Keys() { return reinterpret_cast<KeyType *>(data_); }
+  const KeyType *Keys() const { return reinterpret_cast<const KeyType *>(data_); }
+  ValueType *Values() { return reinterpret_cast<ValueType *>(data_ + INTERNAL_PAGE_SIZE * sizeof(KeyType)); }
+  const ValueType *Values() const {
+    return reinterpret_cast<const ValueType *>(data_ + INTERNAL_PAGE_SIZE * sizeof(KeyType));
+  }
+  void CopyNFrom(const KeyType *keys, const ValueType *values, int size, BufferPoolManager *buffer_pool_manager);
   void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
   void CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
-  MappingType array[0];
+  void Adopt(const ValueType &child, BufferPoolManager *buffer_pool_manager);
+  /** Moves the entries from index on by amount places, in both arrays; the size is left as it is. */
+  void ShiftFrom(int index, int amount);
+  char data_[0];
 };
 }  // namespace bustub
@@ -18,26 +18,32 @@
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
+#define LEAF_PAGE_HEADER_SIZE 32
 #define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
- * page. Only support unique key.
+ * page. Keys are unique within the leaves; a non-unique tree keeps the RIDs of
+ * a repeated key in a posting list that the entry refers to.
  *
  * Leaf page format (keys are stored in order):
- *  ----------------------------------------------------------------------
- * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
- *  ----------------------------------------------------------------------
+ *  ----------------------------------------------------------------------------
+ * | HEADER | KEY(1) | KEY(2) | ... | KEY(n) | ... | RID(1) | RID(2) | ... | RID(n)
+ *  ----------------------------------------------------------------------------
  *
- *  Header format (size in byte, 28 bytes in total):
+ * The keys and the RIDs are kept in two arrays of LEAF_PAGE_SIZE entries each, so a search only touches the keys.
+ * Keys that are a single BIGINT column are searched as an int64_t array with vector compares, see IntKeySearch.
+ *
+ *  Header format (size in byte, 32 bytes in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  -----------------------------------------------
- * | ParentPageId (4) | PageId (4) | NextPageId (4)
- *  -----------------------------------------------
+ *  ----------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | PrevPageId (4)
+ *  ----------------------------------------------------------------
+ *
+ * The leaves form a doubly linked list in key order, so range scans can walk it in either direction.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
@@ -48,26 +54,40 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   // helper methods
   page_id_t GetNextPageId() const;
   void SetNextPageId(page_id_t next_page_id);
+  page_id_t GetPrevPageId() const;
+  void SetPrevPageId(page_id_t prev_page_id);
   KeyType KeyAt(int index) const;
   int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
-  const MappingType &GetItem(int index);
+  MappingType GetItem(int index) const;
+  void SetValueAt(int index, const ValueType &value);
 
   // insert and delete methods
   int Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
+  void PopulateFrom(const MappingType *items, int size);
   bool Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const;
   int RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator);
 
   // Split and Merge utility methods
   void MoveHalfTo(BPlusTreeLeafPage *recipient);
+  void MoveTailTo(BPlusTreeLeafPage *recipient, int keep);
   void MoveAllTo(BPlusTreeLeafPage *recipient);
   void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
 
  private:
-  void CopyNFrom(MappingType *items, int size);
+  KeyType *Keys() { return reinterpret_cast<KeyType *>(data_); }
+  const KeyType *Keys() const { return reinterpret_cast<const KeyType *>(data_); }
+  ValueType *Values() { return reinterpret_cast<ValueType *>(data_ + LEAF_PAGE_SIZE * sizeof(KeyType)); }
+  const ValueType *Values() const {
+    return reinterpret_cast<const ValueType *>(data_ + LEAF_PAGE_SIZE * sizeof(KeyType));
+  }
+  void CopyNFrom(const KeyType *keys, const ValueType *values, int size);
   void CopyLastFrom(const MappingType &item);
   void CopyFirstFrom(const MappingType &item);
+  /** Moves the entries from index on by amount places, in both arrays; the size is left as it is. */
+  void ShiftFrom(int index, int amount);
   page_id_t next_page_id_;
-  MappingType array[0];
+  page_id_t prev_page_id_;
+  char data_[0];
 };
 }  // namespace bustub
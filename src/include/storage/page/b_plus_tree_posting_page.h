@@ -0,0 +1,164 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_posting_page.h
+//
+// Identification: src/include/storage/page/b_plus_tree_posting_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+#include "common/rid.h"
+
+namespace bustub {
+
+#define POSTING_PAGE_HEADER_SIZE 48
+#define POSTING_PAGE_DATA_SIZE (PAGE_SIZE - POSTING_PAGE_HEADER_SIZE)
+#define SHARED_POSTING_PAGE_HEADER_SIZE 16
+#define SMALL_POSTING_LIST_SIZE 8
+#define SHARED_POSTING_PAGE_SLOTS \
+  ((PAGE_SIZE - SHARED_POSTING_PAGE_HEADER_SIZE) / (sizeof(int64_t) * (SMALL_POSTING_LIST_SIZE + 1)))
+
+/**
+ * Posting list page of a non-unique B+ tree. It stores a sorted run of the RIDs that share one key; a key with more
+ * RIDs than fit in a page owns a chain of posting pages with disjoint, ascending runs.
+ *
+ * The first RID of the run is kept in the header, every following RID is stored as the varint-encoded difference to
+ * its predecessor. RIDs of one table are mostly close together, so most of them take one or two bytes.
+ *
+ * Header format (size in byte, 48 bytes in total):
+ *  ---------------------------------------------------------------------------------------
+ * | PageId (4) | LSN (4) | NextPageId (4) | PrevPageId (4) | TailPageId (4) | Size (4) |
+ *  ---------------------------------------------------------------------------------------
+ *  ---------------------------------------------------------------
+ * | BytesUsed (4) | Padding (4) | FirstRid (8) | LastRid (8) |
+ *  ---------------------------------------------------------------
+ *
+ * TailPageId is only kept up to date on the head page of a chain.
+ */
+class BPlusTreePostingPage {
+ public:
+  // After creating a new posting page from buffer pool, must call initialize method to set default values
+  void Init(page_id_t page_id);
+
+  page_id_t GetPageId() const { return page_id_; }
+  page_id_t GetNextPageId() const { return next_page_id_; }
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+  page_id_t GetPrevPageId() const { return prev_page_id_; }
+  void SetPrevPageId(page_id_t prev_page_id) { prev_page_id_ = prev_page_id; }
+  page_id_t GetTailPageId() const { return tail_page_id_; }
+  void SetTailPageId(page_id_t tail_page_id) { tail_page_id_ = tail_page_id; }
+
+  /** @return the number of RIDs on this page */
+  int GetSize() const { return size_; }
+
+  /** @return the number of bytes the deltas take up */
+  int GetBytesUsed() const { return bytes_used_; }
+
+  /** @return the smallest RID on this page, which must not be empty */
+  RID GetFirst() const { return RID(first_rid_); }
+
+  /** @return the largest RID on this page, which must not be empty */
+  RID GetLast() const { return RID(last_rid_); }
+
+  /**
+   * Appends the RIDs of this page to result, in ascending order.
+   * @param[out] result the vector the RIDs are appended to
+   */
+  void Decode(std::vector<RID> *result) const;
+
+  /**
+   * Replaces the contents of this page with a prefix of the given RIDs, as long a prefix as fits.
+   * @param rids RIDs in strictly ascending order
+   * @param count the number of RIDs
+   * @return the number of RIDs that were stored
+   */
+  int Encode(const RID *rids, int count);
+
+ private:
+  page_id_t page_id_;
+  lsn_t lsn_;
+  page_id_t next_page_id_;
+  page_id_t prev_page_id_;
+  page_id_t tail_page_id_;
+  int32_t size_;
+  int32_t bytes_used_;
+  int32_t padding_;
+  int64_t first_rid_;
+  int64_t last_rid_;
+  uint8_t data_[0];
+};
+
+/**
+ * Shared posting page of a non-unique B+ tree. It packs the small posting lists of many keys, those of at most
+ * SMALL_POSTING_LIST_SIZE RIDs, into fixed-size slots, so that a key with a handful of RIDs does not take a whole
+ * posting page. A list that outgrows its slot moves to a chain of BPlusTreePostingPages.
+ *
+ * Header format (size in byte, 16 bytes in total):
+ *  ------------------------------------------------------
+ * | PageId (4) | LSN (4) | UsedSlots (4) | Padding (4) |
+ *  ------------------------------------------------------
+ *
+ * Slot format (size in byte, 8 * (SMALL_POSTING_LIST_SIZE + 1) in total), the RIDs in ascending order:
+ *  ------------------------------------------------------------------
+ * | Size (4) | Padding (4) | RID(1) (8) | ... | RID(SMALL_POSTING_LIST_SIZE) (8) |
+ *  ------------------------------------------------------------------
+ *
+ * A slot of size 0 is free.
+ */
+class BPlusTreeSharedPostingPage {
+ public:
+  // After creating a new shared posting page from buffer pool, must call initialize method to set default values
+  void Init(page_id_t page_id);
+
+  page_id_t GetPageId() const { return page_id_; }
+
+  /** @return the number of slots that hold a list */
+  int GetUsedSlots() const { return used_slots_; }
+
+  /** @return true if every slot holds a list */
+  bool IsFull() const { return used_slots_ == static_cast<int>(SHARED_POSTING_PAGE_SLOTS); }
+
+  /**
+   * Stores a list in a free slot, which the page must have.
+   * @param rids at most SMALL_POSTING_LIST_SIZE RIDs in strictly ascending order
+   * @param count the number of RIDs, at least 1
+   * @return the slot of the list
+   */
+  int Allocate(const RID *rids, int count);
+
+  /** Frees the slot of a list. */
+  void Free(int slot);
+
+  /** Replaces the list in a used slot, with the same constraints as Allocate. */
+  void Encode(int slot, const RID *rids, int count);
+
+  /**
+   * Appends the RIDs of the list in a slot to result, in ascending order.
+   * @param[out] result the vector the RIDs are appended to
+   */
+  void Decode(int slot, std::vector<RID> *result) const;
+
+ private:
+  struct Slot {
+    int32_t size_;
+    int32_t padding_;
+    int64_t rids_[SMALL_POSTING_LIST_SIZE];
+  };
+
+  page_id_t page_id_;
+  lsn_t lsn_;
+  int32_t used_slots_;
+  int32_t padding_;
+  Slot slots_[0];
+};
+
+}  // namespace bustub
@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_page.h
+//
+// Identification: src/include/storage/page/free_space_map_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * A page of the free space map of a table heap, see FreeSpaceMap. The pages of a map form a singly-linked list.
+ *
+ * Format (size in bytes):
+ *  -------------------------------------------------------------------------------------------------------
+ *  | PageId (4) | LSN (4) | NextPageId (4) | Count (4) | HeapPageId_1 (4) | ... | Category_1 (1) | ... |
+ *  -------------------------------------------------------------------------------------------------------
+ *
+ * Entry i holds the free space category of heap page HeapPageId_i. The categories follow the page ids, so that the
+ * page ids stay aligned.
+ */
+class FreeSpaceMapPage : public Page {
+ public:
+  /** The number of entries that fit in a page. */
+  static constexpr uint32_t CAPACITY = (PAGE_SIZE - 16) / (sizeof(page_id_t) + sizeof(uint8_t));
+
+  /** Initialize an empty free space map page. */
+  void Init(page_id_t page_id) {
+    memcpy(GetData(), &page_id, sizeof(page_id_t));
+    SetLSN(INVALID_LSN);
+    SetNextPageId(INVALID_PAGE_ID);
+    SetCount(0);
+  }
+
+  /** @return the page ID that Init gave this page */
+  page_id_t GetMapPageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
+
+  /** @return the page ID of the next free space map page */
+  page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  /** Set the page id of the next free space map page. */
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  /** @return the number of entries in this page */
+  uint32_t GetCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_COUNT); }
+
+  /** @return the heap page id of entry i */
+  page_id_t GetHeapPageId(uint32_t i) {
+    return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_ENTRIES + i * sizeof(page_id_t));
+  }
+
+  /** @return the free space category of entry i */
+  uint8_t GetCategory(uint32_t i) {
+    return *reinterpret_cast<uint8_t *>(GetData() + OFFSET_ENTRIES + CAPACITY * sizeof(page_id_t) + i);
+  }
+
+  /** Set entry i, growing the page to hold it. */
+  void SetEntry(uint32_t i, page_id_t heap_page_id, uint8_t category) {
+    memcpy(GetData() + OFFSET_ENTRIES + i * sizeof(page_id_t), &heap_page_id, sizeof(page_id_t));
+    memcpy(GetData() + OFFSET_ENTRIES + CAPACITY * sizeof(page_id_t) + i, &category, sizeof(uint8_t));
+    if (i >= GetCount()) {
+      SetCount(i + 1);
+    }
+  }
+
+ private:
+  static_assert(sizeof(page_id_t) == 4);
+
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 8;
+  static constexpr size_t OFFSET_COUNT = 12;
+  static constexpr size_t OFFSET_ENTRIES = 16;
+
+  void SetCount(uint32_t count) { memcpy(GetData() + OFFSET_COUNT, &count, sizeof(uint32_t)); }
+};
+
+}  // namespace bustub
@@ -13,10 +13,13 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <utility>
 #include <vector>
 
 #include "common/config.h"
+#include "concurrency/transaction.h"
+#include "recovery/log_manager.h"
 #include "storage/index/int_comparator.h"
 #include "storage/page/hash_table_page_defs.h"
 
@@ -26,12 +29,19 @@ namespace bustub {
  * non-unique keys.
  *
  * Block page format (keys are stored in order):
- *  ----------------------------------------------------------------
- * | KEY(1) + VALUE(1) | KEY(2) + VALUE(2) | ... | KEY(n) + VALUE(n)
- *  ----------------------------------------------------------------
+ *  -------------------------------------------------------------------------------------------------------
+ * | PageId (4) | LSN (4) | CTRL(1) ... CTRL(n) | PADDING | KEY(1) + VALUE(1) | ... | KEY(n) + VALUE(n)
+ *  -------------------------------------------------------------------------------------------------------
  *
  *  Here '+' means concatenation.
  *
+ * Every slot has a control byte, in the style of Swiss tables: 0 for a slot that has never been occupied, 1 for a
+ * tombstone, 2 for a tombstone whose pair has moved on, and 0x80 plus a 7-bit tag of the key's hash for a pair. A
+ * probe compares the tag against the control bytes of BLOCK_GROUP_SIZE slots at once, with AVX2 or SSE2 when the build
+ * targets them, and only compares the keys of the slots whose tags match.
+ *
+ * While logging is enabled, Insert and Remove log the control byte of the slot before and after, and the image of
+ * its pair, by their offsets in the page, so that recovery can redo and undo them without knowing the key type.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class HashTableBlockPage {
@@ -39,6 +49,20 @@ class HashTableBlockPage {
   // Delete all constructor / destructor to ensure memory safety
   HashTableBlockPage() = delete;
 
+  /** @return the control byte of a pair whose key hashes to hash */
+  static uint8_t TagOf(uint64_t hash) { return static_cast<uint8_t>(0x80 | ((hash >> 25) & 0x7F)); }
+
+  /** @return the page ID of this page */
+  page_id_t GetPageId() const { return page_id_; }
+
+  /**
+   * Sets the page ID of this page, which recovery checks to tell a formatted block page from one that never reached
+   * the disk.
+   *
+   * @param page_id the page id of the block page
+   */
+  void SetPageId(page_id_t page_id) { page_id_ = page_id; }
+
   /**
    * Gets the key at an index in the block.
    *
@@ -57,25 +81,46 @@ class HashTableBlockPage {
 
   /**
    * Attempts to insert a key and value into an index in the block.
-   * The insert is thread safe. It uses compare and swap to claim the index,
-   * and then writes the key and value into the index, and then marks the
-   * index as readable.
+   * It writes the key and value into the index, and then publishes them by
+   * storing the tag of the hash into the control byte of the index.
    *
    * @param bucket_ind index to write the key and value to
    * @param key key to insert
    * @param value value to insert
+   * @param hash the hash of the key
+   * @param txn the transaction the insert belongs to, nullptr if none
+   * @param log_manager the log manager, nullptr if the insert is not to be logged
    * @return If the value is inserted successfully, it returns true. If the
-   * index is marked as occupied before the key and value can be inserted,
-   * Insert returns false.
+   * index already holds a pair, Insert returns false.
    */
-  bool Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value);
+  bool Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value, uint64_t hash,
+              Transaction *txn = nullptr, LogManager *log_manager = nullptr);
 
   /**
    * Removes a key and value at index.
    *
    * @param bucket_ind ind to remove the value
+   * @param txn the transaction the remove belongs to, nullptr if none
+   * @param log_manager the log manager, nullptr if the remove is not to be logged
+   */
+  void Remove(slot_offset_t bucket_ind, Transaction *txn = nullptr, LogManager *log_manager = nullptr);
+
+  /**
+   * Empties an index, as if it had never been occupied. Only for a page that nobody probes meanwhile, and that is not
+   * logged, since probes stop at an empty index.
+   *
+   * @param bucket_ind index to empty
+   */
+  void Clear(slot_offset_t bucket_ind);
+
+  /**
+   * Marks the tombstone at an index as moved, once a migration has moved its removed pair to the new table, so that
+   * recovery restores the pair there rather than here.
+   *
+   * @param bucket_ind index of the tombstone
+   * @param log_manager the log manager, nullptr if the change is not to be logged
    */
-  void Remove(slot_offset_t bucket_ind);
+  void MarkMoved(slot_offset_t bucket_ind, LogManager *log_manager = nullptr);
 
   /**
    * Returns whether or not an index is occupied (key/value pair or tombstone)
@@ -93,11 +138,29 @@ class HashTableBlockPage {
    */
   bool IsReadable(slot_offset_t bucket_ind) const;
 
+  /**
+   * Compares the control bytes of the BLOCK_GROUP_SIZE slots from bucket_ind on at once. The bits for slots past the
+   * end of the block are meaningless.
+   *
+   * @param bucket_ind the first slot of the group
+   * @param hash the hash of the key to look for
+   * @param[out] empty bit i is set if slot bucket_ind + i has never been occupied
+   * @return a mask whose bit i is set if slot bucket_ind + i holds a pair with the same tag as the hash
+   */
+  uint32_t MatchGroup(slot_offset_t bucket_ind, uint64_t hash, uint32_t *empty) const;
+
  private:
-  std::atomic_char occupied_[(BLOCK_ARRAY_SIZE - 1) / 8 + 1];
+  static constexpr uint8_t EMPTY = BLOCK_CTRL_EMPTY;
+  static constexpr uint8_t TOMBSTONE = BLOCK_CTRL_TOMBSTONE;
+  static constexpr uint8_t MOVED = BLOCK_CTRL_MOVED;
+
+  /** Logs the change of the control byte of a slot from old_ctrl to new_ctrl, and stamps the page with its LSN. */
+  void LogSlot(LogRecordType type, slot_offset_t bucket_ind, uint8_t old_ctrl, uint8_t new_ctrl, Transaction *txn,
+               LogManager *log_manager);
 
-  // 0 if tombstone/brand new (never occupied), 1 otherwise.
-  std::atomic_char readable_[(BLOCK_ARRAY_SIZE - 1) / 8 + 1];
+  page_id_t page_id_;
+  lsn_t lsn_;
+  std::atomic<uint8_t> ctrl_[BLOCK_ARRAY_SIZE + BLOCK_GROUP_SIZE];
   MappingType array_[0];
 };
 
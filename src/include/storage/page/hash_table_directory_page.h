@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_page.h
+//
+// Identification: src/include/storage/page/hash_table_directory_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cassert>
+#include <climits>
+#include <cstdlib>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * Directory Page for extendible hash table.
+ *
+ * A key goes to the bucket at the directory slot given by the low global depth bits of its hash. A bucket with local
+ * depth d is shared by the 2^(global depth - d) slots whose low d bits are the same.
+ *
+ * A page holds DIRECTORY_ARRAY_SIZE slots; a larger directory spans as many pages as it needs, each holding the slots
+ * from its index times DIRECTORY_ARRAY_SIZE on. The first page keeps the global depth of the whole directory and the
+ * ids of its pages; those fields of the other pages are left over from the page they were copied from, and unused.
+ *
+ * Directory format (size in byte):
+ * ------------------------------------------------------------------------------------------------------
+ * | PageId (4) | LSN (4) | GlobalDepth (4) | BucketPageIds (4 * 512) | LocalDepths (1 * 512) | ...
+ * ------------------------------------------------------------------------------------------------------
+ * -------------------------------
+ * | DirectoryPageIds (4 * 256)
+ * -------------------------------
+ */
+class HashTableDirectoryPage {
+ public:
+  /** The global depth of a directory that fills its first page. */
+  static constexpr uint32_t PAGE_DEPTH = 9;
+  /** The number of slots of a directory page. */
+  static constexpr uint32_t DIRECTORY_ARRAY_SIZE = 1U << PAGE_DEPTH;
+  /** The number of pages of a directory at its largest. */
+  static constexpr uint32_t MAX_PAGES = 256;
+  /** The global depth the directory can grow to. */
+  static constexpr uint32_t MAX_DEPTH = PAGE_DEPTH + 8;
+  static_assert(MAX_PAGES == 1U << (MAX_DEPTH - PAGE_DEPTH), "The directory pages hold every slot.");
+
+  /**
+   * @return the page ID of this page
+   */
+  page_id_t GetPageId() const;
+
+  /**
+   * Sets the page ID of this page
+   *
+   * @param page_id the page id for the page id field to be set to
+   */
+  void SetPageId(page_id_t page_id);
+
+  /**
+   * @return the lsn of this page
+   */
+  lsn_t GetLSN() const;
+
+  /**
+   * Sets the LSN of this page
+   *
+   * @param lsn the log sequence number for the lsn field to be set to
+   */
+  void SetLSN(lsn_t lsn);
+
+  /**
+   * @return the number of low hash bits that pick a directory slot
+   */
+  uint32_t GetGlobalDepth() const;
+
+  /**
+   * @return the mask of the low global depth bits of a hash
+   */
+  uint32_t GetGlobalDepthMask() const;
+
+  /**
+   * Doubles the directory: the new upper half of the slots points at the same buckets as the lower half. A directory
+   * that fills its pages only counts the new depth; its caller first copies the pages into the new upper half.
+   */
+  void IncrGlobalDepth();
+
+  /**
+   * @return the number of slots of the directory, 2^global depth
+   */
+  uint32_t Size() const;
+
+  /**
+   * @return the number of pages of the directory
+   */
+  uint32_t NumPages() const;
+
+  /**
+   * @return the page id of a page of the directory, by its index; the first page is this one
+   */
+  page_id_t GetDirectoryPageId(uint32_t page_idx) const;
+
+  /**
+   * Records the page of the directory at an index past the first.
+   */
+  void SetDirectoryPageId(uint32_t page_idx, page_id_t directory_page_id);
+
+  /**
+   * @return the page id of the bucket at a slot of this page
+   */
+  page_id_t GetBucketPageId(uint32_t bucket_idx) const;
+
+  /**
+   * Points a slot of this page at a bucket.
+   */
+  void SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id);
+
+  /**
+   * @return the local depth of the bucket at a slot of this page
+   */
+  uint32_t GetLocalDepth(uint32_t bucket_idx) const;
+
+  /**
+   * Sets the local depth of the bucket at a slot of this page.
+   */
+  void SetLocalDepth(uint32_t bucket_idx, uint32_t local_depth);
+
+ private:
+  page_id_t page_id_;
+  lsn_t lsn_;
+  uint32_t global_depth_;
+  page_id_t bucket_page_ids_[DIRECTORY_ARRAY_SIZE];
+  uint8_t local_depths_[DIRECTORY_ARRAY_SIZE];
+  page_id_t directory_page_ids_[MAX_PAGES];
+};
+
+static_assert(sizeof(HashTableDirectoryPage) <= PAGE_SIZE, "The hash table directory must fit in a page.");
+
+}  // namespace bustub
@@ -26,13 +26,19 @@ namespace bustub {
  *
  * Header Page for linear probing hash table.
  *
- * Header format (size in byte, 16 bytes in total):
- * -------------------------------------------------------------
- * | LSN (4) | Size (4) | PageId(4) | NextBlockIndex(4)
- * -------------------------------------------------------------
+ * Header format (size in byte, 28 bytes in total):
+ * ----------------------------------------------------------------------------
+ * | PageId (4) | LSN (4) | Size (8) | NextBlockIndex (8) | OldPageId (4)
+ * ----------------------------------------------------------------------------
+ *
+ * The page id and the LSN come first, as in every page that the log refers to, see Page::GetLSN. OldPageId is the
+ * header page of the smaller table that a resize is still migrating pairs from, if any.
  */
 class HashTableHeaderPage {
  public:
+  /** The number of block page ids that fit in the header page. */
+  static constexpr size_t MAX_BLOCKS = (PAGE_SIZE - 32) / sizeof(page_id_t);
+
   /**
    * @return the number of buckets in the hash table;
    */
@@ -69,6 +75,18 @@ class HashTableHeaderPage {
    */
   void SetLSN(lsn_t lsn);
 
+  /**
+   * @return the header page of the table that this one is migrating pairs from, INVALID_PAGE_ID if none
+   */
+  page_id_t GetOldPageId() const;
+
+  /**
+   * Sets the header page of the table that this one is migrating pairs from
+   *
+   * @param page_id the header page of the old table, INVALID_PAGE_ID once it is dropped
+   */
+  void SetOldPageId(page_id_t page_id);
+
   /**
    * Adds a block page_id to the end of header page
    *
@@ -90,11 +108,12 @@ class HashTableHeaderPage {
   size_t NumBlocks();
 
  private:
-  __attribute__((unused)) lsn_t lsn_;
-  __attribute__((unused)) size_t size_;
-  __attribute__((unused)) page_id_t page_id_;
-  __attribute__((unused)) size_t next_ind_;
-  __attribute__((unused)) page_id_t block_page_ids_[0];
+  page_id_t page_id_;
+  lsn_t lsn_;
+  size_t size_;
+  size_t next_ind_;
+  page_id_t old_page_id_;
+  page_id_t block_page_ids_[0];
 };
 
 }  // namespace bustub
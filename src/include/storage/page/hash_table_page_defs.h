@@ -14,11 +14,22 @@
 
 #define MappingType std::pair<KeyType, ValueType>
 
-/** BLOCK_ARRAY_SIZE is the number of (key, value) pairs that can be stored in   * a block page. It is an approximate
- * calculation based on the size of MappingType (which is a std::pair of KeyType and ValueType). For each key/value
- * pair, we need two additional bits for occupied_ and readable_. 4 * PAGE_SIZE / (4 * sizeof (MappingType) + 1) =
- * PAGE_SIZE/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required to maintain the occupied
- * and readable flags for a key value pair.*/
-#define BLOCK_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+/** BLOCK_GROUP_SIZE is the number of control bytes that a block page compares at once when it probes. The control
+ * bytes are padded by as many bytes, so that a group starting at any slot stays within them. */
+#define BLOCK_GROUP_SIZE 32
+
+/** BLOCK_ARRAY_SIZE is the number of (key, value) pairs that can be stored in a block page. For each key/value pair we
+ * need one control byte besides the pair itself; the rest of the page holds the page id and the LSN, the padding of
+ * the control bytes and the alignment of the pairs after them. */
+#define BLOCK_ARRAY_SIZE                                                                       \
+  ((PAGE_SIZE - sizeof(page_id_t) - sizeof(lsn_t) - BLOCK_GROUP_SIZE - alignof(MappingType)) / \
+   (sizeof(MappingType) + 1))
+
+/** The control bytes of the slots of a block page that hold no pair: one that has never been occupied, a tombstone, and
+ * a tombstone whose removed pair a migration has moved to the new table. Every other control byte is the tag of a
+ * pair. */
+#define BLOCK_CTRL_EMPTY 0
+#define BLOCK_CTRL_TOMBSTONE 1
+#define BLOCK_CTRL_MOVED 2
 
 #define HASH_TABLE_BLOCK_TYPE HashTableBlockPage<KeyType, ValueType, KeyComparator>
@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// overflow_page.h
+//
+// Identification: src/include/storage/page/overflow_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * A page of a value that is stored out of line, see OverflowStore. The pages of a value form a singly-linked list.
+ *
+ * Format (size in bytes):
+ *  -------------------------------------------------------------------
+ *  | PageId (4) | LSN (4) | NextPageId (4) | Size (4) | Payload ... |
+ *  -------------------------------------------------------------------
+ */
+class OverflowPage : public Page {
+ public:
+  /** The number of payload bytes that fit in a page. */
+  static constexpr uint32_t CAPACITY = PAGE_SIZE - 16;
+
+  /** Initialize an overflow page with the given payload. */
+  void Init(page_id_t page_id, page_id_t next_page_id, const char *payload, uint32_t size) {
+    memcpy(GetData(), &page_id, sizeof(page_id_t));
+    SetLSN(INVALID_LSN);
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+    memcpy(GetData() + OFFSET_SIZE, &size, sizeof(uint32_t));
+    memcpy(GetData() + OFFSET_PAYLOAD, payload, size);
+  }
+
+  /** @return the page ID of the next page of the value */
+  page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  /** @return the number of payload bytes in this page */
+  uint32_t GetSize() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_SIZE); }
+
+  /** @return the payload of this page */
+  const char *GetPayload() { return GetData() + OFFSET_PAYLOAD; }
+
+ private:
+  static_assert(sizeof(page_id_t) == 4);
+
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 8;
+  static constexpr size_t OFFSET_SIZE = 12;
+  static constexpr size_t OFFSET_PAYLOAD = 16;
+};
+
+}  // namespace bustub
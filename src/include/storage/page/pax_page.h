@@ -0,0 +1,152 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pax_page.h
+//
+// Identification: src/include/storage/page/pax_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "catalog/schema.h"
+#include "storage/page/table_page.h"
+
+namespace bustub {
+
+/**
+ * A table page in PAX (partition attributes across) format, for analytical tables, see TableHeap: the fixed-size part
+ * of each column of its tuples is kept apart, in a minipage of its own, so that a scan that reads a few columns reads
+ * them as arrays, see ColumnScan, and skips the bytes of the other columns.
+ *
+ * Format (size in bytes):
+ *  --------------------------------------------------------------------------------------------------------
+ *  | HEADER | SLOTS (8 * Capacity) | MINIPAGE 0 | ... | MINIPAGE n-1 | FREE SPACE | ... TAILS ... | FOOTER |
+ *  --------------------------------------------------------------------------------------------------------
+ *  Footer format (size in bytes):
+ *  ------------------------------------------------------------------------------
+ *  | Width_0 (2) | ... | Width_n-1 (2) | ColumnCount (2) | Capacity (2) |
+ *  ------------------------------------------------------------------------------
+ *
+ * The header and the slots are those of TablePage, and so are the flags of the slots. The columns of the minipages
+ * are the columns of the schema, each as wide as its fixed-size part, and the null bitmap as the last column; minipage
+ * c holds the column c of slot i at i * Width_c. The tail of a tuple, i.e. its bytes after the fixed-size part, which
+ * are the VARCHAR payloads, goes to the tail region, which grows down from the footer as the tuples of a row page do.
+ * The offset of a slot is the offset of its tail, or 0 if the tail is empty, and its size is that of the whole tuple.
+ *
+ * A forward, see TablePage::ForwardTuple, is no tuple of the schema: it is stored in the tail region as a whole, and
+ * its slot keeps its minipage entries unused.
+ *
+ * An insert takes a slot and the room for its tail, so the free space of a page is that of the tail region, plus the
+ * fixed-size part and the slot that every tuple takes anyway, as long as a slot is left.
+ */
+class PaxPage : public TablePage {
+  friend class TablePage;
+
+ public:
+  /** @return the widths of the minipages of a table with the given schema, the null bitmap last */
+  static std::vector<uint16_t> ColumnWidths(const Schema &schema);
+
+  /**
+   * @param widths the widths of the minipages
+   * @param tuple_size the expected size of a tuple
+   * @return the number of slots of a page that tuples of the expected size fill
+   */
+  static uint32_t CapacityFor(const std::vector<uint16_t> &widths, uint32_t tuple_size);
+
+  /** @return the size of the largest tuple that fits in an empty page with the given minipages and capacity */
+  static uint32_t MaxTupleSize(const std::vector<uint16_t> &widths, uint32_t capacity);
+
+  /**
+   * Initialize the PAX page.
+   * @param page_id the page ID of this table page
+   * @param prev_page_id the previous table page ID
+   * @param widths the widths of the minipages, see ColumnWidths
+   * @param capacity the number of slots, see CapacityFor
+   * @param log_manager the log manager in use
+   * @param txn the transaction that this page is created in
+   */
+  void Init(page_id_t page_id, page_id_t prev_page_id, const std::vector<uint16_t> &widths, uint32_t capacity,
+            LogManager *log_manager, Transaction *txn);
+
+  /** @return the number of slots of this page */
+  uint32_t GetCapacity() { return *reinterpret_cast<uint16_t *>(GetData() + PAGE_SIZE - sizeof(uint16_t)); }
+
+  /** @return the number of minipages of this page, which is the number of columns plus one for the null bitmap */
+  uint32_t GetColumnCount() { return *reinterpret_cast<uint16_t *>(GetData() + PAGE_SIZE - 2 * sizeof(uint16_t)); }
+
+  /** @return the width of the entries of minipage c */
+  uint32_t GetColumnWidth(uint32_t c) { return *reinterpret_cast<uint16_t *>(GetData() + OffsetOfWidth(c)); }
+
+  /** @return the size of the fixed-size part of a tuple, which is the sum of the widths */
+  uint32_t GetFixedLength();
+
+  /** @return the entry of slot 0 in minipage c, which the entries of the next slots follow */
+  const char *GetMinipage(uint32_t c);
+
+  /** @return the tail of the tuple at a slot, whose bytes are those of the tuple from GetFixedLength on */
+  const char *GetTail(uint32_t slot_num) { return GetData() + GetTupleOffsetAtSlot(slot_num); }
+
+ private:
+  static constexpr size_t SIZE_FOOTER = 2 * sizeof(uint16_t);
+
+  /** @return the size of the footer of a page with the given number of minipages */
+  static uint32_t FooterSize(uint32_t column_count) { return SIZE_FOOTER + column_count * sizeof(uint16_t); }
+
+  uint32_t OffsetOfWidth(uint32_t c) { return PAGE_SIZE - FooterSize(GetColumnCount()) + c * sizeof(uint16_t); }
+
+  /** @return the offset of the first minipage, right after the slots */
+  uint32_t OffsetOfMinipages() { return OFFSET_TUPLE_OFFSET + SIZE_TUPLE * GetCapacity(); }
+
+  /** @return the offset of the tail region, right after the last minipage */
+  uint32_t OffsetOfTails() { return OffsetOfMinipages() + GetCapacity() * GetFixedLength(); }
+
+  /** @return the number of bytes of a tuple of the given size, flags included, that go to the tail region */
+  uint32_t TailLength(uint32_t tuple_size);
+
+  /** @return the free bytes of the tail region */
+  uint32_t GetTailSpaceRemaining() { return GetFreeSpacePointer() - OffsetOfTails(); }
+
+  /** @return the first empty slot from slot on, which is GetTupleCount if it is below the capacity */
+  uint32_t FindFreeSlot(uint32_t slot);
+
+  /** Copy the fixed-size part of a tuple into the minipages at a slot. */
+  void Scatter(uint32_t slot_num, const char *data);
+
+  /** Copy the minipage entries of a slot into the fixed-size part of a tuple. */
+  void Gather(uint32_t slot_num, char *data);
+
+  /** @return the offset of a new tail with the given bytes, or 0 if there are none */
+  uint32_t PlaceTail(const char *data, uint32_t length);
+
+  /** Give the tail of the tuple at a slot back to the free space, moving the tails that were placed after it. */
+  void RemoveTail(uint32_t slot_num);
+
+  /** @see TablePage::PlaceTuple */
+  bool PlaceTuple(const Tuple &tuple, uint32_t flags, RID *rid, uint32_t *slot);
+
+  /** @see TablePage::HasRoomFor */
+  bool HasRoomFor(uint32_t slot_num, uint32_t tuple_size);
+
+  /** @see TablePage::CopyTuple */
+  void CopyTuple(uint32_t slot_num, Tuple *tuple);
+
+  /** @see TablePage::ReplaceTuple */
+  void ReplaceTuple(uint32_t slot_num, const Tuple &new_tuple, uint32_t flags);
+
+  /** @see TablePage::RemoveTuple */
+  void RemoveTuple(uint32_t slot_num);
+
+  /** @see TablePage::GetFreeSpace */
+  uint32_t GetFreeSpace();
+
+  /** @see TablePage::GetUsedSpace */
+  uint32_t GetUsedSpace();
+};
+
+}  // namespace bustub
@@ -13,6 +13,7 @@
 #pragma once
 
 #include <cstring>
+#include <vector>
 
 #include "common/rid.h"
 #include "concurrency/lock_manager.h"
@@ -24,6 +25,8 @@ static constexpr uint64_t DELETE_MASK = (1U << (8 * sizeof(uint32_t) - 1));
 
 namespace bustub {
 
+class PaxPage;
+
 /**
  * Slotted page format:
  *  ---------------------------------------------------------
@@ -36,12 +39,21 @@ namespace bustub {
  *  ----------------------------------------------------------------------------
  *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(4) |
  *  ----------------------------------------------------------------------------
- *  ----------------------------------------------------------------
- *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
- *  ----------------------------------------------------------------
+ *  ----------------------------------------------------------------------------------------
+ *  | TupleCount (4) | FreeSpaceMapPageId (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
+ *  ----------------------------------------------------------------------------------------
+ *
+ *  Only the first page of a table heap sets FreeSpaceMapPageId, to the first page of the free space map of the heap.
+ *
+ *  Besides the deleted flag, the top bits of a tuple size flag a tuple that has outgrown its page. Its slot keeps its
+ *  RID but holds the RID of a moved copy in another page, see ForwardTuple. The moved copy is skipped by scans.
  *
+ *  The top bit of FreeSpacePointer flags a page of a PAX table, which keeps the header and the slots, but not the
+ *  tuples, in this format, see PaxPage. The methods that move tuple data around hand such a page over to PaxPage.
  */
 class TablePage : public Page {
+  friend class PaxPage;
+
  public:
   /**
    * Initialize the TablePage header.
@@ -72,6 +84,26 @@ class TablePage : public Page {
     memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
   }
 
+  /** @return the page ID of the first free space map page of the table heap, if this is its first page */
+  page_id_t GetFreeSpaceMapPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_FREE_SPACE_MAP); }
+
+  /** Set the page id of the first free space map page of the table heap. */
+  void SetFreeSpaceMapPageId(page_id_t page_id) {
+    memcpy(GetData() + OFFSET_FREE_SPACE_MAP, &page_id, sizeof(page_id_t));
+  }
+
+  /** @return the number of free bytes in this page, out of which an insert takes SpaceFor(tuple size) */
+  uint32_t GetFreeSpace();
+
+  /** @return true if this is a page of a PAX table, see PaxPage */
+  bool IsPax() { return (*reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE) & PAX_FLAG) != 0; }
+
+  /** @return the free bytes that a page needs to take a tuple of the given size, including its slot */
+  static uint32_t SpaceFor(uint32_t tuple_size) { return tuple_size + SIZE_TUPLE; }
+
+  /** @return the size of the largest tuple that fits in an empty page */
+  static uint32_t MaxTupleSize() { return PAGE_SIZE - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE; }
+
   /**
    * Insert a tuple into the table.
    * @param tuple tuple to insert
@@ -83,6 +115,20 @@ class TablePage : public Page {
    */
   bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
 
+  /**
+   * Insert as many of a batch of tuples into the table as fit, under a single log record.
+   * @param tuples tuples to insert
+   * @param count the number of tuples
+   * @param[out] rids rids of the inserted tuples
+   * @param txn transaction performing the insert
+   * @param lock_manager the lock manager
+   * @param log_manager the log manager
+   * @param is_moved whether the tuples are the moved copies of forwarded tuples, see ForwardTuple
+   * @return the number of tuples inserted, a prefix of the batch
+   */
+  uint32_t InsertTuples(const Tuple *tuples, uint32_t count, RID *rids, Transaction *txn, LockManager *lock_manager,
+                        LogManager *log_manager, bool is_moved = false);
+
   /**
    * Mark a tuple as deleted. This does not actually delete the tuple.
    * @param rid rid of the tuple to mark as deleted
@@ -106,12 +152,51 @@ class TablePage : public Page {
   bool UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID &rid, Transaction *txn,
                    LockManager *lock_manager, LogManager *log_manager);
 
-  /** To be called on commit or abort. Actually perform the delete or rollback an insert. */
-  void ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager);
+  /**
+   * Replace a tuple, or the forward of a tuple, with a forward to its moved copy. The tuple keeps its RID.
+   * @param rid rid of the tuple
+   * @param forward_rid rid of the moved copy
+   * @param[out] old_tuple what the slot held before
+   * @param txn transaction performing the update
+   * @param lock_manager the lock manager
+   * @param log_manager the log manager
+   * @return true if there was room for the forward
+   */
+  bool ForwardTuple(const RID &rid, const RID &forward_rid, Tuple *old_tuple, Transaction *txn,
+                    LockManager *lock_manager, LogManager *log_manager);
+
+  /**
+   * @param rid rid of a tuple
+   * @param[out] forward_rid rid of the moved copy of the tuple
+   * @return true if the tuple has moved to another page, whether it is marked deleted or not
+   */
+  bool GetForwardRid(const RID &rid, RID *forward_rid);
+
+  /**
+   * To be called on commit or abort. Actually perform the delete or rollback an insert.
+   * @param[out] tuple if not null, the tuple that was deleted
+   */
+  void ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager, Tuple *tuple = nullptr);
 
   /** To be called on abort. Rollback a delete, i.e. this reverses a MarkDelete. */
   void RollbackDelete(const RID &rid, Transaction *txn, LogManager *log_manager);
 
+  /**
+   * To be called by recovery, see LogRecovery. Put a tuple back into its slot, as an insert or a delete that is
+   * redone or undone logged it. This takes no locks, and writes no log.
+   * @param slot_num the slot of the tuple, which is empty, or past the last slot
+   * @param tuple the tuple
+   * @param flags the flags of the slot, as the log record has them
+   */
+  void RestoreTuple(uint32_t slot_num, const Tuple &tuple, uint32_t flags);
+
+  /**
+   * To be called by recovery, see RestoreTuple. Replace a tuple with the logged value of an update that is redone
+   * or undone.
+   * @return false if the page has no room left for the value
+   */
+  bool RestoreUpdate(uint32_t slot_num, const Tuple &tuple, uint32_t flags);
+
   /**
    * Read a tuple from a table.
    * @param rid rid of the tuple to read
@@ -122,6 +207,31 @@ class TablePage : public Page {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager);
 
+  /**
+   * Take at least a shared lock on each tuple of this page that a scan reads, as GetTuple does for one, see TableScan.
+   * @param txn transaction performing the reads
+   * @param lock_manager the lock manager
+   * @return false if a lock could not be taken
+   */
+  bool LockTuples(Transaction *txn, LockManager *lock_manager);
+
+  /**
+   * Point a tuple at the data of a tuple of this page, without copying it, see TableScan. The page must not be a PAX
+   * page, whose tuples are not stored in one piece.
+   * @param rid rid of a tuple that GetFirstTupleRid or GetNextTupleRid returned
+   * @param[out] tuple a tuple that does not own its data, which is valid as long as this page does not change
+   */
+  void ViewTuple(const RID &rid, Tuple *tuple);
+
+  /** @return the bytes that the tuples of this page take with their slots, leaving out the empty slots */
+  uint32_t GetUsedSpace();
+
+  /**
+   * @return true if a tuple of this page is marked deleted, by a transaction that has not ended yet, or forwarded, or
+   * the moved copy of a forwarded tuple
+   */
+  bool HasPinnedTuples();
+
   /** @return the rid of the first tuple in this page */
 
   /**
@@ -140,20 +250,36 @@ class TablePage : public Page {
  private:
   static_assert(sizeof(page_id_t) == 4);
 
-  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
+  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 28;
   static constexpr size_t SIZE_TUPLE = 8;
+  static constexpr uint32_t FORWARD_FLAG = 1U << 30;
+  static constexpr uint32_t MOVED_FLAG = 1U << 29;
+  static constexpr uint32_t PAX_FLAG = 1U << 31;
   static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
   static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
   static constexpr size_t OFFSET_FREE_SPACE = 16;
   static constexpr size_t OFFSET_TUPLE_COUNT = 20;
-  static constexpr size_t OFFSET_TUPLE_OFFSET = 24;  // Naming things is hard.
-  static constexpr size_t OFFSET_TUPLE_SIZE = 28;
+  static constexpr size_t OFFSET_FREE_SPACE_MAP = 24;
+  static constexpr size_t OFFSET_TUPLE_OFFSET = 28;  // Naming things is hard.
+  static constexpr size_t OFFSET_TUPLE_SIZE = 32;
+
+  /** Initialize the header, without logging it, see Init. */
+  void InitHeader(page_id_t page_id, uint32_t page_size, page_id_t prev_page_id);
+
+  /**
+   * Log the creation of this page, whose header is initialized.
+   * @param pax_widths the widths of the minipages of a PAX page, see PaxPage::Init, or none for a row page
+   * @param pax_capacity the number of slots of a PAX page
+   */
+  void LogNewPage(LogManager *log_manager, Transaction *txn, std::vector<uint16_t> pax_widths = {},
+                  uint32_t pax_capacity = 0);
 
   /** @return pointer to the end of the current free space, see header comment */
-  uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
+  uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE) & ~PAX_FLAG; }
 
-  /** Sets the pointer, this should be the end of the current free space. */
+  /** Sets the pointer, this should be the end of the current free space. The PAX flag stays as it is. */
   void SetFreeSpacePointer(uint32_t free_space_pointer) {
+    free_space_pointer |= *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE) & PAX_FLAG;
     memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
   }
 
@@ -166,6 +292,38 @@ class TablePage : public Page {
   /** Set the number of tuples in this page. */
   void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
 
+  /**
+   * Copy a tuple into the page, reusing an empty slot if there is one.
+   * @param tuple tuple to insert
+   * @param flags the flags of the slot
+   * @param[out] rid rid of the inserted tuple
+   * @param[in,out] slot the first slot that may be empty, moved past the slot used
+   * @return true if there was enough space
+   */
+  bool PlaceTuple(const Tuple &tuple, uint32_t flags, RID *rid, uint32_t *slot);
+
+  /**
+   * Update a tuple, see UpdateTuple.
+   * @param is_forward whether the new value is the forward to a moved copy, see ForwardTuple
+   */
+  bool UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID &rid, Transaction *txn,
+                   LockManager *lock_manager, LogManager *log_manager, bool is_forward);
+
+  /** @return true if the tuple at a slot can be replaced with one of the given size, flags included */
+  bool HasRoomFor(uint32_t slot_num, uint32_t tuple_size);
+
+  /** Copy the tuple at a slot, flags or not, into a tuple that owns its data. */
+  void CopyTuple(uint32_t slot_num, Tuple *tuple);
+
+  /** Replace the tuple at a slot, which HasRoomFor the new one, giving the slot the new flags. */
+  void ReplaceTuple(uint32_t slot_num, const Tuple &new_tuple, uint32_t flags);
+
+  /** Empty a slot, giving the space of its tuple back to the free space. */
+  void RemoveTuple(uint32_t slot_num);
+
+  /** @return this page as a PAX page, see IsPax */
+  PaxPage *AsPax();
+
   uint32_t GetFreeSpaceRemaining() {
     return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
   }
@@ -193,6 +351,19 @@ class TablePage : public Page {
   /** @return true if the tuple is deleted or empty */
   static bool IsDeleted(uint32_t tuple_size) { return static_cast<bool>(tuple_size & DELETE_MASK) || tuple_size == 0; }
 
+  /** @return true if the slot holds the moved copy of a forwarded tuple */
+  static bool IsMoved(uint32_t tuple_size) { return (tuple_size & MOVED_FLAG) != 0; }
+
+  /** @return tuple size without any flags */
+  static uint32_t SizeOf(uint32_t tuple_size) {
+    return tuple_size & ~(static_cast<uint32_t>(DELETE_MASK) | FORWARD_FLAG | MOVED_FLAG);
+  }
+
+  /** @return the flags of a tuple size, which the log records keep, see LogRecord */
+  static uint32_t FlagsOf(uint32_t tuple_size) {
+    return tuple_size & (static_cast<uint32_t>(DELETE_MASK) | FORWARD_FLAG | MOVED_FLAG);
+  }
+
   /** @return tuple size with the deleted flag set */
   static uint32_t SetDeletedFlag(uint32_t tuple_size) { return static_cast<uint32_t>(tuple_size | DELETE_MASK); }
 
@@ -0,0 +1,160 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// column_scan.h
+//
+// Identification: src/include/storage/table/column_scan.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "concurrency/transaction.h"
+#include "storage/page/pax_page.h"
+#include "storage/table/overflow_store.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * ColumnBatch holds some columns of the tuples that a ColumnScan has read, each as an array of its fixed-size part,
+ * one entry per tuple. The entry of a VARCHAR column is the offset of its serialized value in the batch, which GetValue
+ * reads it from. A batch is valid until the next call to the scan that filled it.
+ */
+class ColumnBatch {
+  friend class ColumnScan;
+
+ public:
+  /** @return the number of tuples in the batch */
+  size_t GetSize() const { return rids_.size(); }
+
+  /** @return the RID of a tuple of the batch */
+  const RID &GetRid(size_t row) const { return rids_[row]; }
+
+  /**
+   * @param i the position of a column among the scanned columns
+   * @return the entries of the column, which must be inlined and of type T, e.g. int32_t for an INTEGER
+   */
+  template <typename T>
+  const T *GetArray(size_t i) const {
+    return reinterpret_cast<const T *>(data_[i].data());
+  }
+
+  /** @return true if the column at position i is null in a tuple of the batch */
+  bool IsNull(size_t i, size_t row) const {
+    uint32_t column_idx = column_ids_[i];
+    return ((nulls_[row * bitmap_width_ + column_idx / 8] >> (column_idx % 8)) & 1) != 0;
+  }
+
+  /** @return the position of a column of the table among the scanned columns, or -1 if it was not scanned */
+  int32_t GetPosition(uint32_t column_idx) const { return positions_[column_idx]; }
+
+  /** @return the value of the column at position i in a tuple of the batch */
+  Value GetValue(size_t i, size_t row) const;
+
+  /** Like GetValue, but a VARCHAR value that is stored inline points into the batch instead of being copied. */
+  Value GetValueView(size_t i, size_t row) const;
+
+  /**
+   * Put a tuple of the batch together, as a tuple of the table whose columns that were not scanned are null.
+   * @param row the tuple of the batch
+   * @param[out] tuple the tuple, which owns its data, and knows its RID
+   */
+  void GetTuple(size_t row, Tuple *tuple) const;
+
+ private:
+  /** Set up the batch for the given columns of a table, see ColumnScan. */
+  void Init(const Schema *schema, const std::vector<uint32_t> &column_ids, const OverflowStore *overflow_store);
+
+  void Clear();
+
+  /** Append the scanned columns of a tuple. */
+  void AppendTuple(const Tuple &tuple);
+
+  /** Append the scanned columns of count tuples at consecutive slots of a PAX page, from slot on. */
+  void AppendPax(PaxPage *page, uint32_t slot, uint32_t count);
+
+  /** @return the serialized VARCHAR value at entry row of the column at position i */
+  const char *GetPayload(size_t i, size_t row) const;
+
+  /** @return the size of the serialized VARCHAR value at storage */
+  static uint32_t PayloadSize(const char *storage);
+
+  const Schema *schema_{nullptr};
+  std::vector<uint32_t> column_ids_;
+  /** the position of each column of the table among the scanned columns, see GetPosition */
+  std::vector<int32_t> positions_;
+  const OverflowStore *overflow_store_{nullptr};
+  /** the entries of each scanned column */
+  std::vector<std::vector<char>> data_;
+  /** the null bitmaps of the tuples, as they are in a tuple of the table, bitmap_width_ bytes each */
+  std::vector<char> nulls_;
+  uint32_t bitmap_width_{0};
+  /** the serialized values of the VARCHAR columns */
+  std::vector<char> varlen_;
+  std::vector<RID> rids_;
+  /** the widths of the minipages of a PAX page of the table, and the sums of the widths of the minipages before each */
+  std::vector<uint16_t> pax_widths_;
+  std::vector<uint32_t> pax_offsets_;
+  /** the data of a tuple of the table whose columns are all null, which GetTuple fills in */
+  Tuple null_tuple_;
+};
+
+/**
+ * ColumnScan reads some columns of a TableHeap, a page at a time, into a ColumnBatch. It reads the minipages of the
+ * columns of a PAX page, see PaxPage, as they are, a run of slots at a time, and leaves the other columns unread; it
+ * reads the tuples of a row page one at a time.
+ *
+ * As TableScan does, it locks the tuples of a page and copies them out under the read latch of the page. The moved
+ * copy of a forwarded tuple is read after the other tuples of the page, so that the batch may not be in slot order.
+ */
+class ColumnScan {
+ public:
+  /**
+   * Create a scan of some columns of a table, from its first page on.
+   * @param table_heap the table to scan
+   * @param schema the schema of the table
+   * @param column_ids the columns to read, which GetArray and GetValue of a batch number from 0
+   * @param txn the transaction performing the reads
+   */
+  ColumnScan(TableHeap *table_heap, const Schema *schema, std::vector<uint32_t> column_ids, Transaction *txn)
+      : table_heap_(table_heap),
+        schema_(schema),
+        column_ids_(std::move(column_ids)),
+        txn_(txn),
+        next_page_id_(table_heap->GetFirstPageId()) {}
+
+  /**
+   * Read the tuples of the next pages of the table, until the batch holds BATCH_SIZE tuples or more, or the table ends.
+   * @param[out] batch the scanned columns of the tuples
+   * @return false at the end of the table, or if the tuples could not be read
+   */
+  bool Next(ColumnBatch *batch);
+
+ private:
+  /** the number of tuples that a batch collects before Next returns it, which whole pages may go over */
+  static constexpr size_t BATCH_SIZE = 1024;
+
+  /** Lock the tuples of a page and append them to the batch. */
+  bool ReadPage(page_id_t page_id, ColumnBatch *batch);
+
+  TableHeap *table_heap_;
+  const Schema *schema_;
+  std::vector<uint32_t> column_ids_;
+  Transaction *txn_;
+  /** the page to read next, or INVALID_PAGE_ID at the end of the table */
+  page_id_t next_page_id_;
+  /** the forwarded tuples of the page being read */
+  std::vector<RID> forwarded_;
+  Tuple moved_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.h
+//
+// Identification: src/include/storage/table/free_space_map.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/page/free_space_map_page.h"
+
+namespace bustub {
+
+/**
+ * FreeSpaceMap tracks how much free space the pages of a table heap have, so that an insert goes straight to a page
+ * with room instead of walking the whole heap.
+ *
+ * An inserter claims a page and keeps inserting into it until it is full, see TableHeap::InsertTuple. A claimed page
+ * is not handed out again until it is released, so concurrent inserters do not all converge on the same page.
+ *
+ * Pages are bucketed by free space into NUM_CATEGORIES categories of CATEGORY_SIZE bytes each, rounding down, so a
+ * page is never found for a tuple it cannot take, unless the map is stale. The buckets live in memory; each page's
+ * category is also written through to the free space map pages, but only when it changes category, and without
+ * logging. The map is a hint: callers check the page they are given, and report its real free space back.
+ */
+class FreeSpaceMap {
+ public:
+  static constexpr uint32_t NUM_CATEGORIES = 256;
+  static constexpr uint32_t CATEGORY_SIZE = PAGE_SIZE / NUM_CATEGORIES;
+
+  /**
+   * Create an empty free space map.
+   * @param buffer_pool_manager the buffer pool manager
+   */
+  explicit FreeSpaceMap(BufferPoolManager *buffer_pool_manager);
+
+  /**
+   * Open the free space map stored from the given page on. The map ends before a page that did not reach the disk, and
+   * misses the heap pages that it has not written yet; it starts empty if its first page did not reach the disk.
+   * @param buffer_pool_manager the buffer pool manager
+   * @param first_page_id the id of the first free space map page
+   */
+  FreeSpaceMap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id);
+
+  /** @return the id of the first free space map page */
+  page_id_t GetFirstPageId() const { return page_ids_.front(); }
+
+  /** @return the heap page that was added to the map last, or INVALID_PAGE_ID if the map is empty */
+  page_id_t GetLastHeapPageId();
+
+  /**
+   * Record the free space of a heap page, adding the page to the map if it is not in it yet.
+   * @param heap_page_id the heap page
+   * @param free_space the free bytes in the page
+   */
+  void UpdatePage(page_id_t heap_page_id, uint32_t free_space);
+
+  /**
+   * Claim a heap page with room, which no other claim returns until the page is released.
+   * @param size the free bytes needed
+   * @return a heap page with at least size free bytes, the one with the least such, or INVALID_PAGE_ID if none
+   */
+  page_id_t ClaimPage(uint32_t size);
+
+  /**
+   * Add a new heap page to the map, claimed.
+   * @param heap_page_id the heap page
+   * @param free_space the free bytes in the page
+   */
+  void ClaimNewPage(page_id_t heap_page_id, uint32_t free_space);
+
+  /**
+   * Claim the given heap page, unless it is claimed already.
+   * @param heap_page_id the heap page
+   * @return true iff the page is in the map and was not claimed
+   */
+  bool TryClaimPage(page_id_t heap_page_id);
+
+  /** Release a claimed heap page, so that claims can return it again. */
+  void ReleasePage(page_id_t heap_page_id);
+
+  /** Remove a heap page, claimed or not, from the map, once it is unlinked from the heap. */
+  void RemovePage(page_id_t heap_page_id);
+
+ private:
+  struct Entry {
+    /** the index of the entry across the free space map pages */
+    uint32_t slot_;
+    uint8_t category_;
+    /** whether the page is claimed, and so in no bucket */
+    bool claimed_;
+    /** the position of the page in the bucket of its category */
+    uint32_t position_;
+  };
+
+  static uint8_t CategoryOf(uint32_t free_space) {
+    return static_cast<uint8_t>(std::min(free_space / CATEGORY_SIZE, NUM_CATEGORIES - 1));
+  }
+
+  void AddEntry(page_id_t heap_page_id, uint8_t category, bool claimed);
+  void AddToBucket(page_id_t heap_page_id, Entry *entry);
+  void RemoveFromBucket(const Entry &entry);
+
+  /** Write an entry through to its free space map page, appending a page if it is the first entry of one. */
+  void WriteEntry(const Entry &entry, page_id_t heap_page_id);
+
+  /** End the map that is opened before a page that did not reach the disk, which is its first page if it has none. */
+  void EndAt(page_id_t page_id);
+
+  Page *FetchMapPage(page_id_t page_id);
+
+  BufferPoolManager *buffer_pool_manager_;
+  std::mutex latch_;
+  /** the free space map pages, in list order */
+  std::vector<page_id_t> page_ids_;
+  std::unordered_map<page_id_t, Entry> entries_;
+  /** the slot of the next entry; the slots of removed pages are not reused */
+  uint32_t next_slot_{0};
+  page_id_t last_heap_page_id_{INVALID_PAGE_ID};
+  std::array<std::vector<page_id_t>, NUM_CATEGORIES> buckets_;
+  /** bit c is set iff the bucket of category c is not empty */
+  std::array<uint64_t, NUM_CATEGORIES / 64> non_empty_{};
+};
+
+}  // namespace bustub
@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// overflow_store.h
+//
+// Identification: src/include/storage/table/overflow_store.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/page/overflow_page.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * OverflowStore keeps VARCHAR values out of line, in overflow pages, so that their tuples stay small; see
+ * TableHeap::EnableOverflow. In place of the value, the tuple keeps a pointer to its first page:
+ *
+ *  ------------------------------------------------------------------------
+ *  | EXTERNAL_LENGTH (4) | FirstPageId (4) | Length (4) | StoredLength (4) |
+ *  ------------------------------------------------------------------------
+ *
+ * EXTERNAL_LENGTH takes the place of the length of an inline value, so that a reader tells the two apart. The value
+ * is stored compressed if asked to and if that makes it smaller, i.e. iff StoredLength < Length.
+ *
+ * Each value has pages of its own, written once and never changed, so that they are read without latches. They are
+ * not logged, and are freed along with the version of the tuple that points at them.
+ */
+class OverflowStore {
+ public:
+  /** The length of an inline value that marks a pointer to an out-of-line one instead. */
+  static constexpr uint32_t EXTERNAL_LENGTH = BUSTUB_VALUE_NULL - 1;
+  /** The size of a pointer to an out-of-line value. */
+  static constexpr uint32_t POINTER_SIZE = 16;
+
+  /** @param buffer_pool_manager the buffer pool manager that the overflow pages live in */
+  explicit OverflowStore(BufferPoolManager *buffer_pool_manager) : buffer_pool_manager_(buffer_pool_manager) {}
+
+  /** @return true if the serialized VARCHAR value at storage is a pointer to an out-of-line value */
+  static bool IsPointer(const char *storage) {
+    return *reinterpret_cast<const uint32_t *>(storage) == EXTERNAL_LENGTH;
+  }
+
+  /**
+   * Store a value out of line.
+   * @param data the bytes of the value
+   * @param length the length of the value
+   * @param compress whether to compress the value, if that makes it smaller
+   * @param[out] pointer the POINTER_SIZE bytes of the pointer to the value
+   * @return false if the overflow pages could not be created
+   */
+  bool Store(const char *data, uint32_t length, bool compress, char *pointer);
+
+  /**
+   * Read a value stored out of line.
+   * @param pointer the pointer to the value
+   * @param type_id the type of the value
+   * @return the value
+   */
+  Value Fetch(const char *pointer, TypeId type_id) const;
+
+  /** Free the overflow pages of a value stored out of line. */
+  void Free(const char *pointer);
+
+ private:
+  /**
+   * Compress data with a byte-oriented LZ77. Each token is a control byte c, followed by c + 1 literal bytes if
+   * c < 0x80, or else by the 2-byte distance back to a match of (c & 0x7f) + MIN_MATCH bytes.
+   * @return true if the compressed data is smaller than the data
+   */
+  static bool Compress(const char *data, uint32_t length, std::string *compressed);
+
+  /** @return true if the compressed data decompressed to exactly length bytes */
+  static bool Decompress(const char *compressed, uint32_t size, char *data, uint32_t length);
+
+  static constexpr uint32_t MIN_MATCH = 4;
+
+  BufferPoolManager *buffer_pool_manager_;
+};
+
+}  // namespace bustub
@@ -12,21 +12,50 @@
 
 #pragma once
 
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
+#include "storage/table/free_space_map.h"
+#include "storage/table/overflow_store.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
+/** The page format of a table heap: ROW pages keep each tuple in one piece, PAX pages keep each column apart. */
+enum class TableFormat { ROW, PAX };
+
 /**
  * TableHeap represents a physical table on disk.
  * This is just a doubly-linked list of pages.
+ *
+ * A free space map, whose first page the first table page points at, finds a page with room for an insert. New pages
+ * are only appended when the map has none. Each transaction claims a page of its own from the map and inserts into it
+ * until it is full, so that concurrent inserters do not serialize on the latch of one page.
+ *
+ * Deletes leave pages sparse, and scans still read them; Vacuum merges sparse pages and unlinks the emptied ones.
+ *
+ * Once EnableOverflow gives the heap the schema of its tuples, the largest VARCHAR values of a large tuple go to
+ * overflow pages, see OverflowStore, and the tuple keeps pointers to them. Such a value is only read when its column
+ * is, so that scans of the other columns read few pages, and a tuple may hold values larger than a page.
+ *
+ * A table heap for analytical queries may have PAX pages instead, see PaxPage, whose layout the schema of the table
+ * fixes, so that ColumnScan reads a few columns without the others. Such a table is created with the schema, and its
+ * pages fit as many tuples as take the declared lengths of their VARCHAR columns.
  */
 class TableHeap {
   friend class TableIterator;
 
+  friend class TableScan;
+
+  friend class ColumnScan;
+
  public:
   ~TableHeap() = default;
 
@@ -46,12 +75,23 @@ class TableHeap {
    * @param lock_manager the lock manager
    * @param log_manager the log manager
    * @param txn the creating transaction
+   * @param pax_schema the schema of the tuples, for a table of PAX pages, or nullptr for a table of row pages
    */
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-            Transaction *txn);
+            Transaction *txn, const Schema *pax_schema = nullptr);
+
+  /**
+   * Keep the large VARCHAR values of the tuples of this table out of line from now on. An old value is freed when the
+   * update or delete that replaces it commits, so a reader that holds no lock on a tuple may not read such a value
+   * while a concurrent transaction replaces it.
+   * @param schema the schema of the tuples, which must outlive the table heap
+   * @param compress whether to compress the values stored out of line
+   */
+  void EnableOverflow(const Schema *schema, bool compress = true);
 
   /**
-   * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
+   * Insert a tuple into the table. If the tuple is too large (>= page_size), even with its values stored out of line,
+   * return false.
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
@@ -59,6 +99,23 @@ class TableHeap {
    */
   bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn);
 
+  /**
+   * Insert a batch of tuples into the table, packing as many as fit into each page under a single latch and log
+   * record. If any tuple is too large (>= page_size), nothing is inserted.
+   * @param tuples tuples to insert
+   * @param[out] rids the rids of the inserted tuples, in batch order
+   * @param txn the transaction performing the insert
+   * @return true iff the insert is successful
+   */
+  bool InsertTuples(const std::vector<Tuple> &tuples, std::vector<RID> *rids, Transaction *txn);
+
+  /**
+   * Give up the page claimed for the inserts of a transaction, so that other transactions can insert into it.
+   * Transaction::ReleaseInsertPages does so on Commit/Abort, or when the transaction goes away without either.
+   * @param page_id the claimed page, see Transaction::GetInsertPageSet
+   */
+  void ReleaseInsertPage(page_id_t page_id);
+
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param rid resource id of the tuple of delete
@@ -68,7 +125,8 @@ class TableHeap {
   bool MarkDelete(const RID &rid, Transaction *txn);  // for delete
 
   /**
-   * if the new tuple is too large to fit in the old page, return false (will delete and insert)
+   * Update a tuple in place. If the new tuple is too large to fit in the old page, it moves to another page, and the
+   * old slot forwards to it, so that the RID stays the same.
    * @param tuple new tuple
    * @param rid rid of the old tuple
    * @param txn transaction performing the update
@@ -76,6 +134,20 @@ class TableHeap {
    */
   bool UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn);
 
+  /**
+   * Called on Commit to free the values that an update replaced, see EnableOverflow.
+   * @param old_tuple the old value of the updated tuple
+   */
+  void ApplyUpdate(const Tuple &old_tuple);
+
+  /**
+   * Called on abort to rollback an update.
+   * @param old_tuple the old value of the updated tuple
+   * @param rid rid of the updated tuple
+   * @param txn transaction performing the rollback
+   */
+  void RollbackUpdate(const Tuple &old_tuple, const RID &rid, Transaction *txn);
+
   /**
    * Called on Commit/Abort to actually delete a tuple or rollback an insert.
    * @param rid rid of the tuple to delete
@@ -99,6 +171,23 @@ class TableHeap {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
 
+  /**
+   * Merge the sparse pages of the table: move their tuples into pages with room, and unlink the pages that are left
+   * empty from the table, giving them back to the buffer pool manager.
+   *
+   * Vacuum latches a few pages at a time, and takes the append latch only to read the last page and while it relinks
+   * the neighbours of a page it unlinks, so inserts and reads go on meanwhile. But moving a tuple changes its RID: no
+   * table scan may run concurrently, nor any transaction that has uncommitted writes to the table. Pages with tuples
+   * that are marked deleted or forwarded, see UpdateTuple, and pages claimed for inserts, are left alone.
+   *
+   * @param txn the transaction performing the moves, which locks the old and new RIDs
+   * @param on_move called with each moved tuple, its old RID and its new RID, before the old copy is deleted, e.g. to
+   * move its index entries
+   * @return the number of pages unlinked
+   */
+  size_t Vacuum(Transaction *txn,
+                const std::function<void(const Tuple &tuple, const RID &old_rid, const RID &new_rid)> &on_move);
+
   /** @return the begin iterator of this table */
   TableIterator Begin(Transaction *txn);
 
@@ -108,11 +197,108 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /** @return the page format of this table */
+  inline TableFormat GetFormat() const { return pax_widths_.empty() ? TableFormat::ROW : TableFormat::PAX; }
+
  private:
+  /**
+   * Insert count tuples into the pages claimed for the transaction, see InsertTuple. Moved copies, see MoveTuple, get
+   * no write records, as they go with the tuples that forward to them.
+   */
+  bool InsertTuples(const Tuple *tuples, size_t count, RID *rids, Transaction *txn, bool is_moved = false);
+
+  /**
+   * Update a tuple, see UpdateTuple, without storing its values out of line or adding a write record.
+   * @param[out] old_tuple the old value of the tuple
+   */
+  bool UpdateTuple(const Tuple &tuple, const RID &rid, Tuple *old_tuple, Transaction *txn);
+
+  /**
+   * Store the largest VARCHAR values of a tuple larger than OVERFLOW_TUPLE_SIZE out of line, until it is no larger,
+   * or no value of at least OVERFLOW_VALUE_SIZE bytes is left inline.
+   * @param tuple the tuple to store
+   * @param[out] stored the tuple with pointers in place of the values stored out of line, if any are
+   * @return the tuple to store, tuple or stored, or nullptr if the overflow pages could not be created
+   */
+  const Tuple *StoreOverflow(const Tuple &tuple, Tuple *stored);
+
+  /** Free the values that a tuple stores out of line. */
+  void FreeOverflow(const Tuple &tuple);
+
+  /**
+   * Move a tuple that has outgrown its page to another page, leaving a forward to it in its slot, so that it keeps
+   * its RID and its index entries stay valid.
+   * @param tuple the new value of the tuple
+   * @param rid rid of the tuple
+   * @param forward_rid rid of the moved copy that the tuple forwards to so far, or an invalid RID
+   * @param[out] old_tuple what the slot of the tuple held before
+   * @return true if the tuple moved
+   */
+  bool MoveTuple(const Tuple &tuple, const RID &rid, const RID &forward_rid, Tuple *old_tuple, Transaction *txn);
+
+  /** Update the moved copy of a forwarded tuple, moving it again if it outgrows its page, see MoveTuple. */
+  bool UpdateMovedTuple(const Tuple &tuple, const RID &rid, const RID &forward_rid, Tuple *old_tuple,
+                        Transaction *txn);
+
+  /**
+   * Delete the moved copy of a forwarded tuple.
+   * @param[out] tuple if not null, the deleted copy
+   */
+  void DeleteMovedTuple(const RID &rid, Transaction *txn, Tuple *tuple = nullptr);
+
+  /**
+   * Append a new page to the table, claimed for the inserts of a transaction.
+   * @return the id of the new page, or INVALID_PAGE_ID if it could not be created
+   */
+  page_id_t AppendPage(Transaction *txn);
+
+  /** Initialize a new page of the table, in the format of the table. */
+  void InitPage(TablePage *page, page_id_t page_id, page_id_t prev_page_id, Transaction *txn);
+
+  /**
+   * Move the live tuples of a page claimed by Vacuum into other pages, see Vacuum.
+   * @param[in,out] target the page that the tuples go to, claimed, or INVALID_PAGE_ID to claim one
+   * @param[in,out] spare the sparse pages that may be targets once the map has no page with room
+   * @return true iff the page was emptied and unlinked
+   */
+  bool VacuumPage(page_id_t page_id, page_id_t *target, std::deque<page_id_t> *spare, Transaction *txn,
+                  const std::function<void(const Tuple &tuple, const RID &old_rid, const RID &new_rid)> &on_move);
+
+  /**
+   * Unlink a page, which is neither the first nor the last, from the page list. The page keeps its own links, and its
+   * neighbours are latched after it.
+   * @return false if a neighbour could not be fetched
+   */
+  bool UnlinkPage(TablePage *page);
+
+  /** The used bytes up to which a page is sparse enough to vacuum, see TablePage::GetUsedSpace. */
+  static constexpr uint32_t VACUUM_USED_SPACE = PAGE_SIZE / 2;
+  /** The size above which a tuple stores values out of line, see StoreOverflow. */
+  static constexpr uint32_t OVERFLOW_TUPLE_SIZE = PAGE_SIZE / 4;
+  /** The size from which a value may be stored out of line; a smaller one would not be worth the page it takes. */
+  static constexpr uint32_t OVERFLOW_VALUE_SIZE = PAGE_SIZE / 8;
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  std::shared_ptr<FreeSpaceMap> free_space_map_;
+  OverflowStore overflow_store_;
+  /** the schema of the tuples, if they keep their large values out of line, see EnableOverflow */
+  const Schema *overflow_schema_{nullptr};
+  bool compress_overflow_{true};
+  /** the widths of the minipages of a PAX page, see PaxPage, or empty for a table of row pages */
+  std::vector<uint16_t> pax_widths_;
+  /** the number of slots of a PAX page */
+  uint32_t pax_capacity_{0};
+  /** the size of the largest tuple that fits in an empty page */
+  uint32_t max_tuple_size_{TablePage::MaxTupleSize()};
+  /**
+   * the last page of the table, guarded by append_latch_, which inserts take to append a page after it, and Vacuum
+   * takes to read it and to relink the neighbours of each page it unlinks
+   */
+  page_id_t last_page_id_{};
+  std::mutex append_latch_;
 };
 
 }  // namespace bustub
@@ -13,6 +13,7 @@
 #pragma once
 
 #include <cassert>
+#include <utility>
 
 #include "common/rid.h"
 #include "concurrency/transaction.h"
@@ -34,6 +35,11 @@ class TableIterator {
   TableIterator(const TableIterator &other)
       : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
 
+  TableIterator(TableIterator &&other) noexcept
+      : table_heap_(other.table_heap_), tuple_(other.tuple_), txn_(other.txn_) {
+    other.tuple_ = nullptr;
+  }
+
   ~TableIterator() { delete tuple_; }
 
   inline bool operator==(const TableIterator &itr) const { return tuple_->rid_.Get() == itr.tuple_->rid_.Get(); }
@@ -50,7 +56,19 @@ class TableIterator {
 
   TableIterator &operator=(const TableIterator &other) {
     table_heap_ = other.table_heap_;
-    *tuple_ = *other.tuple_;
+    if (tuple_ == nullptr) {
+      // this iterator was moved from
+      tuple_ = new Tuple(*other.tuple_);
+    } else {
+      *tuple_ = *other.tuple_;
+    }
+    txn_ = other.txn_;
+    return *this;
+  }
+
+  TableIterator &operator=(TableIterator &&other) noexcept {
+    std::swap(tuple_, other.tuple_);
+    table_heap_ = other.table_heap_;
     txn_ = other.txn_;
     return *this;
   }
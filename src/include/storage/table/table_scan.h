@@ -0,0 +1,70 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_scan.h
+//
+// Identification: src/include/storage/table/table_scan.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "concurrency/transaction.h"
+#include "storage/page/table_page.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * TableScan reads a TableHeap a page at a time, and hands out views of its tuples instead of a copy of each, as
+ * TableIterator does.
+ *
+ * Views may not point into the page in the buffer pool: a concurrent transaction may move the tuples of a page around,
+ * e.g. when it commits a delete, and holding the page latch between calls would block the writers of the table, the
+ * caller included. Instead, the scan locks the tuples of a page and copies the page once, under its read latch, and
+ * the views point into that copy. A view is valid until the next call to Next.
+ *
+ * A tuple of a PAX page is not in one piece in the page, so its view points at a copy of it instead; ColumnScan reads
+ * such pages a column at a time.
+ */
+class TableScan {
+ public:
+  /**
+   * Create a scan of a table, from its first page on.
+   * @param table_heap the table to scan
+   * @param txn the transaction performing the reads
+   */
+  TableScan(TableHeap *table_heap, Transaction *txn)
+      : table_heap_(table_heap), txn_(txn), next_page_id_(table_heap->GetFirstPageId()) {}
+
+  /**
+   * Read the next tuple of the table.
+   * @param[out] view a view of the tuple, which knows its RID
+   * @return false at the end of the table, or if the tuple could not be read
+   */
+  bool Next(TupleView *view);
+
+ private:
+  /** Lock the tuples of a page and copy it into page_. */
+  bool ReadPage(page_id_t page_id);
+
+  TableHeap *table_heap_;
+  Transaction *txn_;
+  /** the page to read once page_ has no tuples left, or INVALID_PAGE_ID at the last page */
+  page_id_t next_page_id_;
+  /** the copy of the page being scanned */
+  TablePage page_;
+  bool has_page_{false};
+  /** the RID of the last tuple handed out, invalid if none was from page_ yet */
+  RID rid_;
+  /** the moved copy of a forwarded tuple, which is read from its own page */
+  Tuple moved_;
+  /** the tuple put together from the minipages of a PAX page, see PaxPage */
+  Tuple row_;
+};
+
+}  // namespace bustub
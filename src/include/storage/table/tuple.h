@@ -12,28 +12,49 @@
 
 #pragma once
 
+#include <cstring>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include "catalog/schema.h"
 #include "common/rid.h"
+#include "type/abstract_pool.h"
 #include "type/value.h"
 
 namespace bustub {
 
+class OverflowStore;
+
 /**
  * Tuple format:
- * ---------------------------------------------------------------------
- * | FIXED-SIZE or VARIED-SIZED OFFSET | PAYLOAD OF VARIED-SIZED FIELD |
- * ---------------------------------------------------------------------
+ * ---------------------------------------------------------------------------------
+ * | FIXED-SIZE or VARIED-SIZED OFFSET | NULL BITMAP | PAYLOAD OF VARIED-SIZED FIELD |
+ * ---------------------------------------------------------------------------------
+ *
+ * Bit i of the null bitmap is set iff column i is null. The bitmap follows the fixed-size part of the columns, so that
+ * the column offsets stay those of Schema, and an index key that is copied from a key tuple can leave it out.
+ *
+ * The payload of a VARCHAR field of a tuple in a table heap may be a pointer to the value, stored out of line in
+ * overflow pages, see OverflowStore. GetValue reads such a value from its pages only when it is asked for.
  */
 class Tuple {
   friend class TablePage;
 
+  friend class PaxPage;
+
   friend class TableHeap;
 
   friend class TableIterator;
 
+  friend class TableScan;
+
+  friend class TupleView;
+
+  friend class ColumnBatch;
+
  public:
   // Default constructor (to create a dummy tuple)
   Tuple() = default;
@@ -47,9 +68,15 @@ class Tuple {
   // copy constructor, deep copy
   Tuple(const Tuple &other);
 
+  // move constructor, takes over the data of other
+  Tuple(Tuple &&other) noexcept;
+
   // assign operator, deep copy
   Tuple &operator=(const Tuple &other);
 
+  // move assign operator, takes over the data of other
+  Tuple &operator=(Tuple &&other) noexcept;
+
   ~Tuple() {
     if (allocated_) {
       delete[] data_;
@@ -63,6 +90,9 @@ class Tuple {
   // deserialize tuple data(deep copy)
   void DeserializeFrom(const char *storage);
 
+  // Refill the tuple with the given values, as the constructor does, reusing its data if it is large enough
+  void SetValues(const std::vector<Value> &values, const Schema *schema);
+
   // return RID of current tuple
   inline RID GetRid() const { return rid_; }
 
@@ -73,17 +103,34 @@ class Tuple {
   inline uint32_t GetLength() const { return size_; }
 
   // Get the value of a specified column (const)
-  // checks the schema to see how to return the Value.
+  // checks the schema to see how to return the Value, and reads a value stored out of line from its pages.
   Value GetValue(const Schema *schema, uint32_t column_idx) const;
 
   // Generates a key tuple given schemas and attributes
-  Tuple KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs);
+  Tuple KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs) const;
 
   // Is the column value null ?
   inline bool IsNull(const Schema *schema, uint32_t column_idx) const {
-    Value value = GetValue(schema, column_idx);
-    return value.IsNull();
+    return ((data_[schema->GetNullBitmapOffset() + column_idx / 8] >> (column_idx % 8)) & 1) != 0;
   }
+
+  // Typed reads of a column that is not null, straight from the tuple data. The column must be of the type read:
+  // GetInt8 for BOOLEAN and TINYINT, GetInt64 for BIGINT and TIMESTAMP, GetDouble for DECIMAL.
+  inline int8_t GetInt8(const Schema *schema, uint32_t column_idx) const { return Read<int8_t>(schema, column_idx); }
+  inline int16_t GetInt16(const Schema *schema, uint32_t column_idx) const {
+    return Read<int16_t>(schema, column_idx);
+  }
+  inline int32_t GetInt32(const Schema *schema, uint32_t column_idx) const {
+    return Read<int32_t>(schema, column_idx);
+  }
+  inline int64_t GetInt64(const Schema *schema, uint32_t column_idx) const {
+    return Read<int64_t>(schema, column_idx);
+  }
+  inline double GetDouble(const Schema *schema, uint32_t column_idx) const { return Read<double>(schema, column_idx); }
+
+  // The characters of a VARCHAR column that is not null, without copying them unless they are stored out of line.
+  // The view is valid as long as the tuple is, and holds the same data.
+  std::string_view GetStringView(const Schema *schema, uint32_t column_idx) const;
   inline bool IsAllocated() { return allocated_; }
 
   std::string ToString(const Schema *schema) const;
@@ -92,10 +139,66 @@ class Tuple {
   // Get the starting storage address of specific column
   const char *GetDataPtr(const Schema *schema, uint32_t column_idx) const;
 
+  // Make the data of the tuple an allocated buffer of size bytes, reusing the current one if it is large enough
+  void Reserve(uint32_t size);
+
+  template <typename T>
+  inline T Read(const Schema *schema, uint32_t column_idx) const {
+    T value;
+    memcpy(&value, data_ + schema->GetOffset(column_idx), sizeof(T));
+    return value;
+  }
+
   bool allocated_{false};  // is allocated?
   RID rid_{};              // if pointing to the table heap, the rid is valid
   uint32_t size_{0};
   char *data_{nullptr};
+  // the store of the values that the tuple points at, if it comes from a table heap that keeps values out of line
+  const OverflowStore *overflow_store_{nullptr};
+  // the out-of-line values that GetStringView has read, by their first overflow page
+  mutable std::unique_ptr<std::unordered_map<page_id_t, std::string>> fetched_values_;
+};
+
+/**
+ * TupleView is a tuple that does not own its data, e.g. one that points into the page that a TableScan has read, or
+ * into a tuple that an executor keeps. It reads like the tuple it views, and is valid as long as that data is, which is
+ * until the next call to the scan or executor that handed it out; ToTuple copies it out to keep it.
+ */
+class TupleView {
+  friend class TableScan;
+
+ public:
+  TupleView() = default;
+
+  // a view of a tuple, valid as long as the tuple is and holds the same data
+  explicit TupleView(const Tuple &tuple) { Reset(tuple); }
+
+  TupleView(const TupleView &other) { Reset(other.tuple_); }
+
+  TupleView &operator=(const TupleView &other) {
+    Reset(other.tuple_);
+    return *this;
+  }
+
+  inline const Tuple &operator*() const { return tuple_; }
+
+  inline const Tuple *operator->() const { return &tuple_; }
+
+  // Copy the viewed tuple out, into a tuple that owns its data, or, given a pool, into a tuple whose data lives in the
+  // pool, which frees it
+  Tuple ToTuple(AbstractPool *pool = nullptr) const;
+
+ private:
+  void Reset(const Tuple &tuple) {
+    tuple_.rid_ = tuple.rid_;
+    tuple_.size_ = tuple.size_;
+    tuple_.data_ = tuple.data_;
+    tuple_.overflow_store_ = tuple.overflow_store_;
+    tuple_.fetched_values_.reset();
+  }
+
+  // never allocated, so that copying it copies no data
+  Tuple tuple_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arena_pool.h
+//
+// Identification: src/include/type/arena_pool.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "common/macros.h"
+#include "type/abstract_pool.h"
+
+namespace bustub {
+
+/**
+ * ArenaPool hands out memory by bumping a pointer through large blocks, and frees it all at once, when the pool is
+ * reset or destroyed; Free does nothing. An allocation larger than a quarter of a block gets a block of its own, so
+ * that it does not waste the rest of the current one.
+ *
+ * It suits the memory of one query, see ExecutorContext::GetPool, and is not thread-safe.
+ */
+class ArenaPool : public AbstractPool {
+ public:
+  /** The size of the blocks that small allocations are carved from. */
+  static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+  ArenaPool() = default;
+
+  DISALLOW_COPY_AND_MOVE(ArenaPool);
+
+  ~ArenaPool() override = default;
+
+  /** @return size bytes, aligned for any type, valid until the pool is reset or destroyed */
+  void *Allocate(size_t size) override;
+
+  /** Does nothing: the memory is freed along with the rest of the pool. */
+  void Free(void *ptr) override {}
+
+  /** Free all the memory of the pool at once, keeping its first block for the allocations to come. */
+  void Reset();
+
+  /** @return the bytes allocated from the pool since it was created or reset */
+  size_t GetAllocatedBytes() const { return allocated_bytes_; }
+
+ private:
+  static constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+
+  /** the blocks of BLOCK_SIZE bytes; the last one is the current one */
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  /** the blocks of the large allocations */
+  std::vector<std::unique_ptr<char[]>> large_blocks_;
+  /** the free part of the current block */
+  char *next_{nullptr};
+  size_t remaining_{0};
+  size_t allocated_bytes_{0};
+};
+
+}  // namespace bustub
@@ -13,6 +13,7 @@
 #pragma once
 
 #include <algorithm>
+#include <cstring>
 #include <stdexcept>
 #include <string>
 
@@ -34,8 +35,13 @@ namespace bustub {
 
 class ValueFactory {
  public:
-  static inline Value Clone(const Value &src, __attribute__((__unused__)) AbstractPool *dataPool = nullptr) {
-    return src.Copy();
+  // The data of a VARCHAR copy is copied too, even if src does not manage it; with a pool, it lives in the pool, which
+  // frees it along with the rest of its memory.
+  static inline Value Clone(const Value &src, AbstractPool *dataPool = nullptr) {
+    if (src.GetTypeId() != TypeId::VARCHAR || src.IsNull()) {
+      return src.Copy();
+    }
+    return GetVarcharValue(src.GetData(), src.GetLength(), true, dataPool);
   }
 
   static inline Value GetTinyIntValue(int8_t value) { return Value(TypeId::TINYINT, value); }
@@ -58,19 +64,26 @@ class ValueFactory {
 
   static inline Value GetBooleanValue(int8_t value) { return Value(TypeId::BOOLEAN, value); }
 
-  static inline Value GetVarcharValue(const char *value, bool manage_data,
-                                      __attribute__((__unused__)) AbstractPool *pool = nullptr) {
+  // With a pool, the data is copied into the pool, whatever manage_data says, and the pool frees it.
+  static inline Value GetVarcharValue(const char *value, bool manage_data, AbstractPool *pool = nullptr) {
     auto len = static_cast<uint32_t>(value == nullptr ? 0U : strlen(value) + 1);
-    return GetVarcharValue(value, len, manage_data);
+    return GetVarcharValue(value, len, manage_data, pool);
   }
 
   static inline Value GetVarcharValue(const char *value, uint32_t len, bool manage_data,
-                                      __attribute__((__unused__)) AbstractPool *pool = nullptr) {
+                                      AbstractPool *pool = nullptr) {
+    if (pool != nullptr && value != nullptr) {
+      auto data = static_cast<char *>(pool->Allocate(len));
+      memcpy(data, value, len);
+      return Value(TypeId::VARCHAR, data, len, false);
+    }
     return Value(TypeId::VARCHAR, value, len, manage_data);
   }
 
-  static inline Value GetVarcharValue(const std::string &value,
-                                      __attribute__((__unused__)) AbstractPool *pool = nullptr) {
+  static inline Value GetVarcharValue(const std::string &value, AbstractPool *pool = nullptr) {
+    if (pool != nullptr) {
+      return GetVarcharValue(value.c_str(), static_cast<uint32_t>(value.length() + 1), false, pool);
+    }
     return Value(TypeId::VARCHAR, value);
   }
 
@@ -12,6 +12,9 @@
 
 #include "recovery/log_manager.h"
 
+#include <cstring>
+#include <utility>
+
 namespace bustub {
 /*
  * set enable_logging = true
@@ -22,33 +25,149 @@ namespace bustub {
  *
  * This thread runs forever until system shutdown/StopFlushThread
  */
-void LogManager::RunFlushThread() {}
+void LogManager::RunFlushThread() {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (flush_thread_ != nullptr) {
+    return;
+  }
+  enable_logging = true;
+  stop_flush_thread_ = false;
+  flush_thread_ = new std::thread([this] {
+    std::unique_lock<std::mutex> lock(latch_);
+    while (!stop_flush_thread_) {
+      cv_.wait_for(lock, log_timeout, [this] { return stop_flush_thread_; });
+      FlushBuffer();
+    }
+  });
+}
 
 /*
  * Stop and join the flush thread, set enable_logging = false
  */
-void LogManager::StopFlushThread() {}
+void LogManager::StopFlushThread() {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    if (flush_thread_ == nullptr) {
+      return;
+    }
+    stop_flush_thread_ = true;
+  }
+  cv_.notify_all();
+  flush_thread_->join();
+  delete flush_thread_;
+  flush_thread_ = nullptr;
+  enable_logging = false;
+}
 
 /*
  * append a log record into log buffer
  * you MUST set the log record's lsn within this method
  * @return: lsn that is assigned to this log record
  *
- *
- * example below
- * // First, serialize the must have fields(20 bytes in total)
- * log_record.lsn_ = next_lsn_++;
- * memcpy(log_buffer_ + offset_, &log_record, 20);
- * int pos = offset_ + 20;
- *
- * if (log_record.log_record_type_ == LogRecordType::INSERT) {
- *    memcpy(log_buffer_ + pos, &log_record.insert_rid_, sizeof(RID));
- *    pos += sizeof(RID);
- *    // we have provided serialize function for tuple class
- *    log_record.insert_tuple_.SerializeTo(log_buffer_ + pos);
- *  }
- *
+ * the header is copied as is, the fields that follow it one by one, see log_record.h for the formats
  */
-lsn_t LogManager::AppendLogRecord(LogRecord *log_record) { return INVALID_LSN; }
+lsn_t LogManager::AppendLogRecord(LogRecord *log_record) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (offset_ + log_record->size_ > LOG_BUFFER_SIZE) {
+    FlushBuffer();
+  }
+  log_record->lsn_ = next_lsn_++;
+  char *data = log_buffer_ + offset_;
+  memcpy(data, log_record, LogRecord::HEADER_SIZE);
+  int pos = LogRecord::HEADER_SIZE;
+  auto append = [&](const void *field, size_t size) {
+    memcpy(data + pos, field, size);
+    pos += static_cast<int>(size);
+  };
+
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      append(&log_record->insert_rid_, sizeof(RID));
+      append(&log_record->tuple_flags_, sizeof(uint32_t));
+      log_record->insert_tuple_.SerializeTo(data + pos);
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      append(&log_record->delete_rid_, sizeof(RID));
+      append(&log_record->tuple_flags_, sizeof(uint32_t));
+      log_record->delete_tuple_.SerializeTo(data + pos);
+      break;
+    case LogRecordType::UPDATE:
+      append(&log_record->update_rid_, sizeof(RID));
+      append(&log_record->tuple_flags_, sizeof(uint32_t));
+      append(&log_record->new_flags_, sizeof(uint32_t));
+      log_record->old_tuple_.SerializeTo(data + pos);
+      pos += sizeof(int32_t) + log_record->old_tuple_.GetLength();
+      log_record->new_tuple_.SerializeTo(data + pos);
+      break;
+    case LogRecordType::NEWPAGE: {
+      auto column_count = static_cast<uint32_t>(log_record->pax_widths_.size());
+      append(&log_record->prev_page_id_, sizeof(page_id_t));
+      append(&log_record->page_id_, sizeof(page_id_t));
+      append(&log_record->pax_capacity_, sizeof(uint32_t));
+      append(&column_count, sizeof(uint32_t));
+      append(log_record->pax_widths_.data(), column_count * sizeof(uint16_t));
+      break;
+    }
+    case LogRecordType::HASH_FREETABLE:
+      append(&log_record->prev_page_id_, sizeof(page_id_t));
+      append(&log_record->page_id_, sizeof(page_id_t));
+      break;
+    case LogRecordType::HASH_INSERT:
+    case LogRecordType::HASH_REMOVE: {
+      auto pair_size = static_cast<uint32_t>(log_record->pair_data_.size());
+      append(&log_record->page_id_, sizeof(page_id_t));
+      append(&log_record->ctrl_offset_, sizeof(uint32_t));
+      append(&log_record->pair_offset_, sizeof(uint32_t));
+      append(&pair_size, sizeof(uint32_t));
+      append(&log_record->old_ctrl_, sizeof(uint8_t));
+      append(&log_record->new_ctrl_, sizeof(uint8_t));
+      append(log_record->pair_data_.data(), pair_size);
+      break;
+    }
+    case LogRecordType::HASH_NEWTABLE: {
+      auto num_blocks = static_cast<uint32_t>(log_record->block_page_ids_.size());
+      append(&log_record->page_id_, sizeof(page_id_t));
+      append(&log_record->prev_page_id_, sizeof(page_id_t));
+      append(&log_record->hash_table_size_, sizeof(uint64_t));
+      append(&num_blocks, sizeof(uint32_t));
+      append(log_record->block_page_ids_.data(), num_blocks * sizeof(page_id_t));
+      break;
+    }
+    case LogRecordType::BULKINSERT: {
+      auto count = static_cast<uint32_t>(log_record->insert_tuples_.size());
+      append(&log_record->page_id_, sizeof(page_id_t));
+      append(&log_record->tuple_flags_, sizeof(uint32_t));
+      append(&count, sizeof(uint32_t));
+      for (uint32_t i = 0; i < count; i++) {
+        append(&log_record->insert_slots_[i], sizeof(uint32_t));
+        log_record->insert_tuples_[i].SerializeTo(data + pos);
+        pos += sizeof(int32_t) + log_record->insert_tuples_[i].GetLength();
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  offset_ += log_record->size_;
+  return log_record->lsn_;
+}
+
+void LogManager::Flush() {
+  std::lock_guard<std::mutex> guard(latch_);
+  FlushBuffer();
+}
+
+void LogManager::FlushBuffer() {
+  if (offset_ == 0) {
+    return;
+  }
+  // the disk manager expects the two buffers to take turns
+  std::swap(log_buffer_, flush_buffer_);
+  disk_manager_->WriteLog(flush_buffer_, offset_);
+  offset_ = 0;
+  persistent_lsn_ = next_lsn_ - 1;
+}
 
 }  // namespace bustub
@@ -12,6 +12,13 @@
 
 #include "recovery/log_recovery.h"
 
+#include <cstring>
+#include <queue>
+#include <vector>
+
+#include "common/exception.h"
+#include "storage/page/hash_table_header_page.h"
+#include "storage/page/pax_page.h"
 #include "storage/page/table_page.h"
 
 namespace bustub {
@@ -19,8 +26,107 @@ namespace bustub {
  * deserialize a log record from log buffer
  * @return: true means deserialize succeed, otherwise can't deserialize cause
  * incomplete log record
+ *
+ * data points into the log buffer, whose end bounds the record
  */
-bool LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record) { return false; }
+bool LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record) {
+  const char *end = log_buffer_ + LOG_BUFFER_SIZE;
+  if (end - data < LogRecord::HEADER_SIZE) {
+    return false;
+  }
+  int pos = 0;
+  auto read = [&](void *field, size_t size) {
+    memcpy(field, data + pos, size);
+    pos += static_cast<int>(size);
+  };
+  read(&log_record->size_, sizeof(int32_t));
+  read(&log_record->lsn_, sizeof(lsn_t));
+  read(&log_record->txn_id_, sizeof(txn_id_t));
+  read(&log_record->prev_lsn_, sizeof(lsn_t));
+  read(&log_record->log_record_type_, sizeof(LogRecordType));
+  // the zeros after the end of the log, or a record that the buffer cuts off
+  if (log_record->size_ < LogRecord::HEADER_SIZE || log_record->size_ > end - data ||
+      log_record->log_record_type_ <= LogRecordType::INVALID ||
+      log_record->log_record_type_ > LogRecordType::BULKINSERT) {
+    return false;
+  }
+
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      read(&log_record->insert_rid_, sizeof(RID));
+      read(&log_record->tuple_flags_, sizeof(uint32_t));
+      log_record->insert_tuple_.DeserializeFrom(data + pos);
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      read(&log_record->delete_rid_, sizeof(RID));
+      read(&log_record->tuple_flags_, sizeof(uint32_t));
+      log_record->delete_tuple_.DeserializeFrom(data + pos);
+      break;
+    case LogRecordType::UPDATE:
+      read(&log_record->update_rid_, sizeof(RID));
+      read(&log_record->tuple_flags_, sizeof(uint32_t));
+      read(&log_record->new_flags_, sizeof(uint32_t));
+      log_record->old_tuple_.DeserializeFrom(data + pos);
+      pos += sizeof(int32_t) + log_record->old_tuple_.GetLength();
+      log_record->new_tuple_.DeserializeFrom(data + pos);
+      break;
+    case LogRecordType::NEWPAGE: {
+      uint32_t column_count;
+      read(&log_record->prev_page_id_, sizeof(page_id_t));
+      read(&log_record->page_id_, sizeof(page_id_t));
+      read(&log_record->pax_capacity_, sizeof(uint32_t));
+      read(&column_count, sizeof(uint32_t));
+      log_record->pax_widths_.resize(column_count);
+      read(log_record->pax_widths_.data(), column_count * sizeof(uint16_t));
+      break;
+    }
+    case LogRecordType::HASH_FREETABLE:
+      read(&log_record->prev_page_id_, sizeof(page_id_t));
+      read(&log_record->page_id_, sizeof(page_id_t));
+      break;
+    case LogRecordType::HASH_INSERT:
+    case LogRecordType::HASH_REMOVE: {
+      uint32_t pair_size;
+      read(&log_record->page_id_, sizeof(page_id_t));
+      read(&log_record->ctrl_offset_, sizeof(uint32_t));
+      read(&log_record->pair_offset_, sizeof(uint32_t));
+      read(&pair_size, sizeof(uint32_t));
+      read(&log_record->old_ctrl_, sizeof(uint8_t));
+      read(&log_record->new_ctrl_, sizeof(uint8_t));
+      log_record->pair_data_.assign(data + pos, data + pos + pair_size);
+      break;
+    }
+    case LogRecordType::HASH_NEWTABLE: {
+      uint32_t num_blocks;
+      read(&log_record->page_id_, sizeof(page_id_t));
+      read(&log_record->prev_page_id_, sizeof(page_id_t));
+      read(&log_record->hash_table_size_, sizeof(uint64_t));
+      read(&num_blocks, sizeof(uint32_t));
+      log_record->block_page_ids_.resize(num_blocks);
+      read(log_record->block_page_ids_.data(), num_blocks * sizeof(page_id_t));
+      break;
+    }
+    case LogRecordType::BULKINSERT: {
+      uint32_t count;
+      read(&log_record->page_id_, sizeof(page_id_t));
+      read(&log_record->tuple_flags_, sizeof(uint32_t));
+      read(&count, sizeof(uint32_t));
+      log_record->insert_slots_.resize(count);
+      log_record->insert_tuples_.resize(count);
+      for (uint32_t i = 0; i < count; i++) {
+        read(&log_record->insert_slots_[i], sizeof(uint32_t));
+        log_record->insert_tuples_[i].DeserializeFrom(data + pos);
+        pos += sizeof(int32_t) + log_record->insert_tuples_[i].GetLength();
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  return true;
+}
 
 /*
  *redo phase on TABLE PAGE level(table/table_page.h)
@@ -29,12 +135,321 @@ bool LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record)
  *LSN with log_record's sequence number, and also build active_txn_ table &
  *lsn_mapping_ table
  */
-void LogRecovery::Redo() {}
+void LogRecovery::Redo() {
+  active_txn_.clear();
+  lsn_mapping_.clear();
+  offset_ = 0;
+  lsn_t last_lsn = INVALID_LSN;
+  while (disk_manager_->ReadLog(log_buffer_, LOG_BUFFER_SIZE, offset_)) {
+    int pos = 0;
+    LogRecord log_record;
+    while (DeserializeLogRecord(log_buffer_ + pos, &log_record)) {
+      lsn_mapping_[log_record.lsn_] = offset_ + pos;
+      // the records that belong to no transaction are never undone
+      if (log_record.txn_id_ != INVALID_TXN_ID) {
+        if (log_record.log_record_type_ == LogRecordType::COMMIT ||
+            log_record.log_record_type_ == LogRecordType::ABORT) {
+          active_txn_.erase(log_record.txn_id_);
+        } else {
+          active_txn_[log_record.txn_id_] = log_record.lsn_;
+        }
+      }
+      RedoLogRecord(&log_record);
+      last_lsn = log_record.lsn_;
+      pos += log_record.size_;
+    }
+    // a record torn by the crash ends the log
+    if (pos == 0) {
+      break;
+    }
+    offset_ += pos;
+  }
+  if (log_manager_ != nullptr && last_lsn != INVALID_LSN) {
+    log_manager_->SetNextLSN(last_lsn + 1);
+    log_manager_->SetPersistentLSN(last_lsn);
+  }
+}
 
 /*
  *undo phase on TABLE PAGE level(table/table_page.h)
  *iterate through active txn map and undo each operation
+ *
+ *the records of all the active transactions are undone latest first, each read back from its offset in the log;
+ *each undo is logged as the record that does it, on behalf of the transaction, which then aborts
  */
-void LogRecovery::Undo() {}
+void LogRecovery::Undo() {
+  std::priority_queue<lsn_t> undo_lsns;
+  for (const auto &[txn_id, lsn] : active_txn_) {
+    undo_lsns.push(lsn);
+  }
+  while (!undo_lsns.empty()) {
+    lsn_t lsn = undo_lsns.top();
+    undo_lsns.pop();
+    LogRecord log_record;
+    if (!disk_manager_->ReadLog(log_buffer_, LOG_BUFFER_SIZE, lsn_mapping_[lsn]) ||
+        !DeserializeLogRecord(log_buffer_, &log_record)) {
+      throw Exception("Cannot read back a log record to undo.");
+    }
+    UndoLogRecord(&log_record);
+    if (log_record.prev_lsn_ != INVALID_LSN) {
+      undo_lsns.push(log_record.prev_lsn_);
+    }
+  }
+  if (log_manager_ != nullptr) {
+    for (const auto &[txn_id, lsn] : active_txn_) {
+      LogRecord abort_record(txn_id, lsn, LogRecordType::ABORT);
+      log_manager_->AppendLogRecord(&abort_record);
+    }
+    log_manager_->Flush();
+  }
+  active_txn_.clear();
+}
+
+void LogRecovery::RedoLogRecord(LogRecord *log_record) {
+  switch (log_record->log_record_type_) {
+    case LogRecordType::NEWPAGE: {
+      // a page that never reached the disk reads as zeros, and one that held something else before as that
+      disk_manager_->ReservePage(log_record->page_id_);
+      auto *page = static_cast<TablePage *>(FetchPage(log_record->page_id_));
+      bool redo = page->GetTablePageId() != log_record->page_id_ || page->GetLSN() < log_record->lsn_;
+      if (redo) {
+        memset(page->GetData(), 0, PAGE_SIZE);
+        if (log_record->pax_widths_.empty()) {
+          page->Init(log_record->page_id_, PAGE_SIZE, log_record->prev_page_id_, nullptr, nullptr);
+        } else {
+          static_cast<PaxPage *>(page)->Init(log_record->page_id_, log_record->prev_page_id_, log_record->pax_widths_,
+                                             log_record->pax_capacity_, nullptr, nullptr);
+        }
+        page->SetLSN(log_record->lsn_);
+      }
+      buffer_pool_manager_->UnpinPage(log_record->page_id_, redo);
+      if (log_record->prev_page_id_ != INVALID_PAGE_ID) {
+        auto *prev_page = static_cast<TablePage *>(FetchPage(log_record->prev_page_id_));
+        bool link = prev_page->GetLSN() < log_record->lsn_;
+        if (link) {
+          prev_page->SetNextPageId(log_record->page_id_);
+        }
+        buffer_pool_manager_->UnpinPage(log_record->prev_page_id_, link);
+      }
+      break;
+    }
+    case LogRecordType::INSERT:
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+    case LogRecordType::UPDATE:
+    case LogRecordType::BULKINSERT: {
+      page_id_t page_id = GetTablePageId(log_record);
+      auto *page = static_cast<TablePage *>(FetchPage(page_id));
+      bool redo = page->GetLSN() < log_record->lsn_;
+      if (redo) {
+        ApplyLogRecord(log_record, page);
+        page->SetLSN(log_record->lsn_);
+      }
+      buffer_pool_manager_->UnpinPage(page_id, redo);
+      break;
+    }
+    case LogRecordType::HASH_INSERT:
+    case LogRecordType::HASH_REMOVE: {
+      Page *page = FetchPage(log_record->page_id_);
+      bool redo = page->GetLSN() < log_record->lsn_;
+      if (redo) {
+        memcpy(page->GetData() + log_record->pair_offset_, log_record->pair_data_.data(),
+               log_record->pair_data_.size());
+        page->GetData()[log_record->ctrl_offset_] = static_cast<char>(log_record->new_ctrl_);
+        page->SetLSN(log_record->lsn_);
+      }
+      buffer_pool_manager_->UnpinPage(log_record->page_id_, redo);
+      break;
+    }
+    case LogRecordType::HASH_NEWTABLE: {
+      // pages that never reached the disk read as zeros, and are formatted again
+      disk_manager_->ReservePage(log_record->page_id_);
+      Page *page = FetchPage(log_record->page_id_);
+      auto *header = reinterpret_cast<HashTableHeaderPage *>(page->GetData());
+      bool redo = header->GetPageId() != log_record->page_id_ || header->GetLSN() < log_record->lsn_;
+      if (redo) {
+        memset(page->GetData(), 0, PAGE_SIZE);
+        header->SetPageId(log_record->page_id_);
+        header->SetLSN(log_record->lsn_);
+        header->SetOldPageId(log_record->prev_page_id_);
+        header->SetSize(log_record->hash_table_size_);
+        for (page_id_t block_page_id : log_record->block_page_ids_) {
+          header->AddBlockPageId(block_page_id);
+        }
+      }
+      buffer_pool_manager_->UnpinPage(log_record->page_id_, redo);
+      for (page_id_t block_page_id : log_record->block_page_ids_) {
+        disk_manager_->ReservePage(block_page_id);
+        Page *block_page = FetchPage(block_page_id);
+        page_id_t formatted_page_id;
+        memcpy(&formatted_page_id, block_page->GetData(), sizeof(page_id_t));
+        bool format = formatted_page_id != block_page_id;
+        if (format) {
+          memset(block_page->GetData(), 0, PAGE_SIZE);
+          memcpy(block_page->GetData(), &block_page_id, sizeof(page_id_t));
+          block_page->SetLSN(log_record->lsn_);
+        }
+        buffer_pool_manager_->UnpinPage(block_page_id, format);
+      }
+      break;
+    }
+    case LogRecordType::HASH_FREETABLE: {
+      Page *page = FetchPage(log_record->page_id_);
+      auto *header = reinterpret_cast<HashTableHeaderPage *>(page->GetData());
+      bool redo = header->GetLSN() < log_record->lsn_;
+      if (redo) {
+        header->SetOldPageId(INVALID_PAGE_ID);
+        header->SetLSN(log_record->lsn_);
+      }
+      buffer_pool_manager_->UnpinPage(log_record->page_id_, redo);
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+void LogRecovery::ApplyLogRecord(LogRecord *log_record, TablePage *page) {
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      page->RestoreTuple(log_record->insert_rid_.GetSlotNum(), log_record->insert_tuple_, log_record->tuple_flags_);
+      break;
+    case LogRecordType::BULKINSERT:
+      for (size_t i = 0; i < log_record->insert_slots_.size(); i++) {
+        page->RestoreTuple(log_record->insert_slots_[i], log_record->insert_tuples_[i], log_record->tuple_flags_);
+      }
+      break;
+    case LogRecordType::MARKDELETE:
+      page->MarkDelete(log_record->delete_rid_, nullptr, nullptr, nullptr);
+      break;
+    case LogRecordType::APPLYDELETE:
+      page->ApplyDelete(log_record->delete_rid_, nullptr, nullptr);
+      break;
+    case LogRecordType::ROLLBACKDELETE:
+      page->RollbackDelete(log_record->delete_rid_, nullptr, nullptr);
+      break;
+    case LogRecordType::UPDATE:
+      if (!page->RestoreUpdate(log_record->update_rid_.GetSlotNum(), log_record->new_tuple_, log_record->new_flags_)) {
+        throw Exception("No room left in the page to put the value of an update back.");
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void LogRecovery::UndoTableLogRecord(LogRecord *log_record) {
+  page_id_t page_id = GetTablePageId(log_record);
+  auto *page = static_cast<TablePage *>(FetchPage(page_id));
+  txn_id_t txn_id = log_record->txn_id_;
+  // each undo is the change of a record, which is applied, and logged if there is a log
+  std::vector<LogRecord> undos;
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      undos.emplace_back(txn_id, INVALID_LSN, LogRecordType::APPLYDELETE, log_record->insert_rid_,
+                         log_record->insert_tuple_, log_record->tuple_flags_);
+      break;
+    case LogRecordType::BULKINSERT:
+      for (size_t i = log_record->insert_slots_.size(); i-- > 0;) {
+        undos.emplace_back(txn_id, INVALID_LSN, LogRecordType::APPLYDELETE, RID(page_id, log_record->insert_slots_[i]),
+                           log_record->insert_tuples_[i], log_record->tuple_flags_);
+      }
+      break;
+    case LogRecordType::MARKDELETE:
+      undos.emplace_back(txn_id, INVALID_LSN, LogRecordType::ROLLBACKDELETE, log_record->delete_rid_, Tuple{});
+      break;
+    case LogRecordType::ROLLBACKDELETE:
+      undos.emplace_back(txn_id, INVALID_LSN, LogRecordType::MARKDELETE, log_record->delete_rid_, Tuple{});
+      break;
+    case LogRecordType::APPLYDELETE:
+      undos.emplace_back(txn_id, INVALID_LSN, LogRecordType::INSERT, log_record->delete_rid_,
+                         log_record->delete_tuple_, log_record->tuple_flags_);
+      break;
+    case LogRecordType::UPDATE:
+      undos.emplace_back(txn_id, INVALID_LSN, LogRecordType::UPDATE, log_record->update_rid_, log_record->new_tuple_,
+                         log_record->old_tuple_, log_record->new_flags_, log_record->tuple_flags_);
+      break;
+    default:
+      break;
+  }
+  for (auto &undo : undos) {
+    ApplyLogRecord(&undo, page);
+    LogUndo(&undo, page);
+  }
+  buffer_pool_manager_->UnpinPage(page_id, !undos.empty());
+}
+
+void LogRecovery::LogUndo(LogRecord *undo, Page *page) {
+  if (log_manager_ == nullptr) {
+    return;
+  }
+  undo->prev_lsn_ = active_txn_[undo->txn_id_];
+  lsn_t lsn = log_manager_->AppendLogRecord(undo);
+  active_txn_[undo->txn_id_] = lsn;
+  page->SetLSN(lsn);
+  // the buffer pool does not force the log while recovery keeps logging off, so the page may be written back anytime
+  log_manager_->Flush();
+}
+
+page_id_t LogRecovery::GetTablePageId(LogRecord *log_record) {
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      return log_record->insert_rid_.GetPageId();
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      return log_record->delete_rid_.GetPageId();
+    case LogRecordType::UPDATE:
+      return log_record->update_rid_.GetPageId();
+    default:
+      return log_record->page_id_;
+  }
+}
+
+void LogRecovery::UndoLogRecord(LogRecord *log_record) {
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+    case LogRecordType::UPDATE:
+    case LogRecordType::BULKINSERT:
+      UndoTableLogRecord(log_record);
+      return;
+    case LogRecordType::HASH_INSERT:
+    case LogRecordType::HASH_REMOVE:
+      break;
+    default:
+      return;
+  }
+  Page *page = FetchPage(log_record->page_id_);
+  char *ctrl = page->GetData() + log_record->ctrl_offset_;
+  // only a slot that still holds the pair as the record left it is undone; one that a migration has moved on has
+  // been logged again on behalf of the transaction, in the new table, and is undone there
+  bool undo = static_cast<uint8_t>(*ctrl) == log_record->new_ctrl_ &&
+              memcmp(page->GetData() + log_record->pair_offset_, log_record->pair_data_.data(),
+                     log_record->pair_data_.size()) == 0;
+  if (undo) {
+    // an insert is undone by a tombstone rather than an empty slot, since later inserts may have probed past the pair
+    bool insert = log_record->log_record_type_ == LogRecordType::HASH_INSERT;
+    uint8_t undo_ctrl = insert ? BLOCK_CTRL_TOMBSTONE : log_record->old_ctrl_;
+    LogRecord undo_record(log_record->txn_id_, INVALID_LSN,
+                          insert ? LogRecordType::HASH_REMOVE : LogRecordType::HASH_INSERT, log_record->page_id_,
+                          log_record->ctrl_offset_, log_record->new_ctrl_, undo_ctrl, log_record->pair_offset_,
+                          log_record->pair_data_.data(), log_record->pair_data_.size());
+    *ctrl = static_cast<char>(undo_ctrl);
+    LogUndo(&undo_record, page);
+  }
+  buffer_pool_manager_->UnpinPage(log_record->page_id_, undo);
+}
+
+Page *LogRecovery::FetchPage(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch a page to recover.");
+  }
+  return page;
+}
 
 }  // namespace bustub
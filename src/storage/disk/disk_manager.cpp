@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <sys/stat.h>
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <iostream>
@@ -65,6 +66,8 @@ DiskManager::DiskManager(const std::string &db_file)
       throw Exception("can't open db file");
     }
   }
+  // the pages of an existing file are taken
+  next_page_id_ = (std::max(GetFileSize(db_file), 0) + PAGE_SIZE - 1) / PAGE_SIZE;
   buffer_used = nullptr;
 }
 
@@ -190,6 +193,14 @@ bool DiskManager::ReadLog(char *log_data, int size, int offset) {
  */
 page_id_t DiskManager::AllocatePage() { return next_page_id_++; }
 
+/**
+ * Skip a page id that recovery found in the log
+ */
+void DiskManager::ReservePage(page_id_t page_id) {
+  page_id_t next_page_id = next_page_id_;
+  while (next_page_id <= page_id && !next_page_id_.compare_exchange_weak(next_page_id, page_id + 1)) {
+  }
+}
 /**
  * Deallocate page (operations like drop index/table)
  * Need bitmap in header page for tracking pages
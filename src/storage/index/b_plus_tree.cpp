@@ -9,40 +9,74 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cmath>
 #include <string>
+#include <type_traits>
+#include <utility>
 
 #include "common/exception.h"
 #include "common/rid.h"
+#include "common/util/parallel_util.h"
 #include "storage/index/b_plus_tree.h"
 #include "storage/page/header_page.h"
 
 namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, bool unique_keys,
+                          const BPlusTreeFillFactors &fill_factors, int cached_levels)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      // an internal page holds one extra entry between an insert and the split it triggers
+      internal_max_size_(std::min(internal_max_size, static_cast<int>(INTERNAL_PAGE_SIZE) - 1)),
+      unique_keys_(unique_keys),
+      fill_factors_(fill_factors),
+      cached_levels_(cached_levels),
+      max_cached_pages_(buffer_pool_manager->GetPoolSize() / CACHED_POOL_FRACTION) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_TYPE::~BPlusTree() {
+  std::scoped_lock lock(top_latch_);
+  ReleaseTopLevels();
+}
 
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::IsEmpty() const { return true; }
+bool BPLUSTREE_TYPE::IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID; }
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 /*
- * Return the only value that associated with input key
+ * Return the values that associated with input key, i.e. the only value of a
+ * unique tree or the whole posting list of a non-unique one
  * This method is used for point query
  * @return : true means key exists
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
-  return false;
+  tree_latch_.RLock();
+  if (IsEmpty()) {
+    tree_latch_.RUnlock();
+    return false;
+  }
+  Page *page = FindLeaf(&key);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType value;
+  bool found = leaf->Lookup(key, &value, comparator_);
+  if (found && PostingList::IsReference(value)) {
+    PostingList::Read(buffer_pool_manager_, value, result);
+  } else if (found) {
+    result->push_back(value);
+  }
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  tree_latch_.RUnlock();
+  return found;
 }
 
 /*****************************************************************************
@@ -52,11 +86,21 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  * Insert constant key & value pair into b+ tree
  * if current tree is empty, start new tree, update root page id and insert
  * entry, otherwise insert into leaf page.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * @return: in a unique tree, if user try to insert duplicate keys return false;
+ * in a non-unique tree, only an existing key & value pair is rejected.
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) { return false; }
+bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  tree_latch_.WLock();
+  bool inserted = true;
+  if (IsEmpty()) {
+    StartNewTree(key, value);
+  } else {
+    inserted = InsertIntoLeaf(key, value, transaction);
+  }
+  tree_latch_.WUnlock();
+  return inserted;
+}
 /*
  * Insert constant key & value pair into an empty tree
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
@@ -64,19 +108,98 @@ bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
  * tree's root page id and insert entry directly into leaf page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {}
+void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate a new page for the root.");
+  }
+  auto *root = reinterpret_cast<LeafPage *>(page->GetData());
+  root->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+  root->Insert(key, value, comparator_);
+  root_page_id_ = page_id;
+  UpdateRootPageId(1);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
 
 /*
  * Insert constant key & value pair into leaf page
  * User needs to first find the right leaf page as insertion target, then look
  * through leaf page to see whether insert key exist or not. If exist, return
  * immdiately, otherwise insert entry. Remember to deal with split if necessary.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * A non-unique tree adds the value of an existing key to its posting list.
+ * @return: false if the key (or, in a non-unique tree, the key & value pair)
+ * already exists, otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) {
-  return false;
+  Page *page = FindLeaf(&key);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  if (!unique_keys_) {
+    int index = leaf->KeyIndex(key, comparator_);
+    if (index < leaf->GetSize() && comparator_(leaf->KeyAt(index), key) == 0) {
+      ValueType postings = leaf->GetItem(index).second;
+      page_id_t shared_page_id = FindSharedPostingPage(leaf, index);
+      bool inserted = PostingList::Insert(buffer_pool_manager_, &postings, value, &shared_page_id);
+      leaf->SetValueAt(index, postings);
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), inserted);
+      return inserted;
+    }
+  }
+  int size = leaf->GetSize();
+  if (leaf->Insert(key, value, comparator_) == size) {
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    return false;
+  }
+  if (leaf->GetSize() >= leaf->GetMaxSize()) {
+    // a key past the end of the rightmost leaf, likely the next of a run of ascending keys
+    bool append =
+        leaf->GetNextPageId() == INVALID_PAGE_ID && comparator_(leaf->KeyAt(leaf->GetSize() - 1), key) == 0;
+    LeafPage *new_leaf = Split(leaf, append);
+    // link the new leaf in between leaf and its old right neighbour
+    new_leaf->SetPrevPageId(leaf->GetPageId());
+    new_leaf->SetNextPageId(leaf->GetNextPageId());
+    if (leaf->GetNextPageId() != INVALID_PAGE_ID) {
+      Page *next_page = FetchTreePage(leaf->GetNextPageId());
+      reinterpret_cast<LeafPage *>(next_page->GetData())->SetPrevPageId(new_leaf->GetPageId());
+      buffer_pool_manager_->UnpinPage(next_page->GetPageId(), true);
+    }
+    leaf->SetNextPageId(new_leaf->GetPageId());
+    InsertIntoParent(leaf, new_leaf->KeyAt(0), new_leaf, append, transaction);
+    buffer_pool_manager_->UnpinPage(new_leaf->GetPageId(), true);
+  }
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  return true;
+}
+
+/*
+ * Find a shared posting page with a free slot for a new small list of the key
+ * at index, among the pages of the small lists nearest to it in the leaf, so
+ * that the lists of nearby keys share pages. Only the first few distinct
+ * pages are checked.
+ * @return: the page id, or INVALID_PAGE_ID if none of them has room
+ */
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t BPLUSTREE_TYPE::FindSharedPostingPage(LeafPage *leaf, int index) {
+  int probes = 0;
+  page_id_t last_probed = INVALID_PAGE_ID;
+  for (int distance = 1; distance < leaf->GetSize() && probes < SHARED_PAGE_PROBES; distance++) {
+    for (int neighbor : {index - distance, index + distance}) {
+      if (neighbor < 0 || neighbor >= leaf->GetSize() || !PostingList::IsSmallList(leaf->GetItem(neighbor).second)) {
+        continue;
+      }
+      page_id_t page_id = leaf->GetItem(neighbor).second.GetPageId();
+      if (page_id == last_probed) {
+        continue;
+      }
+      if (PostingList::HasFreeSlot(buffer_pool_manager_, page_id)) {
+        return page_id;
+      }
+      last_probed = page_id;
+      probes++;
+    }
+  }
+  return INVALID_PAGE_ID;
 }
 
 /*
@@ -84,12 +207,50 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
  * Using template N to represent either internal page or leaf page.
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then move half
- * of key & value pairs from input page to newly created page
+ * of key & value pairs from input page to newly created page. A split by an
+ * append past the end of the tree moves only what the fill factor leaves over.
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-N *BPLUSTREE_TYPE::Split(N *node) {
-  return nullptr;
+N *BPLUSTREE_TYPE::Split(N *node, bool append) {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate a new page for the split.");
+  }
+  auto *new_node = reinterpret_cast<N *>(page->GetData());
+  new_node->Init(page_id, node->GetParentPageId(), node->GetMaxSize());
+  if constexpr (std::is_same_v<N, InternalPage>) {
+    // the new page belongs in the cached levels as much as the old one
+    InvalidateTopLevels();
+  }
+  int keep = SplitPoint(node, append);
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    node->MoveTailTo(new_node, keep);
+  } else {
+    node->MoveTailTo(new_node, keep, buffer_pool_manager_);
+  }
+  return new_node;
+}
+
+/*
+ * Where to split a full node. An ordinary split goes down the middle, leaving
+ * room on both sides for the keys that fall in between. The nodes along the
+ * right edge of a tree that is appended to only ever get keys at their end,
+ * so they are split at their fill factor instead: the old node stays nearly
+ * full, and the new one takes the appends that follow.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::SplitPoint(const BPlusTreePage *node, bool append) const {
+  int size = node->GetSize();
+  int half = node->IsLeafPage() ? size / 2 : (size + 1) / 2;
+  if (!append) {
+    return half;
+  }
+  double fill = node->IsLeafPage() ? fill_factors_.leaf_ : fill_factors_.internal_;
+  // the new leaf gets at least one entry, the new internal page at least two children
+  int most = node->IsLeafPage() ? size - 1 : size - 2;
+  return std::clamp(static_cast<int>(std::lround(size * fill)), std::min(half, most), most);
 }
 
 /*
@@ -103,7 +264,36 @@ N *BPLUSTREE_TYPE::Split(N *node) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                                      Transaction *transaction) {}
+                                      bool append, Transaction *transaction) {
+  if (old_node->IsRootPage()) {
+    page_id_t root_id;
+    Page *page = buffer_pool_manager_->NewPage(&root_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate a new page for the root.");
+    }
+    auto *root = reinterpret_cast<InternalPage *>(page->GetData());
+    root->Init(root_id, INVALID_PAGE_ID, internal_max_size_);
+    root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+    old_node->SetParentPageId(root_id);
+    new_node->SetParentPageId(root_id);
+    root_page_id_ = root_id;
+    UpdateRootPageId(0);
+    buffer_pool_manager_->UnpinPage(root_id, true);
+    return;
+  }
+  Page *page = FetchTreePage(old_node->GetParentPageId());
+  auto *parent = reinterpret_cast<InternalPage *>(page->GetData());
+  parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+  new_node->SetParentPageId(parent->GetPageId());
+  if (parent->GetSize() > parent->GetMaxSize()) {
+    // the parents of the rightmost node are rightmost as well, so an append goes on up the right edge
+    append = append && parent->ValueAt(parent->GetSize() - 1) == new_node->GetPageId();
+    InternalPage *new_parent = Split(parent, append);
+    InsertIntoParent(parent, new_parent->KeyAt(0), new_parent, append, transaction);
+    buffer_pool_manager_->UnpinPage(new_parent->GetPageId(), true);
+  }
+  buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
+}
 
 /*****************************************************************************
  * REMOVE
@@ -113,12 +303,75 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
  * If current tree is empty, return immdiately.
  * If not, User needs to first find the right leaf page as deletion target, then
  * delete entry from leaf page. Remember to deal with redistribute or merge if
- * necessary.
+ * necessary. The posting list of the key, if any, is freed as well.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  tree_latch_.WLock();
+  RemoveKey(key, transaction);
+  tree_latch_.WUnlock();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveKey(const KeyType &key, Transaction *transaction) {
+  if (IsEmpty()) {
+    return;
+  }
+  Page *page = FindLeaf(&key);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType value;
+  if (!leaf->Lookup(key, &value, comparator_)) {
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    return;
+  }
+  if (PostingList::IsReference(value)) {
+    PostingList::Destroy(buffer_pool_manager_, value);
+  }
+  leaf->RemoveAndDeleteRecord(key, comparator_);
+  bool delete_leaf = CoalesceOrRedistribute(leaf, transaction);
+  page_id_t page_id = page->GetPageId();
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  if (delete_leaf) {
+    DeleteTreePage(page_id);
+  }
+}
+
+/*
+ * Delete a single key & value pair. The key itself goes away with its last
+ * value; while it has others, only its posting list changes.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
+void BPLUSTREE_TYPE::Remove(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  tree_latch_.WLock();
+  if (IsEmpty()) {
+    tree_latch_.WUnlock();
+    return;
+  }
+  Page *page = FindLeaf(&key);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = leaf->KeyIndex(key, comparator_);
+  if (index == leaf->GetSize() || comparator_(leaf->KeyAt(index), key) != 0) {
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    tree_latch_.WUnlock();
+    return;
+  }
+  ValueType stored = leaf->GetItem(index).second;
+  if (PostingList::IsReference(stored)) {
+    bool removed = PostingList::Remove(buffer_pool_manager_, &stored, value);
+    leaf->SetValueAt(index, stored);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), removed);
+    tree_latch_.WUnlock();
+    return;
+  }
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  if (stored == value) {
+    RemoveKey(key, transaction);
+  }
+  tree_latch_.WUnlock();
+}
 
 /*
+ * Nothing happens until the input page drops below the merge threshold.
  * User needs to first find the sibling of input page. If sibling's size + input
  * page's size > page's max size, then redistribute. Otherwise, merge.
  * Using template N to represent either internal page or leaf page.
@@ -128,7 +381,57 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
-  return false;
+  if (node->IsRootPage()) {
+    return AdjustRoot(node);
+  }
+  if (node->GetSize() >= MergeThreshold(node)) {
+    return false;
+  }
+  Page *parent_page = FetchTreePage(node->GetParentPageId());
+  auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  int index = parent->ValueIndex(node->GetPageId());
+  Page *neighbor_page = FetchTreePage(parent->ValueAt(index == 0 ? 1 : index - 1));
+  auto *neighbor = reinterpret_cast<N *>(neighbor_page->GetData());
+
+  // a leaf splits as soon as it is full, an internal page only once it overflows
+  int capacity = node->IsLeafPage() ? node->GetMaxSize() - 1 : node->GetMaxSize();
+  if (neighbor->GetSize() + node->GetSize() > capacity) {
+    Redistribute(neighbor, node, index);
+    buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+    buffer_pool_manager_->UnpinPage(neighbor_page->GetPageId(), true);
+    return false;
+  }
+
+  // always merge the right page into the left one, so that the leaf chain stays in order
+  N *left = neighbor;
+  N *right = node;
+  int right_index = index;
+  if (index == 0) {
+    std::swap(left, right);
+    right_index = 1;
+  }
+  bool delete_parent = Coalesce(&left, &right, &parent, right_index, transaction);
+  buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+  if (delete_parent) {
+    DeleteTreePage(parent_page->GetPageId());
+  }
+  buffer_pool_manager_->UnpinPage(neighbor_page->GetPageId(), true);
+  if (index == 0) {
+    // the neighbour was merged into node
+    DeleteTreePage(neighbor_page->GetPageId());
+    return false;
+  }
+  return true;
+}
+
+/*
+ * A node is underfull below the merge threshold, or the min size if that is
+ * lower. An empty leaf, and an internal page down to its last child, always are.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::MergeThreshold(const BPlusTreePage *node) const {
+  int threshold = static_cast<int>(std::lround(node->GetMaxSize() * fill_factors_.merge_threshold_));
+  return std::max(std::min(threshold, node->GetMinSize()), node->IsLeafPage() ? 1 : 2);
 }
 
 /*
@@ -148,21 +451,57 @@ template <typename N>
 bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
                               BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent, int index,
                               Transaction *transaction) {
-  return false;
+  N *left = *neighbor_node;
+  N *right = *node;
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    right->MoveAllTo(left);
+    if (left->GetNextPageId() != INVALID_PAGE_ID) {
+      Page *next_page = FetchTreePage(left->GetNextPageId());
+      reinterpret_cast<LeafPage *>(next_page->GetData())->SetPrevPageId(left->GetPageId());
+      buffer_pool_manager_->UnpinPage(next_page->GetPageId(), true);
+    }
+  } else {
+    right->MoveAllTo(left, (*parent)->KeyAt(index), buffer_pool_manager_);
+  }
+  (*parent)->Remove(index);
+  return CoalesceOrRedistribute(*parent, transaction);
 }
 
 /*
  * Redistribute key & value pairs from one page to its sibling page. If index ==
  * 0, move sibling page's first key & value pair into end of input "node",
  * otherwise move sibling page's last key & value pair into head of input
- * "node".
+ * "node". Pairs keep moving until the two pages are even, so that the next
+ * deletes from "node" do not have to borrow again.
  * Using template N to represent either internal page or leaf page.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
+void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
+  Page *parent_page = FetchTreePage(node->GetParentPageId());
+  auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  int moves = std::max((neighbor_node->GetSize() - node->GetSize()) / 2, 1);
+  for (int i = 0; i < moves; i++) {
+    if (index == 0) {
+      if constexpr (std::is_same_v<N, LeafPage>) {
+        neighbor_node->MoveFirstToEndOf(node);
+      } else {
+        neighbor_node->MoveFirstToEndOf(node, parent->KeyAt(1), buffer_pool_manager_);
+      }
+      parent->SetKeyAt(1, neighbor_node->KeyAt(0));
+    } else {
+      if constexpr (std::is_same_v<N, LeafPage>) {
+        neighbor_node->MoveLastToFrontOf(node);
+      } else {
+        neighbor_node->MoveLastToFrontOf(node, parent->KeyAt(index), buffer_pool_manager_);
+      }
+      parent->SetKeyAt(index, node->KeyAt(0));
+    }
+  }
+  buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+}
 /*
  * Update root page if necessary
  * NOTE: size of root page can be less than min size and this method is only
@@ -174,7 +513,226 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
  * happend
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) { return false; }
+bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
+  if (old_root_node->IsLeafPage()) {
+    if (old_root_node->GetSize() > 0) {
+      return false;
+    }
+    root_page_id_ = INVALID_PAGE_ID;
+    UpdateRootPageId(0);
+    return true;
+  }
+  if (old_root_node->GetSize() > 1) {
+    return false;
+  }
+  root_page_id_ = reinterpret_cast<InternalPage *>(old_root_node)->RemoveAndReturnOnlyChild();
+  UpdateRootPageId(0);
+  Page *page = FetchTreePage(root_page_id_);
+  reinterpret_cast<BPlusTreePage *>(page->GetData())->SetParentPageId(INVALID_PAGE_ID);
+  buffer_pool_manager_->UnpinPage(root_page_id_, true);
+  return true;
+}
+
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+/*
+ * Build an empty tree from sorted key & value pairs. The shape of the whole
+ * tree is worked out up front, so every leaf knows its parent and its place in
+ * the leaf chain when it is written, and the internal pages are filled from
+ * the first keys of their children without reading the children back.
+ * Nodes are filled up to their fill factor, spreading the entries evenly so
+ * that no node ends up below its min size.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoad(const std::vector<MappingType> &entries, size_t num_threads) {
+  tree_latch_.WLock();
+  if (!IsEmpty()) {
+    tree_latch_.WUnlock();
+    throw Exception("Cannot bulk load a B+ tree that is not empty.");
+  }
+  if (entries.empty()) {
+    tree_latch_.WUnlock();
+    return;
+  }
+  num_threads = std::max<size_t>(num_threads, 1);
+  std::vector<MappingType> items = GroupByKey(entries, num_threads);
+
+  // the number of entries of every node, level by level from the leaves up to the root
+  // nodes filled to their fill factor; an internal page of NodeSizes needs a capacity of three to get two children
+  int leaf_capacity = std::clamp(static_cast<int>(std::lround((leaf_max_size_ - 1) * fill_factors_.leaf_)), 1,
+                                 leaf_max_size_ - 1);
+  int internal_capacity = std::clamp(static_cast<int>(std::lround(internal_max_size_ * fill_factors_.internal_)),
+                                     std::min(3, internal_max_size_), internal_max_size_);
+  std::vector<std::vector<int>> levels{NodeSizes(items.size(), leaf_capacity)};
+  while (levels.back().size() > 1) {
+    levels.push_back(NodeSizes(levels.back().size(), internal_capacity));
+  }
+  // allocate the internal pages first, so that the leaves know their parents
+  std::vector<std::vector<page_id_t>> page_ids(levels.size());
+  for (size_t level = 1; level < levels.size(); level++) {
+    for (size_t i = 0; i < levels[level].size(); i++) {
+      page_id_t page_id;
+      if (buffer_pool_manager_->NewPage(&page_id) == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate a new page for the bulk load.");
+      }
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      page_ids[level].push_back(page_id);
+    }
+  }
+  auto parents_of = [&](size_t level) {
+    std::vector<page_id_t> parents;
+    if (level + 1 == levels.size()) {
+      parents.push_back(INVALID_PAGE_ID);
+      return parents;
+    }
+    for (size_t i = 0; i < levels[level + 1].size(); i++) {
+      parents.insert(parents.end(), levels[level + 1][i], page_ids[level + 1][i]);
+    }
+    return parents;
+  };
+
+  // the leaves, every thread a contiguous run of them
+  size_t num_leaves = levels[0].size();
+  std::vector<size_t> offsets(num_leaves + 1, 0);
+  for (size_t i = 0; i < num_leaves; i++) {
+    offsets[i + 1] = offsets[i] + levels[0][i];
+  }
+  std::vector<page_id_t> leaf_parents = parents_of(0);
+  page_ids[0].resize(num_leaves);
+  size_t num_tasks = std::min(num_threads, num_leaves);
+  ParallelUtil::ParallelFor(num_tasks, [&](size_t task) {
+    LeafPage *prev = nullptr;
+    for (size_t i = num_leaves * task / num_tasks; i < num_leaves * (task + 1) / num_tasks; i++) {
+      page_id_t page_id;
+      Page *page = buffer_pool_manager_->NewPage(&page_id);
+      if (page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate a new page for the bulk load.");
+      }
+      auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+      leaf->Init(page_id, leaf_parents[i], leaf_max_size_);
+      leaf->PopulateFrom(&items[offsets[i]], levels[0][i]);
+      if (prev != nullptr) {
+        prev->SetNextPageId(page_id);
+        leaf->SetPrevPageId(prev->GetPageId());
+        buffer_pool_manager_->UnpinPage(prev->GetPageId(), true);
+      }
+      page_ids[0][i] = page_id;
+      prev = leaf;
+    }
+    buffer_pool_manager_->UnpinPage(prev->GetPageId(), true);
+  });
+  // link the runs of leaves to each other
+  for (size_t task = 1; task < num_tasks; task++) {
+    size_t first = num_leaves * task / num_tasks;
+    Page *left = FetchTreePage(page_ids[0][first - 1]);
+    reinterpret_cast<LeafPage *>(left->GetData())->SetNextPageId(page_ids[0][first]);
+    buffer_pool_manager_->UnpinPage(left->GetPageId(), true);
+    Page *right = FetchTreePage(page_ids[0][first]);
+    reinterpret_cast<LeafPage *>(right->GetData())->SetPrevPageId(page_ids[0][first - 1]);
+    buffer_pool_manager_->UnpinPage(right->GetPageId(), true);
+  }
+
+  // the internal levels, bottom up
+  std::vector<KeyType> first_keys(num_leaves);
+  for (size_t i = 0; i < num_leaves; i++) {
+    first_keys[i] = items[offsets[i]].first;
+  }
+  std::vector<std::pair<KeyType, page_id_t>> children;
+  for (size_t level = 1; level < levels.size(); level++) {
+    std::vector<page_id_t> parents = parents_of(level);
+    std::vector<KeyType> level_first_keys;
+    size_t child = 0;
+    for (size_t i = 0; i < levels[level].size(); i++) {
+      children.clear();
+      for (int k = 0; k < levels[level][i]; k++, child++) {
+        children.emplace_back(first_keys[child], page_ids[level - 1][child]);
+      }
+      Page *page = FetchTreePage(page_ids[level][i]);
+      auto *internal = reinterpret_cast<InternalPage *>(page->GetData());
+      internal->Init(page_ids[level][i], parents[i], internal_max_size_);
+      internal->PopulateFrom(children.data(), levels[level][i]);
+      buffer_pool_manager_->UnpinPage(page_ids[level][i], true);
+      level_first_keys.push_back(children[0].first);
+    }
+    first_keys = std::move(level_first_keys);
+  }
+  root_page_id_ = page_ids.back()[0];
+  UpdateRootPageId(1);
+  tree_latch_.WUnlock();
+}
+
+/*
+ * Merge the sorted key & value pairs into one entry per key. In a non-unique
+ * tree, the values of a repeated key go to a posting list; a unique tree keeps
+ * the first one. The entries are split into chunks that do not cut through the
+ * values of a key, one chunk per thread.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<MappingType> BPLUSTREE_TYPE::GroupByKey(const std::vector<MappingType> &entries, size_t num_threads) {
+  size_t num_tasks = std::min(num_threads, entries.size());
+  std::vector<size_t> bounds(num_tasks + 1, entries.size());
+  for (size_t task = 0; task < num_tasks; task++) {
+    size_t bound = entries.size() * task / num_tasks;
+    if (task > 0) {
+      bound = std::max(bound, bounds[task - 1]);
+    }
+    while (bound > 0 && bound < entries.size() && comparator_(entries[bound].first, entries[bound - 1].first) == 0) {
+      bound++;
+    }
+    bounds[task] = bound;
+  }
+
+  std::vector<std::vector<MappingType>> groups(num_tasks);
+  ParallelUtil::ParallelFor(num_tasks, [&](size_t task) {
+    std::vector<ValueType> values;
+    // the small lists of a task fill its own shared pages one after the other
+    page_id_t shared_page_id = INVALID_PAGE_ID;
+    for (size_t i = bounds[task]; i < bounds[task + 1];) {
+      size_t end = i + 1;
+      while (end < bounds[task + 1] && comparator_(entries[end].first, entries[i].first) == 0) {
+        end++;
+      }
+      if (unique_keys_ || end - i == 1) {
+        groups[task].push_back(entries[i]);
+      } else {
+        values.clear();
+        for (size_t k = i; k < end; k++) {
+          values.push_back(entries[k].second);
+        }
+        ValueType postings =
+            PostingList::Build(buffer_pool_manager_, values.data(), static_cast<int>(values.size()), &shared_page_id);
+        groups[task].emplace_back(entries[i].first, postings);
+      }
+      i = end;
+    }
+  });
+
+  std::vector<MappingType> items;
+  if (num_tasks == 1) {
+    items = std::move(groups[0]);
+    return items;
+  }
+  for (const auto &group : groups) {
+    items.insert(items.end(), group.begin(), group.end());
+  }
+  return items;
+}
+
+/*
+ * Spread count entries over as few nodes of the given capacity as hold them.
+ * The nodes differ in size by at most one, so with two or more nodes each of
+ * them is at least half full.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<int> BPLUSTREE_TYPE::NodeSizes(size_t count, int capacity) {
+  size_t num_nodes = (count + capacity - 1) / capacity;
+  std::vector<int> sizes(num_nodes);
+  for (size_t i = 0; i < num_nodes; i++) {
+    sizes[i] = static_cast<int>(count * (i + 1) / num_nodes - count * i / num_nodes);
+  }
+  return sizes;
+}
 
 /*****************************************************************************
  * INDEX ITERATOR
@@ -185,7 +743,7 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) { return false; }
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() { return INDEXITERATOR_TYPE(); }
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() { return ScanRange(nullptr, true, nullptr, true); }
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
@@ -193,7 +751,7 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() { return INDEXITERATOR_TYPE(); }
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) { return INDEXITERATOR_TYPE(); }
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) { return ScanRange(&key, true, nullptr, false); }
 
 /*
  * Input parameter is void, construct an index iterator representing the end
@@ -203,6 +761,42 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) { return INDEXITERA
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::end() { return INDEXITERATOR_TYPE(); }
 
+/*
+ * Input parameters are the bounds of the range, either of which may be null to
+ * leave that side open. Find the leaf page that contains the bound the scan
+ * starts from, then construct an index iterator that stops at the other bound
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::ScanRange(const KeyType *lo, bool lo_inclusive, const KeyType *hi,
+                                             bool hi_inclusive, ScanDirection direction) {
+  tree_latch_.RLock();
+  if (IsEmpty()) {
+    tree_latch_.RUnlock();
+    return INDEXITERATOR_TYPE();
+  }
+  bool forward = direction == ScanDirection::FORWARD;
+  const KeyType *start = forward ? lo : hi;
+  Page *page = FindLeaf(start, !forward);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index;
+  if (start == nullptr) {
+    index = forward ? 0 : leaf->GetSize() - 1;
+  } else {
+    // the first slot >= start, moved past start itself if the bound is exclusive
+    index = leaf->KeyIndex(*start, comparator_);
+    bool found = index < leaf->GetSize() && comparator_(leaf->KeyAt(index), *start) == 0;
+    if (forward) {
+      index += found && !lo_inclusive ? 1 : 0;
+    } else {
+      index -= found && hi_inclusive ? 0 : 1;
+    }
+  }
+  tree_latch_.RUnlock();
+  return forward ? INDEXITERATOR_TYPE(buffer_pool_manager_, page, index, &comparator_, direction, hi, hi_inclusive)
+                 : INDEXITERATOR_TYPE(buffer_pool_manager_, page, index, &comparator_, direction, lo, lo_inclusive);
+}
+
 /*****************************************************************************
  * UTILITIES AND DEBUG
  *****************************************************************************/
@@ -212,7 +806,133 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::end() { return INDEXITERATOR_TYPE(); }
  */
 INDEX_TEMPLATE_ARGUMENTS
 Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
-  throw Exception(ExceptionType::NOT_IMPLEMENTED, "Implement this for test");
+  return FindLeaf(leftMost ? nullptr : &key);
+}
+
+/*
+ * Find leaf page containing particular key, or the left/right most leaf page
+ * if key is nullptr. Return nullptr if the tree is empty
+ * The pages of the cached top levels are reached through their pinned frames,
+ * without going through the buffer pool manager; a page that is not cached,
+ * say one split off since, is fetched as usual.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeaf(const KeyType *key, bool right_most) {
+  if (IsEmpty()) {
+    return nullptr;
+  }
+  RefreshTopLevels();
+  page_id_t page_id = root_page_id_;
+  for (int depth = 0;; depth++) {
+    auto it = depth < top_depth_ ? top_pages_.find(page_id) : top_pages_.end();
+    bool cached = it != top_pages_.end();
+    Page *page = cached ? it->second : FetchTreePage(page_id);
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (node->IsLeafPage()) {
+      return page;
+    }
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    if (key != nullptr) {
+      page_id = internal->Lookup(*key, comparator_);
+    } else {
+      page_id = internal->ValueAt(right_most ? internal->GetSize() - 1 : 0);
+    }
+    if (!cached) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    }
+  }
+}
+
+/*
+ * Pin the internal pages of the top levels, level by level from the root
+ * down, unless they are cached for the current epoch already. Only whole
+ * levels are cached, and only as many as fit in the share of the buffer pool
+ * the tree may keep pinned. Any writer that changes the shape of the top
+ * levels moves the epoch on, so the first lookup after it pins them again.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RefreshTopLevels() {
+  if (cached_levels_ == 0 || top_epoch_.load(std::memory_order_acquire) == epoch_.load(std::memory_order_acquire)) {
+    return;
+  }
+  std::scoped_lock lock(top_latch_);
+  uint64_t epoch = epoch_.load();
+  if (top_epoch_.load() == epoch) {
+    return;
+  }
+  ReleaseTopLevels();
+  std::vector<page_id_t> level;
+  if (!IsEmpty()) {
+    level.push_back(root_page_id_);
+  }
+  std::vector<page_id_t> children;
+  while (top_depth_ < cached_levels_ && !level.empty() && top_pages_.size() + level.size() <= max_cached_pages_) {
+    children.clear();
+    for (page_id_t page_id : level) {
+      Page *page = FetchTreePage(page_id);
+      auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+      if (node->IsLeafPage()) {
+        // the leaves are not cached, and all of a level are leaves if one is
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        break;
+      }
+      auto *internal = reinterpret_cast<InternalPage *>(node);
+      for (int i = 0; i < internal->GetSize(); i++) {
+        children.push_back(internal->ValueAt(i));
+      }
+      top_pages_.emplace(page_id, page);
+    }
+    if (children.empty()) {
+      break;
+    }
+    top_depth_++;
+    level.swap(children);
+  }
+  top_epoch_.store(epoch, std::memory_order_release);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::InvalidateTopLevels() {
+  if (cached_levels_ == 0) {
+    return;
+  }
+  std::scoped_lock lock(top_latch_);
+  ReleaseTopLevels();
+  epoch_.fetch_add(1, std::memory_order_release);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseTopLevels() {
+  for (const auto &[page_id, page] : top_pages_) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+  }
+  top_pages_.clear();
+  top_depth_ = 0;
+}
+
+/*
+ * Delete a page of this tree. A pinned page cannot be deleted, so a page of
+ * the cached top levels is released first.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::DeleteTreePage(page_id_t page_id) {
+  if (top_pages_.count(page_id) != 0) {
+    InvalidateTopLevels();
+  }
+  buffer_pool_manager_->DeletePage(page_id);
+}
+
+/*
+ * Fetch a page of this tree from the buffer pool manager, throwing an
+ * "out of memory" exception if the buffer pool is exhausted
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FetchTreePage(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch a page of the tree.");
+  }
+  return page;
 }
 
 /*
@@ -225,6 +945,8 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
+  // the cached levels hang off the old root
+  InvalidateTopLevels();
   HeaderPage *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
   if (insert_record != 0) {
     // create a new record<index_name + root_page_id> in header_page
@@ -398,5 +1120,7 @@ template class BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTree<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTree<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class BPlusTree<NormalizedKey<16>, RID, NormalizedComparator<16>>;
 
 }  // namespace bustub
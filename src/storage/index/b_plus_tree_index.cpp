@@ -9,6 +9,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <queue>
+
+#include "common/util/parallel_util.h"
 #include "storage/index/b_plus_tree_index.h"
 
 namespace bustub {
@@ -18,15 +22,33 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager)
     : Index(metadata),
+      buffer_pool_manager_(buffer_pool_manager),
+      layout_(metadata->GetKeySchema()),
       comparator_(metadata->GetKeySchema()),
-      container_(metadata->GetName(), buffer_pool_manager, comparator_) {}
+      container_(metadata->GetName(), buffer_pool_manager, comparator_, LEAF_PAGE_SIZE, INTERNAL_PAGE_SIZE,
+                 metadata->IsUnique(), BPlusTreeFillFactors(), CACHED_LEVELS) {
+  // a non-unique key keeps a single leaf entry for all of its RIDs, which has room for one set of included columns
+  if (metadata->IsCovering() && !metadata->IsUnique()) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "Only unique B+ tree indexes can include columns.");
+  }
+  // a normalized key is compared whole, included columns and all
+  if (IsNormalizedKey<KeyType>::value && (metadata->IsCovering() || !layout_.IsFixedWidth())) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "Normalized keys hold only fixed-width key columns.");
+  }
+  if (metadata->GetEntrySchema()->GetLength() > sizeof(KeyType)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "The index entry does not fit in the key size.");
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, layout_);
 
+  if (bloom_filter_ != nullptr) {
+    bloom_filter_->Insert(FilterHash(index_key));
+  }
   container_.Insert(index_key, rid, transaction);
 }
 
@@ -34,20 +56,186 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, layout_);
 
-  container_.Remove(index_key, transaction);
+  container_.Remove(index_key, rid, transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, layout_);
 
+  // a key the filter rules out is not in the index, so skip the descent
+  if (bloom_filter_ != nullptr && !bloom_filter_->MayContain(BloomFilter::Hash(&index_key, sizeof(KeyType)))) {
+    return;
+  }
   container_.GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKeyEntries(const Tuple &key, std::vector<RID> *result, std::vector<Tuple> *entries,
+                                          Transaction *transaction) {
+  KeyType index_key;
+  index_key.SetFromKey(key, layout_);
+
+  if (bloom_filter_ != nullptr && !bloom_filter_->MayContain(BloomFilter::Hash(&index_key, sizeof(KeyType)))) {
+    return;
+  }
+  // the stored keys carry the included columns, so look the key up as a range of one key
+  BPlusTreeIndexCursor<KeyType, ValueType, KeyComparator> cursor(
+      container_.ScanRange(&index_key, true, &index_key, true, ScanDirection::FORWARD), GetEntrySchema());
+  while (cursor.NextEntryBatch(result, entries)) {
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+std::unique_ptr<IndexCursor> BPLUSTREE_INDEX_TYPE::ScanRange(const Tuple *lo, bool lo_inclusive, const Tuple *hi,
+                                                             bool hi_inclusive, ScanDirection direction,
+                                                             Transaction *transaction) {
+  // construct the bounding index keys
+  KeyType lo_key;
+  KeyType hi_key;
+  if (lo != nullptr) {
+    lo_key.SetFromKey(*lo, layout_);
+  }
+  if (hi != nullptr) {
+    hi_key.SetFromKey(*hi, layout_);
+  }
+
+  return std::make_unique<BPlusTreeIndexCursor<KeyType, ValueType, KeyComparator>>(
+      container_.ScanRange(lo == nullptr ? nullptr : &lo_key, lo_inclusive, hi == nullptr ? nullptr : &hi_key,
+                           hi_inclusive, direction),
+      GetEntrySchema());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::BuildFromTable(TableHeap *table, const Schema &schema, Transaction *transaction,
+                                          size_t num_threads) {
+  using Entry = std::pair<KeyType, ValueType>;
+  auto entry_less = [this](const Entry &lhs, const Entry &rhs) {
+    int cmp = comparator_(lhs.first, rhs.first);
+    return cmp < 0 || (cmp == 0 && lhs.second.Get() < rhs.second.Get());
+  };
+  bool lock_tuples = enable_logging;
+  if (lock_tuples) {
+    num_threads = 1;
+  }
+
+  std::vector<page_id_t> page_ids;
+  for (page_id_t page_id = table->GetFirstPageId(); page_id != INVALID_PAGE_ID;) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch a table page.");
+    }
+    page_ids.push_back(page_id);
+    page_id = reinterpret_cast<TablePage *>(page)->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_ids.back(), false);
+  }
+
+  // every thread extracts and sorts the keys of a contiguous range of pages
+  size_t num_tasks = std::max<size_t>(std::min(num_threads, page_ids.size()), 1);
+  std::vector<std::vector<Entry>> runs(num_tasks);
+  ParallelUtil::ParallelFor(num_tasks, [&](size_t task) {
+    KeyType index_key;
+    Tuple tuple;
+    for (size_t i = page_ids.size() * task / num_tasks; i < page_ids.size() * (task + 1) / num_tasks; i++) {
+      auto *page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_ids[i]));
+      if (page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch a table page.");
+      }
+      auto add = [&](const RID &rid) {
+        index_key.SetFromKey(tuple.KeyFromTuple(schema, *GetEntrySchema(), GetEntryAttrs()), layout_);
+        runs[task].emplace_back(index_key, rid);
+      };
+      // the tuples to read through the table heap: all of them if they are locked, else the forwarded ones
+      std::vector<RID> rids;
+      page->RLatch();
+      RID rid;
+      RID forward_rid;
+      for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+        if (lock_tuples || page->GetForwardRid(rid, &forward_rid)) {
+          rids.push_back(rid);
+        } else if (page->GetTuple(rid, &tuple, nullptr, nullptr)) {
+          add(rid);
+        }
+      }
+      page->RUnlatch();
+      // the table heap latches the page again, reads the moved copy of a forwarded tuple and takes the tuple locks
+      for (const RID &heap_rid : rids) {
+        if (table->GetTuple(heap_rid, &tuple, transaction)) {
+          add(heap_rid);
+        }
+      }
+      buffer_pool_manager_->UnpinPage(page_ids[i], false);
+    }
+    std::sort(runs[task].begin(), runs[task].end(), entry_less);
+  });
+
+  // merge the runs, every thread the entries between two splitters taken from the largest run
+  std::vector<Entry> merged;
+  if (num_tasks == 1) {
+    merged = std::move(runs[0]);
+  } else {
+    const auto &sample = *std::max_element(runs.begin(), runs.end(), [](const auto &lhs, const auto &rhs) {
+      return lhs.size() < rhs.size();
+    });
+    // cuts[j][r] is where the entries of thread j start in run r
+    std::vector<std::vector<size_t>> cuts(num_tasks + 1, std::vector<size_t>(num_tasks, 0));
+    std::vector<size_t> offsets(num_tasks + 1, 0);
+    for (size_t r = 0; r < num_tasks; r++) {
+      cuts[num_tasks][r] = runs[r].size();
+    }
+    for (size_t j = 1; j < num_tasks && !sample.empty(); j++) {
+      const Entry &splitter = sample[sample.size() * j / num_tasks];
+      for (size_t r = 0; r < num_tasks; r++) {
+        cuts[j][r] = std::lower_bound(runs[r].begin(), runs[r].end(), splitter, entry_less) - runs[r].begin();
+      }
+    }
+    for (size_t j = 0; j <= num_tasks; j++) {
+      for (size_t r = 0; r < num_tasks; r++) {
+        offsets[j] += cuts[j][r];
+      }
+    }
+    merged.resize(offsets[num_tasks]);
+    ParallelUtil::ParallelFor(num_tasks, [&](size_t task) {
+      using Cursor = std::pair<size_t, size_t>;
+      auto cursor_greater = [&](const Cursor &lhs, const Cursor &rhs) {
+        return entry_less(runs[rhs.first][rhs.second], runs[lhs.first][lhs.second]);
+      };
+      std::priority_queue<Cursor, std::vector<Cursor>, decltype(cursor_greater)> heap(cursor_greater);
+      for (size_t r = 0; r < num_tasks; r++) {
+        if (cuts[task][r] < cuts[task + 1][r]) {
+          heap.emplace(r, cuts[task][r]);
+        }
+      }
+      size_t out = offsets[task];
+      while (!heap.empty()) {
+        auto [r, pos] = heap.top();
+        heap.pop();
+        merged[out++] = runs[r][pos];
+        if (++pos < cuts[task + 1][r]) {
+          heap.emplace(r, pos);
+        }
+      }
+    });
+    runs.clear();
+  }
+
+  container_.BulkLoad(merged, num_threads);
+
+  if (bloom_filter_ != nullptr) {
+    // size the filter for the rows at hand, so that it starts out with a single layer
+    bloom_filter_ = std::make_unique<BloomFilter>(merged.size());
+    ParallelUtil::ParallelFor(num_tasks, [&](size_t task) {
+      for (size_t i = merged.size() * task / num_tasks; i < merged.size() * (task + 1) / num_tasks; i++) {
+        bloom_filter_->Insert(FilterHash(merged[i].first));
+      }
+    });
+  }
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator() { return container_.begin(); }
 
@@ -57,10 +245,36 @@ INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetEndIterator() { return container_.end(); }
 
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetRangeIterator(const KeyType *lo, bool lo_inclusive, const KeyType *hi,
+                                                          bool hi_inclusive, ScanDirection direction) {
+  return container_.ScanRange(lo, lo_inclusive, hi, hi_inclusive, direction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+uint64_t BPLUSTREE_INDEX_TYPE::FilterHash(const KeyType &key) const {
+  if (!GetMetadata()->IsCovering()) {
+    return BloomFilter::Hash(&key, sizeof(KeyType));
+  }
+  // lookups hash keys without the included columns
+  Schema *key_schema = GetKeySchema();
+  std::vector<Value> values;
+  values.reserve(key_schema->GetColumnCount());
+  for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+    values.push_back(key.ToValue(GetEntrySchema(), i));
+  }
+  KeyType search_key;
+  search_key.SetFromKey(Tuple(values, key_schema), layout_);
+  return BloomFilter::Hash(&search_key, sizeof(KeyType));
+}
+
 template class BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class BPlusTreeIndex<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class BPlusTreeIndex<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+
 }  // namespace bustub
@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter.cpp
+//
+// Identification: src/storage/index/bloom_filter.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+
+#include "murmur3/MurmurHash3.h"
+#include "storage/index/bloom_filter.h"
+
+namespace bustub {
+
+namespace {
+
+/** Odd multipliers that pick the bit of each word of a block from the same 32 bits of hash. */
+alignas(32) const uint32_t SALT[8] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                      0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+}  // namespace
+
+BloomFilter::Layer::Layer(size_t capacity)
+    : capacity_(capacity),
+      num_blocks_(std::max<size_t>(capacity * BITS_PER_KEY / (8 * sizeof(Block)), 1)),
+      blocks_(new Block[num_blocks_]()) {}
+
+BloomFilter::BloomFilter(size_t expected_keys) {
+  layers_[0] = std::make_unique<Layer>(std::max<size_t>(expected_keys, DEFAULT_EXPECTED_KEYS));
+  num_layers_.store(1);
+}
+
+uint64_t BloomFilter::Hash(const void *data, size_t size) {
+  uint64_t hash[2];
+  murmur3::MurmurHash3_x64_128(data, static_cast<int>(size), 0, reinterpret_cast<void *>(&hash));
+  return hash[0];
+}
+
+void BloomFilter::Insert(uint64_t hash) {
+  // a key that may be there already would only use up capacity
+  if (MayContain(hash)) {
+    return;
+  }
+  size_t num_layers = num_layers_.load(std::memory_order_acquire);
+  Layer *layer = layers_[num_layers - 1].get();
+  InsertIntoBlock(BlockOf(*layer, hash), static_cast<uint32_t>(hash));
+  // the insert that fills the layer adds the next one; at MAX_LAYERS the last layer keeps taking keys, at a higher
+  // false positive rate
+  if (layer->num_keys_.fetch_add(1) + 1 == layer->capacity_ && num_layers < MAX_LAYERS) {
+    layers_[num_layers] = std::make_unique<Layer>(layer->capacity_ * 4);
+    num_layers_.store(num_layers + 1, std::memory_order_release);
+  }
+}
+
+bool BloomFilter::MayContain(uint64_t hash) const {
+  size_t num_layers = num_layers_.load(std::memory_order_acquire);
+  for (size_t i = 0; i < num_layers; i++) {
+    if (BlockContains(BlockOf(*layers_[i], hash), static_cast<uint32_t>(hash))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t BloomFilter::GetSizeInBytes() const {
+  size_t size = 0;
+  size_t num_layers = num_layers_.load(std::memory_order_acquire);
+  for (size_t i = 0; i < num_layers; i++) {
+    size += layers_[i]->num_blocks_ * sizeof(Block);
+  }
+  return size;
+}
+
+void BloomFilter::InsertIntoBlock(Block *block, uint32_t hash) {
+  for (int i = 0; i < 8; i++) {
+    __atomic_fetch_or(&block->words_[i], 1U << ((hash * SALT[i]) >> 27), __ATOMIC_RELAXED);
+  }
+}
+
+bool BloomFilter::BlockContains(const Block *block, uint32_t hash) {
+#if defined(__AVX2__)
+  __m256i bits = _mm256_srli_epi32(
+      _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(hash)),
+                         _mm256_load_si256(reinterpret_cast<const __m256i *>(SALT))),
+      27);
+  __m256i mask = _mm256_sllv_epi32(_mm256_set1_epi32(1), bits);
+  // testc is set when every bit of the mask is set in the block
+  return _mm256_testc_si256(_mm256_load_si256(reinterpret_cast<const __m256i *>(block->words_)), mask) != 0;
+#else
+  for (int i = 0; i < 8; i++) {
+    uint32_t mask = 1U << ((hash * SALT[i]) >> 27);
+    if ((__atomic_load_n(&block->words_[i], __ATOMIC_RELAXED) & mask) == 0) {
+      return false;
+    }
+  }
+  return true;
+#endif
+}
+
+BloomFilter::Block *BloomFilter::BlockOf(const Layer &layer, uint64_t hash) {
+  // map the upper 32 bits of the hash onto the blocks without a division
+  size_t index = static_cast<size_t>(((hash >> 32) * static_cast<uint64_t>(layer.num_blocks_)) >> 32);
+  return &layer.blocks_[index];
+}
+
+}  // namespace bustub
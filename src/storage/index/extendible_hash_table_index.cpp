@@ -0,0 +1,56 @@
+#include <vector>
+
+#include "storage/index/extendible_hash_table_index.h"
+
+namespace bustub {
+/*
+ * Constructor
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+EXTENDIBLE_HASH_TABLE_INDEX_TYPE::ExtendibleHashTableIndex(IndexMetadata *metadata,
+                                                           BufferPoolManager *buffer_pool_manager,
+                                                           const HashFunction<KeyType> &hash_fn)
+    : Index(metadata),
+      comparator_(metadata->GetKeySchema()),
+      container_(metadata->GetName(), buffer_pool_manager, comparator_, hash_fn) {}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  // construct insert index key
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  if (bloom_filter_ != nullptr) {
+    bloom_filter_->Insert(BloomFilter::Hash(&index_key, sizeof(KeyType)));
+  }
+  container_.Insert(transaction, index_key, rid);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  // construct delete index key
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  container_.Remove(transaction, index_key, rid);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  // construct scan index key
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  // a key the filter rules out is not in the index, so skip the probe
+  if (bloom_filter_ != nullptr && !bloom_filter_->MayContain(BloomFilter::Hash(&index_key, sizeof(KeyType)))) {
+    return;
+  }
+  container_.GetValue(transaction, index_key, result);
+}
+template class ExtendibleHashTableIndex<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExtendibleHashTableIndex<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExtendibleHashTableIndex<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExtendibleHashTableIndex<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExtendibleHashTableIndex<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
@@ -1,30 +1,258 @@
 /**
  * index_iterator.cpp
  */
+#include <algorithm>
 #include <cassert>
+#include <utility>
 
+#include "common/exception.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
 
-/*
- * NOTE: you can change the destructor/constructor method here
- * set your own input parameters
- */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator() = default;
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() = default;
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *buffer_pool_manager, Page *page, int index,
+                                  const KeyComparator *comparator, ScanDirection direction, const KeyType *stop_key,
+                                  bool stop_inclusive)
+    : buffer_pool_manager_(buffer_pool_manager),
+      index_(index),
+      comparator_(comparator),
+      direction_(direction),
+      has_stop_key_(stop_key != nullptr),
+      stop_inclusive_(stop_inclusive) {
+  if (stop_key != nullptr) {
+    stop_key_ = *stop_key;
+  }
+  if (page != nullptr) {
+    Enter(page);
+    Settle();
+    LoadPostings();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other) noexcept { *this = std::move(other); }
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator=(IndexIterator &&other) noexcept {
+  if (this != &other) {
+    Release();
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    page_ = other.page_;
+    leaf_ = other.leaf_;
+    page_id_ = other.page_id_;
+    index_ = other.index_;
+    stop_index_ = other.stop_index_;
+    comparator_ = other.comparator_;
+    direction_ = other.direction_;
+    stop_key_ = other.stop_key_;
+    has_stop_key_ = other.has_stop_key_;
+    stop_inclusive_ = other.stop_inclusive_;
+    postings_ = std::move(other.postings_);
+    posting_index_ = other.posting_index_;
+    posting_next_id_ = other.posting_next_id_;
+    // the pin now belongs to this iterator
+    other.page_ = nullptr;
+    other.leaf_ = nullptr;
+    other.page_id_ = INVALID_PAGE_ID;
+    other.postings_.clear();
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::~IndexIterator() { Release(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+bool INDEXITERATOR_TYPE::isEnd() { return page_ == nullptr; }
 
 INDEX_TEMPLATE_ARGUMENTS
-bool INDEXITERATOR_TYPE::isEnd() { throw std::runtime_error("unimplemented"); }
+const MappingType &INDEXITERATOR_TYPE::operator*() {
+  if (postings_.empty()) {
+    current_ = leaf_->GetItem(index_);
+  } else {
+    current_ = MappingType(leaf_->KeyAt(index_), postings_[posting_index_]);
+  }
+  return current_;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &INDEXITERATOR_TYPE::operator*() { throw std::runtime_error("unimplemented"); }
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
+  if (!postings_.empty()) {
+    if (++posting_index_ < static_cast<int>(postings_.size())) {
+      return *this;
+    }
+    if (posting_next_id_ != INVALID_PAGE_ID) {
+      LoadPostingPage(posting_next_id_);
+      return *this;
+    }
+    postings_.clear();
+  }
+  index_ += direction_ == ScanDirection::FORWARD ? 1 : -1;
+  Settle();
+  LoadPostings();
+  return *this;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() { throw std::runtime_error("unimplemented"); }
+int INDEXITERATOR_TYPE::NextBatch(std::vector<ValueType> *result, std::vector<KeyType> *keys) {
+  if (isEnd()) {
+    return 0;
+  }
+  size_t old_size = result->size();
+  // the values from keyed_size on have no key in keys yet
+  size_t keyed_size = old_size;
+  if (!postings_.empty()) {
+    // finish the posting list the iterator is in the middle of
+    result->insert(result->end(), postings_.begin() + posting_index_, postings_.end());
+    while (posting_next_id_ != INVALID_PAGE_ID) {
+      LoadPostingPage(posting_next_id_);
+      result->insert(result->end(), postings_.begin(), postings_.end());
+    }
+    postings_.clear();
+    if (keys != nullptr) {
+      keys->insert(keys->end(), result->size() - keyed_size, leaf_->KeyAt(index_));
+      keyed_size = result->size();
+    }
+    index_ += direction_ == ScanDirection::FORWARD ? 1 : -1;
+  }
+  int step = direction_ == ScanDirection::FORWARD ? 1 : -1;
+  for (; direction_ == ScanDirection::FORWARD ? index_ < stop_index_ : index_ > stop_index_; index_ += step) {
+    AppendValue(leaf_->GetItem(index_).second, result);
+    if (keys != nullptr) {
+      keys->insert(keys->end(), result->size() - keyed_size, leaf_->KeyAt(index_));
+      keyed_size = result->size();
+    }
+  }
+  Settle();
+  LoadPostings();
+  return static_cast<int>(result->size() - old_size);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Settle() {
+  while (page_ != nullptr) {
+    page_id_t neighbor_id;
+    if (direction_ == ScanDirection::FORWARD) {
+      if (index_ < stop_index_) {
+        return;
+      }
+      // the stop key lies within this leaf, or there is nothing to its right
+      neighbor_id = leaf_->GetNextPageId();
+      if (stop_index_ < leaf_->GetSize() || neighbor_id == INVALID_PAGE_ID) {
+        Release();
+        return;
+      }
+    } else {
+      if (index_ > stop_index_) {
+        return;
+      }
+      neighbor_id = leaf_->GetPrevPageId();
+      if (stop_index_ >= 0 || neighbor_id == INVALID_PAGE_ID) {
+        Release();
+        return;
+      }
+    }
+    Page *neighbor = buffer_pool_manager_->FetchPage(neighbor_id);
+    if (neighbor == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch the next leaf page.");
+    }
+    buffer_pool_manager_->UnpinPage(page_id_, false);
+    Enter(neighbor);
+    index_ = direction_ == ScanDirection::FORWARD ? 0 : leaf_->GetSize() - 1;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Enter(Page *page) {
+  page_ = page;
+  leaf_ = reinterpret_cast<LeafPage *>(page->GetData());
+  page_id_ = page->GetPageId();
+  int size = leaf_->GetSize();
+  if (!has_stop_key_) {
+    stop_index_ = direction_ == ScanDirection::FORWARD ? size : -1;
+    return;
+  }
+  int index = leaf_->KeyIndex(stop_key_, *comparator_);
+  bool found = index < size && (*comparator_)(leaf_->KeyAt(index), stop_key_) == 0;
+  if (direction_ == ScanDirection::FORWARD) {
+    stop_index_ = found && stop_inclusive_ ? index + 1 : index;
+  } else {
+    stop_index_ = found && !stop_inclusive_ ? index : index - 1;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Release() {
+  if (page_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(page_id_, false);
+  }
+  page_ = nullptr;
+  leaf_ = nullptr;
+  page_id_ = INVALID_PAGE_ID;
+  index_ = 0;
+  postings_.clear();
+  posting_index_ = 0;
+  posting_next_id_ = INVALID_PAGE_ID;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::LoadPostings() {
+  postings_.clear();
+  posting_index_ = 0;
+  posting_next_id_ = INVALID_PAGE_ID;
+  if (isEnd() || !PostingList::IsReference(leaf_->GetItem(index_).second)) {
+    return;
+  }
+  ValueType value = leaf_->GetItem(index_).second;
+  if (PostingList::IsSmallList(value)) {
+    PostingList::Read(buffer_pool_manager_, value, &postings_);
+    if (direction_ == ScanDirection::BACKWARD) {
+      std::reverse(postings_.begin(), postings_.end());
+    }
+    return;
+  }
+  page_id_t page_id = value.GetPageId();
+  if (direction_ == ScanDirection::BACKWARD) {
+    // a backward scan starts at the tail, which the head keeps track of
+    BPlusTreePostingPage *head = PostingList::FetchPostingPage(buffer_pool_manager_, page_id);
+    page_id_t tail_id = head->GetTailPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = tail_id;
+  }
+  LoadPostingPage(page_id);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::LoadPostingPage(page_id_t page_id) {
+  BPlusTreePostingPage *page = PostingList::FetchPostingPage(buffer_pool_manager_, page_id);
+  postings_.clear();
+  page->Decode(&postings_);
+  posting_index_ = 0;
+  if (direction_ == ScanDirection::FORWARD) {
+    posting_next_id_ = page->GetNextPageId();
+  } else {
+    posting_next_id_ = page->GetPrevPageId();
+    std::reverse(postings_.begin(), postings_.end());
+  }
+  buffer_pool_manager_->UnpinPage(page_id, false);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::AppendValue(const ValueType &value, std::vector<ValueType> *result) {
+  if (!PostingList::IsReference(value)) {
+    result->push_back(value);
+    return;
+  }
+  size_t old_size = result->size();
+  PostingList::Read(buffer_pool_manager_, value, result);
+  if (direction_ == ScanDirection::BACKWARD) {
+    std::reverse(result->begin() + old_size, result->end());
+  }
+}
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
@@ -36,4 +264,8 @@ template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class IndexIterator<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+
+template class IndexIterator<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+
 }  // namespace bustub
@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_layout.cpp
+//
+// Identification: src/storage/index/key_layout.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/key_layout.h"
+
+#include <cmath>
+#include <limits>
+
+namespace bustub {
+
+namespace {
+
+/** Writes the low `size` bytes of `bits` to `out`, most significant byte first. */
+inline void StoreBigEndian(uint64_t bits, uint32_t size, char *out) {
+  for (uint32_t i = 0; i < size; i++) {
+    out[i] = static_cast<char>(bits >> (8 * (size - 1 - i)));
+  }
+}
+
+/** Reads `size` little-endian bytes as a sign-extended integer. */
+inline uint64_t LoadSigned(const char *in, uint32_t size) {
+  switch (size) {
+    case 1:
+      return static_cast<uint64_t>(static_cast<int64_t>(*reinterpret_cast<const int8_t *>(in)));
+    case 2: {
+      int16_t v;
+      memcpy(&v, in, sizeof(v));
+      return static_cast<uint64_t>(static_cast<int64_t>(v));
+    }
+    case 4: {
+      int32_t v;
+      memcpy(&v, in, sizeof(v));
+      return static_cast<uint64_t>(static_cast<int64_t>(v));
+    }
+    default: {
+      int64_t v;
+      memcpy(&v, in, sizeof(v));
+      return static_cast<uint64_t>(v);
+    }
+  }
+}
+
+}  // namespace
+
+KeyLayout::KeyLayout(const Schema *key_schema) {
+  columns_.reserve(key_schema->GetColumnCount());
+  for (const auto &col : key_schema->GetColumns()) {
+    if (!col.IsInlined()) {
+      fixed_width_ = false;
+    }
+    columns_.push_back({col.GetType(), col.GetOffset(), col.GetFixedLength()});
+  }
+  length_ = key_schema->GetLength();
+}
+
+void KeyLayout::Normalize(const char *raw, char *out) const {
+  BUSTUB_ASSERT(fixed_width_, "Only fixed-width keys can be normalized.");
+  for (const auto &col : columns_) {
+    const char *in = raw + col.offset_;
+    uint64_t bits;
+    switch (col.type_) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+      case TypeId::SMALLINT:
+      case TypeId::INTEGER:
+      case TypeId::BIGINT:
+        // Flip the sign bit so that two's complement orders as unsigned.
+        bits = LoadSigned(in, col.size_) ^ (uint64_t{1} << (8 * col.size_ - 1));
+        break;
+      case TypeId::DECIMAL: {
+        double value;
+        memcpy(&value, in, sizeof(value));
+        // Equal keys must have equal bytes: -0.0 becomes 0.0, and every NaN the same NaN, which orders last.
+        if (value == 0) {
+          value = 0;
+        } else if (std::isnan(value)) {
+          value = std::numeric_limits<double>::quiet_NaN();
+        }
+        memcpy(&bits, &value, sizeof(bits));
+        // Negative numbers order in reverse, so flip every bit; positive numbers only need the sign bit set.
+        bits = (bits >> 63) != 0 ? ~bits : bits ^ (uint64_t{1} << 63);
+        break;
+      }
+      case TypeId::TIMESTAMP:
+        memcpy(&bits, in, sizeof(bits));
+        break;
+      default:
+        UNREACHABLE("Cannot normalize a key column that is not fixed-width.");
+    }
+    StoreBigEndian(bits, col.size_, out + col.offset_);
+  }
+}
+
+void KeyLayout::DenormalizeColumn(TypeId type, uint32_t size, const char *in, char *out) {
+  uint64_t bits = 0;
+  for (uint32_t i = 0; i < size; i++) {
+    bits = (bits << 8) | static_cast<uint8_t>(in[i]);
+  }
+  switch (type) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+    case TypeId::SMALLINT:
+    case TypeId::INTEGER:
+    case TypeId::BIGINT:
+      bits ^= uint64_t{1} << (8 * size - 1);
+      break;
+    case TypeId::DECIMAL:
+      bits = (bits >> 63) != 0 ? bits ^ (uint64_t{1} << 63) : ~bits;
+      break;
+    case TypeId::TIMESTAMP:
+      break;
+    default:
+      UNREACHABLE("Cannot denormalize a key column that is not fixed-width.");
+  }
+  // the raw format is little-endian, so the low bytes come first
+  for (uint32_t i = 0; i < size; i++) {
+    out[i] = static_cast<char>(bits >> (8 * i));
+  }
+}
+
+void KeyLayout::NormalizeBigint(int64_t value, char *out) {
+  StoreBigEndian(static_cast<uint64_t>(value) ^ (uint64_t{1} << 63), sizeof(int64_t), out);
+}
+
+int64_t KeyLayout::DenormalizeBigint(const char *in) {
+  uint64_t bits = 0;
+  for (uint32_t i = 0; i < sizeof(int64_t); i++) {
+    bits = (bits << 8) | static_cast<uint8_t>(in[i]);
+  }
+  return static_cast<int64_t>(bits ^ (uint64_t{1} << 63));
+}
+
+}  // namespace bustub
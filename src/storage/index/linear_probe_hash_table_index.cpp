@@ -19,6 +19,9 @@ void HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *
   KeyType index_key;
   index_key.SetFromKey(key);
 
+  if (bloom_filter_ != nullptr) {
+    bloom_filter_->Insert(BloomFilter::Hash(&index_key, sizeof(KeyType)));
+  }
   container_.Insert(transaction, index_key, rid);
 }
 
@@ -37,6 +40,10 @@ void HASH_TABLE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result,
   KeyType index_key;
   index_key.SetFromKey(key);
 
+  // a key the filter rules out is not in the index, so skip the probe
+  if (bloom_filter_ != nullptr && !bloom_filter_->MayContain(BloomFilter::Hash(&index_key, sizeof(KeyType)))) {
+    return;
+  }
   container_.GetValue(transaction, index_key, result);
 }
 template class LinearProbeHashTableIndex<GenericKey<4>, RID, GenericComparator<4>>;
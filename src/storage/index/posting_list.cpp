@@ -0,0 +1,335 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// posting_list.cpp
+//
+// Identification: src/storage/index/posting_list.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <utility>
+
+#include "common/exception.h"
+#include "storage/index/posting_list.h"
+
+namespace bustub {
+
+namespace {
+
+bool RidLess(const RID &lhs, const RID &rhs) { return lhs.Get() < rhs.Get(); }
+
+}  // namespace
+
+bool PostingList::Insert(BufferPoolManager *bpm, RID *value, const RID &rid, page_id_t *shared_page_id) {
+  if (!IsReference(*value)) {
+    if (*value == rid) {
+      return false;
+    }
+    // the second RID of the key: move both of them to a small list
+    RID rids[2] = {*value, rid};
+    if (RidLess(rids[1], rids[0])) {
+      std::swap(rids[0], rids[1]);
+    }
+    *value = BuildSmallList(bpm, rids, 2, shared_page_id);
+    return true;
+  }
+  if (IsSmallList(*value)) {
+    return InsertIntoSmallList(bpm, value, rid);
+  }
+
+  BPlusTreePostingPage *head = FetchPostingPage(bpm, value->GetPageId());
+  BPlusTreePostingPage *target = FindPage(bpm, head, rid);
+  std::vector<RID> rids;
+  target->Decode(&rids);
+  auto it = std::lower_bound(rids.begin(), rids.end(), rid, RidLess);
+  if (it != rids.end() && *it == rid) {
+    bpm->UnpinPage(target->GetPageId(), false);
+    bpm->UnpinPage(head->GetPageId(), false);
+    return false;
+  }
+  bool append = it == rids.end() && target->GetNextPageId() == INVALID_PAGE_ID;
+  rids.insert(it, rid);
+  int count = static_cast<int>(rids.size());
+  int stored = target->Encode(rids.data(), count);
+  if (stored < count) {
+    // the page is full. An append leaves it packed and starts a new tail, any other insert splits it in half so that
+    // the pages keep room for the RIDs that fall between theirs
+    if (!append) {
+      stored = target->Encode(rids.data(), count / 2);
+    }
+    BPlusTreePostingPage *overflow = NewPostingPage(bpm);
+    overflow->Encode(rids.data() + stored, count - stored);
+    overflow->SetPrevPageId(target->GetPageId());
+    overflow->SetNextPageId(target->GetNextPageId());
+    if (target->GetNextPageId() != INVALID_PAGE_ID) {
+      BPlusTreePostingPage *next = FetchPostingPage(bpm, target->GetNextPageId());
+      next->SetPrevPageId(overflow->GetPageId());
+      bpm->UnpinPage(next->GetPageId(), true);
+    } else {
+      head->SetTailPageId(overflow->GetPageId());
+    }
+    target->SetNextPageId(overflow->GetPageId());
+    bpm->UnpinPage(overflow->GetPageId(), true);
+  }
+  bpm->UnpinPage(target->GetPageId(), true);
+  bpm->UnpinPage(head->GetPageId(), true);
+  return true;
+}
+
+bool PostingList::Remove(BufferPoolManager *bpm, RID *value, const RID &rid) {
+  if (IsSmallList(*value)) {
+    return RemoveFromSmallList(bpm, value, rid);
+  }
+  BPlusTreePostingPage *head = FetchPostingPage(bpm, value->GetPageId());
+  BPlusTreePostingPage *target = FindPage(bpm, head, rid);
+  std::vector<RID> rids;
+  target->Decode(&rids);
+  auto it = std::lower_bound(rids.begin(), rids.end(), rid, RidLess);
+  if (it == rids.end() || !(*it == rid)) {
+    bpm->UnpinPage(target->GetPageId(), false);
+    bpm->UnpinPage(head->GetPageId(), false);
+    return false;
+  }
+  rids.erase(it);
+  target->Encode(rids.data(), static_cast<int>(rids.size()));
+
+  page_id_t head_id = head->GetPageId();
+  page_id_t target_id = target->GetPageId();
+  bool delete_target = target->GetSize() == 0;
+  if (delete_target) {
+    // unlink the empty page; the list still has at least one RID, so it is never the only page
+    page_id_t prev_id = target->GetPrevPageId();
+    page_id_t next_id = target->GetNextPageId();
+    if (prev_id != INVALID_PAGE_ID) {
+      BPlusTreePostingPage *prev = FetchPostingPage(bpm, prev_id);
+      prev->SetNextPageId(next_id);
+      bpm->UnpinPage(prev_id, true);
+    }
+    if (next_id != INVALID_PAGE_ID) {
+      BPlusTreePostingPage *next = FetchPostingPage(bpm, next_id);
+      next->SetPrevPageId(prev_id);
+      if (target_id == head_id) {
+        next->SetTailPageId(head->GetTailPageId());
+      }
+      bpm->UnpinPage(next_id, true);
+    } else {
+      head->SetTailPageId(prev_id);
+    }
+    if (target_id == head_id) {
+      head_id = next_id;
+    }
+  }
+  bpm->UnpinPage(target_id, true);
+  bpm->UnpinPage(head->GetPageId(), true);
+  if (delete_target) {
+    bpm->DeletePage(target_id);
+  }
+
+  // the last remaining RID goes back inline
+  head = FetchPostingPage(bpm, head_id);
+  bool inline_rid = head->GetSize() == 1 && head->GetNextPageId() == INVALID_PAGE_ID;
+  *value = inline_rid ? head->GetFirst() : MakeReference(head_id);
+  bpm->UnpinPage(head_id, false);
+  if (inline_rid) {
+    bpm->DeletePage(head_id);
+  }
+  return true;
+}
+
+RID PostingList::Build(BufferPoolManager *bpm, const RID *rids, int count, page_id_t *shared_page_id) {
+  if (count == 1) {
+    return rids[0];
+  }
+  if (count <= SMALL_POSTING_LIST_SIZE) {
+    return BuildSmallList(bpm, rids, count, shared_page_id);
+  }
+  return BuildChain(bpm, rids, count);
+}
+
+RID PostingList::BuildChain(BufferPoolManager *bpm, const RID *rids, int count) {
+  BPlusTreePostingPage *head = NewPostingPage(bpm);
+  int stored = head->Encode(rids, count);
+  BPlusTreePostingPage *tail = head;
+  while (stored < count) {
+    BPlusTreePostingPage *page = NewPostingPage(bpm);
+    stored += page->Encode(rids + stored, count - stored);
+    page->SetPrevPageId(tail->GetPageId());
+    tail->SetNextPageId(page->GetPageId());
+    if (tail != head) {
+      bpm->UnpinPage(tail->GetPageId(), true);
+    }
+    tail = page;
+  }
+  head->SetTailPageId(tail->GetPageId());
+  if (tail != head) {
+    bpm->UnpinPage(tail->GetPageId(), true);
+  }
+  page_id_t head_id = head->GetPageId();
+  bpm->UnpinPage(head_id, true);
+  return MakeReference(head_id);
+}
+
+void PostingList::Read(BufferPoolManager *bpm, const RID &value, std::vector<RID> *result) {
+  if (IsSmallList(value)) {
+    BPlusTreeSharedPostingPage *page = FetchSharedPage(bpm, value.GetPageId());
+    page->Decode(SlotOf(value), result);
+    bpm->UnpinPage(value.GetPageId(), false);
+    return;
+  }
+  page_id_t page_id = value.GetPageId();
+  while (page_id != INVALID_PAGE_ID) {
+    BPlusTreePostingPage *page = FetchPostingPage(bpm, page_id);
+    page->Decode(result);
+    page_id_t next_id = page->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+    page_id = next_id;
+  }
+}
+
+bool PostingList::HasFreeSlot(BufferPoolManager *bpm, page_id_t shared_page_id) {
+  bool full = FetchSharedPage(bpm, shared_page_id)->IsFull();
+  bpm->UnpinPage(shared_page_id, false);
+  return !full;
+}
+
+void PostingList::Destroy(BufferPoolManager *bpm, const RID &value) {
+  if (IsSmallList(value)) {
+    FreeSmallList(bpm, value);
+    return;
+  }
+  page_id_t page_id = value.GetPageId();
+  while (page_id != INVALID_PAGE_ID) {
+    BPlusTreePostingPage *page = FetchPostingPage(bpm, page_id);
+    page_id_t next_id = page->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+    bpm->DeletePage(page_id);
+    page_id = next_id;
+  }
+}
+
+BPlusTreePostingPage *PostingList::FetchPostingPage(BufferPoolManager *bpm, page_id_t page_id) {
+  Page *page = bpm->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch a posting list page.");
+  }
+  return reinterpret_cast<BPlusTreePostingPage *>(page->GetData());
+}
+
+BPlusTreePostingPage *PostingList::NewPostingPage(BufferPoolManager *bpm) {
+  page_id_t page_id;
+  Page *page = bpm->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate a new posting list page.");
+  }
+  auto *posting_page = reinterpret_cast<BPlusTreePostingPage *>(page->GetData());
+  posting_page->Init(page_id);
+  return posting_page;
+}
+
+BPlusTreeSharedPostingPage *PostingList::FetchSharedPage(BufferPoolManager *bpm, page_id_t page_id) {
+  Page *page = bpm->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch a shared posting list page.");
+  }
+  return reinterpret_cast<BPlusTreeSharedPostingPage *>(page->GetData());
+}
+
+RID PostingList::BuildSmallList(BufferPoolManager *bpm, const RID *rids, int count, page_id_t *shared_page_id) {
+  BPlusTreeSharedPostingPage *page = nullptr;
+  if (*shared_page_id != INVALID_PAGE_ID) {
+    page = FetchSharedPage(bpm, *shared_page_id);
+    if (page->IsFull()) {
+      bpm->UnpinPage(*shared_page_id, false);
+      page = nullptr;
+    }
+  }
+  if (page == nullptr) {
+    Page *new_page = bpm->NewPage(shared_page_id);
+    if (new_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate a new shared posting list page.");
+    }
+    page = reinterpret_cast<BPlusTreeSharedPostingPage *>(new_page->GetData());
+    page->Init(*shared_page_id);
+  }
+  int slot = page->Allocate(rids, count);
+  bpm->UnpinPage(*shared_page_id, true);
+  return MakeSmallList(*shared_page_id, slot);
+}
+
+void PostingList::FreeSmallList(BufferPoolManager *bpm, const RID &value) {
+  BPlusTreeSharedPostingPage *page = FetchSharedPage(bpm, value.GetPageId());
+  page->Free(SlotOf(value));
+  bool empty = page->GetUsedSlots() == 0;
+  bpm->UnpinPage(value.GetPageId(), true);
+  if (empty) {
+    bpm->DeletePage(value.GetPageId());
+  }
+}
+
+bool PostingList::InsertIntoSmallList(BufferPoolManager *bpm, RID *value, const RID &rid) {
+  BPlusTreeSharedPostingPage *page = FetchSharedPage(bpm, value->GetPageId());
+  std::vector<RID> rids;
+  page->Decode(SlotOf(*value), &rids);
+  auto it = std::lower_bound(rids.begin(), rids.end(), rid, RidLess);
+  if (it != rids.end() && *it == rid) {
+    bpm->UnpinPage(value->GetPageId(), false);
+    return false;
+  }
+  rids.insert(it, rid);
+  if (rids.size() <= SMALL_POSTING_LIST_SIZE) {
+    page->Encode(SlotOf(*value), rids.data(), static_cast<int>(rids.size()));
+    bpm->UnpinPage(value->GetPageId(), true);
+    return true;
+  }
+  // the list outgrew its slot: move it to a chain of its own
+  bpm->UnpinPage(value->GetPageId(), false);
+  FreeSmallList(bpm, *value);
+  *value = BuildChain(bpm, rids.data(), static_cast<int>(rids.size()));
+  return true;
+}
+
+bool PostingList::RemoveFromSmallList(BufferPoolManager *bpm, RID *value, const RID &rid) {
+  BPlusTreeSharedPostingPage *page = FetchSharedPage(bpm, value->GetPageId());
+  std::vector<RID> rids;
+  page->Decode(SlotOf(*value), &rids);
+  auto it = std::lower_bound(rids.begin(), rids.end(), rid, RidLess);
+  if (it == rids.end() || !(*it == rid)) {
+    bpm->UnpinPage(value->GetPageId(), false);
+    return false;
+  }
+  rids.erase(it);
+  if (rids.size() > 1) {
+    page->Encode(SlotOf(*value), rids.data(), static_cast<int>(rids.size()));
+    bpm->UnpinPage(value->GetPageId(), true);
+    return true;
+  }
+  // the last remaining RID goes back inline
+  bpm->UnpinPage(value->GetPageId(), false);
+  FreeSmallList(bpm, *value);
+  *value = rids[0];
+  return true;
+}
+
+BPlusTreePostingPage *PostingList::FindPage(BufferPoolManager *bpm, BPlusTreePostingPage *head, const RID &rid) {
+  // RIDs mostly arrive in table order, so check the tail before walking the chain
+  BPlusTreePostingPage *tail = FetchPostingPage(bpm, head->GetTailPageId());
+  if (!RidLess(rid, tail->GetFirst())) {
+    return tail;
+  }
+  bpm->UnpinPage(tail->GetPageId(), false);
+  page_id_t page_id = head->GetPageId();
+  while (true) {
+    BPlusTreePostingPage *page = FetchPostingPage(bpm, page_id);
+    if (!RidLess(page->GetLast(), rid) || page->GetNextPageId() == INVALID_PAGE_ID) {
+      return page;
+    }
+    page_id = page->GetNextPageId();
+    bpm->UnpinPage(page->GetPageId(), false);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,118 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_posting_page.cpp
+//
+// Identification: src/storage/page/b_plus_tree_posting_page.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/b_plus_tree_posting_page.h"
+
+namespace bustub {
+
+void BPlusTreePostingPage::Init(page_id_t page_id) {
+  page_id_ = page_id;
+  lsn_ = INVALID_LSN;
+  next_page_id_ = INVALID_PAGE_ID;
+  prev_page_id_ = INVALID_PAGE_ID;
+  tail_page_id_ = page_id;
+  size_ = 0;
+  bytes_used_ = 0;
+  padding_ = 0;
+  first_rid_ = 0;
+  last_rid_ = 0;
+}
+
+void BPlusTreePostingPage::Decode(std::vector<RID> *result) const {
+  if (size_ == 0) {
+    return;
+  }
+  result->reserve(result->size() + size_);
+  auto rid = static_cast<uint64_t>(first_rid_);
+  result->emplace_back(static_cast<int64_t>(rid));
+  int offset = 0;
+  for (int i = 1; i < size_; i++) {
+    uint64_t delta = 0;
+    int shift = 0;
+    uint8_t byte;
+    do {
+      byte = data_[offset++];
+      delta |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      shift += 7;
+    } while ((byte & 0x80) != 0);
+    rid += delta;
+    result->emplace_back(static_cast<int64_t>(rid));
+  }
+}
+
+int BPlusTreePostingPage::Encode(const RID *rids, int count) {
+  size_ = 0;
+  bytes_used_ = 0;
+  if (count == 0) {
+    return 0;
+  }
+  first_rid_ = rids[0].Get();
+  int stored = 1;
+  for (; stored < count; stored++) {
+    uint64_t delta = static_cast<uint64_t>(rids[stored].Get()) - static_cast<uint64_t>(rids[stored - 1].Get());
+    int length = 1;
+    for (uint64_t rest = delta >> 7; rest != 0; rest >>= 7) {
+      length++;
+    }
+    if (bytes_used_ + length > static_cast<int>(POSTING_PAGE_DATA_SIZE)) {
+      break;
+    }
+    for (; delta >= 0x80; delta >>= 7) {
+      data_[bytes_used_++] = static_cast<uint8_t>(delta | 0x80);
+    }
+    data_[bytes_used_++] = static_cast<uint8_t>(delta);
+  }
+  size_ = stored;
+  last_rid_ = rids[stored - 1].Get();
+  return stored;
+}
+
+void BPlusTreeSharedPostingPage::Init(page_id_t page_id) {
+  page_id_ = page_id;
+  lsn_ = INVALID_LSN;
+  used_slots_ = 0;
+  padding_ = 0;
+  for (size_t slot = 0; slot < SHARED_POSTING_PAGE_SLOTS; slot++) {
+    slots_[slot].size_ = 0;
+  }
+}
+
+int BPlusTreeSharedPostingPage::Allocate(const RID *rids, int count) {
+  int slot = 0;
+  while (slots_[slot].size_ != 0) {
+    slot++;
+  }
+  used_slots_++;
+  Encode(slot, rids, count);
+  return slot;
+}
+
+void BPlusTreeSharedPostingPage::Free(int slot) {
+  slots_[slot].size_ = 0;
+  used_slots_--;
+}
+
+void BPlusTreeSharedPostingPage::Encode(int slot, const RID *rids, int count) {
+  slots_[slot].size_ = count;
+  slots_[slot].padding_ = 0;
+  for (int i = 0; i < count; i++) {
+    slots_[slot].rids_[i] = rids[i].Get();
+  }
+}
+
+void BPlusTreeSharedPostingPage::Decode(int slot, std::vector<RID> *result) const {
+  for (int i = 0; i < slots_[slot].size_; i++) {
+    result->emplace_back(slots_[slot].rids_[i]);
+  }
+}
+
+}  // namespace bustub
@@ -10,6 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 #include "storage/page/hash_table_block_page.h"
 #include "storage/index/generic_key.h"
 
@@ -17,30 +21,105 @@ namespace bustub {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 KeyType HASH_TABLE_BLOCK_TYPE::KeyAt(slot_offset_t bucket_ind) const {
-  return {};
+  return array_[bucket_ind].first;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 ValueType HASH_TABLE_BLOCK_TYPE::ValueAt(slot_offset_t bucket_ind) const {
-  return {};
+  return array_[bucket_ind].second;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BLOCK_TYPE::Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value, uint64_t hash,
+                                   Transaction *txn, LogManager *log_manager) {
+  uint8_t old_ctrl = ctrl_[bucket_ind].load();
+  if ((old_ctrl & 0x80) != 0) {
+    return false;
+  }
+  array_[bucket_ind] = MappingType(key, value);
+  // publish the pair only once it is written
+  ctrl_[bucket_ind].store(TagOf(hash), std::memory_order_release);
+  LogSlot(LogRecordType::HASH_INSERT, bucket_ind, old_ctrl, TagOf(hash), txn, log_manager);
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BLOCK_TYPE::Remove(slot_offset_t bucket_ind, Transaction *txn, LogManager *log_manager) {
+  // the slot stays occupied as a tombstone, so that probes continue past it
+  uint8_t old_ctrl = ctrl_[bucket_ind].exchange(TOMBSTONE);
+  LogSlot(LogRecordType::HASH_REMOVE, bucket_ind, old_ctrl, TOMBSTONE, txn, log_manager);
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-bool HASH_TABLE_BLOCK_TYPE::Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value) {
-  return false;
+void HASH_TABLE_BLOCK_TYPE::Clear(slot_offset_t bucket_ind) {
+  ctrl_[bucket_ind].store(EMPTY);
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BLOCK_TYPE::Remove(slot_offset_t bucket_ind) {}
+void HASH_TABLE_BLOCK_TYPE::MarkMoved(slot_offset_t bucket_ind, LogManager *log_manager) {
+  uint8_t old_ctrl = ctrl_[bucket_ind].exchange(MOVED);
+  LogSlot(LogRecordType::HASH_REMOVE, bucket_ind, old_ctrl, MOVED, nullptr, log_manager);
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BLOCK_TYPE::IsOccupied(slot_offset_t bucket_ind) const {
-  return false;
+  return ctrl_[bucket_ind].load() != EMPTY;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BLOCK_TYPE::IsReadable(slot_offset_t bucket_ind) const {
-  return false;
+  return (ctrl_[bucket_ind].load() & 0x80) != 0;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_BLOCK_TYPE::MatchGroup(slot_offset_t bucket_ind, uint64_t hash, uint32_t *empty) const {
+  static_assert(sizeof(std::atomic<uint8_t>) == 1, "The control bytes are compared as plain bytes.");
+  static_assert(BLOCK_GROUP_SIZE == 32, "The masks hold one bit per slot of a group.");
+  const auto *ctrl = reinterpret_cast<const uint8_t *>(ctrl_ + bucket_ind);
+  uint8_t tag = TagOf(hash);
+#if defined(__AVX2__)
+  __m256i group = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ctrl));
+  *empty = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(group, _mm256_setzero_si256())));
+  __m256i tags = _mm256_set1_epi8(static_cast<char>(tag));
+  return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(group, tags)));
+#elif defined(__SSE2__)
+  __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl));
+  __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl + 16));
+  __m128i zero = _mm_setzero_si128();
+  *empty = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(low, zero))) |
+           static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(high, zero))) << 16;
+  __m128i tags = _mm_set1_epi8(static_cast<char>(tag));
+  return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(low, tags))) |
+         static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(high, tags))) << 16;
+#else
+  uint32_t match = 0;
+  *empty = 0;
+  for (uint32_t i = 0; i < BLOCK_GROUP_SIZE; i++) {
+    match |= static_cast<uint32_t>(ctrl[i] == tag) << i;
+    *empty |= static_cast<uint32_t>(ctrl[i] == EMPTY) << i;
+  }
+  return match;
+#endif
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BLOCK_TYPE::LogSlot(LogRecordType type, slot_offset_t bucket_ind, uint8_t old_ctrl, uint8_t new_ctrl,
+                                    Transaction *txn, LogManager *log_manager) {
+  if (!enable_logging || log_manager == nullptr) {
+    return;
+  }
+  const auto *page = reinterpret_cast<const char *>(this);
+  const auto *pair = reinterpret_cast<const char *>(&array_[bucket_ind]);
+  auto ctrl_offset = static_cast<uint32_t>(reinterpret_cast<const char *>(&ctrl_[bucket_ind]) - page);
+  auto pair_offset = static_cast<uint32_t>(pair - page);
+  // writes that belong to no transaction are never undone
+  LogRecord log_record(txn == nullptr ? INVALID_TXN_ID : txn->GetTransactionId(),
+                       txn == nullptr ? INVALID_LSN : txn->GetPrevLSN(), type, page_id_, ctrl_offset, old_ctrl,
+                       new_ctrl, pair_offset, pair, sizeof(MappingType));
+  lsn_ = log_manager->AppendLogRecord(&log_record);
+  if (txn != nullptr) {
+    txn->SetPrevLSN(lsn_);
+  }
 }
 
 // DO NOT REMOVE ANYTHING BELOW THIS LINE
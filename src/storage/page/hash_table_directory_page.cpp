@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_page.cpp
+//
+// Identification: src/storage/page/hash_table_directory_page.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+
+#include "storage/page/hash_table_directory_page.h"
+
+namespace bustub {
+
+page_id_t HashTableDirectoryPage::GetPageId() const { return page_id_; }
+
+void HashTableDirectoryPage::SetPageId(bustub::page_id_t page_id) { page_id_ = page_id; }
+
+lsn_t HashTableDirectoryPage::GetLSN() const { return lsn_; }
+
+void HashTableDirectoryPage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
+
+uint32_t HashTableDirectoryPage::GetGlobalDepth() const { return global_depth_; }
+
+uint32_t HashTableDirectoryPage::GetGlobalDepthMask() const { return Size() - 1; }
+
+void HashTableDirectoryPage::IncrGlobalDepth() {
+  assert(global_depth_ < MAX_DEPTH);
+  uint32_t size = Size();
+  if (size < DIRECTORY_ARRAY_SIZE) {
+    memcpy(bucket_page_ids_ + size, bucket_page_ids_, size * sizeof(page_id_t));
+    memcpy(local_depths_ + size, local_depths_, size * sizeof(uint8_t));
+  }
+  global_depth_++;
+}
+
+uint32_t HashTableDirectoryPage::Size() const { return 1U << global_depth_; }
+
+uint32_t HashTableDirectoryPage::NumPages() const { return (Size() - 1) / DIRECTORY_ARRAY_SIZE + 1; }
+
+page_id_t HashTableDirectoryPage::GetDirectoryPageId(uint32_t page_idx) const {
+  assert(page_idx < MAX_PAGES);
+  return page_idx == 0 ? page_id_ : directory_page_ids_[page_idx];
+}
+
+void HashTableDirectoryPage::SetDirectoryPageId(uint32_t page_idx, page_id_t directory_page_id) {
+  assert(page_idx > 0 && page_idx < MAX_PAGES);
+  directory_page_ids_[page_idx] = directory_page_id;
+}
+
+page_id_t HashTableDirectoryPage::GetBucketPageId(uint32_t bucket_idx) const {
+  assert(bucket_idx < DIRECTORY_ARRAY_SIZE);
+  return bucket_page_ids_[bucket_idx];
+}
+
+void HashTableDirectoryPage::SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id) {
+  assert(bucket_idx < DIRECTORY_ARRAY_SIZE);
+  bucket_page_ids_[bucket_idx] = bucket_page_id;
+}
+
+uint32_t HashTableDirectoryPage::GetLocalDepth(uint32_t bucket_idx) const {
+  assert(bucket_idx < DIRECTORY_ARRAY_SIZE);
+  return local_depths_[bucket_idx];
+}
+
+void HashTableDirectoryPage::SetLocalDepth(uint32_t bucket_idx, uint32_t local_depth) {
+  assert(bucket_idx < DIRECTORY_ARRAY_SIZE && local_depth <= MAX_DEPTH);
+  local_depths_[bucket_idx] = static_cast<uint8_t>(local_depth);
+}
+
+}  // namespace bustub
@@ -0,0 +1,220 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pax_page.cpp
+//
+// Identification: src/storage/page/pax_page.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/pax_page.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace bustub {
+
+std::vector<uint16_t> PaxPage::ColumnWidths(const Schema &schema) {
+  std::vector<uint16_t> widths;
+  widths.reserve(schema.GetColumnCount() + 1);
+  for (const auto &column : schema.GetColumns()) {
+    widths.push_back(static_cast<uint16_t>(column.GetFixedLength()));
+  }
+  widths.push_back(static_cast<uint16_t>(schema.GetFixedLength() - schema.GetNullBitmapOffset()));
+  return widths;
+}
+
+uint32_t PaxPage::CapacityFor(const std::vector<uint16_t> &widths, uint32_t tuple_size) {
+  // Leave room for a forward in the tail region of a full page, in case a tuple outgrows it.
+  uint32_t space = PAGE_SIZE - OFFSET_TUPLE_OFFSET - FooterSize(widths.size()) - sizeof(RID);
+  uint32_t capacity = space / (SIZE_TUPLE + std::max<uint32_t>(tuple_size, 1));
+  return std::clamp<uint32_t>(capacity, 1, UINT16_MAX);
+}
+
+uint32_t PaxPage::MaxTupleSize(const std::vector<uint16_t> &widths, uint32_t capacity) {
+  uint32_t fixed_length = 0;
+  for (auto width : widths) {
+    fixed_length += width;
+  }
+  return PAGE_SIZE - OFFSET_TUPLE_OFFSET - FooterSize(widths.size()) - capacity * (SIZE_TUPLE + fixed_length) +
+         fixed_length;
+}
+
+void PaxPage::Init(page_id_t page_id, page_id_t prev_page_id, const std::vector<uint16_t> &widths, uint32_t capacity,
+                   LogManager *log_manager, Transaction *txn) {
+  uint32_t footer_size = FooterSize(widths.size());
+  InitHeader(page_id, PAGE_SIZE - footer_size, prev_page_id);
+  auto column_count = static_cast<uint16_t>(widths.size());
+  auto slots = static_cast<uint16_t>(capacity);
+  memcpy(GetData() + PAGE_SIZE - footer_size, widths.data(), widths.size() * sizeof(uint16_t));
+  memcpy(GetData() + PAGE_SIZE - 2 * sizeof(uint16_t), &column_count, sizeof(uint16_t));
+  memcpy(GetData() + PAGE_SIZE - sizeof(uint16_t), &slots, sizeof(uint16_t));
+  uint32_t free_space_pointer = GetFreeSpacePointer() | PAX_FLAG;
+  memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
+  LogNewPage(log_manager, txn, widths, capacity);
+}
+
+uint32_t PaxPage::GetFixedLength() {
+  uint32_t fixed_length = 0;
+  for (uint32_t c = 0; c < GetColumnCount(); c++) {
+    fixed_length += GetColumnWidth(c);
+  }
+  return fixed_length;
+}
+
+const char *PaxPage::GetMinipage(uint32_t c) {
+  uint32_t offset = OffsetOfMinipages();
+  for (uint32_t i = 0; i < c; i++) {
+    offset += GetCapacity() * GetColumnWidth(i);
+  }
+  return GetData() + offset;
+}
+
+uint32_t PaxPage::TailLength(uint32_t tuple_size) {
+  if (tuple_size == 0) {
+    return 0;
+  }
+  if ((tuple_size & FORWARD_FLAG) != 0) {
+    return SizeOf(tuple_size);
+  }
+  BUSTUB_ASSERT(SizeOf(tuple_size) >= GetFixedLength(), "A tuple is at least as large as its fixed-size part.");
+  return SizeOf(tuple_size) - GetFixedLength();
+}
+
+uint32_t PaxPage::FindFreeSlot(uint32_t slot) {
+  uint32_t i;
+  for (i = slot; i < GetTupleCount(); i++) {
+    if (GetTupleSize(i) == 0) {
+      break;
+    }
+  }
+  return i;
+}
+
+void PaxPage::Scatter(uint32_t slot_num, const char *data) {
+  uint32_t capacity = GetCapacity();
+  char *minipage = GetData() + OffsetOfMinipages();
+  for (uint32_t c = 0; c < GetColumnCount(); c++) {
+    uint32_t width = GetColumnWidth(c);
+    memcpy(minipage + slot_num * width, data, width);
+    data += width;
+    minipage += capacity * width;
+  }
+}
+
+void PaxPage::Gather(uint32_t slot_num, char *data) {
+  uint32_t capacity = GetCapacity();
+  const char *minipage = GetData() + OffsetOfMinipages();
+  for (uint32_t c = 0; c < GetColumnCount(); c++) {
+    uint32_t width = GetColumnWidth(c);
+    memcpy(data, minipage + slot_num * width, width);
+    data += width;
+    minipage += capacity * width;
+  }
+}
+
+uint32_t PaxPage::PlaceTail(const char *data, uint32_t length) {
+  if (length == 0) {
+    return 0;
+  }
+  SetFreeSpacePointer(GetFreeSpacePointer() - length);
+  memcpy(GetData() + GetFreeSpacePointer(), data, length);
+  return GetFreeSpacePointer();
+}
+
+void PaxPage::RemoveTail(uint32_t slot_num) {
+  uint32_t tail_offset = GetTupleOffsetAtSlot(slot_num);
+  uint32_t tail_length = TailLength(GetTupleSize(slot_num));
+  if (tail_length == 0) {
+    return;
+  }
+  uint32_t free_space_pointer = GetFreeSpacePointer();
+  BUSTUB_ASSERT(tail_offset >= free_space_pointer, "Free space appears before tails.");
+
+  memmove(GetData() + free_space_pointer + tail_length, GetData() + free_space_pointer,
+          tail_offset - free_space_pointer);
+  SetFreeSpacePointer(free_space_pointer + tail_length);
+  SetTupleOffsetAtSlot(slot_num, 0);
+
+  // Update the offsets of the tails that moved; an empty tail has offset 0 and stays.
+  for (uint32_t i = 0; i < GetTupleCount(); ++i) {
+    uint32_t tail_offset_i = GetTupleOffsetAtSlot(i);
+    if (tail_offset_i != 0 && tail_offset_i < tail_offset) {
+      SetTupleOffsetAtSlot(i, tail_offset_i + tail_length);
+    }
+  }
+}
+
+bool PaxPage::PlaceTuple(const Tuple &tuple, uint32_t flags, RID *rid, uint32_t *slot) {
+  BUSTUB_ASSERT(tuple.size_ > 0, "Cannot have empty tuples.");
+  uint32_t tail_length = TailLength(tuple.size_ | flags);
+  uint32_t i = FindFreeSlot(*slot);
+  if (i == GetCapacity() || GetTailSpaceRemaining() < tail_length) {
+    return false;
+  }
+
+  Scatter(i, tuple.data_);
+  SetTupleOffsetAtSlot(i, PlaceTail(tuple.data_ + GetFixedLength(), tail_length));
+  SetTupleSize(i, tuple.size_ | flags);
+
+  rid->Set(GetTablePageId(), i);
+  if (i == GetTupleCount()) {
+    SetTupleCount(GetTupleCount() + 1);
+  }
+  *slot = i + 1;
+  return true;
+}
+
+bool PaxPage::HasRoomFor(uint32_t slot_num, uint32_t tuple_size) {
+  return GetTailSpaceRemaining() + TailLength(GetTupleSize(slot_num)) >= TailLength(tuple_size);
+}
+
+void PaxPage::CopyTuple(uint32_t slot_num, Tuple *tuple) {
+  uint32_t tuple_size = GetTupleSize(slot_num);
+  tuple->Reserve(SizeOf(tuple_size));
+  uint32_t tail_length = TailLength(tuple_size);
+  if ((tuple_size & FORWARD_FLAG) == 0) {
+    Gather(slot_num, tuple->data_);
+  }
+  memcpy(tuple->data_ + tuple->size_ - tail_length, GetTail(slot_num), tail_length);
+}
+
+void PaxPage::ReplaceTuple(uint32_t slot_num, const Tuple &new_tuple, uint32_t flags) {
+  RemoveTail(slot_num);
+  uint32_t tail_length = TailLength(new_tuple.size_ | flags);
+  if ((flags & FORWARD_FLAG) == 0) {
+    Scatter(slot_num, new_tuple.data_);
+  }
+  SetTupleOffsetAtSlot(slot_num, PlaceTail(new_tuple.data_ + new_tuple.size_ - tail_length, tail_length));
+  SetTupleSize(slot_num, new_tuple.size_ | flags);
+}
+
+void PaxPage::RemoveTuple(uint32_t slot_num) {
+  RemoveTail(slot_num);
+  SetTupleSize(slot_num, 0);
+  SetTupleOffsetAtSlot(slot_num, 0);
+}
+
+uint32_t PaxPage::GetFreeSpace() {
+  if (FindFreeSlot(0) == GetCapacity()) {
+    return 0;
+  }
+  return GetTailSpaceRemaining() + GetFixedLength() + SIZE_TUPLE;
+}
+
+uint32_t PaxPage::GetUsedSpace() {
+  // The tuples take their tails, and the slots and minipage entries that they keep from other tuples.
+  uint32_t used_space = PAGE_SIZE - FooterSize(GetColumnCount()) - GetFreeSpacePointer();
+  uint32_t fixed_length = GetFixedLength();
+  for (uint32_t i = 0; i < GetTupleCount(); ++i) {
+    if (GetTupleSize(i) != 0) {
+      used_space += SIZE_TUPLE + fixed_length;
+    }
+  }
+  return used_space;
+}
+
+}  // namespace bustub
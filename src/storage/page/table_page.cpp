@@ -12,40 +12,102 @@
 
 #include "storage/page/table_page.h"
 
+#include <algorithm>
 #include <cassert>
+#include <utility>
+#include <vector>
+
+#include "storage/page/pax_page.h"
 
 namespace bustub {
 
 void TablePage::Init(page_id_t page_id, uint32_t page_size, page_id_t prev_page_id, LogManager *log_manager,
                      Transaction *txn) {
+  InitHeader(page_id, page_size, prev_page_id);
+  LogNewPage(log_manager, txn);
+}
+
+void TablePage::InitHeader(page_id_t page_id, uint32_t page_size, page_id_t prev_page_id) {
   // Set the page ID.
   memcpy(GetData(), &page_id, sizeof(page_id));
+  // Set the previous and next page IDs.
+  SetPrevPageId(prev_page_id);
+  SetNextPageId(INVALID_PAGE_ID);
+  SetFreeSpaceMapPageId(INVALID_PAGE_ID);
+  // Set the pointer as a whole, which makes a row page, see IsPax.
+  memcpy(GetData() + OFFSET_FREE_SPACE, &page_size, sizeof(uint32_t));
+  SetTupleCount(0);
+}
+
+void TablePage::LogNewPage(LogManager *log_manager, Transaction *txn, std::vector<uint16_t> pax_widths,
+                           uint32_t pax_capacity) {
   // Log that we are creating a new page.
   if (enable_logging) {
-    LogRecord log_record =
-        LogRecord(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::NEWPAGE, prev_page_id, page_id);
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::NEWPAGE, GetPrevPageId(),
+                         GetTablePageId(), std::move(pax_widths), pax_capacity);
     lsn_t lsn = log_manager->AppendLogRecord(&log_record);
     SetLSN(lsn);
     txn->SetPrevLSN(lsn);
   }
-  // Set the previous and next page IDs.
-  SetPrevPageId(prev_page_id);
-  SetNextPageId(INVALID_PAGE_ID);
-  SetFreeSpacePointer(page_size);
-  SetTupleCount(0);
 }
 
 bool TablePage::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, LockManager *lock_manager,
                             LogManager *log_manager) {
+  return InsertTuples(&tuple, 1, rid, txn, lock_manager, log_manager) == 1;
+}
+
+uint32_t TablePage::InsertTuples(const Tuple *tuples, uint32_t count, RID *rids, Transaction *txn,
+                                 LockManager *lock_manager, LogManager *log_manager, bool is_moved) {
+  uint32_t num_inserted = 0;
+  uint32_t slot = 0;
+  uint32_t flags = is_moved ? MOVED_FLAG : 0;
+  while (num_inserted < count && PlaceTuple(tuples[num_inserted], flags, &rids[num_inserted], &slot)) {
+    num_inserted++;
+  }
+
+  // Write the log record, a plain insert record if there is a single tuple.
+  if (enable_logging && num_inserted > 0) {
+    for (uint32_t i = 0; i < num_inserted; i++) {
+      BUSTUB_ASSERT(!txn->IsSharedLocked(rids[i]) && !txn->IsExclusiveLocked(rids[i]),
+                    "A new tuple should not be locked.");
+      // Acquire an exclusive lock on the new tuple.
+      bool locked = lock_manager->LockExclusive(txn, rids[i]);
+      BUSTUB_ASSERT(locked, "Locking a new tuple should always work.");
+    }
+    lsn_t lsn;
+    if (num_inserted == 1) {
+      LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::INSERT, rids[0], tuples[0],
+                           flags);
+      lsn = log_manager->AppendLogRecord(&log_record);
+    } else {
+      std::vector<uint32_t> slots;
+      slots.reserve(num_inserted);
+      for (uint32_t i = 0; i < num_inserted; i++) {
+        slots.push_back(rids[i].GetSlotNum());
+      }
+      LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::BULKINSERT, GetTablePageId(),
+                           std::move(slots), std::vector<Tuple>(tuples, tuples + num_inserted), flags);
+      lsn = log_manager->AppendLogRecord(&log_record);
+    }
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+  return num_inserted;
+}
+
+bool TablePage::PlaceTuple(const Tuple &tuple, uint32_t flags, RID *rid, uint32_t *slot) {
+  if (IsPax()) {
+    return AsPax()->PlaceTuple(tuple, flags, rid, slot);
+  }
   BUSTUB_ASSERT(tuple.size_ > 0, "Cannot have empty tuples.");
-  // If there is not enough space, then return false.
-  if (GetFreeSpaceRemaining() < tuple.size_ + SIZE_TUPLE) {
+  // If there is not enough space even in a reused slot, then return false.
+  if (GetFreeSpaceRemaining() < tuple.size_) {
     return false;
   }
 
   // Try to find a free slot to reuse.
   uint32_t i;
-  for (i = 0; i < GetTupleCount(); i++) {
+  for (i = *slot; i < GetTupleCount(); i++) {
     // If the slot is empty, i.e. its tuple has size 0,
     if (GetTupleSize(i) == 0) {
       // Then we break out of the loop at index i.
@@ -53,7 +115,7 @@ bool TablePage::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, Lock
     }
   }
 
-  // If there was no free slot left, and we cannot claim it from the free space, then we give up.
+  // If there was no free slot left, and we cannot claim a new one from the free space too, then we give up.
   if (i == GetTupleCount() && GetFreeSpaceRemaining() < tuple.size_ + SIZE_TUPLE) {
     return false;
   }
@@ -64,24 +126,13 @@ bool TablePage::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, Lock
 
   // Set the tuple.
   SetTupleOffsetAtSlot(i, GetFreeSpacePointer());
-  SetTupleSize(i, tuple.size_);
+  SetTupleSize(i, tuple.size_ | flags);
 
   rid->Set(GetTablePageId(), i);
   if (i == GetTupleCount()) {
     SetTupleCount(GetTupleCount() + 1);
   }
-
-  // Write the log record.
-  if (enable_logging) {
-    BUSTUB_ASSERT(!txn->IsSharedLocked(*rid) && !txn->IsExclusiveLocked(*rid), "A new tuple should not be locked.");
-    // Acquire an exclusive lock on the new tuple.
-    bool locked = lock_manager->LockExclusive(txn, *rid);
-    BUSTUB_ASSERT(locked, "Locking a new tuple should always work.");
-    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::INSERT, *rid, tuple);
-    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
-    SetLSN(lsn);
-    txn->SetPrevLSN(lsn);
-  }
+  *slot = i + 1;
   return true;
 }
 
@@ -129,6 +180,11 @@ bool TablePage::MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_m
 
 bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID &rid, Transaction *txn,
                             LockManager *lock_manager, LogManager *log_manager) {
+  return UpdateTuple(new_tuple, old_tuple, rid, txn, lock_manager, log_manager, false);
+}
+
+bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID &rid, Transaction *txn,
+                            LockManager *lock_manager, LogManager *log_manager, bool is_forward) {
   BUSTUB_ASSERT(new_tuple.size_ > 0, "Cannot have empty tuples.");
   uint32_t slot_num = rid.GetSlotNum();
   // If the slot number is invalid, abort the transaction.
@@ -146,21 +202,16 @@ bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID
     }
     return false;
   }
+  // The new value takes over the flags of the slot.
+  uint32_t flags = (tuple_size & (FORWARD_FLAG | MOVED_FLAG)) | (is_forward ? FORWARD_FLAG : 0);
   // If there is not enuogh space to update, we need to update via delete followed by an insert (not enough space).
-  if (GetFreeSpaceRemaining() + tuple_size < new_tuple.size_) {
+  if (!HasRoomFor(slot_num, new_tuple.size_ | flags)) {
     return false;
   }
 
   // Copy out the old value.
-  uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
-  old_tuple->size_ = tuple_size;
-  if (old_tuple->allocated_) {
-    delete[] old_tuple->data_;
-  }
-  old_tuple->data_ = new char[old_tuple->size_];
-  memcpy(old_tuple->data_, GetData() + tuple_offset, old_tuple->size_);
+  CopyTuple(slot_num, old_tuple);
   old_tuple->rid_ = rid;
-  old_tuple->allocated_ = true;
 
   if (enable_logging) {
     // Acquire an exclusive lock, upgrading from shared if necessary.
@@ -171,13 +222,41 @@ bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID
     } else if (!txn->IsExclusiveLocked(rid) && !lock_manager->LockExclusive(txn, rid)) {
       return false;
     }
-    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::UPDATE, rid, *old_tuple, new_tuple);
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::UPDATE, rid, *old_tuple, new_tuple,
+                         FlagsOf(tuple_size), flags);
     lsn_t lsn = log_manager->AppendLogRecord(&log_record);
     SetLSN(lsn);
     txn->SetPrevLSN(lsn);
   }
 
   // Perform the update.
+  ReplaceTuple(slot_num, new_tuple, flags);
+  return true;
+}
+
+bool TablePage::HasRoomFor(uint32_t slot_num, uint32_t tuple_size) {
+  if (IsPax()) {
+    return AsPax()->HasRoomFor(slot_num, tuple_size);
+  }
+  return GetFreeSpaceRemaining() + SizeOf(GetTupleSize(slot_num)) >= SizeOf(tuple_size);
+}
+
+void TablePage::CopyTuple(uint32_t slot_num, Tuple *tuple) {
+  if (IsPax()) {
+    AsPax()->CopyTuple(slot_num, tuple);
+    return;
+  }
+  tuple->Reserve(SizeOf(GetTupleSize(slot_num)));
+  memcpy(tuple->data_, GetData() + GetTupleOffsetAtSlot(slot_num), tuple->size_);
+}
+
+void TablePage::ReplaceTuple(uint32_t slot_num, const Tuple &new_tuple, uint32_t flags) {
+  if (IsPax()) {
+    AsPax()->ReplaceTuple(slot_num, new_tuple, flags);
+    return;
+  }
+  uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
+  uint32_t tuple_size = SizeOf(GetTupleSize(slot_num));
   uint32_t free_space_pointer = GetFreeSpacePointer();
   BUSTUB_ASSERT(tuple_offset >= free_space_pointer, "Offset should appear after current free space position.");
 
@@ -185,7 +264,7 @@ bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID
           tuple_offset - free_space_pointer);
   SetFreeSpacePointer(free_space_pointer + tuple_size - new_tuple.size_);
   memcpy(GetData() + tuple_offset + tuple_size - new_tuple.size_, new_tuple.data_, new_tuple.size_);
-  SetTupleSize(slot_num, new_tuple.size_);
+  SetTupleSize(slot_num, new_tuple.size_ | flags);
 
   // Update all tuple offsets.
   for (uint32_t i = 0; i < GetTupleCount(); ++i) {
@@ -194,38 +273,71 @@ bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID
       SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size - new_tuple.size_);
     }
   }
-  return true;
 }
 
-void TablePage::ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager) {
+void TablePage::ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager, Tuple *tuple) {
   uint32_t slot_num = rid.GetSlotNum();
   BUSTUB_ASSERT(slot_num < GetTupleCount(), "Cannot have more slots than tuples.");
 
-  uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
-  uint32_t tuple_size = GetTupleSize(slot_num);
-  // Check if this is a delete operation, i.e. commit a delete.
-  if (IsDeleted(tuple_size)) {
-    tuple_size = UnsetDeletedFlag(tuple_size);
-  }
-  // Otherwise we are rolling back an insert.
-
-  // We need to copy out the deleted tuple for undo purposes.
+  // We need to copy out the deleted tuple for undo purposes. This commits a delete, if the deleted flag is set, or
+  // otherwise rolls back an insert.
   Tuple delete_tuple;
-  delete_tuple.size_ = tuple_size;
-  delete_tuple.data_ = new char[delete_tuple.size_];
-  memcpy(delete_tuple.data_, GetData() + tuple_offset, delete_tuple.size_);
+  CopyTuple(slot_num, &delete_tuple);
   delete_tuple.rid_ = rid;
-  delete_tuple.allocated_ = true;
 
   if (enable_logging) {
     BUSTUB_ASSERT(txn->IsExclusiveLocked(rid), "We must own the exclusive lock!");
 
-    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::APPLYDELETE, rid, delete_tuple);
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::APPLYDELETE, rid, delete_tuple,
+                         FlagsOf(GetTupleSize(slot_num)));
     lsn_t lsn = log_manager->AppendLogRecord(&log_record);
     SetLSN(lsn);
     txn->SetPrevLSN(lsn);
   }
 
+  RemoveTuple(slot_num);
+
+  // Give the empty slots at the end back to the free space.
+  uint32_t tuple_count = GetTupleCount();
+  while (tuple_count > 0 && GetTupleSize(tuple_count - 1) == 0) {
+    tuple_count--;
+  }
+  SetTupleCount(tuple_count);
+  if (tuple != nullptr) {
+    *tuple = std::move(delete_tuple);
+  }
+}
+
+void TablePage::RestoreTuple(uint32_t slot_num, const Tuple &tuple, uint32_t flags) {
+  // Claim the slots up to the one of the tuple, empty, so that PlaceTuple finds the slot as the first empty one.
+  for (uint32_t i = GetTupleCount(); i < slot_num; i++) {
+    SetTupleOffsetAtSlot(i, 0);
+    SetTupleSize(i, 0);
+  }
+  SetTupleCount(std::max(GetTupleCount(), slot_num));
+  BUSTUB_ASSERT(slot_num == GetTupleCount() || GetTupleSize(slot_num) == 0, "The slot must be empty.");
+  RID rid;
+  uint32_t slot = slot_num;
+  bool is_placed = PlaceTuple(tuple, flags, &rid, &slot);
+  BUSTUB_ASSERT(is_placed && rid.GetSlotNum() == slot_num, "The tuple fitted the page when it was logged.");
+}
+
+bool TablePage::RestoreUpdate(uint32_t slot_num, const Tuple &tuple, uint32_t flags) {
+  BUSTUB_ASSERT(slot_num < GetTupleCount() && !IsDeleted(GetTupleSize(slot_num)), "The slot must hold a tuple.");
+  if (!HasRoomFor(slot_num, tuple.size_ | flags)) {
+    return false;
+  }
+  ReplaceTuple(slot_num, tuple, flags);
+  return true;
+}
+
+void TablePage::RemoveTuple(uint32_t slot_num) {
+  if (IsPax()) {
+    AsPax()->RemoveTuple(slot_num);
+    return;
+  }
+  uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
+  uint32_t tuple_size = SizeOf(GetTupleSize(slot_num));
   uint32_t free_space_pointer = GetFreeSpacePointer();
   BUSTUB_ASSERT(tuple_offset >= free_space_pointer, "Free space appears before tuples.");
 
@@ -293,22 +405,87 @@ bool TablePage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockMan
   }
 
   // At this point, we have at least a shared lock on the RID. Copy the tuple data into our result.
-  uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
-  tuple->size_ = tuple_size;
-  if (tuple->allocated_) {
-    delete[] tuple->data_;
+  CopyTuple(slot_num, tuple);
+  tuple->rid_ = rid;
+  return true;
+}
+
+bool TablePage::LockTuples(Transaction *txn, LockManager *lock_manager) {
+  if (!enable_logging) {
+    return true;
   }
-  tuple->data_ = new char[tuple->size_];
-  memcpy(tuple->data_, GetData() + tuple_offset, tuple->size_);
+  for (uint32_t i = 0; i < GetTupleCount(); ++i) {
+    uint32_t tuple_size = GetTupleSize(i);
+    if (IsDeleted(tuple_size) || IsMoved(tuple_size)) {
+      continue;
+    }
+    RID rid(GetTablePageId(), i);
+    if (!txn->IsSharedLocked(rid) && !txn->IsExclusiveLocked(rid) && !lock_manager->LockShared(txn, rid)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void TablePage::ViewTuple(const RID &rid, Tuple *tuple) {
+  BUSTUB_ASSERT(!tuple->allocated_, "A view must not own its data.");
+  BUSTUB_ASSERT(!IsPax(), "The tuples of a PAX page cannot be viewed in place.");
+  uint32_t slot_num = rid.GetSlotNum();
+  tuple->size_ = SizeOf(GetTupleSize(slot_num));
+  tuple->data_ = GetData() + GetTupleOffsetAtSlot(slot_num);
   tuple->rid_ = rid;
-  tuple->allocated_ = true;
+}
+
+bool TablePage::ForwardTuple(const RID &rid, const RID &forward_rid, Tuple *old_tuple, Transaction *txn,
+                             LockManager *lock_manager, LogManager *log_manager) {
+  Tuple forward(forward_rid);
+  forward.size_ = sizeof(RID);
+  forward.data_ = reinterpret_cast<char *>(&forward.rid_);
+  return UpdateTuple(forward, old_tuple, rid, txn, lock_manager, log_manager, true);
+}
+
+bool TablePage::GetForwardRid(const RID &rid, RID *forward_rid) {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount() || (GetTupleSize(slot_num) & FORWARD_FLAG) == 0) {
+    return false;
+  }
+  memcpy(static_cast<void *>(forward_rid), GetData() + GetTupleOffsetAtSlot(slot_num), sizeof(RID));
   return true;
 }
 
+uint32_t TablePage::GetFreeSpace() {
+  if (IsPax()) {
+    return AsPax()->GetFreeSpace();
+  }
+  return GetFreeSpaceRemaining();
+}
+
+uint32_t TablePage::GetUsedSpace() {
+  if (IsPax()) {
+    return AsPax()->GetUsedSpace();
+  }
+  uint32_t used_space = PAGE_SIZE - GetFreeSpacePointer();
+  for (uint32_t i = 0; i < GetTupleCount(); ++i) {
+    if (GetTupleSize(i) != 0) {
+      used_space += SIZE_TUPLE;
+    }
+  }
+  return used_space;
+}
+
+bool TablePage::HasPinnedTuples() {
+  for (uint32_t i = 0; i < GetTupleCount(); ++i) {
+    if ((GetTupleSize(i) & (DELETE_MASK | FORWARD_FLAG | MOVED_FLAG)) != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
 bool TablePage::GetFirstTupleRid(RID *first_rid) {
   // Find and return the first valid tuple.
   for (uint32_t i = 0; i < GetTupleCount(); ++i) {
-    if (!IsDeleted(GetTupleSize(i))) {
+    if (!IsDeleted(GetTupleSize(i)) && !IsMoved(GetTupleSize(i))) {
       first_rid->Set(GetTablePageId(), i);
       return true;
     }
@@ -321,7 +498,7 @@ bool TablePage::GetNextTupleRid(const RID &cur_rid, RID *next_rid) {
   BUSTUB_ASSERT(cur_rid.GetPageId() == GetTablePageId(), "Wrong table!");
   // Find and return the first valid tuple after our current slot number.
   for (auto i = cur_rid.GetSlotNum() + 1; i < GetTupleCount(); ++i) {
-    if (!IsDeleted(GetTupleSize(i))) {
+    if (!IsDeleted(GetTupleSize(i)) && !IsMoved(GetTupleSize(i))) {
       next_rid->Set(GetTablePageId(), i);
       return true;
     }
@@ -330,4 +507,7 @@ bool TablePage::GetNextTupleRid(const RID &cur_rid, RID *next_rid) {
   next_rid->Set(INVALID_PAGE_ID, 0);
   return false;
 }
+
+PaxPage *TablePage::AsPax() { return reinterpret_cast<PaxPage *>(this); }
+
 }  // namespace bustub
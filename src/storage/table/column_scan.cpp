@@ -0,0 +1,251 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// column_scan.cpp
+//
+// Identification: src/storage/table/column_scan.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/column_scan.h"
+
+#include <cstring>
+#include <vector>
+
+#include "type/value_factory.h"
+
+namespace bustub {
+
+Value ColumnBatch::GetValue(size_t i, size_t row) const {
+  const auto &column = schema_->GetColumn(column_ids_[i]);
+  if (column.IsInlined()) {
+    return Value::DeserializeFrom(data_[i].data() + row * column.GetFixedLength(), column.GetType());
+  }
+  const char *payload = GetPayload(i, row);
+  if (OverflowStore::IsPointer(payload)) {
+    return overflow_store_->Fetch(payload, column.GetType());
+  }
+  return Value::DeserializeFrom(payload, column.GetType());
+}
+
+Value ColumnBatch::GetValueView(size_t i, size_t row) const {
+  const auto &column = schema_->GetColumn(column_ids_[i]);
+  if (column.IsInlined() || IsNull(i, row)) {
+    return GetValue(i, row);
+  }
+  const char *payload = GetPayload(i, row);
+  if (OverflowStore::IsPointer(payload)) {
+    return overflow_store_->Fetch(payload, column.GetType());
+  }
+  uint32_t length;
+  memcpy(&length, payload, sizeof(uint32_t));
+  return Value(TypeId::VARCHAR, payload + sizeof(uint32_t), length, false);
+}
+
+void ColumnBatch::GetTuple(size_t row, Tuple *tuple) const {
+  uint32_t size = null_tuple_.size_;
+  for (size_t i = 0; i < column_ids_.size(); i++) {
+    if (!schema_->GetColumn(column_ids_[i]).IsInlined()) {
+      size += PayloadSize(GetPayload(i, row));
+    }
+  }
+  tuple->Reserve(size);
+  memcpy(tuple->data_, null_tuple_.data_, null_tuple_.size_);
+  // The VARCHAR values go after those of the null tuple, which the columns that were not scanned keep pointing at.
+  uint32_t offset = null_tuple_.size_;
+  for (size_t i = 0; i < column_ids_.size(); i++) {
+    uint32_t column_idx = column_ids_[i];
+    const auto &column = schema_->GetColumn(column_idx);
+    char *null_byte = tuple->data_ + schema_->GetNullBitmapOffset() + column_idx / 8;
+    if (!IsNull(i, row)) {
+      *null_byte = static_cast<char>(*null_byte & ~(1 << (column_idx % 8)));
+    }
+    if (column.IsInlined()) {
+      memcpy(tuple->data_ + column.GetOffset(), data_[i].data() + row * column.GetFixedLength(),
+             column.GetFixedLength());
+      continue;
+    }
+    const char *payload = GetPayload(i, row);
+    uint32_t payload_size = PayloadSize(payload);
+    memcpy(tuple->data_ + offset, payload, payload_size);
+    memcpy(tuple->data_ + column.GetOffset(), &offset, sizeof(uint32_t));
+    offset += payload_size;
+  }
+  tuple->rid_ = rids_[row];
+  tuple->overflow_store_ = overflow_store_;
+  tuple->fetched_values_.reset();
+}
+
+void ColumnBatch::Init(const Schema *schema, const std::vector<uint32_t> &column_ids,
+                       const OverflowStore *overflow_store) {
+  schema_ = schema;
+  column_ids_ = column_ids;
+  positions_.assign(schema->GetColumnCount(), -1);
+  for (size_t i = 0; i < column_ids.size(); i++) {
+    positions_[column_ids[i]] = static_cast<int32_t>(i);
+  }
+  overflow_store_ = overflow_store;
+  data_.assign(column_ids.size(), {});
+  pax_widths_ = PaxPage::ColumnWidths(*schema);
+  bitmap_width_ = pax_widths_.back();
+  pax_offsets_.assign(pax_widths_.size(), 0);
+  for (size_t c = 1; c < pax_widths_.size(); c++) {
+    pax_offsets_[c] = pax_offsets_[c - 1] + pax_widths_[c - 1];
+  }
+  std::vector<Value> values;
+  values.reserve(schema->GetColumnCount());
+  for (const auto &column : schema->GetColumns()) {
+    values.push_back(ValueFactory::GetNullValueByType(column.GetType()));
+  }
+  null_tuple_.SetValues(values, schema);
+}
+
+void ColumnBatch::Clear() {
+  for (size_t i = 0; i < column_ids_.size(); i++) {
+    data_[i].clear();
+  }
+  nulls_.clear();
+  varlen_.clear();
+  rids_.clear();
+}
+
+void ColumnBatch::AppendTuple(const Tuple &tuple) {
+  rids_.push_back(tuple.rid_);
+  const char *bitmap = tuple.data_ + schema_->GetNullBitmapOffset();
+  nulls_.insert(nulls_.end(), bitmap, bitmap + bitmap_width_);
+  for (size_t i = 0; i < column_ids_.size(); i++) {
+    uint32_t column_idx = column_ids_[i];
+    const auto &column = schema_->GetColumn(column_idx);
+    if (column.IsInlined()) {
+      const char *entry = tuple.data_ + column.GetOffset();
+      data_[i].insert(data_[i].end(), entry, entry + column.GetFixedLength());
+      continue;
+    }
+    const char *payload = tuple.GetDataPtr(schema_, column_idx);
+    auto offset = static_cast<uint32_t>(varlen_.size());
+    data_[i].insert(data_[i].end(), reinterpret_cast<char *>(&offset), reinterpret_cast<char *>(&offset + 1));
+    varlen_.insert(varlen_.end(), payload, payload + PayloadSize(payload));
+  }
+}
+
+void ColumnBatch::AppendPax(PaxPage *page, uint32_t slot, uint32_t count) {
+  size_t size = rids_.size();
+  rids_.resize(size + count);
+  for (uint32_t row = 0; row < count; row++) {
+    rids_[size + row].Set(page->GetTablePageId(), slot + row);
+  }
+  // Minipage c starts Capacity entries of each column before c after minipage 0.
+  uint32_t capacity = page->GetCapacity();
+  const char *minipages = page->GetMinipage(0);
+  const char *bitmap = minipages + capacity * pax_offsets_.back() + slot * bitmap_width_;
+  nulls_.insert(nulls_.end(), bitmap, bitmap + count * bitmap_width_);
+  for (size_t i = 0; i < column_ids_.size(); i++) {
+    uint32_t column_idx = column_ids_[i];
+    uint32_t width = pax_widths_[column_idx];
+    const char *minipage = minipages + capacity * pax_offsets_[column_idx] + slot * width;
+    if (schema_->GetColumn(column_idx).IsInlined()) {
+      data_[i].insert(data_[i].end(), minipage, minipage + count * width);
+      continue;
+    }
+    // The entry of a VARCHAR column is the offset of its value in the tuple, whose tail starts at the fixed length.
+    for (uint32_t row = 0; row < count; row++) {
+      uint32_t tuple_offset;
+      memcpy(&tuple_offset, minipage + row * width, sizeof(uint32_t));
+      const char *payload = page->GetTail(slot + row) + tuple_offset - schema_->GetFixedLength();
+      auto offset = static_cast<uint32_t>(varlen_.size());
+      data_[i].insert(data_[i].end(), reinterpret_cast<char *>(&offset), reinterpret_cast<char *>(&offset + 1));
+      varlen_.insert(varlen_.end(), payload, payload + PayloadSize(payload));
+    }
+  }
+}
+
+const char *ColumnBatch::GetPayload(size_t i, size_t row) const {
+  uint32_t offset;
+  memcpy(&offset, data_[i].data() + row * sizeof(uint32_t), sizeof(uint32_t));
+  return varlen_.data() + offset;
+}
+
+uint32_t ColumnBatch::PayloadSize(const char *storage) {
+  if (OverflowStore::IsPointer(storage)) {
+    return OverflowStore::POINTER_SIZE;
+  }
+  uint32_t length;
+  memcpy(&length, storage, sizeof(uint32_t));
+  return sizeof(uint32_t) + (length == BUSTUB_VALUE_NULL ? 0 : length);
+}
+
+bool ColumnScan::Next(ColumnBatch *batch) {
+  if (batch->schema_ != schema_ || batch->column_ids_ != column_ids_) {
+    batch->Init(schema_, column_ids_, &table_heap_->overflow_store_);
+  }
+  batch->Clear();
+  while (batch->GetSize() < BATCH_SIZE && next_page_id_ != INVALID_PAGE_ID) {
+    if (!ReadPage(next_page_id_, batch)) {
+      next_page_id_ = INVALID_PAGE_ID;
+      return false;
+    }
+  }
+  return batch->GetSize() > 0;
+}
+
+bool ColumnScan::ReadPage(page_id_t page_id, ColumnBatch *batch) {
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  auto page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(page_id));
+  if (page == nullptr) {
+    txn_->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  page->RLatch();
+  bool is_locked = page->LockTuples(txn_, table_heap_->lock_manager_);
+  if (is_locked) {
+    next_page_id_ = page->GetNextPageId();
+    forwarded_.clear();
+    bool is_pax = page->IsPax();
+    // The consecutive slots of a PAX page, which are read a column at a time.
+    uint32_t run_slot = 0;
+    uint32_t run_length = 0;
+    RID rid;
+    RID forward_rid;
+    for (bool has_tuple = page->GetFirstTupleRid(&rid); has_tuple;) {
+      if (page->GetForwardRid(rid, &forward_rid)) {
+        forwarded_.push_back(rid);
+      } else if (!is_pax) {
+        Tuple view;
+        page->ViewTuple(rid, &view);
+        batch->AppendTuple(view);
+      } else if (run_length > 0 && rid.GetSlotNum() == run_slot + run_length) {
+        run_length++;
+      } else {
+        if (run_length > 0) {
+          batch->AppendPax(static_cast<PaxPage *>(page), run_slot, run_length);
+        }
+        run_slot = rid.GetSlotNum();
+        run_length = 1;
+      }
+      RID next_rid;
+      has_tuple = page->GetNextTupleRid(rid, &next_rid);
+      rid = next_rid;
+    }
+    if (run_length > 0) {
+      batch->AppendPax(static_cast<PaxPage *>(page), run_slot, run_length);
+    }
+  }
+  page->RUnlatch();
+  buffer_pool_manager->UnpinPage(page_id, false);
+  if (!is_locked) {
+    return false;
+  }
+  // The moved copies of the forwarded tuples are in other pages, which are read without the latch on this one.
+  for (const auto &rid : forwarded_) {
+    if (!table_heap_->GetTuple(rid, &moved_, txn_)) {
+      return false;
+    }
+    batch->AppendTuple(moved_);
+  }
+  return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,219 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.cpp
+//
+// Identification: src/storage/table/free_space_map.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/free_space_map.h"
+
+#include "common/exception.h"
+
+namespace bustub {
+
+FreeSpaceMap::FreeSpaceMap(BufferPoolManager *buffer_pool_manager) : buffer_pool_manager_(buffer_pool_manager) {
+  page_id_t page_id;
+  auto page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->NewPage(&page_id));
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate a free space map page.");
+  }
+  page->Init(page_id);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  page_ids_.push_back(page_id);
+}
+
+FreeSpaceMap::FreeSpaceMap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id)
+    : buffer_pool_manager_(buffer_pool_manager) {
+  uint32_t slot = 0;
+  for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID;) {
+    auto page = reinterpret_cast<FreeSpaceMapPage *>(FetchMapPage(page_id));
+    // The map is not logged, so a page of it may not have reached the disk before a crash: the map ends before it.
+    if (page->GetMapPageId() != page_id) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      EndAt(page_id);
+      break;
+    }
+    page_ids_.push_back(page_id);
+    for (uint32_t i = 0; i < page->GetCount(); i++, slot++) {
+      page_id_t heap_page_id = page->GetHeapPageId(i);
+      // the entry of a page removed from the heap
+      if (heap_page_id == INVALID_PAGE_ID) {
+        continue;
+      }
+      Entry &entry = entries_[heap_page_id];
+      entry.slot_ = slot;
+      entry.category_ = page->GetCategory(i);
+      entry.claimed_ = false;
+      AddToBucket(heap_page_id, &entry);
+      last_heap_page_id_ = heap_page_id;
+    }
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  next_slot_ = slot;
+}
+
+void FreeSpaceMap::EndAt(page_id_t page_id) {
+  if (page_ids_.empty()) {
+    auto page = reinterpret_cast<FreeSpaceMapPage *>(FetchMapPage(page_id));
+    page->Init(page_id);
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    page_ids_.push_back(page_id);
+    return;
+  }
+  auto page = reinterpret_cast<FreeSpaceMapPage *>(FetchMapPage(page_ids_.back()));
+  page->SetNextPageId(INVALID_PAGE_ID);
+  buffer_pool_manager_->UnpinPage(page_ids_.back(), true);
+}
+
+page_id_t FreeSpaceMap::GetLastHeapPageId() {
+  std::scoped_lock lock(latch_);
+  return last_heap_page_id_;
+}
+
+void FreeSpaceMap::UpdatePage(page_id_t heap_page_id, uint32_t free_space) {
+  uint8_t category = CategoryOf(free_space);
+  std::scoped_lock lock(latch_);
+  auto it = entries_.find(heap_page_id);
+  if (it == entries_.end()) {
+    AddEntry(heap_page_id, category, false);
+    return;
+  }
+  Entry &entry = it->second;
+  if (entry.category_ == category) {
+    return;
+  }
+  if (!entry.claimed_) {
+    RemoveFromBucket(entry);
+  }
+  entry.category_ = category;
+  if (!entry.claimed_) {
+    AddToBucket(heap_page_id, &entry);
+  }
+  WriteEntry(entry, heap_page_id);
+}
+
+page_id_t FreeSpaceMap::ClaimPage(uint32_t size) {
+  uint32_t category = (size + CATEGORY_SIZE - 1) / CATEGORY_SIZE;
+  std::scoped_lock lock(latch_);
+  for (uint32_t word = category / 64; word < non_empty_.size(); word++) {
+    uint64_t bits = non_empty_[word];
+    if (word == category / 64) {
+      bits &= ~uint64_t{0} << (category % 64);
+    }
+    if (bits != 0) {
+      page_id_t heap_page_id = buckets_[word * 64 + __builtin_ctzll(bits)].back();
+      Entry &entry = entries_[heap_page_id];
+      RemoveFromBucket(entry);
+      entry.claimed_ = true;
+      return heap_page_id;
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+void FreeSpaceMap::ClaimNewPage(page_id_t heap_page_id, uint32_t free_space) {
+  std::scoped_lock lock(latch_);
+  AddEntry(heap_page_id, CategoryOf(free_space), true);
+}
+
+void FreeSpaceMap::ReleasePage(page_id_t heap_page_id) {
+  std::scoped_lock lock(latch_);
+  auto it = entries_.find(heap_page_id);
+  if (it != entries_.end() && it->second.claimed_) {
+    it->second.claimed_ = false;
+    AddToBucket(heap_page_id, &it->second);
+  }
+}
+
+bool FreeSpaceMap::TryClaimPage(page_id_t heap_page_id) {
+  std::scoped_lock lock(latch_);
+  auto it = entries_.find(heap_page_id);
+  if (it == entries_.end() || it->second.claimed_) {
+    return false;
+  }
+  RemoveFromBucket(it->second);
+  it->second.claimed_ = true;
+  return true;
+}
+
+void FreeSpaceMap::RemovePage(page_id_t heap_page_id) {
+  std::scoped_lock lock(latch_);
+  auto it = entries_.find(heap_page_id);
+  if (it == entries_.end()) {
+    return;
+  }
+  if (!it->second.claimed_) {
+    RemoveFromBucket(it->second);
+  }
+  // Leave the slot empty rather than move another entry into it, so that the last slot keeps the page added last.
+  WriteEntry(it->second, INVALID_PAGE_ID);
+  entries_.erase(it);
+}
+
+void FreeSpaceMap::AddEntry(page_id_t heap_page_id, uint8_t category, bool claimed) {
+  Entry &entry = entries_[heap_page_id];
+  entry.slot_ = next_slot_++;
+  entry.category_ = category;
+  entry.claimed_ = claimed;
+  if (!claimed) {
+    AddToBucket(heap_page_id, &entry);
+  }
+  WriteEntry(entry, heap_page_id);
+  last_heap_page_id_ = heap_page_id;
+}
+
+void FreeSpaceMap::AddToBucket(page_id_t heap_page_id, Entry *entry) {
+  auto &bucket = buckets_[entry->category_];
+  entry->position_ = static_cast<uint32_t>(bucket.size());
+  bucket.push_back(heap_page_id);
+  non_empty_[entry->category_ / 64] |= uint64_t{1} << (entry->category_ % 64);
+}
+
+void FreeSpaceMap::RemoveFromBucket(const Entry &entry) {
+  auto &bucket = buckets_[entry.category_];
+  // move the last page of the bucket into the hole
+  page_id_t moved_page_id = bucket.back();
+  bucket[entry.position_] = moved_page_id;
+  entries_[moved_page_id].position_ = entry.position_;
+  bucket.pop_back();
+  if (bucket.empty()) {
+    non_empty_[entry.category_ / 64] &= ~(uint64_t{1} << (entry.category_ % 64));
+  }
+}
+
+void FreeSpaceMap::WriteEntry(const Entry &entry, page_id_t heap_page_id) {
+  uint32_t index = entry.slot_ / FreeSpaceMapPage::CAPACITY;
+  if (index == page_ids_.size()) {
+    page_id_t page_id;
+    auto page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->NewPage(&page_id));
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate a free space map page.");
+    }
+    page->Init(page_id);
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    auto prev_page = reinterpret_cast<FreeSpaceMapPage *>(FetchMapPage(page_ids_.back()));
+    prev_page->SetNextPageId(page_id);
+    buffer_pool_manager_->UnpinPage(page_ids_.back(), true);
+    page_ids_.push_back(page_id);
+  }
+  auto page = reinterpret_cast<FreeSpaceMapPage *>(FetchMapPage(page_ids_[index]));
+  page->SetEntry(entry.slot_ % FreeSpaceMapPage::CAPACITY, heap_page_id, entry.category_);
+  buffer_pool_manager_->UnpinPage(page_ids_[index], true);
+}
+
+Page *FreeSpaceMap::FetchMapPage(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch a free space map page.");
+  }
+  return page;
+}
+
+}  // namespace bustub
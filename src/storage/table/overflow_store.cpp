@@ -0,0 +1,180 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// overflow_store.cpp
+//
+// Identification: src/storage/table/overflow_store.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/overflow_store.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+bool OverflowStore::Store(const char *data, uint32_t length, bool compress, char *pointer) {
+  std::string compressed;
+  const char *stored = data;
+  uint32_t stored_length = length;
+  if (compress && Compress(data, length, &compressed)) {
+    stored = compressed.data();
+    stored_length = static_cast<uint32_t>(compressed.size());
+  }
+  // Write the pages back to front, so that each is written once, along with the link to the next one.
+  uint32_t num_pages = std::max(1U, (stored_length + OverflowPage::CAPACITY - 1) / OverflowPage::CAPACITY);
+  page_id_t next_page_id = INVALID_PAGE_ID;
+  for (uint32_t i = num_pages; i-- > 0;) {
+    page_id_t page_id;
+    auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->NewPage(&page_id));
+    if (page == nullptr) {
+      // Free the pages written so far.
+      char tail[POINTER_SIZE];
+      memcpy(tail, &EXTERNAL_LENGTH, sizeof(uint32_t));
+      memcpy(tail + 4, &next_page_id, sizeof(page_id_t));
+      Free(tail);
+      return false;
+    }
+    uint32_t offset = i * OverflowPage::CAPACITY;
+    page->Init(page_id, next_page_id, stored + offset, std::min(OverflowPage::CAPACITY, stored_length - offset));
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    next_page_id = page_id;
+  }
+  memcpy(pointer, &EXTERNAL_LENGTH, sizeof(uint32_t));
+  memcpy(pointer + 4, &next_page_id, sizeof(page_id_t));
+  memcpy(pointer + 8, &length, sizeof(uint32_t));
+  memcpy(pointer + 12, &stored_length, sizeof(uint32_t));
+  return true;
+}
+
+Value OverflowStore::Fetch(const char *pointer, TypeId type_id) const {
+  page_id_t page_id;
+  uint32_t length;
+  uint32_t stored_length;
+  memcpy(&page_id, pointer + 4, sizeof(page_id_t));
+  memcpy(&length, pointer + 8, sizeof(uint32_t));
+  memcpy(&stored_length, pointer + 12, sizeof(uint32_t));
+  std::vector<char> stored(stored_length);
+  uint32_t offset = 0;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch an overflow page.");
+    }
+    uint32_t size = std::min(page->GetSize(), stored_length - offset);
+    memcpy(stored.data() + offset, page->GetPayload(), size);
+    offset += size;
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  if (stored_length == length) {
+    return Value(type_id, stored.data(), length, true);
+  }
+  std::vector<char> data(length);
+  if (offset != stored_length || !Decompress(stored.data(), stored_length, data.data(), length)) {
+    throw Exception(ExceptionType::INVALID, "Corrupt out-of-line value.");
+  }
+  return Value(type_id, data.data(), length, true);
+}
+
+void OverflowStore::Free(const char *pointer) {
+  page_id_t page_id;
+  memcpy(&page_id, pointer + 4, sizeof(page_id_t));
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      return;
+    }
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+bool OverflowStore::Compress(const char *data, uint32_t length, std::string *compressed) {
+  static constexpr uint32_t max_literals = 0x80;
+  static constexpr uint32_t max_match = 0x7f + MIN_MATCH;
+  static constexpr uint32_t max_distance = 0xffff;
+  static constexpr uint32_t hash_bits = 12;
+  compressed->clear();
+  compressed->reserve(length);
+  // the last position of each hash of MIN_MATCH bytes
+  std::vector<int64_t> last_pos(1U << hash_bits, -1);
+  uint32_t literal_start = 0;
+  auto append_literals = [&](uint32_t end) {
+    while (literal_start < end) {
+      uint32_t count = std::min(end - literal_start, max_literals);
+      compressed->push_back(static_cast<char>(count - 1));
+      compressed->append(data + literal_start, count);
+      literal_start += count;
+    }
+  };
+  uint32_t pos = 0;
+  while (pos + MIN_MATCH <= length && compressed->size() < length) {
+    uint32_t word;
+    memcpy(&word, data + pos, sizeof(uint32_t));
+    uint32_t hash = (word * 2654435761U) >> (32 - hash_bits);
+    int64_t candidate = last_pos[hash];
+    last_pos[hash] = pos;
+    if (candidate < 0 || pos - candidate > max_distance || memcmp(data + candidate, data + pos, MIN_MATCH) != 0) {
+      pos++;
+      continue;
+    }
+    // The match may overlap the bytes it copies, e.g. for a run of one byte.
+    uint32_t match = MIN_MATCH;
+    while (match < max_match && pos + match < length && data[candidate + match] == data[pos + match]) {
+      match++;
+    }
+    append_literals(pos);
+    auto distance = static_cast<uint16_t>(pos - candidate);
+    compressed->push_back(static_cast<char>(0x80 | (match - MIN_MATCH)));
+    compressed->append(reinterpret_cast<const char *>(&distance), sizeof(uint16_t));
+    pos += match;
+    literal_start = pos;
+  }
+  append_literals(length);
+  return compressed->size() < length;
+}
+
+bool OverflowStore::Decompress(const char *compressed, uint32_t size, char *data, uint32_t length) {
+  uint32_t in = 0;
+  uint32_t out = 0;
+  while (in < size) {
+    auto control = static_cast<uint8_t>(compressed[in++]);
+    if (control < 0x80) {
+      uint32_t count = control + 1U;
+      if (in + count > size || out + count > length) {
+        return false;
+      }
+      memcpy(data + out, compressed + in, count);
+      in += count;
+      out += count;
+      continue;
+    }
+    uint32_t match = (control & 0x7fU) + MIN_MATCH;
+    uint16_t distance;
+    if (in + sizeof(uint16_t) > size) {
+      return false;
+    }
+    memcpy(&distance, compressed + in, sizeof(uint16_t));
+    in += sizeof(uint16_t);
+    if (distance == 0 || distance > out || out + match > length) {
+      return false;
+    }
+    for (uint32_t i = 0; i < match; i++, out++) {
+      data[out] = data[out - distance];
+    }
+  }
+  return out == length;
+}
+
+}  // namespace bustub
@@ -10,9 +10,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
+#include <functional>
+#include <memory>
+#include <utility>
 
 #include "common/logger.h"
+#include "storage/page/pax_page.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -22,76 +27,228 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
     : buffer_pool_manager_(buffer_pool_manager),
       lock_manager_(lock_manager),
       log_manager_(log_manager),
-      first_page_id_(first_page_id) {}
+      first_page_id_(first_page_id),
+      overflow_store_(buffer_pool_manager) {
+  auto first_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  BUSTUB_ASSERT(first_page != nullptr, "Couldn't fetch the first page of the table heap.");
+  first_page->WLatch();
+  if (first_page->IsPax()) {
+    auto pax_page = static_cast<PaxPage *>(static_cast<TablePage *>(first_page));
+    for (uint32_t c = 0; c < pax_page->GetColumnCount(); c++) {
+      pax_widths_.push_back(static_cast<uint16_t>(pax_page->GetColumnWidth(c)));
+    }
+    pax_capacity_ = pax_page->GetCapacity();
+    max_tuple_size_ = PaxPage::MaxTupleSize(pax_widths_, pax_capacity_);
+  }
+  page_id_t page_id = first_page_id_;
+  if (first_page->GetFreeSpaceMapPageId() != INVALID_PAGE_ID) {
+    free_space_map_ = std::make_shared<FreeSpaceMap>(buffer_pool_manager_, first_page->GetFreeSpaceMapPageId());
+    if (free_space_map_->GetLastHeapPageId() != INVALID_PAGE_ID) {
+      page_id = free_space_map_->GetLastHeapPageId();
+    }
+  } else {
+    free_space_map_ = std::make_shared<FreeSpaceMap>(buffer_pool_manager_);
+    first_page->SetFreeSpaceMapPageId(free_space_map_->GetFirstPageId());
+  }
+  first_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  // The map is not logged, so it may miss the pages appended last before a crash: walk on from the last one it has.
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    BUSTUB_ASSERT(page != nullptr, "Couldn't fetch a page of the table heap.");
+    page->RLatch();
+    free_space_map_->UpdatePage(page_id, page->GetFreeSpace());
+    last_page_id_ = page_id;
+    page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(last_page_id_, false);
+  }
+}
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-                     Transaction *txn)
-    : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
+                     Transaction *txn, const Schema *pax_schema)
+    : buffer_pool_manager_(buffer_pool_manager),
+      lock_manager_(lock_manager),
+      log_manager_(log_manager),
+      overflow_store_(buffer_pool_manager) {
+  if (pax_schema != nullptr) {
+    // Size the pages for tuples whose VARCHAR values take their declared lengths.
+    pax_widths_ = PaxPage::ColumnWidths(*pax_schema);
+    uint32_t tuple_size = pax_schema->GetFixedLength();
+    for (auto i : pax_schema->GetUnlinedColumns()) {
+      tuple_size += sizeof(uint32_t) + pax_schema->GetColumn(i).GetVariableLength();
+    }
+    pax_capacity_ = PaxPage::CapacityFor(pax_widths_, tuple_size);
+    max_tuple_size_ = PaxPage::MaxTupleSize(pax_widths_, pax_capacity_);
+  }
   // Initialize the first table page.
   auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_));
   BUSTUB_ASSERT(first_page != nullptr, "Couldn't create a page for the table heap.");
   first_page->WLatch();
-  first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
+  InitPage(first_page, first_page_id_, INVALID_LSN, txn);
+  free_space_map_ = std::make_shared<FreeSpaceMap>(buffer_pool_manager_);
+  first_page->SetFreeSpaceMapPageId(free_space_map_->GetFirstPageId());
+  free_space_map_->UpdatePage(first_page_id_, first_page->GetFreeSpace());
   first_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  last_page_id_ = first_page_id_;
+}
+
+void TableHeap::EnableOverflow(const Schema *schema, bool compress) {
+  overflow_schema_ = schema;
+  compress_overflow_ = compress;
 }
 
 bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
-  if (tuple.size_ + 32 > PAGE_SIZE) {  // larger than one page size
+  Tuple stored;
+  const Tuple *stored_tuple = StoreOverflow(tuple, &stored);
+  if (stored_tuple == nullptr) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
+  if (!InsertTuples(stored_tuple, 1, rid, txn)) {
+    FreeOverflow(*stored_tuple);
+    return false;
+  }
+  return true;
+}
 
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  if (cur_page == nullptr) {
-    txn->SetState(TransactionState::ABORTED);
+bool TableHeap::InsertTuples(const std::vector<Tuple> &tuples, std::vector<RID> *rids, Transaction *txn) {
+  rids->assign(tuples.size(), RID());
+  // Store the large values out of line first, copying the batch only once a tuple has any.
+  std::vector<Tuple> stored_tuples;
+  bool is_copied = false;
+  for (size_t i = 0; i < tuples.size(); i++) {
+    Tuple stored;
+    const Tuple *stored_tuple = StoreOverflow(tuples[i], &stored);
+    if (stored_tuple == nullptr) {
+      for (const auto &tuple : stored_tuples) {
+        FreeOverflow(tuple);
+      }
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    if (stored_tuple == &stored && !is_copied) {
+      stored_tuples.reserve(tuples.size());
+      stored_tuples.assign(tuples.begin(), tuples.begin() + i);
+      is_copied = true;
+    }
+    if (is_copied) {
+      stored_tuples.push_back(*stored_tuple);
+    }
+  }
+  const Tuple *batch = is_copied ? stored_tuples.data() : tuples.data();
+  if (!InsertTuples(batch, tuples.size(), rids->data(), txn)) {
+    for (size_t i = 0; i < tuples.size(); i++) {
+      if ((*rids)[i].GetPageId() == INVALID_PAGE_ID) {
+        FreeOverflow(batch[i]);
+      }
+    }
     return false;
   }
+  return true;
+}
 
-  cur_page->WLatch();
-  // Insert into the first page with enough space. If no such page exists, create a new page and insert into that.
-  // INVARIANT: cur_page is WLatched if you leave the loop normally.
-  while (!cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
-    auto next_page_id = cur_page->GetNextPageId();
-    // If the next page is a valid page,
-    if (next_page_id != INVALID_PAGE_ID) {
-      // Unlatch and unpin the current page.
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-      // And repeat the process with the next page.
-      cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
-      cur_page->WLatch();
-    } else {
-      // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
-      // If we could not create a new page,
-      if (new_page == nullptr) {
-        // Then life sucks and we abort the transaction.
-        cur_page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
+bool TableHeap::InsertTuples(const Tuple *tuples, size_t count, RID *rids, Transaction *txn, bool is_moved) {
+  for (size_t i = 0; i < count; i++) {
+    if (tuples[i].size_ > max_tuple_size_) {  // larger than one page size
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+  }
+
+  auto insert_pages = txn->GetInsertPageSet();
+  auto insert_page = insert_pages->find(this);
+  size_t num_inserted = 0;
+  while (num_inserted < count) {
+    // Insert into the page that this transaction has claimed, if any.
+    if (insert_page != insert_pages->end()) {
+      page_id_t page_id = insert_page->second.page_id_;
+      auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+      if (cur_page == nullptr) {
         txn->SetState(TransactionState::ABORTED);
         return false;
       }
-      // Otherwise we were able to create a new page. We initialize it now.
-      new_page->WLatch();
-      cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
+      cur_page->WLatch();
+      auto num_packed = cur_page->InsertTuples(tuples + num_inserted, static_cast<uint32_t>(count - num_inserted),
+                                               rids + num_inserted, txn, lock_manager_, log_manager_, is_moved);
+      free_space_map_->UpdatePage(page_id, cur_page->GetFreeSpace());
       cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-      cur_page = new_page;
+      buffer_pool_manager_->UnpinPage(page_id, num_packed > 0);
+      // Update the transaction's write set, with one record for each run of consecutive slots. Moved copies go with
+      // the tuples that forward to them.
+      for (size_t i = num_inserted, end = is_moved ? num_inserted : num_inserted + num_packed; i < end;) {
+        uint32_t run = 1;
+        while (i + run < end && rids[i + run].GetSlotNum() == rids[i].GetSlotNum() + run) {
+          run++;
+        }
+        txn->GetWriteSet()->emplace_back(rids[i], WType::INSERT, Tuple{}, this, run);
+        i += run;
+      }
+      num_inserted += num_packed;
+      if (num_inserted == count) {
+        return true;
+      }
+      // The page is full, at least for the next tuple: let it go, with the space it has left.
+      free_space_map_->ReleasePage(page_id);
+      insert_pages->erase(insert_page);
+    }
+
+    // Claim a page that the free space map says has enough space, or a new one if none has. The map may be stale, but
+    // the failed insert above reports the page's real free space back, so the same page is not claimed again.
+    page_id_t page_id = free_space_map_->ClaimPage(TablePage::SpaceFor(tuples[num_inserted].size_));
+    if (page_id == INVALID_PAGE_ID) {
+      page_id = AppendPage(txn);
+      if (page_id == INVALID_PAGE_ID) {
+        txn->SetState(TransactionState::ABORTED);
+        return false;
+      }
     }
+    insert_page = insert_pages->emplace(this, InsertPage{page_id, free_space_map_}).first;
   }
-  // This line has caused most of us to double-take and "whoa double unlatch".
-  // We are not, in fact, double unlatching. See the invariant above.
-  cur_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-  // Update the transaction's write set.
-  txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
   return true;
 }
 
+void TableHeap::ReleaseInsertPage(page_id_t page_id) { free_space_map_->ReleasePage(page_id); }
+
+page_id_t TableHeap::AppendPage(Transaction *txn) {
+  std::scoped_lock append_lock(append_latch_);
+  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id_));
+  if (cur_page == nullptr) {
+    return INVALID_PAGE_ID;
+  }
+  cur_page->WLatch();
+  page_id_t next_page_id;
+  auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
+  // If we could not create a new page,
+  if (new_page == nullptr) {
+    // Then life sucks and we abort the transaction.
+    cur_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_page_id_, false);
+    return INVALID_PAGE_ID;
+  }
+  // Otherwise we were able to create a new page. We initialize it now.
+  new_page->WLatch();
+  cur_page->SetNextPageId(next_page_id);
+  InitPage(new_page, next_page_id, last_page_id_, txn);
+  free_space_map_->ClaimNewPage(next_page_id, new_page->GetFreeSpace());
+  cur_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(last_page_id_, true);
+  new_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(next_page_id, true);
+  last_page_id_ = next_page_id;
+  return next_page_id;
+}
+
+void TableHeap::InitPage(TablePage *page, page_id_t page_id, page_id_t prev_page_id, Transaction *txn) {
+  if (pax_widths_.empty()) {
+    page->Init(page_id, PAGE_SIZE, prev_page_id, log_manager_, txn);
+  } else {
+    static_cast<PaxPage *>(page)->Init(page_id, prev_page_id, pax_widths_, pax_capacity_, log_manager_, txn);
+  }
+}
+
 bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
-  // TODO(Amadou): remove empty page
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // If the page could not be found, then abort the transaction.
@@ -110,6 +267,32 @@ bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
 }
 
 bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn) {
+  Tuple stored;
+  const Tuple *new_tuple = StoreOverflow(tuple, &stored);
+  if (new_tuple == nullptr) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  Tuple old_tuple;
+  if (!UpdateTuple(*new_tuple, rid, &old_tuple, txn)) {
+    FreeOverflow(*new_tuple);
+    return false;
+  }
+  // Update the transaction's write set.
+  txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
+  return true;
+}
+
+void TableHeap::ApplyUpdate(const Tuple &old_tuple) { FreeOverflow(old_tuple); }
+
+void TableHeap::RollbackUpdate(const Tuple &old_tuple, const RID &rid, Transaction *txn) {
+  Tuple new_tuple;
+  if (UpdateTuple(old_tuple, rid, &new_tuple, txn)) {
+    FreeOverflow(new_tuple);
+  }
+}
+
+bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Tuple *old_tuple, Transaction *txn) {
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // If the page could not be found, then abort the transaction.
@@ -118,28 +301,118 @@ bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn
     return false;
   }
   // Update the tuple; but first save the old value for rollbacks.
-  Tuple old_tuple;
+  RID forward_rid;
   page->WLatch();
-  bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
+  bool is_forwarded = page->GetForwardRid(rid, &forward_rid) && page->GetTuple(rid, old_tuple, txn, lock_manager_);
+  if (is_forwarded && enable_logging && !txn->IsExclusiveLocked(rid)) {
+    // The update of the moved copy needs the same lock as an update in place.
+    is_forwarded = lock_manager_->LockUpgrade(txn, rid);
+  }
+  bool is_updated = !is_forwarded && page->UpdateTuple(tuple, old_tuple, rid, txn, lock_manager_, log_manager_);
+  if (is_updated) {
+    free_space_map_->UpdatePage(rid.GetPageId(), page->GetFreeSpace());
+  }
+  // A tuple that no longer fits in its page moves to another one, but keeps its RID.
+  bool is_outgrown = !is_forwarded && !is_updated && txn->GetState() != TransactionState::ABORTED &&
+                     tuple.size_ <= max_tuple_size_ && page->GetTuple(rid, old_tuple, txn, lock_manager_);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_updated);
-  // Update the transaction's write set.
-  if (is_updated && txn->GetState() != TransactionState::ABORTED) {
-    txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
+  if (is_forwarded) {
+    is_updated = UpdateMovedTuple(tuple, rid, forward_rid, old_tuple, txn);
+  } else if (is_outgrown) {
+    is_updated = MoveTuple(tuple, rid, RID(), old_tuple, txn);
+  }
+  return is_updated;
+}
+
+bool TableHeap::UpdateMovedTuple(const Tuple &tuple, const RID &rid, const RID &forward_rid, Tuple *old_tuple,
+                                 Transaction *txn) {
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(forward_rid.GetPageId()));
+  if (page == nullptr) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  page->WLatch();
+  bool is_updated = page->UpdateTuple(tuple, old_tuple, forward_rid, txn, lock_manager_, log_manager_);
+  if (is_updated) {
+    free_space_map_->UpdatePage(forward_rid.GetPageId(), page->GetFreeSpace());
+  }
+  bool is_outgrown = !is_updated && txn->GetState() != TransactionState::ABORTED &&
+                     tuple.size_ <= max_tuple_size_ &&
+                     page->GetTuple(forward_rid, old_tuple, txn, lock_manager_);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(forward_rid.GetPageId(), is_updated);
+  old_tuple->rid_ = rid;
+  if (is_outgrown) {
+    // The moved copy has outgrown its page too: move it again, and point the forward at the new copy.
+    Tuple old_forward;
+    is_updated = MoveTuple(tuple, rid, forward_rid, &old_forward, txn);
   }
   return is_updated;
 }
 
+bool TableHeap::MoveTuple(const Tuple &tuple, const RID &rid, const RID &forward_rid, Tuple *old_tuple,
+                          Transaction *txn) {
+  RID moved_rid;
+  if (!InsertTuples(&tuple, 1, &moved_rid, txn, true)) {
+    return false;
+  }
+  // Forward the tuple to the new copy. The tuple is locked, so its page had only other tuples change meanwhile; but
+  // a tuple smaller than a forward may have lost the room for it.
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  bool is_forwarded = false;
+  if (page != nullptr) {
+    page->WLatch();
+    is_forwarded = page->ForwardTuple(rid, moved_rid, old_tuple, txn, lock_manager_, log_manager_);
+    free_space_map_->UpdatePage(rid.GetPageId(), page->GetFreeSpace());
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(rid.GetPageId(), is_forwarded);
+  }
+  // Delete whichever copy is not forwarded to.
+  if (!is_forwarded) {
+    DeleteMovedTuple(moved_rid, txn);
+  } else if (forward_rid.GetPageId() != INVALID_PAGE_ID) {
+    DeleteMovedTuple(forward_rid, txn);
+  }
+  return is_forwarded;
+}
+
+void TableHeap::DeleteMovedTuple(const RID &rid, Transaction *txn, Tuple *tuple) {
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
+  page->WLatch();
+  if (enable_logging && !txn->IsExclusiveLocked(rid)) {
+    lock_manager_->LockExclusive(txn, rid);
+  }
+  page->ApplyDelete(rid, txn, log_manager_, tuple);
+  free_space_map_->UpdatePage(rid.GetPageId(), page->GetFreeSpace());
+  if (enable_logging) {
+    lock_manager_->Unlock(txn, rid);
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
+}
+
 void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
-  // Delete the tuple from the page.
+  // Delete the tuple from the page, keeping a copy if it may have values out of line.
+  RID forward_rid;
+  Tuple deleted_tuple;
+  Tuple *tuple = overflow_schema_ != nullptr ? &deleted_tuple : nullptr;
   page->WLatch();
-  page->ApplyDelete(rid, txn, log_manager_);
+  bool is_forwarded = page->GetForwardRid(rid, &forward_rid);
+  page->ApplyDelete(rid, txn, log_manager_, is_forwarded ? nullptr : tuple);
+  free_space_map_->UpdatePage(rid.GetPageId(), page->GetFreeSpace());
   lock_manager_->Unlock(txn, rid);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  // A forwarded tuple takes its moved copy along.
+  if (is_forwarded) {
+    DeleteMovedTuple(forward_rid, txn, tuple);
+  }
+  FreeOverflow(deleted_tuple);
 }
 
 void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
@@ -162,13 +435,263 @@ bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
     return false;
   }
   // Read the tuple from the page.
+  RID forward_rid;
   page->RLatch();
   bool res = page->GetTuple(rid, tuple, txn, lock_manager_);
+  bool is_forwarded = res && page->GetForwardRid(rid, &forward_rid);
   page->RUnlatch();
   buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+  tuple->overflow_store_ = &overflow_store_;
+  tuple->fetched_values_.reset();
+  if (!is_forwarded) {
+    return res;
+  }
+  // The tuple has moved: read its moved copy. Note that rid may be the rid of the tuple itself.
+  RID tuple_rid = rid;
+  page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(forward_rid.GetPageId()));
+  if (page == nullptr) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  page->RLatch();
+  res = page->GetTuple(forward_rid, tuple, txn, lock_manager_);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(forward_rid.GetPageId(), false);
+  tuple->rid_ = tuple_rid;
   return res;
 }
 
+size_t TableHeap::Vacuum(Transaction *txn,
+                         const std::function<void(const Tuple &, const RID &, const RID &)> &on_move) {
+  // Claim the sparse pages, so that inserts leave them alone. The first page and the last page stay in any case; the
+  // pages appended meanwhile come after the last page as of now, so the walk stops there.
+  page_id_t last_page_id;
+  {
+    std::scoped_lock append_lock(append_latch_);
+    last_page_id = last_page_id_;
+  }
+  std::deque<page_id_t> sparse;
+  auto first_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  if (first_page == nullptr) {
+    return 0;
+  }
+  first_page->RLatch();
+  page_id_t page_id = first_page->GetNextPageId();
+  first_page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(first_page_id_, false);
+  while (page_id != INVALID_PAGE_ID && page_id != last_page_id) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      break;
+    }
+    page->RLatch();
+    bool is_sparse = page->GetUsedSpace() <= VACUUM_USED_SPACE;
+    page_id_t next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    if (is_sparse && free_space_map_->TryClaimPage(page_id)) {
+      sparse.push_back(page_id);
+    }
+    page_id = next_page_id;
+  }
+
+  // Empty the sparse pages from the back, into pages with room, and then into the sparse pages from the front.
+  size_t num_unlinked = 0;
+  page_id_t target = INVALID_PAGE_ID;
+  while (!sparse.empty()) {
+    page_id = sparse.back();
+    sparse.pop_back();
+    if (VacuumPage(page_id, &target, &sparse, txn, on_move)) {
+      num_unlinked++;
+    } else {
+      free_space_map_->ReleasePage(page_id);
+    }
+  }
+  if (target != INVALID_PAGE_ID) {
+    free_space_map_->ReleasePage(target);
+  }
+  return num_unlinked;
+}
+
+bool TableHeap::VacuumPage(page_id_t page_id, page_id_t *target, std::deque<page_id_t> *spare, Transaction *txn,
+                           const std::function<void(const Tuple &, const RID &, const RID &)> &on_move) {
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  if (page == nullptr) {
+    return false;
+  }
+  page->WLatch();
+  // A tuple that is marked deleted must stay where the commit or abort of its transaction looks for it, and a
+  // forwarded tuple where its forward points.
+  bool is_emptied = !page->HasPinnedTuples();
+  RID rid;
+  while (is_emptied && page->GetFirstTupleRid(&rid)) {
+    Tuple tuple;
+    page->GetTuple(rid, &tuple, txn, lock_manager_);
+    tuple.overflow_store_ = &overflow_store_;
+    // Insert a copy into the target, claiming another target whenever it is full.
+    RID new_rid;
+    bool is_inserted = false;
+    while (!is_inserted) {
+      if (*target == INVALID_PAGE_ID) {
+        *target = free_space_map_->ClaimPage(TablePage::SpaceFor(tuple.size_));
+        if (*target == INVALID_PAGE_ID && !spare->empty()) {
+          *target = spare->front();
+          spare->pop_front();
+        }
+        if (*target == INVALID_PAGE_ID) {
+          break;
+        }
+      }
+      auto target_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(*target));
+      if (target_page == nullptr) {
+        break;
+      }
+      target_page->WLatch();
+      is_inserted = target_page->InsertTuple(tuple, &new_rid, txn, lock_manager_, log_manager_);
+      free_space_map_->UpdatePage(*target, target_page->GetFreeSpace());
+      target_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(*target, is_inserted);
+      if (!is_inserted) {
+        free_space_map_->ReleasePage(*target);
+        *target = INVALID_PAGE_ID;
+      }
+    }
+    if (!is_inserted) {
+      is_emptied = false;
+      break;
+    }
+    // Readers find the new copy before the old one goes.
+    on_move(tuple, rid, new_rid);
+    page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+    page->ApplyDelete(rid, txn, log_manager_);
+    if (enable_logging) {
+      lock_manager_->Unlock(txn, rid);
+    }
+  }
+  if (is_emptied) {
+    // the neighbours are relinked clear of an append to the last page
+    std::scoped_lock append_lock(append_latch_);
+    is_emptied = UnlinkPage(page);
+  }
+  if (is_emptied) {
+    free_space_map_->RemovePage(page_id);
+  } else {
+    free_space_map_->UpdatePage(page_id, page->GetFreeSpace());
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  if (is_emptied) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  return is_emptied;
+}
+
+bool TableHeap::UnlinkPage(TablePage *page) {
+  page_id_t prev_page_id = page->GetPrevPageId();
+  page_id_t next_page_id = page->GetNextPageId();
+  auto prev_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(prev_page_id));
+  if (prev_page == nullptr) {
+    return false;
+  }
+  auto next_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
+  if (next_page == nullptr) {
+    buffer_pool_manager_->UnpinPage(prev_page_id, false);
+    return false;
+  }
+  prev_page->WLatch();
+  prev_page->SetNextPageId(next_page_id);
+  prev_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(prev_page_id, true);
+  next_page->WLatch();
+  next_page->SetPrevPageId(prev_page_id);
+  next_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(next_page_id, true);
+  return true;
+}
+
+const Tuple *TableHeap::StoreOverflow(const Tuple &tuple, Tuple *stored) {
+  if (overflow_schema_ == nullptr) {
+    return &tuple;
+  }
+  const Schema *schema = overflow_schema_;
+  // A value that the tuple points at already belongs to the tuple it came from, so it gets pages of its own.
+  std::vector<bool> is_external(schema->GetColumnCount());
+  bool has_pointers = false;
+  std::vector<std::pair<uint32_t, uint32_t>> candidates;
+  for (uint32_t column_idx : schema->GetUnlinedColumns()) {
+    const char *storage = tuple.GetDataPtr(schema, column_idx);
+    uint32_t length = *reinterpret_cast<const uint32_t *>(storage);
+    if (OverflowStore::IsPointer(storage)) {
+      is_external[column_idx] = true;
+      has_pointers = true;
+    } else if (length != BUSTUB_VALUE_NULL && length >= OVERFLOW_VALUE_SIZE) {
+      candidates.emplace_back(length, column_idx);
+    }
+  }
+  // Then the largest values go out of line, until the tuple is small enough, also for the pages of a PAX table.
+  std::sort(candidates.begin(), candidates.end(), std::greater<>());
+  uint32_t size = tuple.size_;
+  uint32_t max_size = std::min(OVERFLOW_TUPLE_SIZE, max_tuple_size_);
+  for (auto [length, column_idx] : candidates) {
+    if (size <= max_size) {
+      break;
+    }
+    is_external[column_idx] = true;
+    size -= sizeof(uint32_t) + length - OverflowStore::POINTER_SIZE;
+  }
+  if (!has_pointers && size == tuple.size_) {
+    return &tuple;
+  }
+
+  stored->size_ = size;
+  stored->data_ = new char[size];
+  stored->allocated_ = true;
+  stored->rid_ = tuple.rid_;
+  stored->overflow_store_ = &overflow_store_;
+  memcpy(stored->data_, tuple.data_, schema->GetFixedLength());
+  uint32_t offset = schema->GetFixedLength();
+  std::vector<uint32_t> pointer_offsets;
+  for (uint32_t column_idx : schema->GetUnlinedColumns()) {
+    const char *storage = tuple.GetDataPtr(schema, column_idx);
+    uint32_t length = *reinterpret_cast<const uint32_t *>(storage);
+    memcpy(stored->data_ + schema->GetColumn(column_idx).GetOffset(), &offset, sizeof(uint32_t));
+    if (!is_external[column_idx]) {
+      uint32_t value_size = sizeof(uint32_t) + (length == BUSTUB_VALUE_NULL ? 0 : length);
+      memcpy(stored->data_ + offset, storage, value_size);
+      offset += value_size;
+      continue;
+    }
+    bool is_stored;
+    if (OverflowStore::IsPointer(storage)) {
+      Value value = tuple.GetValue(schema, column_idx);
+      is_stored = overflow_store_.Store(value.GetData(), value.GetLength(), compress_overflow_, stored->data_ + offset);
+    } else {
+      is_stored = overflow_store_.Store(storage + sizeof(uint32_t), length, compress_overflow_, stored->data_ + offset);
+    }
+    if (!is_stored) {
+      for (uint32_t pointer_offset : pointer_offsets) {
+        overflow_store_.Free(stored->data_ + pointer_offset);
+      }
+      return nullptr;
+    }
+    pointer_offsets.push_back(offset);
+    offset += OverflowStore::POINTER_SIZE;
+  }
+  return stored;
+}
+
+void TableHeap::FreeOverflow(const Tuple &tuple) {
+  if (overflow_schema_ == nullptr || tuple.data_ == nullptr) {
+    return;
+  }
+  for (uint32_t column_idx : overflow_schema_->GetUnlinedColumns()) {
+    const char *storage = tuple.GetDataPtr(overflow_schema_, column_idx);
+    if (OverflowStore::IsPointer(storage)) {
+      overflow_store_.Free(storage);
+    }
+  }
+}
+
 TableIterator TableHeap::Begin(Transaction *txn) {
   // Start an iterator from the first page.
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
@@ -55,7 +55,8 @@ TableIterator &TableIterator::operator++() {
   }
   tuple_->rid_ = next_tuple_rid;
 
-  if (*this != table_heap_->End()) {
+  // the end iterator is the one at an invalid page
+  if (next_tuple_rid.GetPageId() != INVALID_PAGE_ID) {
     table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
   }
   // release until copy the tuple
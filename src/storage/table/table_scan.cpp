@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_scan.cpp
+//
+// Identification: src/storage/table/table_scan.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/table_scan.h"
+
+#include <cstring>
+
+namespace bustub {
+
+bool TableScan::Next(TupleView *view) {
+  RID rid;
+  while (!has_page_ ||
+         !(rid_.GetPageId() == INVALID_PAGE_ID ? page_.GetFirstTupleRid(&rid) : page_.GetNextTupleRid(rid_, &rid))) {
+    if (next_page_id_ == INVALID_PAGE_ID || !ReadPage(next_page_id_)) {
+      has_page_ = false;
+      next_page_id_ = INVALID_PAGE_ID;
+      return false;
+    }
+    rid_ = RID();
+  }
+  rid_ = rid;
+  RID forward_rid;
+  if (page_.GetForwardRid(rid, &forward_rid)) {
+    // The tuple has moved: read its moved copy, which this scan skips in the page it is in.
+    if (!table_heap_->GetTuple(rid, &moved_, txn_)) {
+      return false;
+    }
+    view->Reset(moved_);
+    return true;
+  }
+  if (page_.IsPax()) {
+    // The columns of the tuple are apart: put them together, the tuple being locked already.
+    page_.GetTuple(rid, &row_, txn_, table_heap_->lock_manager_);
+    row_.overflow_store_ = &table_heap_->overflow_store_;
+    view->Reset(row_);
+    return true;
+  }
+  view->tuple_.fetched_values_.reset();
+  page_.ViewTuple(rid, &view->tuple_);
+  view->tuple_.overflow_store_ = &table_heap_->overflow_store_;
+  return true;
+}
+
+bool TableScan::ReadPage(page_id_t page_id) {
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  auto page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(page_id));
+  if (page == nullptr) {
+    txn_->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  page->RLatch();
+  bool is_locked = page->LockTuples(txn_, table_heap_->lock_manager_);
+  if (is_locked) {
+    memcpy(page_.GetData(), page->GetData(), PAGE_SIZE);
+    has_page_ = true;
+    next_page_id_ = page_.GetNextPageId();
+  }
+  page->RUnlatch();
+  buffer_pool_manager->UnpinPage(page_id, false);
+  return is_locked;
+}
+
+}  // namespace bustub
@@ -14,46 +14,55 @@
 #include <cstdlib>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "storage/table/overflow_store.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
-// TODO(Amadou): It does not look like nulls are supported. Add a null bitmap?
-Tuple::Tuple(std::vector<Value> values, const Schema *schema) : allocated_(true) {
+Tuple::Tuple(std::vector<Value> values, const Schema *schema) { SetValues(values, schema); }
+
+void Tuple::SetValues(const std::vector<Value> &values, const Schema *schema) {
   assert(values.size() == schema->GetColumnCount());
 
   // 1. Calculate the size of the tuple.
-  uint32_t tuple_size = schema->GetLength();
+  uint32_t tuple_size = schema->GetFixedLength();
   for (auto &i : schema->GetUnlinedColumns()) {
-    tuple_size += (values[i].GetLength() + sizeof(uint32_t));
+    tuple_size += ((values[i].IsNull() ? 0 : values[i].GetLength()) + sizeof(uint32_t));
   }
 
   // 2. Allocate memory.
-  size_ = tuple_size;
-  data_ = new char[size_];
+  Reserve(tuple_size);
   std::memset(data_, 0, size_);
+  rid_ = RID();
+  overflow_store_ = nullptr;
+  fetched_values_.reset();
 
   // 3. Serialize each attribute based on the input value.
   uint32_t column_count = schema->GetColumnCount();
-  uint32_t offset = schema->GetLength();
+  uint32_t offset = schema->GetFixedLength();
 
   for (uint32_t i = 0; i < column_count; i++) {
     const auto &col = schema->GetColumn(i);
+    if (values[i].IsNull()) {
+      data_[schema->GetNullBitmapOffset() + i / 8] |= static_cast<char>(1 << (i % 8));
+    }
     if (!col.IsInlined()) {
       // Serialize relative offset, where the actual varchar data is stored.
       *reinterpret_cast<uint32_t *>(data_ + col.GetOffset()) = offset;
       // Serialize varchar value, in place (size+data).
       values[i].SerializeTo(data_ + offset);
-      offset += (values[i].GetLength() + sizeof(uint32_t));
+      offset += ((values[i].IsNull() ? 0 : values[i].GetLength()) + sizeof(uint32_t));
     } else {
       values[i].SerializeTo(data_ + col.GetOffset());
     }
   }
 }
 
-Tuple::Tuple(const Tuple &other) : allocated_(other.allocated_), rid_(other.rid_), size_(other.size_) {
+Tuple::Tuple(const Tuple &other)
+    : allocated_(other.allocated_), rid_(other.rid_), size_(other.size_), overflow_store_(other.overflow_store_) {
   if (allocated_) {
     delete[] data_;
   }
@@ -67,6 +76,18 @@ Tuple::Tuple(const Tuple &other) : allocated_(other.allocated_), rid_(other.rid_
   }
 }
 
+Tuple::Tuple(Tuple &&other) noexcept
+    : allocated_(other.allocated_),
+      rid_(other.rid_),
+      size_(other.size_),
+      data_(other.data_),
+      overflow_store_(other.overflow_store_),
+      fetched_values_(std::move(other.fetched_values_)) {
+  other.allocated_ = false;
+  other.size_ = 0;
+  other.data_ = nullptr;
+}
+
 Tuple &Tuple::operator=(const Tuple &other) {
   if (allocated_) {
     delete[] data_;
@@ -74,6 +95,8 @@ Tuple &Tuple::operator=(const Tuple &other) {
   allocated_ = other.allocated_;
   rid_ = other.rid_;
   size_ = other.size_;
+  overflow_store_ = other.overflow_store_;
+  fetched_values_.reset();
 
   if (allocated_) {
     // Deep copy.
@@ -87,16 +110,81 @@ Tuple &Tuple::operator=(const Tuple &other) {
   return *this;
 }
 
+Tuple &Tuple::operator=(Tuple &&other) noexcept {
+  if (this == &other) {
+    return *this;
+  }
+  if (allocated_) {
+    delete[] data_;
+  }
+  allocated_ = other.allocated_;
+  rid_ = other.rid_;
+  size_ = other.size_;
+  data_ = other.data_;
+  overflow_store_ = other.overflow_store_;
+  fetched_values_ = std::move(other.fetched_values_);
+  other.allocated_ = false;
+  other.size_ = 0;
+  other.data_ = nullptr;
+  return *this;
+}
+
 Value Tuple::GetValue(const Schema *schema, const uint32_t column_idx) const {
   assert(schema);
   assert(data_);
   const TypeId column_type = schema->GetColumn(column_idx).GetType();
   const char *data_ptr = GetDataPtr(schema, column_idx);
+  if (!schema->GetColumn(column_idx).IsInlined() && OverflowStore::IsPointer(data_ptr)) {
+    assert(overflow_store_);
+    return overflow_store_->Fetch(data_ptr, column_type);
+  }
   // the third parameter "is_inlined" is unused
   return Value::DeserializeFrom(data_ptr, column_type);
 }
 
-Tuple Tuple::KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs) {
+std::string_view Tuple::GetStringView(const Schema *schema, const uint32_t column_idx) const {
+  assert(!schema->GetColumn(column_idx).IsInlined());
+  const char *data_ptr = data_ + *reinterpret_cast<const uint32_t *>(data_ + schema->GetOffset(column_idx));
+  uint32_t length;
+  if (OverflowStore::IsPointer(data_ptr)) {
+    assert(overflow_store_);
+    page_id_t page_id;
+    memcpy(&page_id, data_ptr + sizeof(uint32_t), sizeof(page_id_t));
+    if (fetched_values_ == nullptr) {
+      fetched_values_ = std::make_unique<std::unordered_map<page_id_t, std::string>>();
+    }
+    auto it = fetched_values_->find(page_id);
+    if (it == fetched_values_->end()) {
+      Value value = overflow_store_->Fetch(data_ptr, TypeId::VARCHAR);
+      it = fetched_values_->emplace(page_id, std::string(value.GetData(), value.GetLength())).first;
+    }
+    data_ptr = it->second.data();
+    length = static_cast<uint32_t>(it->second.size());
+  } else {
+    memcpy(&length, data_ptr, sizeof(uint32_t));
+    data_ptr += sizeof(uint32_t);
+  }
+  // Like Value::ToString, leave out the terminating null character that the length counts.
+  return {data_ptr, length == 0 ? 0 : length - 1};
+}
+
+Tuple Tuple::KeyFromTuple(const Schema &schema, const Schema &key_schema,
+                          const std::vector<uint32_t> &key_attrs) const {
+  if (key_schema.IsInlined()) {
+    // Copy the key columns across as they are, null bits included, without building Values.
+    Tuple key;
+    key.allocated_ = true;
+    key.size_ = key_schema.GetFixedLength();
+    key.data_ = new char[key.size_]();
+    for (uint32_t i = 0; i < key_attrs.size(); i++) {
+      memcpy(key.data_ + key_schema.GetOffset(i), data_ + schema.GetOffset(key_attrs[i]),
+             key_schema.GetColumn(i).GetFixedLength());
+      if (IsNull(&schema, key_attrs[i])) {
+        key.data_[key_schema.GetNullBitmapOffset() + i / 8] |= static_cast<char>(1 << (i % 8));
+      }
+    }
+    return key;
+  }
   std::vector<Value> values;
   values.reserve(key_attrs.size());
   for (auto idx : key_attrs) {
@@ -120,6 +208,17 @@ const char *Tuple::GetDataPtr(const Schema *schema, const uint32_t column_idx) c
   return (data_ + offset);
 }
 
+void Tuple::Reserve(uint32_t size) {
+  if (!allocated_ || size_ < size) {
+    if (allocated_) {
+      delete[] data_;
+    }
+    data_ = new char[size];
+    allocated_ = true;
+  }
+  size_ = size;
+}
+
 std::string Tuple::ToString(const Schema *schema) const {
   std::stringstream os;
 
@@ -153,13 +252,23 @@ void Tuple::SerializeTo(char *storage) const {
 void Tuple::DeserializeFrom(const char *storage) {
   uint32_t size = *reinterpret_cast<const uint32_t *>(storage);
   // Construct a tuple.
-  this->size_ = size;
-  if (this->allocated_) {
-    delete[] this->data_;
-  }
-  this->data_ = new char[this->size_];
+  this->Reserve(size);
   memcpy(this->data_, storage + sizeof(int32_t), this->size_);
-  this->allocated_ = true;
+  this->fetched_values_.reset();
+}
+
+Tuple TupleView::ToTuple(AbstractPool *pool) const {
+  Tuple tuple;
+  if (pool != nullptr) {
+    tuple.size_ = tuple_.size_;
+    tuple.data_ = static_cast<char *>(pool->Allocate(tuple_.size_));
+  } else {
+    tuple.Reserve(tuple_.size_);
+  }
+  memcpy(tuple.data_, tuple_.data_, tuple_.size_);
+  tuple.rid_ = tuple_.rid_;
+  tuple.overflow_store_ = tuple_.overflow_store_;
+  return tuple;
 }
 
 }  // namespace bustub
@@ -0,0 +1,47 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arena_pool.cpp
+//
+// Identification: src/type/arena_pool.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "type/arena_pool.h"
+
+namespace bustub {
+
+void *ArenaPool::Allocate(size_t size) {
+  size = (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+  allocated_bytes_ += size;
+  if (size > BLOCK_SIZE / 4) {
+    large_blocks_.emplace_back(new char[size]);
+    return large_blocks_.back().get();
+  }
+  if (size > remaining_) {
+    // The rest of the current block is left unused.
+    blocks_.emplace_back(new char[BLOCK_SIZE]);
+    next_ = blocks_.back().get();
+    remaining_ = BLOCK_SIZE;
+  }
+  char *data = next_;
+  next_ += size;
+  remaining_ -= size;
+  return data;
+}
+
+void ArenaPool::Reset() {
+  allocated_bytes_ = 0;
+  large_blocks_.clear();
+  if (blocks_.empty()) {
+    return;
+  }
+  blocks_.resize(1);
+  next_ = blocks_.front().get();
+  remaining_ = BLOCK_SIZE;
+}
+
+}  // namespace bustub
@@ -10,19 +10,25 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
 #include <string>
 #include <unordered_set>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/catalog.h"
+#include "concurrency/transaction.h"
 #include "gtest/gtest.h"
+#include "storage/index/b_plus_tree_index.h"
 #include "type/value_factory.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(CatalogTest, DISABLED_CreateTableTest) {
+TEST(CatalogTest, CreateTableTest) {
   auto disk_manager = new DiskManager("catalog_test.db");
   auto bpm = new BufferPoolManager(32, disk_manager);
   auto catalog = new Catalog(bpm, nullptr, nullptr);
@@ -48,4 +54,287 @@ TEST(CatalogTest, DISABLED_CreateTableTest) {
   delete disk_manager;
 }
 
+namespace {
+
+/** Creates a table of num_rows rows (i, i % num_groups) in the catalog. */
+TableMetadata *CreateTestTable(Catalog *catalog, Transaction *txn, const std::string &table_name, int num_rows,
+                               int num_groups) {
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::BIGINT);
+  columns.emplace_back("B", TypeId::BIGINT);
+  auto *table_metadata = catalog->CreateTable(txn, table_name, Schema(columns));
+  for (int i = 0; i < num_rows; i++) {
+    std::vector<Value> values{ValueFactory::GetBigIntValue(i), ValueFactory::GetBigIntValue(i % num_groups)};
+    Tuple tuple(values, &table_metadata->schema_);
+    RID rid;
+    EXPECT_TRUE(table_metadata->table_->InsertTuple(tuple, &rid, txn));
+  }
+  return table_metadata;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, CreateIndexTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManager(64, disk_manager);
+  // the B+ trees keep their roots in the header page
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  Transaction txn(0);
+  const int num_rows = 3000;
+  const int num_groups = 7;
+  auto *table_metadata = CreateTestTable(catalog, &txn, "potato", num_rows, num_groups);
+  const Schema &schema = table_metadata->schema_;
+
+  for (size_t build_threads : {1, 3, 8}) {
+    std::string suffix = std::to_string(build_threads);
+    Schema *unique_key_schema = Schema::CopySchema(&schema, {0});
+    auto *unique_index = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+        &txn, "a_" + suffix, "potato", schema, *unique_key_schema, {0}, 8, true, build_threads);
+    Schema *group_key_schema = Schema::CopySchema(&schema, {1});
+    auto *group_index = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+        &txn, "b_" + suffix, "potato", schema, *group_key_schema, {1}, 8, false, build_threads, true);
+
+    // every row is found through both indexes
+    std::vector<std::vector<RID>> groups(num_groups);
+    for (auto it = table_metadata->table_->Begin(&txn); it != table_metadata->table_->End(); ++it) {
+      int64_t a = it->GetValue(&schema, 0).GetAs<int64_t>();
+      std::vector<RID> result;
+      unique_index->index_->ScanKey(it->KeyFromTuple(schema, *unique_key_schema, {0}), &result, &txn);
+      ASSERT_EQ(std::vector<RID>{it->GetRid()}, result);
+      groups[a % num_groups].push_back(it->GetRid());
+    }
+    // the group index filters lookups through its Bloom filter, which must know every key
+    for (int64_t b = 0; b <= num_groups; b++) {
+      Tuple key({ValueFactory::GetBigIntValue(b)}, group_key_schema);
+      std::vector<RID> result;
+      group_index->index_->ScanKey(key, &result, &txn);
+      ASSERT_EQ(b < num_groups ? groups[b] : std::vector<RID>{}, result);
+    }
+    delete unique_key_schema;
+    delete group_key_schema;
+  }
+
+  bpm->UnpinPage(header_page_id, true);
+  delete catalog;
+  delete bpm;
+  delete disk_manager;
+  remove("catalog_test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, NormalizedIndexTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManager(64, disk_manager);
+  // the B+ trees keep their roots in the header page
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  Transaction txn(0);
+  const int num_rows = 3000;
+  const int num_groups = 7;
+  auto *table_metadata = CreateTestTable(catalog, &txn, "potato", num_rows, num_groups);
+  const Schema &schema = table_metadata->schema_;
+  Schema *key_schema = Schema::CopySchema(&schema, {1, 0});
+  auto *index = catalog->CreateIndex<NormalizedKey<16>, RID, NormalizedComparator<16>>(
+      &txn, "ba", "potato", schema, *key_schema, {1, 0}, 16, true);
+
+  // a range scan returns the keys of a group in order
+  Tuple lo({ValueFactory::GetBigIntValue(3), ValueFactory::GetBigIntValue(100)}, key_schema);
+  Tuple hi({ValueFactory::GetBigIntValue(3), ValueFactory::GetBigIntValue(200)}, key_schema);
+  auto cursor = index->index_->ScanRange(&lo, false, &hi, true, ScanDirection::FORWARD, &txn);
+  std::vector<RID> rids;
+  std::vector<Tuple> entries;
+  while (cursor->NextEntryBatch(&rids, &entries)) {
+  }
+  std::vector<int64_t> expected;
+  for (int64_t a = 101; a <= 200; a++) {
+    if (a % num_groups == 3) {
+      expected.push_back(a);
+    }
+  }
+  ASSERT_EQ(expected.size(), entries.size());
+  for (size_t i = 0; i < entries.size(); i++) {
+    EXPECT_EQ(3, entries[i].GetValue(key_schema, 0).GetAs<int64_t>());
+    EXPECT_EQ(expected[i], entries[i].GetValue(key_schema, 1).GetAs<int64_t>());
+    std::vector<RID> result;
+    index->index_->ScanKey(entries[i], &result, &txn);
+    EXPECT_EQ(std::vector<RID>{rids[i]}, result);
+  }
+
+  // the included columns would take part in the memcmp
+  Schema *covering_key_schema = Schema::CopySchema(&schema, {0});
+  EXPECT_THROW((catalog->CreateIndex<NormalizedKey<16>, RID, NormalizedComparator<16>>(
+                   &txn, "a", "potato", schema, *covering_key_schema, {0}, 16, true, 1, false, {1})),
+               Exception);
+
+  delete key_schema;
+  delete covering_key_schema;
+  bpm->UnpinPage(header_page_id, true);
+  delete catalog;
+  delete bpm;
+  delete disk_manager;
+  remove("catalog_test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, VacuumTableTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManager(64, disk_manager);
+  // the B+ trees keep their roots in the header page
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  LockManager lock_manager;
+  auto catalog = new Catalog(bpm, &lock_manager, nullptr);
+  Transaction txn(0);
+  const int num_rows = 3000;
+  const int num_groups = 7;
+  auto *table_metadata = CreateTestTable(catalog, &txn, "potato", num_rows, num_groups);
+  TableHeap *table = table_metadata->table_.get();
+  const Schema &schema = table_metadata->schema_;
+  Schema *unique_key_schema = Schema::CopySchema(&schema, {0});
+  auto *unique_index = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      &txn, "a", "potato", schema, *unique_key_schema, {0}, 8, true);
+  Schema *group_key_schema = Schema::CopySchema(&schema, {1});
+  auto *group_index = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      &txn, "b", "potato", schema, *group_key_schema, {1}, 8, false);
+
+  // delete two rows out of three, along with their index entries
+  std::vector<Tuple> deleted;
+  for (auto it = table->Begin(&txn); it != table->End(); ++it) {
+    if (it->GetValue(&schema, 0).GetAs<int64_t>() % 3 != 0) {
+      deleted.push_back(*it);
+    }
+  }
+  for (const auto &tuple : deleted) {
+    ASSERT_TRUE(table->MarkDelete(tuple.GetRid(), &txn));
+    table->ApplyDelete(tuple.GetRid(), &txn);
+    unique_index->index_->DeleteEntry(tuple.KeyFromTuple(schema, *unique_key_schema, {0}), tuple.GetRid(), &txn);
+    group_index->index_->DeleteEntry(tuple.KeyFromTuple(schema, *group_key_schema, {1}), tuple.GetRid(), &txn);
+  }
+  EXPECT_GT(catalog->VacuumTable(&txn, "potato"), 0);
+
+  // every row left is found through both indexes, at its new RID
+  std::vector<std::vector<RID>> groups(num_groups);
+  int num_scanned = 0;
+  for (auto it = table->Begin(&txn); it != table->End(); ++it, num_scanned++) {
+    int64_t a = it->GetValue(&schema, 0).GetAs<int64_t>();
+    std::vector<RID> result;
+    unique_index->index_->ScanKey(it->KeyFromTuple(schema, *unique_key_schema, {0}), &result, &txn);
+    ASSERT_EQ(std::vector<RID>{it->GetRid()}, result);
+    groups[a % num_groups].push_back(it->GetRid());
+  }
+  EXPECT_EQ(num_rows / 3, num_scanned);
+  for (int64_t b = 0; b < num_groups; b++) {
+    Tuple key({ValueFactory::GetBigIntValue(b)}, group_key_schema);
+    std::vector<RID> result;
+    group_index->index_->ScanKey(key, &result, &txn);
+    std::sort(result.begin(), result.end(), [](const RID &x, const RID &y) { return x.Get() < y.Get(); });
+    std::sort(groups[b].begin(), groups[b].end(), [](const RID &x, const RID &y) { return x.Get() < y.Get(); });
+    ASSERT_EQ(groups[b], result);
+  }
+
+  delete unique_key_schema;
+  delete group_key_schema;
+  bpm->UnpinPage(header_page_id, true);
+  delete catalog;
+  delete bpm;
+  delete disk_manager;
+  remove("catalog_test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, ForwardedTupleIndexTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManager(64, disk_manager);
+  // the B+ trees keep their roots in the header page
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  Transaction txn(0);
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::BIGINT);
+  columns.emplace_back("B", TypeId::VARCHAR, 2000);
+  auto *table_metadata = catalog->CreateTable(&txn, "potato", Schema(columns));
+  TableHeap *table = table_metadata->table_.get();
+  const Schema &schema = table_metadata->schema_;
+  auto make_tuple = [&](int64_t a, size_t length) {
+    std::vector<Value> values{ValueFactory::GetBigIntValue(a), ValueFactory::GetVarcharValue(std::string(length, 'x'))};
+    return Tuple(values, &schema);
+  };
+  const int num_rows = 500;
+  std::vector<RID> rids(num_rows);
+  for (int i = 0; i < num_rows; i++) {
+    ASSERT_TRUE(table->InsertTuple(make_tuple(i, 100), &rids[i], &txn));
+  }
+  txn.ReleaseInsertPages();
+
+  // the pages are full, so the rows that grow move to other pages and their slots forward to them
+  for (int i = 0; i < num_rows; i += 10) {
+    ASSERT_TRUE(table->UpdateTuple(make_tuple(i, 600), rids[i], &txn));
+  }
+  auto page = static_cast<TablePage *>(bpm->FetchPage(rids[0].GetPageId()));
+  RID forward_rid;
+  EXPECT_TRUE(page->GetForwardRid(rids[0], &forward_rid));
+  bpm->UnpinPage(rids[0].GetPageId(), false);
+
+  // every row is indexed once, by its own key at its own RID
+  Schema *key_schema = Schema::CopySchema(&schema, {0});
+  for (size_t build_threads : {1, 4}) {
+    auto *index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+        &txn, "a_" + std::to_string(build_threads), "potato", schema, *key_schema, {0}, 8, true, build_threads);
+    for (int i = 0; i < num_rows; i++) {
+      Tuple key({ValueFactory::GetBigIntValue(i)}, key_schema);
+      std::vector<RID> result;
+      index_info->index_->ScanKey(key, &result, &txn);
+      ASSERT_EQ(std::vector<RID>{rids[i]}, result);
+    }
+    auto *index = dynamic_cast<BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> *>(index_info->index_.get());
+    int num_entries = 0;
+    for (auto it = index->GetBeginIterator(); !it.isEnd(); ++it) {
+      num_entries++;
+    }
+    EXPECT_EQ(num_rows, num_entries);
+  }
+
+  delete key_schema;
+  bpm->UnpinPage(header_page_id, true);
+  delete catalog;
+  delete bpm;
+  delete disk_manager;
+  remove("catalog_test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, DISABLED_CreateIndexBenchmarkTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManager(1024, disk_manager);
+  // the B+ trees keep their roots in the header page
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  Transaction txn(0);
+  auto *table_metadata = CreateTestTable(catalog, &txn, "potato", 30000, 100);
+  const Schema &schema = table_metadata->schema_;
+  Schema *key_schema = Schema::CopySchema(&schema, {0});
+
+  for (size_t build_threads : {1, 4, 16, 32}) {
+    auto start = std::chrono::steady_clock::now();
+    catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+        &txn, "a_" + std::to_string(build_threads), "potato", schema, *key_schema, {0}, 8, true, build_threads);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "create index on 30000 rows with " << build_threads << " threads: " << elapsed.count() << " ms"
+              << std::endl;
+  }
+
+  delete key_schema;
+  bpm->UnpinPage(header_page_id, true);
+  delete catalog;
+  delete bpm;
+  delete disk_manager;
+  remove("catalog_test.db");
+}
+
 }  // namespace bustub
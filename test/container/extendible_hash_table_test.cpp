@@ -0,0 +1,241 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table_test.cpp
+//
+// Identification: test/container/extendible_hash_table_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "catalog/schema.h"
+#include "container/hash/extendible_hash_table.h"
+#include "container/hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, SampleTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // insert a few values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(std::vector<int>{i}, res);
+  }
+
+  // insert one more value for each key; duplicate values for the same key are not allowed
+  for (int i = 0; i < 5; i++) {
+    EXPECT_EQ(i != 0, ht.Insert(nullptr, i, 2 * i));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    std::sort(res.begin(), res.end());
+    EXPECT_EQ(i == 0 ? std::vector<int>{0} : std::vector<int>({i, 2 * i}), res);
+  }
+
+  // look for a key that does not exist
+  std::vector<int> res;
+  EXPECT_FALSE(ht.GetValue(nullptr, 20, &res));
+  EXPECT_EQ(0, res.size());
+
+  // delete some values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(i == 0 ? std::vector<int>{} : std::vector<int>{2 * i}, res);
+  }
+  for (int i = 0; i < 5; i++) {
+    // (0, 0) has been deleted
+    EXPECT_EQ(i != 0, ht.Remove(nullptr, i, 2 * i));
+  }
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, SplitTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+  const int num_keys = 20000;
+  const int num_duplicates = 4000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    if (i < num_duplicates) {
+      EXPECT_TRUE(ht.Insert(nullptr, i % 10, -i - 1));
+    }
+  }
+  // about 500 pairs of ints fit in a bucket
+  EXPECT_GE(ht.GetGlobalDepth(), 7);
+
+  for (int i = 0; i < num_keys; i += 2) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  for (int i = 10; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_EQ(i % 2 == 1, ht.GetValue(nullptr, i, &res));
+    EXPECT_EQ(i % 2 == 1 ? std::vector<int>{i} : std::vector<int>{}, res);
+  }
+  // one key with many values, all of which fit in its bucket
+  std::vector<int> res;
+  ht.GetValue(nullptr, 3, &res);
+  EXPECT_EQ(num_duplicates / 10 + 1, res.size());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, DirectoryPagesTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(1000, disk_manager);
+  Schema key_schema{std::vector<Column>{Column{"a", TypeId::BIGINT}}};
+
+  // large pairs, so that few of them make for more buckets than one directory page has slots for
+  ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>> ht("blah", bpm, GenericComparator<64>(&key_schema),
+                                                                      HashFunction<GenericKey<64>>());
+  const int num_keys = 40000;
+  GenericKey<64> key;
+  for (int i = 0; i < num_keys; i++) {
+    key.SetFromInteger(i);
+    ASSERT_TRUE(ht.Insert(nullptr, key, RID(i)));
+  }
+  EXPECT_GT(ht.GetGlobalDepth(), HashTableDirectoryPage::PAGE_DEPTH);
+
+  for (int i = 0; i < num_keys; i += 2) {
+    key.SetFromInteger(i);
+    EXPECT_TRUE(ht.Remove(nullptr, key, RID(i)));
+  }
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<RID> res;
+    key.SetFromInteger(i);
+    EXPECT_EQ(i % 2 == 1, ht.GetValue(nullptr, key, &res));
+    EXPECT_EQ(i % 2 == 1 ? std::vector<RID>{RID(i)} : std::vector<RID>{}, res);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, HasherTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  // the hasher is a template argument of the table
+  ExtendibleHashTable<int, int, IntComparator, Murmur3Hasher> ht("blah", bpm, IntComparator(),
+                                                                 HashFunction<int, Murmur3Hasher>());
+  const int num_keys = 1000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    EXPECT_EQ(std::vector<int>{i}, res);
+  }
+  EXPECT_GT(ht.GetGlobalDepth(), 0);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, ConcurrentTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+  const int num_threads = 4;
+  const int keys_per_thread = 5000;
+  // every thread inserts its own keys, reading back each one and removing every third as it goes, while the others
+  // split the buckets under it
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&ht, t]() {
+      for (int i = t; i < num_threads * keys_per_thread; i += num_threads) {
+        EXPECT_TRUE(ht.Insert(nullptr, i, i));
+        std::vector<int> res;
+        EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+        EXPECT_EQ(std::vector<int>{i}, res);
+        if (i % 3 == 0) {
+          EXPECT_TRUE(ht.Remove(nullptr, i, i));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (int i = 0; i < num_threads * keys_per_thread; i++) {
+    std::vector<int> res;
+    EXPECT_EQ(i % 3 != 0, ht.GetValue(nullptr, i, &res));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, DISABLED_InsertLatencyTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(256, disk_manager);
+  const int num_keys = 50000;
+
+  auto benchmark = [&](HashTable<int, int, IntComparator> *ht, const char *name) {
+    std::chrono::duration<double, std::micro> total(0);
+    std::chrono::duration<double, std::micro> worst(0);
+    for (int i = 0; i < num_keys; i++) {
+      auto start = std::chrono::steady_clock::now();
+      ht->Insert(nullptr, i, i);
+      std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+      total += elapsed;
+      worst = std::max(worst, elapsed);
+    }
+    std::cout << name << ": " << total.count() / num_keys << " us/insert on average, " << worst.count()
+              << " us at worst" << std::endl;
+  };
+  {
+    LinearProbeHashTable<int, int, IntComparator> ht("linear", bpm, IntComparator(), 1000, HashFunction<int>());
+    benchmark(&ht, "linear probing");
+  }
+  {
+    ExtendibleHashTable<int, int, IntComparator> ht("extendible", bpm, IntComparator(), HashFunction<int>());
+    benchmark(&ht, "extendible hashing");
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+}  // namespace bustub
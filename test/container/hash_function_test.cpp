@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_function_test.cpp
+//
+// Identification: test/container/hash_function_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "common/util/hash_util.h"
+#include "container/hash/hash_function.h"
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(HashFunctionTest, Crc32cTest) {
+  // the hashes of integers are the same on every target, with or without the CRC32C instruction
+  EXPECT_EQ(0x8226610566cdc5d6ULL, HashUtil::HashInt(0));
+  EXPECT_EQ(0x9eb5caf49b68c5cdULL, HashUtil::HashInt(1));
+  EXPECT_EQ(0xdd3986841897fdefULL, HashUtil::HashInt(42));
+  EXPECT_EQ(0x2b5c0b16ef7a2eafULL, HashUtil::HashInt(UINT64_MAX));
+  uint64_t value = 0x9E3779B97F4A7C15ULL;
+  for (int i = 0; i < 100000; i++) {
+    value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+    ASSERT_EQ(HashUtil::Crc32cPortable(i, value), HashUtil::Crc32c(i, value)) << value;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(HashFunctionTest, DistributionTest) {
+  const int num_keys = 100000;
+  const int num_buckets = 1024;
+  // sequential keys spread evenly over the buckets of a table, and over the tags of a block page
+  auto check = [&](auto hash_of) {
+    std::vector<int> buckets(num_buckets);
+    std::unordered_set<uint64_t> tags;
+    std::unordered_set<uint64_t> hashes;
+    for (int i = 0; i < num_keys; i++) {
+      uint64_t hash = hash_of(i);
+      buckets[hash % num_buckets]++;
+      tags.insert((hash >> 25) & 0x7F);
+      hashes.insert(hash);
+    }
+    EXPECT_EQ(num_keys, hashes.size());
+    EXPECT_EQ(128, tags.size());
+    int expected = num_keys / num_buckets;
+    EXPECT_LT(*std::max_element(buckets.begin(), buckets.end()), 2 * expected);
+    EXPECT_GT(*std::min_element(buckets.begin(), buckets.end()), expected / 2);
+  };
+  check([](int i) { return HashFunction<int>().GetHash(i); });
+  check([](int i) {
+    GenericKey<64> key;
+    key.SetFromInteger(i);
+    return HashFunction<GenericKey<64>>().GetHash(key);
+  });
+  check([](int i) {
+    std::string s = "key-" + std::to_string(i);
+    return HashUtil::HashBytes(s.data(), s.size());
+  });
+
+  // every length reads its own bytes, and no more
+  std::string bytes = "abcdefghijklmnopqrstuvwxyz0123456789";
+  std::unordered_set<hash_t> prefixes;
+  for (size_t length = 0; length <= bytes.size(); length++) {
+    std::string prefix = bytes.substr(0, length);
+    EXPECT_EQ(HashUtil::HashBytes(prefix.data(), length), HashUtil::HashBytes(bytes.data(), length));
+    prefixes.insert(HashUtil::HashBytes(bytes.data(), length));
+  }
+  EXPECT_EQ(bytes.size() + 1, prefixes.size());
+  EXPECT_NE(HashUtil::CombineHashes(1, 2), HashUtil::CombineHashes(2, 1));
+}
+
+// NOLINTNEXTLINE
+TEST(HashFunctionTest, DISABLED_ThroughputTest) {
+  const int num_hashes = 2000000;
+  auto benchmark = [&](const char *name, auto hash_of) {
+    uint64_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_hashes; i++) {
+      sink += hash_of(i);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_NE(0, sink);
+    std::cout << name << ": " << num_hashes / elapsed.count() / 1e6 << "M hashes/s" << std::endl;
+  };
+
+  benchmark("int, murmur3", [](int i) { return HashFunction<int, Murmur3Hasher>().GetHash(i); });
+  benchmark("int, crc32c", [](int i) { return HashFunction<int, Crc32cHasher>().GetHash(i); });
+  GenericKey<64> key;
+  key.SetFromInteger(0);
+  benchmark("64-byte key, murmur3", [&](int i) {
+    key.SetFromInteger(i);
+    return HashFunction<GenericKey<64>, Murmur3Hasher>().GetHash(key);
+  });
+  benchmark("64-byte key, wyhash", [&](int i) {
+    key.SetFromInteger(i);
+    return HashFunction<GenericKey<64>, WyHasher>().GetHash(key);
+  });
+  // the byte-at-a-time loop that HashUtil::HashBytes used to be
+  std::string value(24, 'x');
+  benchmark("24-byte string, byte loop", [&](int i) {
+    value[0] = static_cast<char>(i);
+    hash_t hash = value.size();
+    for (char byte : value) {
+      hash = ((hash << 5) ^ (hash >> 27)) ^ byte;
+    }
+    return hash;
+  });
+  benchmark("24-byte string, wyhash", [&](int i) {
+    value[0] = static_cast<char>(i);
+    return HashUtil::HashBytes(value.data(), value.size());
+  });
+}
+
+}  // namespace bustub
@@ -18,12 +18,13 @@
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/hash_table_block_page.h"
+#include "storage/page/hash_table_directory_page.h"
 #include "storage/page/hash_table_header_page.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_HeaderPageSampleTest) {
+TEST(HashTablePageTest, HeaderPageSampleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(5, disk_manager);
 
@@ -61,7 +62,7 @@ TEST(HashTablePageTest, DISABLED_HeaderPageSampleTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_BlockPageSampleTest) {
+TEST(HashTablePageTest, BlockPageSampleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(5, disk_manager);
 
@@ -73,7 +74,7 @@ TEST(HashTablePageTest, DISABLED_BlockPageSampleTest) {
 
   // insert a few (key, value) pairs
   for (unsigned i = 0; i < 10; i++) {
-    block_page->Insert(i, i, i);
+    block_page->Insert(i, i, i, i << 25);
   }
 
   // check for the inserted pairs
@@ -103,6 +104,12 @@ TEST(HashTablePageTest, DISABLED_BlockPageSampleTest) {
     }
   }
 
+  // a group of control bytes is matched at once: slot 4 carries the tag of its hash, slot 3 is a tombstone now
+  uint32_t empty;
+  EXPECT_EQ(1U << 4, block_page->MatchGroup(0, 4U << 25, &empty));
+  EXPECT_EQ(0U, block_page->MatchGroup(0, 3U << 25, &empty));
+  EXPECT_EQ(~0U << 10, empty);
+
   // unpin the header page now that we are done
   bpm->UnpinPage(block_page_id, true, nullptr);
   disk_manager->ShutDown();
@@ -111,4 +118,55 @@ TEST(HashTablePageTest, DISABLED_BlockPageSampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, DirectoryPageSampleTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(5, disk_manager);
+
+  // get a directory page from the BufferPoolManager
+  page_id_t directory_page_id = INVALID_PAGE_ID;
+  auto directory_page =
+      reinterpret_cast<HashTableDirectoryPage *>(bpm->NewPage(&directory_page_id, nullptr)->GetData());
+  EXPECT_EQ(0, directory_page->GetGlobalDepth());
+  EXPECT_EQ(1, directory_page->Size());
+  directory_page->SetPageId(directory_page_id);
+  EXPECT_EQ(directory_page_id, directory_page->GetPageId());
+
+  // the one bucket of the empty directory
+  directory_page->SetBucketPageId(0, 10);
+  directory_page->SetLocalDepth(0, 0);
+
+  // doubling the directory points the new slots at the same buckets
+  for (uint32_t depth = 1; depth <= 3; depth++) {
+    directory_page->IncrGlobalDepth();
+    EXPECT_EQ(depth, directory_page->GetGlobalDepth());
+    EXPECT_EQ(1U << depth, directory_page->Size());
+    EXPECT_EQ((1U << depth) - 1, directory_page->GetGlobalDepthMask());
+    for (uint32_t i = 0; i < directory_page->Size(); i++) {
+      EXPECT_EQ(10, directory_page->GetBucketPageId(i));
+      EXPECT_EQ(0, directory_page->GetLocalDepth(i));
+    }
+  }
+
+  // split the bucket on its lowest bit
+  for (uint32_t i = 0; i < directory_page->Size(); i++) {
+    directory_page->SetLocalDepth(i, 1);
+    if ((i & 1) != 0) {
+      directory_page->SetBucketPageId(i, 11);
+    }
+  }
+  directory_page->IncrGlobalDepth();
+  for (uint32_t i = 0; i < directory_page->Size(); i++) {
+    EXPECT_EQ((i & 1) != 0 ? 11 : 10, directory_page->GetBucketPageId(i));
+    EXPECT_EQ(1, directory_page->GetLocalDepth(i));
+  }
+
+  // unpin the directory page now that we are done
+  bpm->UnpinPage(directory_page_id, true, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
@@ -10,6 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <iostream>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -21,7 +25,7 @@
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(HashTableTest, DISABLED_SampleTest) {
+TEST(HashTableTest, SampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(50, disk_manager);
 
@@ -104,4 +108,235 @@ TEST(HashTableTest, DISABLED_SampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTableTest, ResizeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  // the table starts out with a handful of buckets and doubles as it fills up
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 10, HashFunction<int>());
+  const int num_keys = 5000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    EXPECT_TRUE(ht.Insert(nullptr, i % 10, -i - 1));
+  }
+  EXPECT_GE(ht.GetSize(), 2 * num_keys);
+
+  for (int i = 0; i < num_keys; i += 2) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  for (int i = 10; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_EQ(i % 2 == 1, ht.GetValue(nullptr, i, &res));
+    EXPECT_EQ(i % 2 == 1 ? std::vector<int>{i} : std::vector<int>{}, res);
+  }
+  // one key with many values
+  std::vector<int> res;
+  ht.GetValue(nullptr, 3, &res);
+  EXPECT_EQ(num_keys / 10 + 1, res.size());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, HasherTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  // the hasher is a template argument of the table
+  LinearProbeHashTable<int, int, IntComparator, Murmur3Hasher> ht("blah", bpm, IntComparator(), 10,
+                                                                  HashFunction<int, Murmur3Hasher>());
+  const int num_keys = 1000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    EXPECT_EQ(std::vector<int>{i}, res);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, DISABLED_InsertLatencyHistogramTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(256, disk_manager);
+
+  // the table doubles six times on the way, migrating its pairs as the inserts go on
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1000, HashFunction<int>());
+  const int num_keys = 100000;
+  std::vector<double> latencies;
+  latencies.reserve(num_keys);
+  for (int i = 0; i < num_keys; i++) {
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    latencies.push_back(elapsed.count());
+  }
+  // every pair can be found, whether or not it has been migrated yet
+  for (int i = 0; i < num_keys; i += 7) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    EXPECT_EQ(std::vector<int>{i}, res);
+  }
+
+  // power of two buckets of microseconds
+  std::vector<int> histogram;
+  for (double latency : latencies) {
+    size_t bucket = 0;
+    while (latency >= static_cast<double>(1ULL << bucket)) {
+      bucket++;
+    }
+    histogram.resize(std::max(histogram.size(), bucket + 1));
+    histogram[bucket]++;
+  }
+  for (size_t bucket = 0; bucket < histogram.size(); bucket++) {
+    std::cout << "< " << (1ULL << bucket) << " us: " << histogram[bucket] << std::endl;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&](double p) { return latencies[static_cast<size_t>(p * (latencies.size() - 1))]; };
+  std::cout << "p50 " << percentile(0.5) << " us, p99 " << percentile(0.99) << " us, p99.99 " << percentile(0.9999)
+            << " us, max " << latencies.back() << " us" << std::endl;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, OptimisticConcurrentTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  // small enough to resize, and migrate, under the readers
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 10, HashFunction<int>(),
+                                                   HashTableConcurrencyMode::OPTIMISTIC);
+  const int num_stable = 1000;
+  const int num_threads = 4;
+  const int keys_per_thread = 3000;
+  for (int i = 0; i < num_stable; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  // the writers insert and remove keys of their own, while the readers look up the keys that stay put
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&ht, t]() {
+      for (int i = num_stable + t; i < num_stable + num_threads * keys_per_thread; i += num_threads) {
+        EXPECT_TRUE(ht.Insert(nullptr, i, i));
+        if (i % 3 == 0) {
+          EXPECT_TRUE(ht.Remove(nullptr, i, i));
+        }
+      }
+    });
+  }
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 2; t++) {
+    readers.emplace_back([&ht, &done, t]() {
+      for (int i = t; !done; i = (i + 7) % num_stable) {
+        std::vector<int> res;
+        EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+        EXPECT_EQ(std::vector<int>{i}, res);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  done = true;
+  for (auto &thread : readers) {
+    thread.join();
+  }
+  for (int i = 0; i < num_stable + num_threads * keys_per_thread; i++) {
+    std::vector<int> res;
+    EXPECT_EQ(i < num_stable || i % 3 != 0, ht.GetValue(nullptr, i, &res));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, DISABLED_ReadThroughputTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(256, disk_manager);
+  const int num_keys = 20000;
+  const int lookups_per_thread = 100000;
+
+  auto benchmark = [&](HashTableConcurrencyMode mode, const char *name) {
+    LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 2 * num_keys, HashFunction<int>(),
+                                                     mode);
+    for (int i = 0; i < num_keys; i++) {
+      ht.Insert(nullptr, i, i);
+    }
+    for (int num_threads = 1; num_threads <= 4; num_threads *= 2) {
+      auto start = std::chrono::steady_clock::now();
+      std::vector<std::thread> threads;
+      for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+          for (int i = 0; i < lookups_per_thread; i++) {
+            std::vector<int> res;
+            ht.GetValue(nullptr, (i * 31 + t) % num_keys, &res);
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      std::cout << name << ", " << num_threads << " threads: " << num_threads * lookups_per_thread / elapsed.count()
+                << " lookups/s" << std::endl;
+    }
+  };
+  benchmark(HashTableConcurrencyMode::LATCHED, "latched");
+  benchmark(HashTableConcurrencyMode::OPTIMISTIC, "optimistic");
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, DISABLED_ProbeBenchmarkTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(1024, disk_manager);
+
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1000, HashFunction<int>());
+  const int num_keys = 50000;
+  const int num_lookups = 200000;
+  for (int i = 0; i < num_keys; i++) {
+    ht.Insert(nullptr, i, i);
+  }
+  // hits look up keys in the table, misses keys that are not
+  for (int miss = 0; miss < 2; miss++) {
+    int found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_lookups; i++) {
+      std::vector<int> res;
+      found += static_cast<int>(ht.GetValue(nullptr, (i * 31) % num_keys + miss * num_keys, &res));
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(miss == 0 ? num_lookups : 0, found);
+    std::cout << (miss == 0 ? "hit" : "miss") << " probes: " << num_lookups / elapsed.count() << " lookups/s"
+              << std::endl;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
@@ -10,15 +10,18 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cstdio>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "execution/plans/delete_plan.h"
 #include "execution/plans/limit_plan.h"
+#include "execution/plans/nested_loop_join_plan.h"
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/table_generator.h"
@@ -31,8 +34,11 @@
 #include "execution/expressions/aggregate_value_expression.h"
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/conjunction_expression.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/plans/index_scan_plan.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "execution/plans/update_plan.h"
 #include "gtest/gtest.h"
 #include "storage/b_plus_tree_test_util.h"  // NOLINT
 #include "storage/table/tuple.h"
@@ -104,9 +110,15 @@ class ExecutorTest : public ::testing::Test {
     return allocated_exprs_.back().get();
   }
 
-  const AbstractExpression *MakeAggregateValueExpression(bool is_group_by_term, uint32_t term_idx) {
-    allocated_exprs_.emplace_back(
-        std::make_unique<AggregateValueExpression>(is_group_by_term, term_idx, TypeId::INTEGER));
+  const AbstractExpression *MakeConjunctionExpression(const AbstractExpression *lhs, const AbstractExpression *rhs,
+                                                      ConjunctionType conj_type) {
+    allocated_exprs_.emplace_back(std::make_unique<ConjunctionExpression>(lhs, rhs, conj_type));
+    return allocated_exprs_.back().get();
+  }
+
+  const AbstractExpression *MakeAggregateValueExpression(bool is_group_by_term, uint32_t term_idx,
+                                                         TypeId ret_type = TypeId::INTEGER) {
+    allocated_exprs_.emplace_back(std::make_unique<AggregateValueExpression>(is_group_by_term, term_idx, ret_type));
     return allocated_exprs_.back().get();
   }
 
@@ -140,7 +152,7 @@ class ExecutorTest : public ::testing::Test {
 };
 
 // NOLINTNEXTLINE
-TEST_F(ExecutorTest, DISABLED_SimpleSeqScanTest) {
+TEST_F(ExecutorTest, SimpleSeqScanTest) {
   // SELECT colA, colB FROM test_1 WHERE colA < 500
 
   // Construct query plan
@@ -169,7 +181,245 @@ TEST_F(ExecutorTest, DISABLED_SimpleSeqScanTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(ExecutorTest, DISABLED_SimpleRawInsertTest) {
+TEST_F(ExecutorTest, SeqScanViewTest) {
+  // SELECT * FROM test_1 WHERE colA < 500 and SELECT colD, colA FROM test_1 WHERE colA < 500, through views
+  TableMetadata *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  std::vector<std::pair<std::string, const AbstractExpression *>> columns;
+  for (const auto &col : schema.GetColumns()) {
+    columns.emplace_back(col.GetName(), MakeColumnValueExpression(schema, 0, col.GetName()));
+  }
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *const500 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(500));
+  auto *predicate = MakeComparisonExpression(colA, const500, ComparisonType::LessThan);
+  auto *all_schema = MakeOutputSchema(columns);
+  auto *projected_schema = MakeOutputSchema({columns[3], columns[0]});
+  SeqScanPlanNode all_plan{all_schema, predicate, table_info->oid_};
+  SeqScanPlanNode projected_plan{projected_schema, predicate, table_info->oid_};
+
+  for (const auto *plan : {&all_plan, &projected_plan}) {
+    const Schema *out_schema = plan->OutputSchema();
+    uint32_t a_idx = out_schema->GetColIdx("colA");
+    uint32_t d_idx = out_schema->GetColIdx("colD");
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(plan, &result_set, GetTxn(), GetExecutorContext());
+    ASSERT_EQ(500, result_set.size());
+
+    // the views read the same as the tuples that Next copies out, and know their RIDs
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), plan);
+    executor->Init();
+    TupleView view;
+    RID rid;
+    size_t num_viewed = 0;
+    for (; executor->NextView(&view, &rid); num_viewed++) {
+      ASSERT_LT(num_viewed, result_set.size());
+      ASSERT_EQ(result_set[num_viewed].GetInt32(out_schema, a_idx), view->GetInt32(out_schema, a_idx));
+      ASSERT_EQ(result_set[num_viewed].GetInt32(out_schema, d_idx), view->GetInt32(out_schema, d_idx));
+      Tuple tuple;
+      ASSERT_TRUE(table_info->table_->GetTuple(rid, &tuple, GetTxn()));
+      ASSERT_EQ(tuple.GetInt32(&schema, 0), view->GetInt32(out_schema, a_idx));
+    }
+    ASSERT_EQ(result_set.size(), num_viewed);
+
+    // Init rewinds the executor for either kind of scan
+    const int num_scans = 2;
+    int64_t sum = 0;
+    for (int i = 0; i < num_scans; i++) {
+      executor->Init();
+      Tuple tuple;
+      while (executor->Next(&tuple, &rid)) {
+        sum += tuple.GetInt32(out_schema, d_idx);
+      }
+    }
+    for (int i = 0; i < num_scans; i++) {
+      executor->Init();
+      while (executor->NextView(&view, &rid)) {
+        sum -= view->GetInt32(out_schema, d_idx);
+      }
+    }
+    EXPECT_EQ(0, sum);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, PaxSeqScanTest) {
+  // INSERT INTO pax_1 SELECT * FROM test_1, then SELECT colD, colA FROM either table WHERE colA < 500
+  TableMetadata *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  TableMetadata *pax_info = GetCatalog()->CreateTable(GetTxn(), "pax_1", schema, TableFormat::PAX);
+  ASSERT_EQ(TableFormat::PAX, pax_info->table_->GetFormat());
+  std::vector<std::pair<std::string, const AbstractExpression *>> columns;
+  for (const auto &col : schema.GetColumns()) {
+    columns.emplace_back(col.GetName(), MakeColumnValueExpression(schema, 0, col.GetName()));
+  }
+  SeqScanPlanNode copy_plan{MakeOutputSchema(columns), nullptr, table_info->oid_};
+  InsertPlanNode insert_plan{&copy_plan, pax_info->oid_};
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+
+  // The projected scans of the PAX table read colA and colD only, see ColumnScan, and compare colA a batch at a time
+  // unless the predicate is more than one comparison; the other ones read whole tuples.
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *const500 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(500));
+  auto *less_than = MakeComparisonExpression(colA, const500, ComparisonType::LessThan);
+  auto *greater_than = MakeComparisonExpression(const500, colA, ComparisonType::GreaterThan);
+  auto *conjunction = MakeConjunctionExpression(less_than, greater_than, ConjunctionType::And);
+  for (const auto *out_schema : {MakeOutputSchema({columns[3], columns[0]}), MakeOutputSchema(columns)}) {
+    for (const auto *predicate : {less_than, greater_than, conjunction}) {
+      SeqScanPlanNode row_plan{out_schema, predicate, table_info->oid_};
+      SeqScanPlanNode pax_plan{out_schema, predicate, pax_info->oid_};
+      std::vector<Tuple> row_result;
+      std::vector<Tuple> pax_result;
+      GetExecutionEngine()->Execute(&row_plan, &row_result, GetTxn(), GetExecutorContext());
+      GetExecutionEngine()->Execute(&pax_plan, &pax_result, GetTxn(), GetExecutorContext());
+      ASSERT_EQ(500, row_result.size());
+      ASSERT_EQ(row_result.size(), pax_result.size());
+      for (size_t i = 0; i < row_result.size(); i++) {
+        for (uint32_t c = 0; c < out_schema->GetColumnCount(); c++) {
+          ASSERT_EQ(CmpBool::CmpTrue,
+                    row_result[i].GetValue(out_schema, c).CompareEquals(pax_result[i].GetValue(out_schema, c)));
+        }
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SimpleIndexScanTest) {
+  // SELECT colA, colB FROM test_1 WHERE colA >= 100 AND 200 > colA, through an index on colA
+
+  TableMetadata *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  Schema *key_schema = ParseCreateStatement("a int");
+  auto *index_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index_colA", "test_1", schema, *key_schema, {0}, 8);
+
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *const100 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(100));
+  auto *const200 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(200));
+  auto *predicate = MakeConjunctionExpression(
+      MakeComparisonExpression(colA, const100, ComparisonType::GreaterThanOrEqual),
+      MakeComparisonExpression(const200, colA, ComparisonType::GreaterThan), ConjunctionType::And);
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+
+  // the key range is pushed into the index, so the tuples come back in key order
+  for (auto direction : {ScanDirection::FORWARD, ScanDirection::BACKWARD}) {
+    IndexScanPlanNode plan{out_schema, predicate, index_info->index_oid_, direction};
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+    ASSERT_EQ(result_set.size(), 100);
+    for (size_t i = 0; i < result_set.size(); i++) {
+      int32_t expected = direction == ScanDirection::FORWARD ? 100 + i : 199 - i;
+      ASSERT_EQ(result_set[i].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(), expected);
+      ASSERT_TRUE(result_set[i].GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>() < 10);
+    }
+  }
+
+  // contradictory bounds return nothing, a single equality is a point lookup
+  auto *const50 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(50));
+  auto *empty = MakeConjunctionExpression(MakeComparisonExpression(colA, const50, ComparisonType::LessThan),
+                                          MakeComparisonExpression(colA, const100, ComparisonType::GreaterThan),
+                                          ConjunctionType::And);
+  IndexScanPlanNode empty_plan{out_schema, empty, index_info->index_oid_};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&empty_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_TRUE(result_set.empty());
+
+  IndexScanPlanNode point_plan{out_schema, MakeComparisonExpression(colA, const50, ComparisonType::Equal),
+                               index_info->index_oid_};
+  GetExecutionEngine()->Execute(&point_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 1);
+  ASSERT_EQ(result_set[0].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(), 50);
+
+  // a fractional bound rounds toward the keys it lets through, and one beyond the key type opens or empties the range
+  auto count = [&](ComparisonType comp_type, const Value &value) {
+    IndexScanPlanNode plan{out_schema, MakeComparisonExpression(colA, MakeConstantValueExpression(value), comp_type),
+                           index_info->index_oid_};
+    std::vector<Tuple> result;
+    GetExecutionEngine()->Execute(&plan, &result, GetTxn(), GetExecutorContext());
+    return result.size();
+  };
+  EXPECT_EQ(6, count(ComparisonType::LessThan, ValueFactory::GetDecimalValue(5.5)));
+  EXPECT_EQ(6, count(ComparisonType::LessThanOrEqual, ValueFactory::GetDecimalValue(5.5)));
+  EXPECT_EQ(5, count(ComparisonType::LessThan, ValueFactory::GetDecimalValue(5.0)));
+  EXPECT_EQ(994, count(ComparisonType::GreaterThan, ValueFactory::GetDecimalValue(5.5)));
+  EXPECT_EQ(994, count(ComparisonType::GreaterThanOrEqual, ValueFactory::GetDecimalValue(5.5)));
+  EXPECT_EQ(0, count(ComparisonType::Equal, ValueFactory::GetDecimalValue(5.5)));
+  EXPECT_EQ(1, count(ComparisonType::Equal, ValueFactory::GetDecimalValue(5.0)));
+  EXPECT_EQ(1000, count(ComparisonType::LessThan, ValueFactory::GetBigIntValue(int64_t{1} << 40)));
+  EXPECT_EQ(0, count(ComparisonType::GreaterThan, ValueFactory::GetBigIntValue(int64_t{1} << 40)));
+  EXPECT_EQ(0, count(ComparisonType::Equal, ValueFactory::GetBigIntValue(int64_t{1} << 40)));
+  EXPECT_EQ(1000, count(ComparisonType::GreaterThan, ValueFactory::GetDecimalValue(-1e30)));
+  EXPECT_EQ(0, count(ComparisonType::LessThanOrEqual, ValueFactory::GetDecimalValue(-1e30)));
+  EXPECT_EQ(10, count(ComparisonType::LessThan, ValueFactory::GetBigIntValue(10)));
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, CoveringIndexScanTest) {
+  // SELECT colA, colB FROM test_1 WHERE colA >= 100 AND colA < 200, through an index on colA that includes colB
+
+  TableMetadata *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  Schema *key_schema = ParseCreateStatement("a int");
+  auto *index_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<16>, RID, GenericComparator<16>>(
+      GetTxn(), "index_colA_colB", "test_1", schema, *key_schema, {0}, 16, true, 1, false, {1});
+  // a non-unique index keeps one leaf entry per key, so it cannot include columns
+  EXPECT_THROW((GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<16>, RID, GenericComparator<16>>(
+                   GetTxn(), "index_colB_colA", "test_1", schema, *key_schema, {1}, 16, false, 1, false, {0})),
+               Exception);
+
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *colC = MakeColumnValueExpression(schema, 0, "colC");
+  auto *const100 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(100));
+  auto *const200 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(200));
+  auto *predicate = MakeConjunctionExpression(
+      MakeComparisonExpression(colA, const100, ComparisonType::GreaterThanOrEqual),
+      MakeComparisonExpression(colA, const200, ComparisonType::LessThan), ConjunctionType::And);
+  auto *covered_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  auto *uncovered_schema = MakeOutputSchema({{"colA", colA}, {"colC", colC}});
+
+  // the covered query reads colB from the index, matching the table; colA is the row number
+  std::vector<int32_t> col_b;
+  for (auto it = table_info->table_->Begin(GetTxn()); it != table_info->table_->End(); ++it) {
+    col_b.push_back(it->GetValue(&schema, 1).GetAs<int32_t>());
+  }
+  for (auto direction : {ScanDirection::FORWARD, ScanDirection::BACKWARD}) {
+    IndexScanPlanNode plan{covered_schema, predicate, index_info->index_oid_, direction};
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+    ASSERT_EQ(result_set.size(), 100);
+    for (size_t i = 0; i < result_set.size(); i++) {
+      int32_t a = result_set[i].GetValue(covered_schema, 0).GetAs<int32_t>();
+      ASSERT_EQ(a, direction == ScanDirection::FORWARD ? 100 + i : 199 - i);
+      ASSERT_EQ(result_set[i].GetValue(covered_schema, 1).GetAs<int32_t>(), col_b[a]);
+    }
+  }
+
+  // delete the rows from the heap behind the index's back: only the query that needs colC notices
+  for (auto it = table_info->table_->Begin(GetTxn()); it != table_info->table_->End(); ++it) {
+    table_info->table_->ApplyDelete(it->GetRid(), GetTxn());
+  }
+  IndexScanPlanNode covered_plan{covered_schema, predicate, index_info->index_oid_};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&covered_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 100);
+  IndexScanPlanNode point_plan{covered_schema, MakeComparisonExpression(colA, const100, ComparisonType::Equal),
+                               index_info->index_oid_};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&point_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 1);
+  ASSERT_EQ(result_set[0].GetValue(covered_schema, 1).GetAs<int32_t>(), col_b[100]);
+  IndexScanPlanNode uncovered_plan{uncovered_schema, predicate, index_info->index_oid_};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&uncovered_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_TRUE(result_set.empty());
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SimpleRawInsertTest) {
   // INSERT INTO empty_table2 VALUES (100, 10), (101, 11), (102, 12)
   // Create Values to insert
   std::vector<Value> val1{ValueFactory::GetIntegerValue(100), ValueFactory::GetIntegerValue(10)};
@@ -214,7 +464,7 @@ TEST_F(ExecutorTest, DISABLED_SimpleRawInsertTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(ExecutorTest, DISABLED_SimpleSelectInsertTest) {
+TEST_F(ExecutorTest, SimpleSelectInsertTest) {
   // INSERT INTO empty_table2 SELECT colA, colB FROM test_1 WHERE colA < 500
   std::unique_ptr<AbstractPlanNode> scan_plan1;
   const Schema *out_schema1;
@@ -266,7 +516,7 @@ TEST_F(ExecutorTest, DISABLED_SimpleSelectInsertTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(ExecutorTest, DISABLED_SimpleRawInsertWithIndexTest) {
+TEST_F(ExecutorTest, SimpleRawInsertWithIndexTest) {
   // INSERT INTO empty_table2 VALUES (100, 10), (101, 11), (102, 12)
   // Create Values to insert
   std::vector<Value> val1{ValueFactory::GetIntegerValue(100), ValueFactory::GetIntegerValue(10)};
@@ -335,6 +585,113 @@ TEST_F(ExecutorTest, DISABLED_SimpleRawInsertWithIndexTest) {
   delete key_schema;
 }
 
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, BulkInsertTest) {
+  // INSERT INTO empty_table2 VALUES (1000, 0), ..., (2999, 9), which spans several batches of the insert executor
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("empty_table2");
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  auto index_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index1", "empty_table2", table_info->schema_, *key_schema, {0}, 8);
+  const int num_raw = 2000;
+  std::vector<std::vector<Value>> raw_vals;
+  for (int i = 0; i < num_raw; i++) {
+    raw_vals.push_back({ValueFactory::GetIntegerValue(1000 + i), ValueFactory::GetIntegerValue(i % 10)});
+  }
+  InsertPlanNode raw_insert_plan{std::move(raw_vals), table_info->oid_};
+  GetExecutionEngine()->Execute(&raw_insert_plan, nullptr, GetTxn(), GetExecutorContext());
+
+  // INSERT INTO empty_table2 SELECT colA, colB FROM test_1 WHERE colA < 500, through an index on test_1
+  auto test_1_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema *int_key_schema = ParseCreateStatement("a int");
+  auto test_1_index_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index_colA", "test_1", test_1_info->schema_, *int_key_schema, {0}, 8);
+  auto *colA = MakeColumnValueExpression(test_1_info->schema_, 0, "colA");
+  auto *colB = MakeColumnValueExpression(test_1_info->schema_, 0, "colB");
+  auto *predicate = MakeComparisonExpression(colA, MakeConstantValueExpression(ValueFactory::GetIntegerValue(500)),
+                                             ComparisonType::LessThan);
+  IndexScanPlanNode scan_plan{MakeOutputSchema({{"colA", colA}, {"colB", colB}}), predicate,
+                              test_1_index_info->index_oid_};
+  InsertPlanNode select_insert_plan{&scan_plan, table_info->oid_};
+  GetExecutionEngine()->Execute(&select_insert_plan, nullptr, GetTxn(), GetExecutorContext());
+
+  // every row is in the table, and the index points at it
+  auto &schema = table_info->schema_;
+  std::unordered_set<int32_t> keys;
+  for (auto it = table_info->table_->Begin(GetTxn()); it != table_info->table_->End(); ++it) {
+    int32_t a = it->GetValue(&schema, 0).GetAs<int32_t>();
+    ASSERT_TRUE(keys.insert(a).second);
+    if (a >= 1000) {
+      ASSERT_EQ((a - 1000) % 10, it->GetValue(&schema, 1).GetAs<int32_t>());
+    }
+    std::vector<RID> rids;
+    auto index_key = it->KeyFromTuple(schema, index_info->key_schema_, index_info->index_->GetKeyAttrs());
+    index_info->index_->ScanKey(index_key, &rids, GetTxn());
+    ASSERT_EQ(1, rids.size());
+    ASSERT_EQ(it->GetRid(), rids[0]);
+  }
+  ASSERT_EQ(num_raw + 500, keys.size());
+  delete int_key_schema;
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, UpdateTest) {
+  // indexes on colA, through which the updates find their rows, and on colB
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  Schema *key_schema = ParseCreateStatement("a int");
+  auto index_a = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index_colA", "test_1", schema, *key_schema, {0}, 8);
+  auto index_b = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index_colB", "test_1", schema, *key_schema, {1}, 8, false);
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *predicate = MakeComparisonExpression(colA, MakeConstantValueExpression(ValueFactory::GetIntegerValue(500)),
+                                             ComparisonType::LessThan);
+  IndexScanPlanNode scan_plan{MakeOutputSchema({{"colA", colA}}), predicate, index_a->index_oid_};
+  std::vector<RID> rids;
+  for (auto it = table_info->table_->Begin(GetTxn()); it != table_info->table_->End(); ++it) {
+    rids.push_back(it->GetRid());
+  }
+
+  // UPDATE test_1 SET colC = colC + 1 WHERE colA < 500, a counter update that changes no index
+  std::unordered_map<uint32_t, UpdateInfo> counter_attrs{{2, UpdateInfo(UpdateType::Add, 1)}};
+  UpdatePlanNode counter_plan{&scan_plan, table_info->oid_, counter_attrs};
+  size_t num_writes = GetTxn()->GetWriteSet()->size();
+  size_t num_index_writes = GetTxn()->GetIndexWriteSet()->size();
+  GetExecutionEngine()->Execute(&counter_plan, nullptr, GetTxn(), GetExecutorContext());
+  EXPECT_EQ(num_writes + 500, GetTxn()->GetWriteSet()->size());
+  EXPECT_EQ(num_index_writes, GetTxn()->GetIndexWriteSet()->size());
+
+  // UPDATE test_1 SET colB = 10 WHERE colA < 500, which moves the rows to another key of the colB index
+  std::unordered_map<uint32_t, UpdateInfo> group_attrs{{1, UpdateInfo(UpdateType::Set, 10)}};
+  UpdatePlanNode group_plan{&scan_plan, table_info->oid_, group_attrs};
+  GetExecutionEngine()->Execute(&group_plan, nullptr, GetTxn(), GetExecutorContext());
+  EXPECT_EQ(num_index_writes + 500, GetTxn()->GetIndexWriteSet()->size());
+
+  // the rows kept their RIDs, and both indexes point at them
+  size_t i = 0;
+  std::vector<RID> group_rids;
+  for (auto it = table_info->table_->Begin(GetTxn()); it != table_info->table_->End(); ++it, i++) {
+    ASSERT_EQ(rids[i], it->GetRid());
+    int32_t a = it->GetValue(&schema, 0).GetAs<int32_t>();
+    std::vector<RID> result;
+    index_a->index_->ScanKey(Tuple({ValueFactory::GetIntegerValue(a)}, key_schema), &result, GetTxn());
+    ASSERT_EQ(std::vector<RID>{it->GetRid()}, result);
+    if (a < 500) {
+      ASSERT_EQ(10, it->GetValue(&schema, 1).GetAs<int32_t>());
+      group_rids.push_back(it->GetRid());
+    }
+  }
+  ASSERT_EQ(rids.size(), i);
+  std::vector<RID> result;
+  index_b->index_->ScanKey(Tuple({ValueFactory::GetIntegerValue(10)}, key_schema), &result, GetTxn());
+  auto by_rid = [](const RID &x, const RID &y) { return x.Get() < y.Get(); };
+  std::sort(result.begin(), result.end(), by_rid);
+  std::sort(group_rids.begin(), group_rids.end(), by_rid);
+  ASSERT_EQ(group_rids, result);
+  delete key_schema;
+}
+
 // NOLINTNEXTLINE
 TEST_F(ExecutorTest, DISABLED_SimpleDeleteTest) {
   // SELECT colA FROM test_1 WHERE colA == 50
@@ -386,7 +743,7 @@ TEST_F(ExecutorTest, DISABLED_SimpleDeleteTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(ExecutorTest, DISABLED_SimpleNestedLoopJoinTest) {
+TEST_F(ExecutorTest, SimpleNestedLoopJoinTest) {
   // SELECT test_1.colA, test_1.colB, test_2.col1, test_2.col3 FROM test_1 JOIN test_2 ON test_1.colA = test_2.col1
   std::unique_ptr<AbstractPlanNode> scan_plan1;
   const Schema *out_schema1;
@@ -436,7 +793,7 @@ TEST_F(ExecutorTest, DISABLED_SimpleNestedLoopJoinTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(ExecutorTest, DISABLED_SimpleAggregationTest) {
+TEST_F(ExecutorTest, SimpleAggregationTest) {
   // SELECT COUNT(colA), SUM(colA), min(colA), max(colA) from test_1;
   std::unique_ptr<AbstractPlanNode> scan_plan;
   const Schema *scan_schema;
@@ -487,7 +844,7 @@ TEST_F(ExecutorTest, DISABLED_SimpleAggregationTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(ExecutorTest, DISABLED_SimpleGroupByAggregation) {
+TEST_F(ExecutorTest, SimpleGroupByAggregation) {
   // SELECT count(colA), colB, sum(colC) FROM test_1 Group By colB HAVING count(colA) > 100
   std::unique_ptr<AbstractPlanNode> scan_plan;
   const Schema *scan_schema;
@@ -546,4 +903,74 @@ TEST_F(ExecutorTest, DISABLED_SimpleGroupByAggregation) {
   }
 }
 
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, JoinAggregationTest) {
+  // SELECT name, COUNT(colA), SUM(colC) FROM test_1 JOIN names ON test_1.colB = names.id GROUP BY name
+  Schema names_schema{std::vector<Column>{Column{"id", TypeId::INTEGER}, Column{"name", TypeId::VARCHAR, 32}}};
+  auto names_info = GetCatalog()->CreateTable(GetTxn(), "names", names_schema);
+  const int num_names = 100;
+  const int num_groups = 7;
+  auto group_name = [](int i) { return "a group name of some length " + std::to_string(i % num_groups); };
+  std::vector<std::vector<Value>> raw_vals;
+  for (int i = 0; i < num_names; i++) {
+    raw_vals.push_back({ValueFactory::GetIntegerValue(i % 10), ValueFactory::GetVarcharValue(group_name(i))});
+  }
+  InsertPlanNode insert_plan{std::move(raw_vals), names_info->oid_};
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+
+  TableMetadata *test_1_info = GetCatalog()->GetTable("test_1");
+  const Schema *left_schema = MakeOutputSchema({{"colA", MakeColumnValueExpression(test_1_info->schema_, 0, "colA")},
+                                                {"colB", MakeColumnValueExpression(test_1_info->schema_, 0, "colB")},
+                                                {"colC", MakeColumnValueExpression(test_1_info->schema_, 0, "colC")}});
+  SeqScanPlanNode left_plan{left_schema, nullptr, test_1_info->oid_};
+  const Schema *right_schema = MakeOutputSchema({{"id", MakeColumnValueExpression(names_info->schema_, 0, "id")},
+                                                 {"name", MakeColumnValueExpression(names_info->schema_, 0, "name")}});
+  SeqScanPlanNode right_plan{right_schema, nullptr, names_info->oid_};
+  auto *predicate = MakeComparisonExpression(MakeColumnValueExpression(*left_schema, 0, "colB"),
+                                             MakeColumnValueExpression(*right_schema, 1, "id"), ComparisonType::Equal);
+  const Schema *join_schema = MakeOutputSchema({{"colA", MakeColumnValueExpression(*left_schema, 0, "colA")},
+                                                {"colC", MakeColumnValueExpression(*left_schema, 0, "colC")},
+                                                {"name", MakeColumnValueExpression(*right_schema, 1, "name")}});
+  NestedLoopJoinPlanNode join_plan{join_schema, {&left_plan, &right_plan}, predicate};
+  const AbstractExpression *colA = MakeColumnValueExpression(*join_schema, 0, "colA");
+  const AbstractExpression *colC = MakeColumnValueExpression(*join_schema, 0, "colC");
+  const AbstractExpression *name = MakeColumnValueExpression(*join_schema, 0, "name");
+  const Schema *agg_schema = MakeOutputSchema({{"name", MakeAggregateValueExpression(true, 0, TypeId::VARCHAR)},
+                                               {"countA", MakeAggregateValueExpression(false, 0)},
+                                               {"sumC", MakeAggregateValueExpression(false, 1)}});
+  AggregationPlanNode agg_plan{agg_schema,
+                               &join_plan,
+                               nullptr,
+                               {name},
+                               {colA, colC},
+                               {AggregationType::CountAggregate, AggregationType::SumAggregate}};
+
+  // the expected groups, joined by hand
+  std::unordered_map<std::string, std::pair<int32_t, int32_t>> expected;
+  for (auto it = test_1_info->table_->Begin(GetTxn()); it != test_1_info->table_->End(); ++it) {
+    for (int i = 0; i < num_names; i++) {
+      if (i % 10 == it->GetInt32(&test_1_info->schema_, 1)) {
+        auto &group = expected[group_name(i)];
+        group.first++;
+        group.second += it->GetInt32(&test_1_info->schema_, 2);
+      }
+    }
+  }
+
+  // the pool starts every query empty, so a query runs the same the second time
+  const int num_queries = 2;
+  for (int i = 0; i < num_queries; i++) {
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&agg_plan, &result_set, GetTxn(), GetExecutorContext());
+    ASSERT_EQ(num_groups, result_set.size());
+    for (const auto &tuple : result_set) {
+      const auto &group = expected.at(tuple.GetValue(agg_schema, 0).ToString());
+      ASSERT_EQ(group.first, tuple.GetInt32(agg_schema, 1));
+      ASSERT_EQ(group.second, tuple.GetInt32(agg_schema, 2));
+    }
+    // the memory that the query kept is freed with it
+    ASSERT_EQ(0, GetExecutorContext()->GetPool()->GetAllocatedBytes());
+  }
+}
+
 }  // namespace bustub
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <chrono>  // NOLINT
 #include <string>
 #include <vector>
 
@@ -17,12 +18,15 @@
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
 #include "concurrency/transaction_manager.h"
+#include "container/hash/linear_probe_hash_table.h"
 #include "gtest/gtest.h"
 #include "logging/common.h"
 #include "recovery/log_recovery.h"
+#include "storage/page/header_page.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
@@ -43,7 +47,7 @@ class RecoveryTest : public ::testing::Test {
 };
 
 // NOLINTNEXTLINE
-TEST_F(RecoveryTest, DISABLED_RedoTest) {
+TEST_F(RecoveryTest, RedoTest) {
   BustubInstance *bustub_instance = new BustubInstance("test.db");
 
   ASSERT_FALSE(enable_logging);
@@ -89,16 +93,15 @@ TEST_F(RecoveryTest, DISABLED_RedoTest) {
   bustub_instance = new BustubInstance("test.db");
 
   ASSERT_FALSE(enable_logging);
-  LOG_INFO("Check if tuple is not in table before recovery");
+  LOG_INFO("Check if the table is not on disk before recovery");
   Tuple old_tuple;
   Tuple old_tuple1;
-  txn = bustub_instance->transaction_manager_->Begin();
-  test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
-                             bustub_instance->log_manager_, first_page_id);
-  ASSERT_FALSE(test_table->GetTuple(rid, &old_tuple, txn));
-  ASSERT_FALSE(test_table->GetTuple(rid1, &old_tuple1, txn));
-  bustub_instance->transaction_manager_->Commit(txn);
-  delete txn;
+  // the table cannot be opened yet, since its first page never reached the disk, and reads as zeros
+  auto *first_page = static_cast<TablePage *>(bustub_instance->buffer_pool_manager_->FetchPage(first_page_id));
+  RID first_rid;
+  ASSERT_FALSE(first_page->GetFirstTupleRid(&first_rid));
+  ASSERT_EQ(0, first_page->GetLSN());
+  bustub_instance->buffer_pool_manager_->UnpinPage(first_page_id, false);
 
   LOG_INFO("Begin recovery");
   auto *log_recovery = new LogRecovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_);
@@ -112,7 +115,6 @@ TEST_F(RecoveryTest, DISABLED_RedoTest) {
 
   LOG_INFO("Check if recovery success");
   txn = bustub_instance->transaction_manager_->Begin();
-  delete test_table;
   test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
                              bustub_instance->log_manager_, first_page_id);
 
@@ -132,7 +134,7 @@ TEST_F(RecoveryTest, DISABLED_RedoTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(RecoveryTest, DISABLED_UndoTest) {
+TEST_F(RecoveryTest, UndoTest) {
   BustubInstance *bustub_instance = new BustubInstance("test.db");
 
   ASSERT_FALSE(enable_logging);
@@ -313,4 +315,170 @@ TEST_F(RecoveryTest, DISABLED_CheckpointTest) {
   LOG_INFO("Shutdown System");
   delete bustub_instance;
 }
+
+// NOLINTNEXTLINE
+TEST_F(RecoveryTest, HashTableTest) {
+  const int num_keys = 20000;
+  const int txn_keys = 100;
+  auto *bustub_instance = new BustubInstance("test.db");
+  auto *bpm = bustub_instance->buffer_pool_manager_;
+  // the header page, which records where the table is
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  ASSERT_EQ(HEADER_PAGE_ID, header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  bustub_instance->log_manager_->RunFlushThread();
+
+  {
+    LinearProbeHashTable<int, int, IntComparator> ht("hash", bpm, IntComparator(), 1000, HashFunction<int>());
+    for (int i = 0; i < num_keys; i++) {
+      EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    }
+    for (int i = 0; i < num_keys; i += 2) {
+      EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    }
+    // one transaction commits, the other one is cut short by the crash, after its pairs and its tombstone have
+    // moved to a new table, and the table it wrote them to has been freed
+    Transaction *active = bustub_instance->transaction_manager_->Begin();
+    for (int i = num_keys + txn_keys; i < num_keys + 2 * txn_keys; i++) {
+      EXPECT_TRUE(ht.Insert(active, i, i));
+    }
+    EXPECT_TRUE(ht.Remove(active, 3, 3));
+    ht.Resize(ht.GetSize());
+    // every lookup migrates a few more buckets, until the old table is freed
+    for (int i = 0; i < num_keys; i++) {
+      std::vector<int> res;
+      EXPECT_EQ(i % 2 == 1 && i != 3, ht.GetValue(nullptr, i, &res)) << i;
+    }
+    Transaction *committed = bustub_instance->transaction_manager_->Begin();
+    for (int i = num_keys; i < num_keys + txn_keys; i++) {
+      EXPECT_TRUE(ht.Insert(committed, i, i));
+    }
+    EXPECT_TRUE(ht.Remove(committed, 1, 1));
+    bustub_instance->transaction_manager_->Commit(committed);
+    delete committed;
+    // a resize is still migrating pairs when the crash comes, some of them after the transaction is gone
+    ht.Resize(ht.GetSize());
+    delete active;
+    for (int i = 0; i < num_keys; i += 20) {
+      std::vector<int> res;
+      ht.GetValue(nullptr, i, &res);
+    }
+  }
+  // the log reaches the disk as the flush thread stops, the buffer pool does not
+  delete bustub_instance;
+
+  bustub_instance = new BustubInstance("test.db");
+  bpm = bustub_instance->buffer_pool_manager_;
+  LogRecovery log_recovery(bustub_instance->disk_manager_, bpm, bustub_instance->log_manager_);
+  log_recovery.Redo();
+  log_recovery.Undo();
+
+  bustub_instance->log_manager_->RunFlushThread();
+  {
+    LinearProbeHashTable<int, int, IntComparator> ht("hash", bpm, IntComparator(), 1000, HashFunction<int>());
+    for (int i = 0; i < num_keys + 2 * txn_keys; i++) {
+      std::vector<int> res;
+      bool present = (i < num_keys && i % 2 == 1 && i != 1) || (i >= num_keys && i < num_keys + txn_keys);
+      EXPECT_EQ(present, ht.GetValue(nullptr, i, &res)) << i;
+      EXPECT_EQ(present ? std::vector<int>{i} : std::vector<int>{}, res);
+    }
+    // the recovered table takes new pairs, and still knows the old ones
+    for (int i = 0; i < num_keys; i += 2) {
+      EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    }
+    EXPECT_FALSE(ht.Insert(nullptr, 5, 5));
+  }
+
+  delete bustub_instance;
+}
+
+// NOLINTNEXTLINE
+TEST_F(RecoveryTest, TableHeapTest) {
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 1000}}};
+  auto make_tuple = [&](int32_t i, size_t length) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i),
+                              ValueFactory::GetVarcharValue(std::string(length, 'x'))};
+    return Tuple(values, &schema);
+  };
+  const int num_tuples = 2000;
+
+  auto *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+  TransactionManager *txn_manager = bustub_instance->transaction_manager_;
+  std::vector<page_id_t> first_page_ids;
+  {
+    Transaction *txn = txn_manager->Begin();
+    TableHeap row_table(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                        bustub_instance->log_manager_, txn);
+    TableHeap pax_table(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                        bustub_instance->log_manager_, txn, &schema);
+    txn_manager->Commit(txn);
+    delete txn;
+    for (TableHeap *table : {&row_table, &pax_table}) {
+      first_page_ids.push_back(table->GetFirstPageId());
+      // the committed transaction inserts in batches, which take a log record per page, and updates and deletes
+      Transaction *committed = txn_manager->Begin();
+      std::vector<Tuple> tuples;
+      for (int i = 0; i < num_tuples; i++) {
+        tuples.push_back(make_tuple(i, 10));
+      }
+      std::vector<RID> rids;
+      ASSERT_TRUE(table->InsertTuples(tuples, &rids, committed));
+      for (int i = 0; i < num_tuples; i += 10) {
+        ASSERT_TRUE(table->MarkDelete(rids[i], committed));
+        ASSERT_TRUE(table->UpdateTuple(make_tuple(i + 1, 20), rids[i + 1], committed));
+      }
+      txn_manager->Commit(committed);
+      delete committed;
+      // a page reaches the disk halfway, with the records up to it
+      bustub_instance->buffer_pool_manager_->FlushPage(rids[num_tuples / 2].GetPageId());
+
+      // the transaction that the crash cuts short inserts, updates, some tuples outgrowing their pages, and deletes
+      Transaction *active = txn_manager->Begin();
+      std::vector<Tuple> new_tuples;
+      for (int i = num_tuples; i < 2 * num_tuples; i++) {
+        new_tuples.push_back(make_tuple(i, 10));
+      }
+      std::vector<RID> new_rids;
+      ASSERT_TRUE(table->InsertTuples(new_tuples, &new_rids, active));
+      for (int i = 2; i < num_tuples; i += 10) {
+        ASSERT_TRUE(table->UpdateTuple(make_tuple(-i, i % 20 == 2 ? 900 : 5), rids[i], active));
+        ASSERT_TRUE(table->MarkDelete(rids[i + 1], active));
+      }
+      delete active;
+    }
+  }
+  // the log reaches the disk as the flush thread stops, the buffer pool does not
+  delete bustub_instance;
+
+  // the committed tuples are all there is, after recovery, and after a crash right after recovery too
+  for (int round = 0; round < 2; round++) {
+    bustub_instance = new BustubInstance("test.db");
+    LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_,
+                             bustub_instance->log_manager_);
+    log_recovery.Redo();
+    log_recovery.Undo();
+    for (page_id_t first_page_id : first_page_ids) {
+      TableHeap table(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                      bustub_instance->log_manager_, first_page_id);
+      Transaction txn(0);
+      std::vector<uint32_t> lengths(num_tuples);
+      int num_scanned = 0;
+      for (auto it = table.Begin(&txn); it != table.End(); ++it, ++num_scanned) {
+        int32_t i = it->GetValue(&schema, 0).GetAs<int32_t>();
+        ASSERT_TRUE(i >= 0 && i < num_tuples) << i;
+        EXPECT_EQ(0, lengths[i]) << i;
+        lengths[i] = it->GetValue(&schema, 1).GetLength();
+      }
+      EXPECT_EQ(num_tuples - num_tuples / 10, num_scanned);
+      for (int i = 0; i < num_tuples; i++) {
+        uint32_t length = i % 10 == 0 ? 0 : make_tuple(i, i % 10 == 1 ? 20 : 10).GetValue(&schema, 1).GetLength();
+        EXPECT_EQ(length, lengths[i]) << i;
+      }
+    }
+    delete bustub_instance;
+  }
+}
+
 }  // namespace bustub
@@ -0,0 +1,135 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_bulk_load_test.cpp
+//
+// Identification: test/storage/b_plus_tree_bulk_load_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+
+namespace bustub {
+
+namespace {
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+/** Bulk loads a tree, then checks it against the reference, also after inserts and removes that split and merge. */
+void CheckBulkLoad(BufferPoolManager *bpm, const GenericComparator<8> &comparator, int num_entries, bool unique_keys,
+                   size_t num_threads) {
+  std::mt19937 generator(num_entries);
+  // few distinct keys, so that a non-unique tree gets posting lists
+  int64_t key_range = unique_keys ? num_entries * 4 + 1 : num_entries / 8 + 1;
+  std::vector<std::pair<GenericKey<8>, RID>> entries;
+  std::map<int64_t, std::vector<RID>> reference;
+  GenericKey<8> index_key;
+  for (int i = 0; i < num_entries; i++) {
+    int64_t key = static_cast<int64_t>(generator() % key_range);
+    if (unique_keys && reference.count(key) != 0) {
+      continue;
+    }
+    index_key.SetFromInteger(key);
+    entries.emplace_back(index_key, RID(i));
+    reference[key].push_back(RID(i));
+  }
+  std::sort(entries.begin(), entries.end(), [&](const auto &lhs, const auto &rhs) {
+    int cmp = comparator(lhs.first, rhs.first);
+    return cmp < 0 || (cmp == 0 && lhs.second.Get() < rhs.second.Get());
+  });
+
+  Tree tree("foo_pk", bpm, comparator, 4, 5, unique_keys);
+  tree.BulkLoad(entries, num_threads);
+  ASSERT_EQ(entries.empty(), tree.IsEmpty());
+
+  auto check = [&]() {
+    std::vector<RID> expected;
+    for (const auto &[key, rids] : reference) {
+      expected.insert(expected.end(), rids.begin(), rids.end());
+      index_key.SetFromInteger(key);
+      std::vector<RID> result;
+      tree.GetValue(index_key, &result);
+      ASSERT_EQ(rids, result);
+    }
+    std::vector<RID> scanned;
+    for (auto it = tree.begin(); !it.isEnd(); ++it) {
+      scanned.push_back((*it).second);
+    }
+    ASSERT_EQ(expected, scanned);
+    scanned.clear();
+    for (auto it = tree.ScanRange(nullptr, false, nullptr, false, ScanDirection::BACKWARD); !it.isEnd(); ++it) {
+      scanned.push_back((*it).second);
+    }
+    std::reverse(scanned.begin(), scanned.end());
+    ASSERT_EQ(expected, scanned);
+  };
+  check();
+
+  // the tree must take inserts and removes like any other
+  for (int i = 0; i < num_entries / 2; i++) {
+    int64_t key = static_cast<int64_t>(generator() % key_range);
+    index_key.SetFromInteger(key);
+    RID rid(num_entries + i);
+    if (tree.Insert(index_key, rid, nullptr)) {
+      reference[key].push_back(rid);
+    }
+  }
+  std::vector<std::pair<int64_t, RID>> removes;
+  for (const auto &[key, rids] : reference) {
+    for (size_t i = 0; i < rids.size(); i += 2) {
+      removes.emplace_back(key, rids[i]);
+    }
+  }
+  for (const auto &[key, rid] : removes) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, rid, nullptr);
+    auto &rids = reference[key];
+    rids.erase(std::find(rids.begin(), rids.end(), rid));
+    if (rids.empty()) {
+      reference.erase(key);
+    }
+  }
+  check();
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeBulkLoadTest, BulkLoadTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(64, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  for (int num_entries : {0, 1, 3, 4, 17, 1000}) {
+    for (bool unique_keys : {true, false}) {
+      for (size_t num_threads : {1, 4}) {
+        CheckBulkLoad(bpm, comparator, num_entries, unique_keys, num_threads);
+      }
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,251 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_duplicate_key_test.cpp
+//
+// Identification: test/storage/b_plus_tree_duplicate_key_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/page/b_plus_tree_posting_page.h"
+
+namespace bustub {
+
+namespace {
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+struct RidLess {
+  bool operator()(const RID &lhs, const RID &rhs) const { return lhs.Get() < rhs.Get(); }
+};
+
+using Reference = std::map<int64_t, std::set<RID, RidLess>>;
+
+/** @return the (key, rid) pairs of the whole tree in visiting order, computed from the reference */
+std::vector<std::pair<int64_t, RID>> ExpectedScan(const Reference &reference, ScanDirection direction) {
+  std::vector<std::pair<int64_t, RID>> result;
+  for (const auto &[key, rids] : reference) {
+    for (const auto &rid : rids) {
+      result.emplace_back(key, rid);
+    }
+  }
+  if (direction == ScanDirection::BACKWARD) {
+    std::reverse(result.begin(), result.end());
+  }
+  return result;
+}
+
+void CheckTree(Tree *tree, const Reference &reference) {
+  GenericKey<8> index_key;
+  for (const auto &[key, rids] : reference) {
+    index_key.SetFromInteger(key);
+    std::vector<RID> result;
+    ASSERT_EQ(!rids.empty(), tree->GetValue(index_key, &result));
+    ASSERT_EQ(std::vector<RID>(rids.begin(), rids.end()), result);
+  }
+  for (auto direction : {ScanDirection::FORWARD, ScanDirection::BACKWARD}) {
+    auto expected = ExpectedScan(reference, direction);
+    std::vector<std::pair<int64_t, RID>> scanned;
+    for (auto it = tree->ScanRange(nullptr, false, nullptr, false, direction); !it.isEnd(); ++it) {
+      scanned.emplace_back((*it).first.ToString(), (*it).second);
+    }
+    ASSERT_EQ(expected, scanned);
+
+    // the values pile up across batches while the keys are taken a batch at a time, as index cursors do
+    std::vector<RID> batched;
+    std::vector<GenericKey<8>> keys;
+    std::vector<int64_t> batched_keys;
+    auto it = tree->ScanRange(nullptr, false, nullptr, false, direction);
+    while (it.NextBatch(&batched, &keys) > 0) {
+      for (const auto &key : keys) {
+        batched_keys.push_back(key.ToString());
+      }
+      keys.clear();
+    }
+    ASSERT_EQ(expected.size(), batched.size());
+    ASSERT_EQ(expected.size(), batched_keys.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+      ASSERT_EQ(expected[i].first, batched_keys[i]);
+      ASSERT_EQ(expected[i].second, batched[i]);
+    }
+  }
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeDuplicateKeyTest, PostingPageTest) {
+  alignas(64) char data[PAGE_SIZE];
+  auto page = reinterpret_cast<BPlusTreePostingPage *>(data);
+  page->Init(1);
+
+  // rows of neighbouring slots take one byte each, a jump to the next table page five
+  std::vector<RID> rids;
+  for (int i = 0; i < 10000; i++) {
+    rids.emplace_back(i / 40, i % 40);
+  }
+  int stored = page->Encode(rids.data(), static_cast<int>(rids.size()));
+  EXPECT_GT(stored, static_cast<int>(POSTING_PAGE_DATA_SIZE) * 3 / 4);
+  EXPECT_LT(stored, static_cast<int>(rids.size()));
+  EXPECT_LE(page->GetBytesUsed(), static_cast<int>(POSTING_PAGE_DATA_SIZE));
+  EXPECT_EQ(rids[0], page->GetFirst());
+  EXPECT_EQ(rids[stored - 1], page->GetLast());
+
+  std::vector<RID> decoded;
+  page->Decode(&decoded);
+  ASSERT_EQ(std::vector<RID>(rids.begin(), rids.begin() + stored), decoded);
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeDuplicateKeyTest, InsertRemoveScanTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  auto *disk_manager = new DiskManager("test.db");
+  // a small pool, so that a leaked pin fails the test
+  auto *bpm = new BufferPoolManager(64, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Tree tree("foo_pk", bpm, comparator, 4, 5, false);
+
+  // one key with a list that spans several posting pages, and many keys with a handful of RIDs
+  std::vector<std::pair<int64_t, RID>> pairs;
+  for (int i = 0; i < 8000; i++) {
+    pairs.emplace_back(0, RID(i / 4, i % 4));
+  }
+  std::mt19937 generator(15445);
+  for (int64_t key = 1; key < 40; key++) {
+    int count = static_cast<int>(generator() % 5) + 1;
+    for (int i = 0; i < count; i++) {
+      pairs.emplace_back(key, RID(static_cast<page_id_t>(generator() % 1000), generator() % 100));
+    }
+  }
+  std::shuffle(pairs.begin(), pairs.end(), generator);
+
+  GenericKey<8> index_key;
+  Reference reference;
+  for (const auto &[key, rid] : pairs) {
+    index_key.SetFromInteger(key);
+    bool expected = reference[key].insert(rid).second;
+    ASSERT_EQ(expected, tree.Insert(index_key, rid, nullptr));
+  }
+  // the same key & value pair is rejected
+  index_key.SetFromInteger(0);
+  EXPECT_FALSE(tree.Insert(index_key, RID(0, 0), nullptr));
+  CheckTree(&tree, reference);
+
+  // removing RIDs one at a time shrinks the lists, some back to a single inline RID
+  std::shuffle(pairs.begin(), pairs.end(), generator);
+  for (size_t i = 0; i < pairs.size() * 3 / 4; i++) {
+    const auto &[key, rid] = pairs[i];
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, rid, nullptr);
+    reference[key].erase(rid);
+  }
+  // a value the key does not have leaves it alone
+  index_key.SetFromInteger(1);
+  tree.Remove(index_key, RID(5000, 0), nullptr);
+  CheckTree(&tree, reference);
+
+  // removing a key drops its whole posting list
+  index_key.SetFromInteger(0);
+  tree.Remove(index_key, nullptr);
+  reference[0].clear();
+  CheckTree(&tree, reference);
+
+  for (size_t i = pairs.size() * 3 / 4; i < pairs.size(); i++) {
+    const auto &[key, rid] = pairs[i];
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, rid, nullptr);
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeDuplicateKeyTest, SmallListTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(64, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  // every key has a handful of RIDs, which the shared posting pages pack many lists to a page
+  const int num_keys = 2000;
+  std::vector<std::pair<int64_t, RID>> pairs;
+  std::vector<std::pair<GenericKey<8>, RID>> entries;
+  for (int64_t key = 0; key < num_keys; key++) {
+    for (int i = 0; i < 2 + key % 3; i++) {
+      pairs.emplace_back(key, RID(static_cast<page_id_t>(key), i));
+    }
+  }
+  std::mt19937 generator(15445);
+  std::shuffle(pairs.begin(), pairs.end(), generator);
+
+  GenericKey<8> index_key;
+  Reference reference;
+  Tree tree("foo_pk", bpm, comparator, 128, 128, false);
+  page_id_t first_page_id = disk_manager->AllocatePage();
+  for (const auto &[key, rid] : pairs) {
+    index_key.SetFromInteger(key);
+    reference[key].insert(rid);
+    ASSERT_TRUE(tree.Insert(index_key, rid, nullptr));
+  }
+  // a page per key would take num_keys pages
+  EXPECT_LT(disk_manager->AllocatePage() - first_page_id, num_keys / 10);
+  CheckTree(&tree, reference);
+
+  // a bulk load packs the lists as tightly
+  std::sort(pairs.begin(), pairs.end(), [](const auto &lhs, const auto &rhs) {
+    return lhs.first != rhs.first ? lhs.first < rhs.first : lhs.second.Get() < rhs.second.Get();
+  });
+  for (const auto &[key, rid] : pairs) {
+    index_key.SetFromInteger(key);
+    entries.emplace_back(index_key, rid);
+  }
+  Tree loaded("foo_pk", bpm, comparator, 128, 128, false);
+  first_page_id = disk_manager->AllocatePage();
+  loaded.BulkLoad(entries);
+  EXPECT_LT(disk_manager->AllocatePage() - first_page_id, num_keys / 10);
+  CheckTree(&loaded, reference);
+
+  // removing all but one RID of every key moves that RID back inline
+  for (const auto &[key, rid] : pairs) {
+    if (rid.GetSlotNum() > 0) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, rid, nullptr);
+      reference[key].erase(rid);
+    }
+  }
+  CheckTree(&tree, reference);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
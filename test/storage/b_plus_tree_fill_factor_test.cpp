@@ -0,0 +1,189 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_fill_factor_test.cpp
+//
+// Identification: test/storage/b_plus_tree_fill_factor_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+
+namespace bustub {
+
+namespace {
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+
+const int LEAF_MAX_SIZE = 32;
+const int INTERNAL_MAX_SIZE = 32;
+
+/** @return the number of leaves of a tree that is not empty */
+int CountLeaves(Tree *tree, BufferPoolManager *bpm) {
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(0);
+  Page *page = tree->FindLeafPage(index_key, true);
+  int num_leaves = 1;
+  page_id_t next_page_id = reinterpret_cast<LeafPage *>(page->GetData())->GetNextPageId();
+  bpm->UnpinPage(page->GetPageId(), false);
+  while (next_page_id != INVALID_PAGE_ID) {
+    page = bpm->FetchPage(next_page_id);
+    next_page_id = reinterpret_cast<LeafPage *>(page->GetData())->GetNextPageId();
+    bpm->UnpinPage(page->GetPageId(), false);
+    num_leaves++;
+  }
+  return num_leaves;
+}
+
+/** Checks that the tree holds exactly the given keys, each with the RID of the same number. */
+void CheckKeys(Tree *tree, const std::set<int64_t> &keys) {
+  GenericKey<8> index_key;
+  for (int64_t key : keys) {
+    index_key.SetFromInteger(key);
+    std::vector<RID> result;
+    ASSERT_TRUE(tree->GetValue(index_key, &result));
+    ASSERT_EQ(RID(key), result[0]);
+  }
+  std::vector<int64_t> scanned;
+  for (auto it = tree->begin(); !it.isEnd(); ++it) {
+    scanned.push_back((*it).second.Get());
+  }
+  ASSERT_EQ(std::vector<int64_t>(keys.begin(), keys.end()), scanned);
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeFillFactorTest, SerialInsertTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(64, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  const int num_keys = 10000;
+
+  // a leaf splits once it has LEAF_MAX_SIZE entries, so it holds at most one fewer
+  double leaf_capacity = LEAF_MAX_SIZE - 1;
+  for (double fill : {0.5, 0.9, 1.0}) {
+    BPlusTreeFillFactors fill_factors;
+    fill_factors.leaf_ = fill;
+    fill_factors.internal_ = fill;
+    Tree tree("foo_pk", bpm, comparator, LEAF_MAX_SIZE, INTERNAL_MAX_SIZE, true, fill_factors);
+    GenericKey<8> index_key;
+    std::set<int64_t> keys;
+    for (int64_t key = 0; key < 2 * num_keys; key += 2) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(key));
+      keys.insert(key);
+    }
+    CheckKeys(&tree, keys);
+    int num_leaves = CountLeaves(&tree, bpm);
+    double density = num_keys / (num_leaves * leaf_capacity);
+    EXPECT_GT(density, fill - 0.05);
+
+    // keys in between the appended ones still go in, splitting the full leaves in half
+    std::vector<int64_t> odd_keys;
+    for (int64_t key = 1; key < 2 * num_keys; key += 2) {
+      odd_keys.push_back(key);
+    }
+    std::shuffle(odd_keys.begin(), odd_keys.end(), std::mt19937(num_keys));
+    for (int64_t key : odd_keys) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(key));
+      keys.insert(key);
+    }
+    CheckKeys(&tree, keys);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeFillFactorTest, DeleteChurnTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(64, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  const int num_keys = 5000;
+
+  int last_leaves = 0;
+  for (double merge_threshold : {0.5, 0.25, 0.0}) {
+    BPlusTreeFillFactors fill_factors;
+    fill_factors.merge_threshold_ = merge_threshold;
+    Tree tree("foo_pk", bpm, comparator, LEAF_MAX_SIZE, INTERNAL_MAX_SIZE, true, fill_factors);
+    std::mt19937 generator(num_keys);
+    std::vector<int64_t> order(num_keys);
+    for (int64_t key = 0; key < num_keys; key++) {
+      order[key] = key;
+    }
+    std::shuffle(order.begin(), order.end(), generator);
+    GenericKey<8> index_key;
+    std::set<int64_t> keys;
+    for (int64_t key : order) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(key));
+      keys.insert(key);
+    }
+    int full_leaves = CountLeaves(&tree, bpm);
+
+    // delete two keys in three, putting some back in between
+    std::shuffle(order.begin(), order.end(), generator);
+    for (size_t i = 0; i < order.size(); i++) {
+      if (i % 3 == 2) {
+        continue;
+      }
+      index_key.SetFromInteger(order[i]);
+      tree.Remove(index_key);
+      keys.erase(order[i]);
+      if (i % 7 == 0) {
+        index_key.SetFromInteger(order[i / 2]);
+        if (tree.Insert(index_key, RID(order[i / 2]))) {
+          keys.insert(order[i / 2]);
+        }
+      }
+    }
+    CheckKeys(&tree, keys);
+    // a higher threshold merges more of the emptied leaves
+    int num_leaves = CountLeaves(&tree, bpm);
+    EXPECT_LE(num_leaves, full_leaves);
+    EXPECT_GT(num_leaves, last_leaves);
+    last_leaves = num_leaves;
+
+    // the tree empties out all the same
+    for (int64_t key : std::vector<int64_t>(keys.begin(), keys.end())) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key);
+    }
+    ASSERT_TRUE(tree.IsEmpty());
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,188 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_page_search_test.cpp
+//
+// Identification: test/storage/b_plus_tree_page_search_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "common/rid.h"
+#include "gtest/gtest.h"
+#include "storage/index/int_key_search.h"
+#include "storage/page/b_plus_tree_internal_page.h"
+#include "storage/page/b_plus_tree_leaf_page.h"
+
+namespace bustub {
+
+using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+using InternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+
+// NOLINTNEXTLINE
+TEST(BPlusTreePageSearchTest, SearchTest) {
+  std::mt19937_64 generator(15445);
+  for (int size = 0; size < 300; size++) {
+    std::vector<int64_t> keys(size);
+    for (auto &key : keys) {
+      // a narrow domain produces duplicates and keys on both sides of every probe
+      key = static_cast<int64_t>(generator() % 512) - 256;
+    }
+    std::sort(keys.begin(), keys.end());
+    for (int64_t probe = -260; probe <= 260; probe++) {
+      EXPECT_EQ(std::lower_bound(keys.begin(), keys.end(), probe) - keys.begin(),
+                IntKeySearch::LowerBound(keys.data(), size, probe));
+      EXPECT_EQ(std::upper_bound(keys.begin(), keys.end(), probe) - keys.begin(),
+                IntKeySearch::UpperBound(keys.data(), size, probe));
+    }
+  }
+  std::vector<int64_t> extremes{INT64_MIN, 0, INT64_MAX};
+  EXPECT_EQ(0, IntKeySearch::LowerBound(extremes.data(), 3, INT64_MIN));
+  EXPECT_EQ(3, IntKeySearch::UpperBound(extremes.data(), 3, INT64_MAX));
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreePageSearchTest, LeafPageTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  alignas(64) char data[PAGE_SIZE];
+  alignas(64) char sibling_data[PAGE_SIZE];
+  auto page = reinterpret_cast<LeafPage *>(data);
+  auto sibling = reinterpret_cast<LeafPage *>(sibling_data);
+  page->Init(1);
+  sibling->Init(2);
+
+  std::vector<int64_t> keys(page->GetMaxSize());
+  for (size_t i = 0; i < keys.size(); i++) {
+    keys[i] = static_cast<int64_t>(i) * 2;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    page->Insert(index_key, RID(key), comparator);
+  }
+  // duplicates are rejected
+  index_key.SetFromInteger(keys[0]);
+  EXPECT_EQ(page->GetMaxSize(), page->Insert(index_key, RID(keys[0]), comparator));
+
+  RID rid;
+  for (int i = 0; i < page->GetSize(); i++) {
+    EXPECT_EQ(i * 2, page->KeyAt(i).ToString());
+    EXPECT_EQ(i * 2, page->GetItem(i).second.Get());
+    index_key.SetFromInteger(i * 2);
+    EXPECT_TRUE(page->Lookup(index_key, &rid, comparator));
+    EXPECT_EQ(i * 2, rid.Get());
+    index_key.SetFromInteger(i * 2 + 1);
+    EXPECT_FALSE(page->Lookup(index_key, &rid, comparator));
+    EXPECT_EQ(i + 1, page->KeyIndex(index_key, comparator));
+  }
+
+  index_key.SetFromInteger(10);
+  EXPECT_EQ(page->GetMaxSize() - 1, page->RemoveAndDeleteRecord(index_key, comparator));
+  EXPECT_FALSE(page->Lookup(index_key, &rid, comparator));
+
+  int size = page->GetSize();
+  page->MoveHalfTo(sibling);
+  EXPECT_EQ(size, page->GetSize() + sibling->GetSize());
+  EXPECT_LT(page->KeyAt(page->GetSize() - 1).ToString(), sibling->KeyAt(0).ToString());
+  sibling->MoveFirstToEndOf(page);
+  page->MoveLastToFrontOf(sibling);
+  // merging the right sibling back into its left one keeps the keys in order
+  sibling->MoveAllTo(page);
+  EXPECT_EQ(0, sibling->GetSize());
+  EXPECT_EQ(size, page->GetSize());
+  for (int i = 1; i < page->GetSize(); i++) {
+    EXPECT_LT(page->KeyAt(i - 1).ToString(), page->KeyAt(i).ToString());
+    EXPECT_EQ(page->KeyAt(i).ToString(), page->GetItem(i).second.Get());
+  }
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreePageSearchTest, InternalPageLookupTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  alignas(64) char data[PAGE_SIZE];
+  auto page = reinterpret_cast<InternalPage *>(data);
+  page->Init(1);
+
+  // child i covers the keys [i * 10, i * 10 + 10), child 0 also everything below
+  const int size = 200;
+  std::vector<std::pair<GenericKey<8>, page_id_t>> items(size);
+  for (int i = 0; i < size; i++) {
+    items[i].first.SetFromInteger(i * 10);
+    items[i].second = i;
+  }
+  page->PopulateFrom(items.data(), size);
+
+  GenericKey<8> index_key;
+  for (int64_t key = -5; key < size * 10 + 5; key++) {
+    index_key.SetFromInteger(key);
+    auto expected = static_cast<page_id_t>(std::min<int64_t>(std::max<int64_t>(key, 0) / 10, size - 1));
+    EXPECT_EQ(expected, page->Lookup(index_key, comparator));
+  }
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreePageSearchTest, DISABLED_PointLookupBenchmark) {
+  const int num_lookups = 1 << 18;
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  // the former leaf layout: (key, rid) pairs searched with the comparator
+  using Pair = std::pair<GenericKey<8>, RID>;
+  std::vector<Pair> pairs((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(Pair));
+  alignas(64) char data[PAGE_SIZE];
+  auto page = reinterpret_cast<LeafPage *>(data);
+  page->Init(1);
+  const int size = std::min(static_cast<int>(pairs.size()), page->GetMaxSize());
+  pairs.resize(size);
+  GenericKey<8> index_key;
+  for (int i = 0; i < size; i++) {
+    index_key.SetFromInteger(i * 3);
+    pairs[i] = {index_key, RID(i)};
+    page->Insert(index_key, RID(i), comparator);
+  }
+
+  std::vector<GenericKey<8>> probes(1024);
+  std::mt19937_64 generator(15445);
+  for (auto &probe : probes) {
+    probe.SetFromInteger(static_cast<int64_t>(generator() % (size * 3)));
+  }
+
+  auto run = [&](const char *name, auto &&key_index) {
+    auto start = std::chrono::steady_clock::now();
+    int64_t checksum = 0;
+    for (int i = 0; i < num_lookups; i++) {
+      checksum += key_index(probes[i % probes.size()]);
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ": " << elapsed / num_lookups << " ns/lookup (checksum " << checksum << ")" << std::endl;
+    return checksum;
+  };
+
+  int64_t expected = run("(key, rid) pairs", [&](const GenericKey<8> &key) {
+    auto it = std::lower_bound(pairs.begin(), pairs.end(), key, [&](const auto &pair, const GenericKey<8> &k) {
+      return comparator(pair.first, k) < 0;
+    });
+    return it - pairs.begin();
+  });
+  EXPECT_EQ(expected, run("leaf key array", [&](const GenericKey<8> &key) {
+              return page->KeyIndex(key, comparator);
+            }));
+  delete key_schema;
+}
+
+}  // namespace bustub
@@ -0,0 +1,165 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_range_scan_test.cpp
+//
+// Identification: test/storage/b_plus_tree_range_scan_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+
+namespace bustub {
+
+namespace {
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+/** @return the keys of the scan in visiting order, computed from the reference set */
+std::vector<int64_t> ExpectedScan(const std::set<int64_t> &keys, const int64_t *lo, bool lo_inclusive,
+                                  const int64_t *hi, bool hi_inclusive, ScanDirection direction) {
+  std::vector<int64_t> result;
+  for (auto key : keys) {
+    bool above = lo == nullptr || key > *lo || (lo_inclusive && key == *lo);
+    bool below = hi == nullptr || key < *hi || (hi_inclusive && key == *hi);
+    if (above && below) {
+      result.push_back(key);
+    }
+  }
+  if (direction == ScanDirection::BACKWARD) {
+    std::reverse(result.begin(), result.end());
+  }
+  return result;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeRangeScanTest, BoundsAndDirectionTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  auto *disk_manager = new DiskManager("test.db");
+  // a small pool, so that a leaked pin fails the test
+  auto *bpm = new BufferPoolManager(16, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Tree tree("foo_pk", bpm, comparator, 4, 5);
+
+  // even keys only, so that bounds fall both on and between keys
+  std::vector<int64_t> keys(400);
+  for (size_t i = 0; i < keys.size(); i++) {
+    keys[i] = static_cast<int64_t>(i) * 2;
+  }
+  std::mt19937 generator(15445);
+  std::shuffle(keys.begin(), keys.end(), generator);
+  GenericKey<8> index_key;
+  std::set<int64_t> reference;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(key), nullptr);
+    reference.insert(key);
+  }
+  // deletes merge and redistribute leaves, which must keep the links in both directions intact
+  for (size_t i = 0; i < keys.size(); i += 3) {
+    index_key.SetFromInteger(keys[i]);
+    tree.Remove(index_key, nullptr);
+    reference.erase(keys[i]);
+  }
+
+  std::uniform_int_distribution<int64_t> bound_dist(-10, 810);
+  for (int round = 0; round < 500; round++) {
+    int64_t lo = bound_dist(generator);
+    int64_t hi = bound_dist(generator);
+    bool lo_inclusive = (round & 1) != 0;
+    bool hi_inclusive = (round & 2) != 0;
+    auto direction = (round & 4) != 0 ? ScanDirection::BACKWARD : ScanDirection::FORWARD;
+    // every eighth round leaves one side of the range open
+    const int64_t *lo_ptr = round % 16 == 8 ? nullptr : &lo;
+    const int64_t *hi_ptr = round % 16 == 15 ? nullptr : &hi;
+    GenericKey<8> lo_key;
+    GenericKey<8> hi_key;
+    lo_key.SetFromInteger(lo);
+    hi_key.SetFromInteger(hi);
+
+    std::vector<int64_t> scanned;
+    for (auto it = tree.ScanRange(lo_ptr == nullptr ? nullptr : &lo_key, lo_inclusive,
+                                  hi_ptr == nullptr ? nullptr : &hi_key, hi_inclusive, direction);
+         !it.isEnd(); ++it) {
+      scanned.push_back((*it).second.Get());
+    }
+    ASSERT_EQ(ExpectedScan(reference, lo_ptr, lo_inclusive, hi_ptr, hi_inclusive, direction), scanned);
+  }
+
+  // iterator comparisons
+  EXPECT_TRUE(tree.end() == tree.end());
+  EXPECT_TRUE(tree.begin() != tree.end());
+  EXPECT_TRUE(tree.begin() == tree.ScanRange(nullptr, false, nullptr, false));
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeRangeScanTest, BatchTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(16, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  const int leaf_max_size = 8;
+  Tree tree("foo_pk", bpm, comparator, leaf_max_size, 5);
+
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < 1000; key++) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(key), nullptr);
+  }
+
+  GenericKey<8> lo_key;
+  GenericKey<8> hi_key;
+  lo_key.SetFromInteger(123);
+  hi_key.SetFromInteger(877);
+  for (auto direction : {ScanDirection::FORWARD, ScanDirection::BACKWARD}) {
+    auto it = tree.ScanRange(&lo_key, true, &hi_key, false, direction);
+    std::vector<RID> rids;
+    int batches = 0;
+    int count;
+    while ((count = it.NextBatch(&rids)) > 0) {
+      // never more than a leaf worth of entries per batch
+      EXPECT_LT(count, leaf_max_size);
+      batches++;
+    }
+    EXPECT_TRUE(it.isEnd());
+    ASSERT_EQ(877 - 123, rids.size());
+    for (size_t i = 0; i < rids.size(); i++) {
+      EXPECT_EQ(direction == ScanDirection::FORWARD ? 123 + i : 876 - i, rids[i].Get());
+    }
+    EXPECT_GT(batches, 1);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
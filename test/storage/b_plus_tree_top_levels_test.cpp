@@ -0,0 +1,162 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_top_levels_test.cpp
+//
+// Identification: test/storage/b_plus_tree_top_levels_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+
+namespace bustub {
+
+namespace {
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+/** Checks that the tree holds exactly the given keys, each with the RID of the same number. */
+void CheckKeys(Tree *tree, const std::set<int64_t> &keys) {
+  GenericKey<8> index_key;
+  for (int64_t key : keys) {
+    index_key.SetFromInteger(key);
+    std::vector<RID> result;
+    ASSERT_TRUE(tree->GetValue(index_key, &result));
+    ASSERT_EQ(RID(key), result[0]);
+  }
+  std::vector<int64_t> scanned;
+  for (auto it = tree->begin(); !it.isEnd(); ++it) {
+    scanned.push_back((*it).second.Get());
+  }
+  ASSERT_EQ(std::vector<int64_t>(keys.begin(), keys.end()), scanned);
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeTopLevelsTest, SplitAndMergeTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  auto *disk_manager = new DiskManager("test.db");
+  const size_t pool_size = 64;
+  auto *bpm = new BufferPoolManager(pool_size, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  const int num_keys = 2000;
+
+  {
+    // small nodes, so that the cached levels split, merge and change root all the time
+    Tree tree("foo_pk", bpm, comparator, 4, 5, true, BPlusTreeFillFactors(), 3);
+    std::mt19937 generator(num_keys);
+    std::vector<int64_t> order(num_keys);
+    for (int64_t key = 0; key < num_keys; key++) {
+      order[key] = key;
+    }
+    GenericKey<8> index_key;
+    std::set<int64_t> keys;
+    for (int round = 0; round < 2; round++) {
+      std::shuffle(order.begin(), order.end(), generator);
+      for (int64_t key : order) {
+        index_key.SetFromInteger(key);
+        if (tree.Insert(index_key, RID(key))) {
+          keys.insert(key);
+        }
+        // lookups in between, so that the top levels are cached again and again
+        if (key % 16 == 0) {
+          std::vector<RID> result;
+          ASSERT_TRUE(tree.GetValue(index_key, &result));
+        }
+      }
+      CheckKeys(&tree, keys);
+
+      std::shuffle(order.begin(), order.end(), generator);
+      for (size_t i = 0; i < order.size() * (round + 1) / 2; i++) {
+        index_key.SetFromInteger(order[i]);
+        tree.Remove(index_key);
+        keys.erase(order[i]);
+        if (i % 16 == 0) {
+          std::vector<RID> result;
+          ASSERT_FALSE(tree.GetValue(index_key, &result));
+        }
+      }
+      CheckKeys(&tree, keys);
+    }
+    ASSERT_TRUE(keys.empty());
+    ASSERT_TRUE(tree.IsEmpty());
+  }
+
+  // the tree let go of its pins, so the whole pool but the header page can be taken
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 1; i < pool_size; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    page_ids.push_back(page_id);
+  }
+  for (page_id_t id : page_ids) {
+    bpm->UnpinPage(id, false);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeTopLevelsTest, DISABLED_LookupLatencyTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(4096, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  const int num_keys = 20000;
+
+  std::vector<int64_t> order(num_keys);
+  for (int64_t key = 0; key < num_keys; key++) {
+    order[key] = key;
+  }
+  std::shuffle(order.begin(), order.end(), std::mt19937(num_keys));
+  for (int cached_levels : {0, 3}) {
+    // four levels of internal pages above the leaves, all in memory
+    Tree tree("foo_pk", bpm, comparator, 16, 16, true, BPlusTreeFillFactors(), cached_levels);
+    GenericKey<8> index_key;
+    for (int64_t key : order) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(key));
+    }
+    std::vector<RID> result;
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t key : order) {
+      index_key.SetFromInteger(key);
+      tree.GetValue(index_key, &result);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_EQ(num_keys, result.size());
+    std::cout << cached_levels << " cached levels: " << elapsed.count() / num_keys << " ns/lookup" << std::endl;
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter_test.cpp
+//
+// Identification: test/storage/bloom_filter_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "storage/index/bloom_filter.h"
+#include "storage/index/extendible_hash_table_index.h"
+#include "storage/index/linear_probe_hash_table_index.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+uint64_t HashOf(int64_t key) { return BloomFilter::Hash(&key, sizeof(key)); }
+
+/** @return the fraction of num_probes keys, none of which were inserted, that the filter lets through */
+double FalsePositiveRate(const BloomFilter &filter, int64_t first_absent_key, int num_probes) {
+  int positives = 0;
+  for (int64_t key = first_absent_key; key < first_absent_key + num_probes; key++) {
+    positives += filter.MayContain(HashOf(key)) ? 1 : 0;
+  }
+  return static_cast<double>(positives) / num_probes;
+}
+
+/** Inserts the even keys of [0, 2 * num_keys) into the index, then looks up those and the odd keys. */
+void CheckLookups(Index *index, int num_keys) {
+  Schema *key_schema = index->GetKeySchema();
+  for (int64_t key = 0; key < 2 * num_keys; key += 2) {
+    index->InsertEntry(Tuple({ValueFactory::GetBigIntValue(key)}, key_schema), RID(key), nullptr);
+  }
+  std::vector<Tuple> hits;
+  std::vector<Tuple> misses;
+  for (int64_t key = 0; key < 2 * num_keys; key++) {
+    (key % 2 == 0 ? hits : misses).emplace_back(std::vector<Value>{ValueFactory::GetBigIntValue(key)}, key_schema);
+  }
+  for (const auto *keys : {&hits, &misses}) {
+    std::vector<RID> result;
+    for (const auto &key : *keys) {
+      index->ScanKey(key, &result, nullptr);
+    }
+    ASSERT_EQ(keys == &hits ? keys->size() : 0, result.size());
+  }
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(BloomFilterTest, FalsePositiveRateTest) {
+  const int num_keys = 100000;
+
+  // sized up front: a single layer
+  BloomFilter sized(num_keys);
+  for (int64_t key = 0; key < num_keys; key++) {
+    sized.Insert(HashOf(key));
+  }
+  // grown from the default size: several layers
+  BloomFilter grown;
+  for (int64_t key = 0; key < num_keys; key++) {
+    grown.Insert(HashOf(key));
+  }
+
+  for (const auto *filter : {&sized, &grown}) {
+    // no false negatives, ever
+    for (int64_t key = 0; key < num_keys; key++) {
+      ASSERT_TRUE(filter->MayContain(HashOf(key)));
+    }
+    EXPECT_LT(FalsePositiveRate(*filter, num_keys, num_keys), 0.02);
+  }
+
+  // a layer that holds the keys it was sized for
+  EXPECT_LT(FalsePositiveRate(sized, num_keys, num_keys), 0.005);
+}
+
+// NOLINTNEXTLINE
+TEST(BloomFilterTest, IndexLookupTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(256, disk_manager);
+  // the B+ trees keep their roots in the header page
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  const int num_keys = 10000;
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::BIGINT);
+  Schema schema(columns);
+  for (bool bloom_filter : {false, true}) {
+    std::string suffix = bloom_filter ? " with filter" : " without filter";
+    auto *metadata = new IndexMetadata("tree" + suffix, "table", &schema, {0}, true, bloom_filter);
+    BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> tree(metadata, bpm);
+    CheckLookups(&tree, num_keys);
+
+    metadata = new IndexMetadata("hash" + suffix, "table", &schema, {0}, true, bloom_filter);
+    LinearProbeHashTableIndex<GenericKey<8>, RID, GenericComparator<8>> hash_table(metadata, bpm, 2 * num_keys,
+                                                                                   HashFunction<GenericKey<8>>());
+    CheckLookups(&hash_table, num_keys);
+
+    metadata = new IndexMetadata("extendible" + suffix, "table", &schema, {0}, true, bloom_filter);
+    ExtendibleHashTableIndex<GenericKey<8>, RID, GenericComparator<8>> extendible(metadata, bpm,
+                                                                                 HashFunction<GenericKey<8>>());
+    CheckLookups(&extendible, num_keys);
+  }
+
+  bpm->UnpinPage(header_page_id, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+}  // namespace bustub
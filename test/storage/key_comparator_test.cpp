@@ -0,0 +1,165 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_comparator_test.cpp
+//
+// Identification: test/storage/key_comparator_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+#include "storage/index/normalized_key.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+int Sign(int x) { return (x > 0) - (x < 0); }
+
+/** The comparison GenericComparator used to do for every key: one Value per column. */
+template <size_t KeySize>
+int ValueCompare(Schema *key_schema, const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) {
+  for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+    Value lhs_value = lhs.ToValue(key_schema, i);
+    Value rhs_value = rhs.ToValue(key_schema, i);
+    if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
+      return -1;
+    }
+    if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(KeyComparatorTest, MultiColumnOrderTest) {
+  Schema *key_schema = ParseCreateStatement("a smallint,b double,c int");
+  KeyLayout layout(key_schema);
+  GenericComparator<16> generic_comparator(key_schema);
+  NormalizedComparator<16> normalized_comparator;
+  ASSERT_TRUE(layout.IsFixedWidth());
+
+  std::mt19937 generator(15445);
+  std::vector<GenericKey<16>> generic_keys(256);
+  std::vector<NormalizedKey<16>> normalized_keys(256);
+  for (size_t i = 0; i < generic_keys.size(); i++) {
+    // small domains so that the later columns decide some of the comparisons
+    std::vector<Value> values{
+        ValueFactory::GetSmallIntValue(static_cast<int16_t>(static_cast<int>(generator() % 7) - 3)),
+        ValueFactory::GetDecimalValue(static_cast<double>(static_cast<int>(generator() % 9) - 4) / 3),
+        ValueFactory::GetIntegerValue(static_cast<int32_t>(generator()))};
+    Tuple tuple(values, key_schema);
+    generic_keys[i].SetFromKey(tuple);
+    normalized_keys[i].SetFromKey(tuple, layout);
+  }
+
+  for (size_t i = 0; i < generic_keys.size(); i++) {
+    for (size_t j = 0; j < generic_keys.size(); j++) {
+      int expected = ValueCompare(key_schema, generic_keys[i], generic_keys[j]);
+      EXPECT_EQ(expected, Sign(generic_comparator(generic_keys[i], generic_keys[j])));
+      EXPECT_EQ(expected, Sign(normalized_comparator(normalized_keys[i], normalized_keys[j])));
+    }
+  }
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST(KeyComparatorTest, BigintEncodingTest) {
+  std::vector<int64_t> keys{BUSTUB_INT64_NULL, BUSTUB_INT64_MIN, -256, -1, 0, 1, 255, 256, BUSTUB_INT64_MAX};
+  NormalizedComparator<8> comparator;
+  NormalizedKey<8> lhs;
+  NormalizedKey<8> rhs;
+  for (size_t i = 0; i < keys.size(); i++) {
+    lhs.SetFromInteger(keys[i]);
+    EXPECT_EQ(keys[i], lhs.ToString());
+    for (size_t j = 0; j < keys.size(); j++) {
+      rhs.SetFromInteger(keys[j]);
+      EXPECT_EQ(Sign(static_cast<int>(i) - static_cast<int>(j)), Sign(comparator(lhs, rhs)));
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(KeyComparatorTest, DecimalEncodingTest) {
+  Schema *key_schema = ParseCreateStatement("a double");
+  KeyLayout layout(key_schema);
+  NormalizedComparator<8> comparator;
+  double inf = std::numeric_limits<double>::infinity();
+  // in order; -0.0 equals 0.0 and the NaNs equal each other
+  double nan = std::numeric_limits<double>::quiet_NaN();
+  std::vector<std::pair<double, int>> keys{{-inf, 0}, {BUSTUB_DECIMAL_NULL, 1}, {-1.5, 2}, {-0.0, 3}, {0.0, 3},
+                                           {1e-300, 4}, {2.5, 5}, {inf, 6}, {nan, 7}, {-nan, 7}};
+  std::vector<NormalizedKey<8>> normalized_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    normalized_keys[i].SetFromKey(Tuple({ValueFactory::GetDecimalValue(keys[i].first)}, key_schema), layout);
+  }
+  for (size_t i = 0; i < keys.size(); i++) {
+    for (size_t j = 0; j < keys.size(); j++) {
+      EXPECT_EQ(Sign(keys[i].second - keys[j].second), Sign(comparator(normalized_keys[i], normalized_keys[j])));
+    }
+    // the numbers decode to themselves, up to the sign of zero
+    if (!std::isnan(keys[i].first)) {
+      EXPECT_EQ(keys[i].first, normalized_keys[i].ToValue(key_schema, 0).GetAs<double>());
+    }
+  }
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST(KeyComparatorTest, DISABLED_ComparatorBenchmark) {
+  const size_t num_keys = 1 << 12;
+  const size_t num_compares = 1 << 20;
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> generic_comparator(key_schema);
+  NormalizedComparator<8> normalized_comparator;
+
+  std::mt19937_64 generator(15445);
+  std::vector<GenericKey<8>> generic_keys(num_keys);
+  std::vector<NormalizedKey<8>> normalized_keys(num_keys);
+  for (size_t i = 0; i < num_keys; i++) {
+    auto key = static_cast<int64_t>(generator());
+    generic_keys[i].SetFromInteger(key);
+    normalized_keys[i].SetFromInteger(key);
+  }
+
+  auto run = [&](const char *name, auto &&compare) {
+    auto start = std::chrono::steady_clock::now();
+    int64_t checksum = 0;
+    for (size_t i = 0; i < num_compares; i++) {
+      checksum += compare(i % num_keys, (i * 7 + 1) % num_keys);
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ": " << elapsed / num_compares << " ns/compare (checksum " << checksum << ")" << std::endl;
+    return checksum;
+  };
+
+  int64_t expected = run("Value-based", [&](size_t i, size_t j) {
+    return ValueCompare(key_schema, generic_keys[i], generic_keys[j]);
+  });
+  EXPECT_EQ(expected, run("GenericComparator", [&](size_t i, size_t j) {
+              return Sign(generic_comparator(generic_keys[i], generic_keys[j]));
+            }));
+  EXPECT_EQ(expected, run("NormalizedComparator", [&](size_t i, size_t j) {
+              return Sign(normalized_comparator(normalized_keys[i], normalized_keys[j]));
+            }));
+  delete key_schema;
+}
+
+}  // namespace bustub
@@ -0,0 +1,763 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_heap_test.cpp
+//
+// Identification: test/table/table_heap_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/schema.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "recovery/log_recovery.h"
+#include "storage/table/column_scan.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/table_scan.h"
+#include "storage/table/tuple.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+class TableHeapTest : public ::testing::Test {
+ protected:
+  void SetUp() override { remove("test.db"); }
+
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+  }
+
+  Tuple MakeTuple(int32_t i) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(100, 'x'))};
+    return Tuple(values, &schema_);
+  }
+
+  Schema schema_{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 100}}};
+};
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, FreeSpaceReuseTest) {
+  DiskManager disk_manager("test.db");
+  auto *bpm = new BufferPoolManager(50, &disk_manager);
+  LockManager lock_manager;
+  LogManager log_manager(&disk_manager);
+  Transaction txn(0);
+  auto *table = new TableHeap(bpm, &lock_manager, &log_manager, &txn);
+
+  const int num_tuples = 1000;
+  std::vector<RID> rids;
+  std::set<page_id_t> pages;
+  for (int i = 0; i < num_tuples; i++) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(MakeTuple(i), &rid, &txn));
+    rids.push_back(rid);
+    pages.insert(rid.GetPageId());
+  }
+  // every page but the last is full
+  ASSERT_GT(pages.size(), 3);
+
+  // empty the second page
+  page_id_t freed_page_id = *std::next(pages.begin());
+  int num_freed = 0;
+  for (const auto &rid : rids) {
+    if (rid.GetPageId() == freed_page_id) {
+      ASSERT_TRUE(table->MarkDelete(rid, &txn));
+      table->ApplyDelete(rid, &txn);
+      num_freed++;
+    }
+  }
+
+  // the inserts fill the room left in the last page and then the emptied page, without appending a page
+  int num_reused = 0;
+  for (int i = 0; i < num_freed; i++) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(MakeTuple(num_tuples + i), &rid, &txn));
+    EXPECT_EQ(1, pages.count(rid.GetPageId()));
+    if (rid.GetPageId() == freed_page_id) {
+      num_reused++;
+      Tuple tuple;
+      ASSERT_TRUE(table->GetTuple(rid, &tuple, &txn));
+      EXPECT_EQ(num_tuples + i, tuple.GetValue(&schema_, 0).GetAs<int32_t>());
+    }
+  }
+  EXPECT_GT(num_reused, 0);
+
+  // the free space map pages survive the buffer pool, and the table opens from them
+  page_id_t emptied_page_id = *std::next(pages.begin(), 2);
+  num_freed = 0;
+  for (const auto &rid : rids) {
+    if (rid.GetPageId() == emptied_page_id) {
+      ASSERT_TRUE(table->MarkDelete(rid, &txn));
+      table->ApplyDelete(rid, &txn);
+      num_freed++;
+    }
+  }
+  // as a commit would
+  txn.ReleaseInsertPages();
+  page_id_t first_page_id = table->GetFirstPageId();
+  bpm->FlushAllPages();
+  delete table;
+  delete bpm;
+  bpm = new BufferPoolManager(50, &disk_manager);
+  table = new TableHeap(bpm, &lock_manager, &log_manager, first_page_id);
+  for (int i = 0; i < num_freed; i++) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(MakeTuple(-i), &rid, &txn));
+    EXPECT_EQ(1, pages.count(rid.GetPageId()));
+  }
+
+  int num_scanned = 0;
+  for (auto it = table->Begin(&txn); it != table->End(); ++it) {
+    num_scanned++;
+  }
+  EXPECT_EQ(num_tuples, num_scanned);
+
+  delete table;
+  delete bpm;
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, DISABLED_InsertBenchmarkTest) {
+  DiskManager disk_manager("test.db");
+  BufferPoolManager bpm(50, &disk_manager);
+  LockManager lock_manager;
+  LogManager log_manager(&disk_manager);
+  Transaction txn(0);
+  TableHeap table(&bpm, &lock_manager, &log_manager, &txn);
+
+  const int num_tuples = 100000;
+  Tuple tuple = MakeTuple(0);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_tuples; i++) {
+    RID rid;
+    ASSERT_TRUE(table.InsertTuple(tuple, &rid, &txn));
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << "insert " << num_tuples << " tuples: " << num_tuples / elapsed.count() / 1e6 << "M tuples/s"
+            << std::endl;
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, TableScanTest) {
+  DiskManager disk_manager("test.db");
+  BufferPoolManager bpm(1000, &disk_manager);
+  LockManager lock_manager;
+  LogManager log_manager(&disk_manager);
+  Transaction txn(0);
+  TableHeap table(&bpm, &lock_manager, &log_manager, &txn);
+
+  const int num_tuples = 20000;
+  int64_t expected_sum = 0;
+  for (int i = 0; i < num_tuples; i++) {
+    RID rid;
+    ASSERT_TRUE(table.InsertTuple(MakeTuple(i), &rid, &txn));
+    expected_sum += i;
+  }
+
+  // the iterator copies each tuple out of its page, the scan hands out views of a copy of the page
+  int64_t sum = 0;
+  for (auto it = table.Begin(&txn); it != table.End(); ++it) {
+    sum += it->GetInt32(&schema_, 0);
+  }
+  EXPECT_EQ(expected_sum, sum);
+
+  sum = 0;
+  TableScan scan(&table, &txn);
+  TupleView view;
+  while (scan.Next(&view)) {
+    sum += view->GetInt32(&schema_, 0);
+  }
+  EXPECT_EQ(expected_sum, sum);
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, BulkInsertTest) {
+  DiskManager disk_manager("test.db");
+  BufferPoolManager bpm(50, &disk_manager);
+  LockManager lock_manager;
+  LogManager log_manager(&disk_manager);
+  TransactionManager txn_manager(&lock_manager, &log_manager);
+  Transaction create_txn(0);
+  TableHeap table(&bpm, &lock_manager, &log_manager, &create_txn);
+  enable_logging = true;
+
+  const int num_tuples = 50000;
+  const size_t batch_size = 1024;
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < num_tuples; i++) {
+    tuples.push_back(MakeTuple(i));
+  }
+
+  // one tuple at a time, then a batch at a time: a batch takes one log record per page, and one write record per run
+  // of slots
+  std::vector<RID> rids(num_tuples);
+  for (bool bulk : {false, true}) {
+    Transaction *txn = txn_manager.Begin();
+    lsn_t start_lsn = log_manager.GetNextLSN();
+    if (bulk) {
+      std::vector<Tuple> batch;
+      std::vector<RID> batch_rids;
+      for (size_t i = 0; i < tuples.size(); i += batch_size) {
+        batch.assign(tuples.begin() + i, tuples.begin() + std::min(i + batch_size, tuples.size()));
+        ASSERT_TRUE(table.InsertTuples(batch, &batch_rids, txn));
+        std::copy(batch_rids.begin(), batch_rids.end(), rids.begin() + i);
+      }
+    } else {
+      for (int i = 0; i < num_tuples; i++) {
+        ASSERT_TRUE(table.InsertTuple(tuples[i], &rids[i], txn));
+      }
+    }
+    if (bulk) {
+      EXPECT_LT(log_manager.GetNextLSN() - start_lsn, num_tuples / 10);
+      EXPECT_LT(txn->GetWriteSet()->size(), num_tuples / 10);
+    }
+    for (int i = 0; i < num_tuples; i += 997) {
+      Tuple tuple;
+      ASSERT_TRUE(table.GetTuple(rids[i], &tuple, txn));
+      EXPECT_EQ(i, tuple.GetValue(&schema_, 0).GetAs<int32_t>());
+    }
+    // the bulk insert is rolled back, tuple by tuple
+    if (bulk) {
+      txn_manager.Abort(txn);
+    } else {
+      txn_manager.Commit(txn);
+    }
+    delete txn;
+  }
+  int num_scanned = 0;
+  for (auto it = table.Begin(&create_txn); it != table.End(); ++it) {
+    num_scanned++;
+  }
+  EXPECT_EQ(num_tuples, num_scanned);
+
+  // the bulk insert records read back from the log
+  log_manager.Flush();
+  lsn_t next_lsn = log_manager.GetNextLSN();
+  enable_logging = false;
+  LogRecovery log_recovery(&disk_manager, &bpm, &log_manager);
+  log_recovery.Redo();
+  EXPECT_EQ(next_lsn, log_manager.GetNextLSN());
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, ConcurrentInsertTest) {
+  DiskManager disk_manager("test.db");
+  BufferPoolManager bpm(100, &disk_manager);
+  LockManager lock_manager;
+  LogManager log_manager(&disk_manager);
+  Transaction create_txn(0);
+  TableHeap table(&bpm, &lock_manager, &log_manager, &create_txn);
+  table.ReleaseInsertPage(table.GetFirstPageId());
+
+  const int num_tuples = 20000;
+  Tuple tuple = MakeTuple(0);
+  int num_inserted = 0;
+  for (int num_threads : {1, 4}) {
+    std::vector<std::vector<RID>> rids(num_threads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+      threads.emplace_back([&, t] {
+        Transaction txn(t + 1);
+        for (int i = 0; i < num_tuples / num_threads; i++) {
+          RID rid;
+          ASSERT_TRUE(table.InsertTuple(tuple, &rid, &txn));
+          rids[t].push_back(rid);
+        }
+        // the transaction releases its insert page as it goes away
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    num_inserted += num_tuples;
+
+    // Each transaction fills pages of its own, since a full page is not claimed again for a tuple of the same size.
+    // Only the page that a transaction releases part full when it ends can go on to another transaction.
+    std::unordered_map<page_id_t, std::set<int>> page_owners;
+    for (int t = 0; t < num_threads; t++) {
+      for (const auto &rid : rids[t]) {
+        page_owners[rid.GetPageId()].insert(t);
+      }
+    }
+    int num_shared_pages = 0;
+    for (const auto &[page_id, owners] : page_owners) {
+      num_shared_pages += owners.size() > 1 ? 1 : 0;
+    }
+    EXPECT_LE(num_shared_pages, num_threads);
+  }
+
+  // a transaction that goes away without Commit or Abort leaves its part full page to the next one, and one that
+  // outlives the table releases nothing
+  {
+    Transaction txn(5);
+    TableHeap other_table(&bpm, &lock_manager, &log_manager, &txn);
+    RID first_rid;
+    RID next_rid;
+    {
+      Transaction insert_txn(6);
+      ASSERT_TRUE(other_table.InsertTuple(tuple, &first_rid, &insert_txn));
+    }
+    ASSERT_TRUE(other_table.InsertTuple(tuple, &next_rid, &txn));
+    EXPECT_EQ(first_rid.GetPageId(), next_rid.GetPageId());
+  }
+
+  int num_scanned = 0;
+  for (auto it = table.Begin(&create_txn); it != table.End(); ++it) {
+    num_scanned++;
+  }
+  EXPECT_EQ(num_inserted, num_scanned);
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, VacuumTest) {
+  DiskManager disk_manager("test.db");
+  BufferPoolManager bpm(50, &disk_manager);
+  LockManager lock_manager;
+  LogManager log_manager(&disk_manager);
+  Transaction txn(0);
+  TableHeap table(&bpm, &lock_manager, &log_manager, &txn);
+
+  const int num_tuples = 50000;
+  const int keep_every = 10;
+  std::vector<RID> rids(num_tuples);
+  for (int i = 0; i < num_tuples; i++) {
+    ASSERT_TRUE(table.InsertTuple(MakeTuple(i), &rids[i], &txn));
+  }
+  txn.ReleaseInsertPages();
+
+  // an insert reuses the slot of a deleted tuple, without room for another slot
+  ASSERT_TRUE(table.MarkDelete(rids[1], &txn));
+  table.ApplyDelete(rids[1], &txn);
+  RID rid;
+  ASSERT_TRUE(table.InsertTuple(MakeTuple(1), &rid, &txn));
+  EXPECT_EQ(rids[1], rid);
+  txn.ReleaseInsertPages();
+
+  for (int i = 0; i < num_tuples; i++) {
+    if (i % keep_every != 0) {
+      ASSERT_TRUE(table.MarkDelete(rids[i], &txn));
+      table.ApplyDelete(rids[i], &txn);
+    }
+  }
+
+  auto count_pages = [&] {
+    int num_pages = 0;
+    for (page_id_t page_id = table.GetFirstPageId(); page_id != INVALID_PAGE_ID; num_pages++) {
+      auto page = static_cast<TablePage *>(bpm.FetchPage(page_id));
+      page_id_t next_page_id = page->GetNextPageId();
+      bpm.UnpinPage(page_id, false);
+      page_id = next_page_id;
+    }
+    return num_pages;
+  };
+  auto scan = [&] {
+    std::set<int32_t> values;
+    for (auto it = table.Begin(&txn); it != table.End(); ++it) {
+      values.insert(it->GetValue(&schema_, 0).GetAs<int32_t>());
+    }
+    return values;
+  };
+  int num_pages = count_pages();
+  std::set<int32_t> values = scan();
+  ASSERT_EQ(num_tuples / keep_every, values.size());
+
+  std::unordered_map<int32_t, RID> moved;
+  size_t num_unlinked = table.Vacuum(&txn, [&](const Tuple &tuple, const RID &old_rid, const RID &new_rid) {
+    int32_t value = tuple.GetValue(&schema_, 0).GetAs<int32_t>();
+    EXPECT_EQ(rids[value], old_rid);
+    moved[value] = new_rid;
+  });
+  EXPECT_EQ(num_pages - num_unlinked, count_pages());
+  EXPECT_LT(count_pages(), num_pages / (keep_every / 2));
+  EXPECT_EQ(values, scan());
+  for (const auto &[value, new_rid] : moved) {
+    Tuple tuple;
+    ASSERT_TRUE(table.GetTuple(new_rid, &tuple, &txn));
+    EXPECT_EQ(value, tuple.GetValue(&schema_, 0).GetAs<int32_t>());
+  }
+
+  // the heap takes inserts as before
+  for (int i = 0; i < num_tuples; i++) {
+    ASSERT_TRUE(table.InsertTuple(MakeTuple(num_tuples + i), &rid, &txn));
+  }
+  EXPECT_EQ(num_tuples + num_tuples / keep_every, scan().size());
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, ForwardTest) {
+  DiskManager disk_manager("test.db");
+  BufferPoolManager bpm(50, &disk_manager);
+  LockManager lock_manager;
+  LogManager log_manager(&disk_manager);
+  TransactionManager txn_manager(&lock_manager, &log_manager);
+  Transaction create_txn(0);
+  TableHeap table(&bpm, &lock_manager, &log_manager, &create_txn);
+
+  const int num_tuples = 200;
+  std::vector<RID> rids(num_tuples);
+  for (int i = 0; i < num_tuples; i++) {
+    ASSERT_TRUE(table.InsertTuple(MakeTuple(i), &rids[i], &create_txn));
+  }
+  create_txn.ReleaseInsertPages();
+  auto make_tuple = [&](int32_t i, size_t length) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i),
+                              ValueFactory::GetVarcharValue(std::string(length, 'y'))};
+    return Tuple(values, &schema_);
+  };
+  // every tuple is scanned once, at its RID, and reads the same through its RID
+  auto check = [&](int32_t value, size_t length) {
+    int num_scanned = 0;
+    for (auto it = table.Begin(&create_txn); it != table.End(); ++it, num_scanned++) {
+      int32_t i = it->GetValue(&schema_, 0).GetAs<int32_t>();
+      ASSERT_EQ(rids[i], it->GetRid());
+      size_t expected_length = i == value ? length : 100;
+      ASSERT_EQ(expected_length, it->GetValue(&schema_, 1).ToString().size());
+    }
+    EXPECT_EQ(value < num_tuples && length == 0 ? num_tuples - 1 : num_tuples, num_scanned);
+    // a table scan hands out views of the same tuples
+    TableScan scan(&table, &create_txn);
+    TupleView view;
+    int num_viewed = 0;
+    for (; scan.Next(&view); num_viewed++) {
+      int32_t i = view->GetInt32(&schema_, 0);
+      ASSERT_EQ(rids[i], view->GetRid());
+      ASSERT_EQ(i == value ? length : 100, view->GetStringView(&schema_, 1).size());
+    }
+    EXPECT_EQ(num_scanned, num_viewed);
+    Tuple tuple;
+    if (length > 0) {
+      ASSERT_TRUE(table.GetTuple(rids[value], &tuple, &create_txn));
+      EXPECT_EQ(rids[value], tuple.GetRid());
+      EXPECT_EQ(length, tuple.GetValue(&schema_, 1).ToString().size());
+    }
+  };
+
+  // The first page is full, so a tuple that grows moves out and forwards, and then moves on when it grows again. A
+  // rollback puts the old values back through the forward.
+  Transaction *txn = txn_manager.Begin();
+  ASSERT_TRUE(table.UpdateTuple(make_tuple(0, 3000), rids[0], txn));
+  check(0, 3000);
+  ASSERT_TRUE(table.UpdateTuple(make_tuple(0, 4000), rids[0], txn));
+  check(0, 4000);
+  ASSERT_TRUE(table.UpdateTuple(make_tuple(0, 10), rids[0], txn));
+  check(0, 10);
+  txn_manager.Abort(txn);
+  delete txn;
+  check(0, 100);
+
+  // a delete takes the moved copy along
+  txn = txn_manager.Begin();
+  ASSERT_TRUE(table.UpdateTuple(make_tuple(1, 3000), rids[1], txn));
+  txn_manager.Commit(txn);
+  delete txn;
+  check(1, 3000);
+  txn = txn_manager.Begin();
+  ASSERT_TRUE(table.MarkDelete(rids[1], txn));
+  txn_manager.Commit(txn);
+  delete txn;
+  check(1, 0);
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, OverflowTest) {
+  DiskManager disk_manager("test.db");
+  BufferPoolManager bpm(50, &disk_manager);
+  LockManager lock_manager;
+  LogManager log_manager(&disk_manager);
+  TransactionManager txn_manager(&lock_manager, &log_manager);
+  std::mt19937 gen(0);
+  auto random_string = [&](size_t length) {
+    std::string value(length, 'a');
+    for (auto &c : value) {
+      c = static_cast<char>('a' + gen() % 26);
+    }
+    return value;
+  };
+  auto make_tuple = [&](int32_t i, const std::string &value) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(value)};
+    return Tuple(values, &schema_);
+  };
+  auto value_of = [&](const Tuple &tuple) { return tuple.GetValue(&schema_, 1).ToString(); };
+
+  for (bool compress : {false, true}) {
+    Transaction create_txn(0);
+    TableHeap table(&bpm, &lock_manager, &log_manager, &create_txn);
+    table.EnableOverflow(&schema_, compress);
+    // values larger than a page, compressible or not, go out of line; a small one stays inline
+    std::vector<std::string> values{std::string(20000, 'z'), random_string(10000), random_string(600), "short"};
+    std::vector<RID> rids(values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+      ASSERT_TRUE(table.InsertTuple(make_tuple(i, values[i]), &rids[i], &create_txn));
+    }
+    for (size_t i = 0; i < values.size(); i++) {
+      Tuple tuple;
+      ASSERT_TRUE(table.GetTuple(rids[i], &tuple, &create_txn));
+      EXPECT_EQ(values[i], value_of(tuple));
+      EXPECT_EQ(values[i].size() > 1000, tuple.GetLength() < values[i].size());
+    }
+
+    // a rollback puts the old value back, and a commit the new one
+    Transaction *txn = txn_manager.Begin();
+    ASSERT_TRUE(table.UpdateTuple(make_tuple(0, random_string(5000)), rids[0], txn));
+    txn_manager.Abort(txn);
+    delete txn;
+    std::string value = random_string(5000);
+    txn = txn_manager.Begin();
+    ASSERT_TRUE(table.UpdateTuple(make_tuple(0, value), rids[0], txn));
+    txn_manager.Commit(txn);
+    delete txn;
+    Tuple tuple;
+    ASSERT_TRUE(table.GetTuple(rids[0], &tuple, &create_txn));
+    EXPECT_EQ(value, value_of(tuple));
+
+    // a tuple read from the table is inserted with a copy of its values, which outlives it
+    RID rid;
+    ASSERT_TRUE(table.InsertTuple(tuple, &rid, &create_txn));
+    txn = txn_manager.Begin();
+    ASSERT_TRUE(table.MarkDelete(rids[0], txn));
+    txn_manager.Commit(txn);
+    delete txn;
+    ASSERT_TRUE(table.GetTuple(rid, &tuple, &create_txn));
+    EXPECT_EQ(value, value_of(tuple));
+  }
+
+  // A scan of the narrow column of a wide table reads far fewer pages once the wide values are out of line.
+  const int num_tuples = 2000;
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < num_tuples; i++) {
+    tuples.push_back(make_tuple(i, random_string(2000)));
+  }
+  int inline_pages = 0;
+  for (bool overflow : {false, true}) {
+    Transaction txn(0);
+    TableHeap table(&bpm, &lock_manager, &log_manager, &txn);
+    if (overflow) {
+      table.EnableOverflow(&schema_);
+    }
+    std::vector<RID> rids;
+    ASSERT_TRUE(table.InsertTuples(tuples, &rids, &txn));
+    int num_pages = 0;
+    for (page_id_t page_id = table.GetFirstPageId(); page_id != INVALID_PAGE_ID; num_pages++) {
+      auto page = static_cast<TablePage *>(bpm.FetchPage(page_id));
+      page_id_t next_page_id = page->GetNextPageId();
+      bpm.UnpinPage(page_id, false);
+      page_id = next_page_id;
+    }
+    if (overflow) {
+      EXPECT_LT(num_pages * 10, inline_pages);
+    } else {
+      inline_pages = num_pages;
+    }
+    for (uint32_t column_idx : {0, 1}) {
+      int64_t sum = 0;
+      for (auto it = table.Begin(&txn); it != table.End(); ++it) {
+        Value value = it->GetValue(&schema_, column_idx);
+        sum += column_idx == 0 ? value.GetAs<int32_t>() : value.GetLength();
+      }
+      EXPECT_EQ(column_idx == 0 ? num_tuples * (num_tuples - 1) / 2 : num_tuples * 2001, sum);
+    }
+  }
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, PaxTest) {
+  DiskManager disk_manager("test.db");
+  BufferPoolManager bpm(50, &disk_manager);
+  LockManager lock_manager;
+  LogManager log_manager(&disk_manager);
+  TransactionManager txn_manager(&lock_manager, &log_manager);
+  Transaction create_txn(0);
+  TableHeap table(&bpm, &lock_manager, &log_manager, &create_txn, &schema_);
+  ASSERT_EQ(TableFormat::PAX, table.GetFormat());
+
+  // every seventh tuple has a null VARCHAR
+  auto make_tuple = [&](int32_t i, size_t length) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i),
+                              i % 7 == 0 && length == 100 ? ValueFactory::GetNullValueByType(TypeId::VARCHAR)
+                                                          : ValueFactory::GetVarcharValue(std::string(length, 'y'))};
+    return Tuple(values, &schema_);
+  };
+  const int num_tuples = 200;
+  std::vector<RID> rids(num_tuples);
+  for (int i = 0; i < num_tuples; i++) {
+    ASSERT_TRUE(table.InsertTuple(make_tuple(i, 100), &rids[i], &create_txn));
+  }
+  create_txn.ReleaseInsertPages();
+  // a tuple larger than the tail region of an empty page does not fit
+  RID rid;
+  EXPECT_FALSE(table.InsertTuple(make_tuple(num_tuples, 3600), &rid, &create_txn));
+  create_txn.SetState(TransactionState::GROWING);
+
+  auto length_of = [&](int32_t i, int32_t value, size_t length) -> size_t {
+    return i == value ? length : i % 7 == 0 ? 0 : 100;
+  };
+  // every tuple reads the same through its RID, the iterator, a table scan and a column scan
+  auto check = [&](TableHeap *heap, int32_t value, size_t length) {
+    int num_scanned = 0;
+    for (auto it = heap->Begin(&create_txn); it != heap->End(); ++it, num_scanned++) {
+      int32_t i = it->GetValue(&schema_, 0).GetAs<int32_t>();
+      ASSERT_EQ(rids[i], it->GetRid());
+      ASSERT_EQ(length_of(i, value, length) == 0 && i % 7 == 0, it->IsNull(&schema_, 1));
+      ASSERT_EQ(length_of(i, value, length), it->IsNull(&schema_, 1) ? 0 : it->GetValue(&schema_, 1).ToString().size());
+      Tuple tuple;
+      ASSERT_TRUE(heap->GetTuple(rids[i], &tuple, &create_txn));
+      ASSERT_EQ(it->GetLength(), tuple.GetLength());
+      ASSERT_EQ(0, memcmp(it->GetData(), tuple.GetData(), tuple.GetLength()));
+    }
+    EXPECT_EQ(value < num_tuples && length == 0 ? num_tuples - 1 : num_tuples, num_scanned);
+    TableScan scan(heap, &create_txn);
+    TupleView view;
+    int num_viewed = 0;
+    for (; scan.Next(&view); num_viewed++) {
+      int32_t i = view->GetInt32(&schema_, 0);
+      ASSERT_EQ(rids[i], view->GetRid());
+      ASSERT_EQ(i % 7 == 0 && i != value, view->IsNull(&schema_, 1));
+    }
+    EXPECT_EQ(num_scanned, num_viewed);
+    // the column scan reads the columns in the order asked for
+    ColumnScan column_scan(heap, &schema_, {1, 0}, &create_txn);
+    ColumnBatch batch;
+    int num_read = 0;
+    while (column_scan.Next(&batch)) {
+      for (size_t row = 0; row < batch.GetSize(); row++, num_read++) {
+        int32_t i = batch.GetArray<int32_t>(1)[row];
+        ASSERT_EQ(rids[i], batch.GetRid(row));
+        ASSERT_EQ(i % 7 == 0 && i != value, batch.IsNull(0, row));
+        ASSERT_EQ(length_of(i, value, length), batch.IsNull(0, row) ? 0 : batch.GetValue(0, row).ToString().size());
+        Tuple tuple;
+        batch.GetTuple(row, &tuple);
+        ASSERT_EQ(i, tuple.GetInt32(&schema_, 0));
+        ASSERT_EQ(length_of(i, value, length), tuple.IsNull(&schema_, 1) ? 0 : tuple.GetStringView(&schema_, 1).size());
+      }
+    }
+    EXPECT_EQ(num_scanned, num_read);
+  };
+  check(&table, num_tuples, 0);
+
+  // The first page is full, so a tuple that grows moves out and forwards, and its moved copy is updated in turn. A
+  // rollback puts the old values back through the forward.
+  Transaction *txn = txn_manager.Begin();
+  ASSERT_TRUE(table.UpdateTuple(make_tuple(1, 3000), rids[1], txn));
+  check(&table, 1, 3000);
+  ASSERT_TRUE(table.UpdateTuple(make_tuple(1, 3200), rids[1], txn));
+  check(&table, 1, 3200);
+  ASSERT_TRUE(table.UpdateTuple(make_tuple(1, 10), rids[1], txn));
+  check(&table, 1, 10);
+  txn_manager.Abort(txn);
+  delete txn;
+  check(&table, 1, 100);
+
+  // an update in place, and a delete that takes the moved copy along
+  txn = txn_manager.Begin();
+  ASSERT_TRUE(table.UpdateTuple(make_tuple(2, 50), rids[2], txn));
+  txn_manager.Commit(txn);
+  delete txn;
+  check(&table, 2, 50);
+  txn = txn_manager.Begin();
+  ASSERT_TRUE(table.UpdateTuple(make_tuple(2, 3000), rids[2], txn));
+  txn_manager.Commit(txn);
+  delete txn;
+  check(&table, 2, 3000);
+  txn = txn_manager.Begin();
+  ASSERT_TRUE(table.MarkDelete(rids[2], txn));
+  txn_manager.Commit(txn);
+  delete txn;
+  check(&table, 2, 0);
+
+  // an opened table reads the format of its pages
+  TableHeap opened(&bpm, &lock_manager, &log_manager, table.GetFirstPageId());
+  EXPECT_EQ(TableFormat::PAX, opened.GetFormat());
+  check(&opened, 2, 0);
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, DISABLED_ColumnScanBenchmarkTest) {
+  DiskManager disk_manager("test.db");
+  BufferPoolManager bpm(8000, &disk_manager);
+  LockManager lock_manager;
+  LogManager log_manager(&disk_manager);
+  std::vector<Column> columns;
+  for (int i = 0; i < 30; i++) {
+    columns.emplace_back("c" + std::to_string(i), TypeId::INTEGER);
+  }
+  Schema schema(columns);
+  const int num_tuples = 100000;
+  std::vector<Tuple> tuples;
+  std::vector<Value> values(columns.size());
+  for (int i = 0; i < num_tuples; i++) {
+    for (size_t j = 0; j < columns.size(); j++) {
+      values[j] = ValueFactory::GetIntegerValue(i + static_cast<int32_t>(j));
+    }
+    tuples.emplace_back(values, &schema);
+  }
+  const std::vector<uint32_t> column_ids{3, 17, 29};
+  const int64_t expected_sum = 3 * static_cast<int64_t>(num_tuples) * (num_tuples - 1) / 2 + (3 + 17 + 29) * num_tuples;
+
+  // Read 3 of the 30 columns: a table scan of row pages, and column scans of row pages and of PAX pages.
+  for (auto format : {TableFormat::ROW, TableFormat::PAX}) {
+    Transaction txn(0);
+    TableHeap table(&bpm, &lock_manager, &log_manager, &txn, format == TableFormat::PAX ? &schema : nullptr);
+    std::vector<RID> rids;
+    ASSERT_TRUE(table.InsertTuples(tuples, &rids, &txn));
+    const char *name = format == TableFormat::PAX ? "pax" : "row";
+    if (format == TableFormat::ROW) {
+      int64_t sum = 0;
+      auto start = std::chrono::steady_clock::now();
+      TableScan scan(&table, &txn);
+      TupleView view;
+      while (scan.Next(&view)) {
+        for (auto column_idx : column_ids) {
+          sum += view->GetInt32(&schema, column_idx);
+        }
+      }
+      std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+      EXPECT_EQ(expected_sum, sum);
+      std::cout << name << ": table scan of 3 of 30 columns of " << num_tuples << " tuples: " << elapsed.count()
+                << " ms" << std::endl;
+    }
+    int64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    ColumnScan scan(&table, &schema, column_ids, &txn);
+    ColumnBatch batch;
+    while (scan.Next(&batch)) {
+      for (size_t i = 0; i < column_ids.size(); i++) {
+        const auto *array = batch.GetArray<int32_t>(i);
+        for (size_t row = 0; row < batch.GetSize(); row++) {
+          sum += array[row];
+        }
+      }
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(expected_sum, sum);
+    std::cout << name << ": column scan of 3 of 30 columns of " << num_tuples << " tuples: " << elapsed.count()
+              << " ms" << std::endl;
+  }
+  disk_manager.ShutDown();
+}
+
+}  // namespace bustub
@@ -14,13 +14,18 @@
 #include <cstdio>
 #include <iostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
 #include "gtest/gtest.h"
 #include "logging/common.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 // NOLINTNEXTLINE
@@ -71,4 +76,102 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(TupleTest, NullBitmapTest) {
+  std::vector<Column> cols{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 20},
+                           Column{"c", TypeId::BIGINT},  Column{"d", TypeId::SMALLINT},
+                           Column{"e", TypeId::DECIMAL}, Column{"f", TypeId::BOOLEAN},
+                           Column{"g", TypeId::TINYINT}, Column{"h", TypeId::VARCHAR, 20},
+                           Column{"i", TypeId::INTEGER}};
+  Schema schema{cols};
+  std::vector<Value> values{ValueFactory::GetIntegerValue(-7),
+                            ValueFactory::GetVarcharValue("hello"),
+                            ValueFactory::GetBigIntValue(int64_t{1} << 40),
+                            ValueFactory::GetSmallIntValue(12),
+                            ValueFactory::GetDecimalValue(2.5),
+                            ValueFactory::GetBooleanValue(true),
+                            ValueFactory::GetTinyIntValue(-3),
+                            ValueFactory::GetNullValueByType(TypeId::VARCHAR),
+                            ValueFactory::GetNullValueByType(TypeId::INTEGER)};
+  Tuple tuple(values, &schema);
+  // the ninth column takes a second byte of bitmap
+  EXPECT_EQ(schema.GetLength() + 2, schema.GetFixedLength());
+  for (uint32_t i = 0; i < values.size(); i++) {
+    EXPECT_EQ(values[i].IsNull(), tuple.IsNull(&schema, i));
+    EXPECT_EQ(values[i].IsNull(), tuple.GetValue(&schema, i).IsNull());
+    EXPECT_EQ(schema.GetColumn(i).GetOffset(), schema.GetOffset(i));
+  }
+  EXPECT_EQ(-7, tuple.GetInt32(&schema, 0));
+  EXPECT_EQ("hello", tuple.GetStringView(&schema, 1));
+  EXPECT_EQ(int64_t{1} << 40, tuple.GetInt64(&schema, 2));
+  EXPECT_EQ(12, tuple.GetInt16(&schema, 3));
+  EXPECT_EQ(2.5, tuple.GetDouble(&schema, 4));
+  EXPECT_EQ(1, tuple.GetInt8(&schema, 5));
+  EXPECT_EQ(-3, tuple.GetInt8(&schema, 6));
+
+  // keys copy the column bytes and their null bits
+  Schema key_schema{std::vector<Column>{cols[8], cols[2], cols[0]}};
+  Tuple key = tuple.KeyFromTuple(schema, key_schema, {8, 2, 0});
+  EXPECT_TRUE(key.IsNull(&key_schema, 0));
+  EXPECT_EQ(int64_t{1} << 40, key.GetInt64(&key_schema, 1));
+  EXPECT_FALSE(key.IsNull(&key_schema, 2));
+  EXPECT_EQ(-7, key.GetValue(&key_schema, 2).GetAs<int32_t>());
+
+  // predicates compare VARCHAR columns in place
+  ColumnValueExpression column(0, 1, TypeId::VARCHAR);
+  ConstantValueExpression hello(ValueFactory::GetVarcharValue("hello"));
+  ConstantValueExpression world(ValueFactory::GetVarcharValue("world"));
+  ComparisonExpression equal(&column, &hello, ComparisonType::Equal);
+  ComparisonExpression less(&column, &world, ComparisonType::LessThan);
+  ComparisonExpression greater(&column, &world, ComparisonType::GreaterThan);
+  EXPECT_TRUE(equal.Evaluate(&tuple, &schema).GetAs<bool>());
+  EXPECT_TRUE(less.Evaluate(&tuple, &schema).GetAs<bool>());
+  EXPECT_FALSE(greater.Evaluate(&tuple, &schema).GetAs<bool>());
+
+  // a VARCHAR value counts its terminating zero, the view does not
+  EXPECT_EQ(tuple.GetValue(&schema, 1).GetLength(), tuple.GetStringView(&schema, 1).size() + 1);
+  // a key is one byte of bitmap longer than its columns
+  EXPECT_EQ(key_schema.GetLength() + 1, key.GetLength());
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, MoveTest) {
+  std::vector<Column> columns{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 20}};
+  Schema schema(columns);
+  Tuple tuple({ValueFactory::GetIntegerValue(1), ValueFactory::GetVarcharValue("hello")}, &schema);
+  const char *data = tuple.GetData();
+
+  // a move takes the data over without copying it
+  Tuple moved(std::move(tuple));
+  EXPECT_EQ(data, moved.GetData());
+  EXPECT_EQ(nullptr, tuple.GetData());  // NOLINT
+  EXPECT_EQ(0U, tuple.GetLength());     // NOLINT
+  Tuple assigned;
+  assigned = std::move(moved);
+  EXPECT_EQ(data, assigned.GetData());
+  EXPECT_EQ(1, assigned.GetInt32(&schema, 0));
+  EXPECT_EQ("hello", assigned.GetStringView(&schema, 1));
+
+  // refilling a tuple reuses its data if the values fit
+  assigned.SetValues({ValueFactory::GetIntegerValue(2), ValueFactory::GetVarcharValue("hi")}, &schema);
+  EXPECT_EQ(data, assigned.GetData());
+  EXPECT_EQ(2, assigned.GetInt32(&schema, 0));
+  EXPECT_EQ("hi", assigned.GetStringView(&schema, 1));
+  assigned.SetValues({ValueFactory::GetIntegerValue(3), ValueFactory::GetVarcharValue(std::string(100, 'x'))}, &schema);
+  EXPECT_EQ(100U, assigned.GetStringView(&schema, 1).size());
+
+  // a view reads the tuple in place, and copies of it do not copy the data, unlike ToTuple
+  TupleView view(assigned);
+  TupleView copy = view;
+  EXPECT_EQ(assigned.GetData(), copy->GetData());
+  EXPECT_EQ(3, copy->GetInt32(&schema, 0));
+  Tuple owned = copy.ToTuple();
+  EXPECT_NE(assigned.GetData(), owned.GetData());
+  EXPECT_TRUE(owned.IsAllocated());
+  assigned.SetValues({ValueFactory::GetIntegerValue(4), ValueFactory::GetVarcharValue("")}, &schema);
+  EXPECT_EQ(4, copy->GetInt32(&schema, 0));
+  EXPECT_EQ(3, owned.GetInt32(&schema, 0));
+  EXPECT_EQ(std::string(100, 'x'), owned.GetStringView(&schema, 1));
+}
+
 }  // namespace bustub
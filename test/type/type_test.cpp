@@ -10,13 +10,17 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstdint>
+#include <cstring>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
+#include "type/arena_pool.h"
 #include "type/value.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 //===--------------------------------------------------------------------===//
@@ -95,4 +99,43 @@ TEST(TypeTests, TemplateTest) {
   BPlusTreePage<Value, Value> node;
   node.GetInfo(val1, val2);
 }
+// NOLINTNEXTLINE
+TEST(TypeTests, ArenaPoolTest) {
+  ArenaPool pool;
+  // small allocations are aligned, and do not overlap
+  std::vector<char *> chunks;
+  for (size_t i = 1; i < 1000; i++) {
+    auto chunk = static_cast<char *>(pool.Allocate(i));
+    ASSERT_EQ(0, reinterpret_cast<uintptr_t>(chunk) % alignof(std::max_align_t));
+    memset(chunk, static_cast<int>(i % 128), i);
+    chunks.push_back(chunk);
+  }
+  // a large allocation gets a block of its own
+  auto large = static_cast<char *>(pool.Allocate(ArenaPool::BLOCK_SIZE * 2));
+  memset(large, 0, ArenaPool::BLOCK_SIZE * 2);
+  for (size_t i = 1; i < 1000; i++) {
+    ASSERT_EQ(static_cast<char>(i % 128), chunks[i - 1][0]);
+    ASSERT_EQ(static_cast<char>(i % 128), chunks[i - 1][i - 1]);
+  }
+  EXPECT_GE(pool.GetAllocatedBytes(), 999 * 1000 / 2 + ArenaPool::BLOCK_SIZE * 2);
+
+  // a VARCHAR copy in the pool does not manage its data, and reads the same
+  Value value = ValueFactory::GetVarcharValue("hello");
+  Value clone = ValueFactory::Clone(value, &pool);
+  EXPECT_EQ(CmpBool::CmpTrue, value.CompareEquals(clone));
+  EXPECT_NE(value.GetData(), clone.GetData());
+  Value copy = clone;
+  EXPECT_EQ(clone.GetData(), copy.GetData());
+  EXPECT_EQ("hello", ValueFactory::GetVarcharValue(std::string("hello"), &pool).ToString());
+  // without a pool, a copy of a value that does not manage its data gets data of its own
+  Value owned = ValueFactory::Clone(clone);
+  EXPECT_NE(clone.GetData(), owned.GetData());
+  EXPECT_EQ("hello", owned.ToString());
+
+  // a reset frees it all, and the first block is used again
+  pool.Reset();
+  EXPECT_EQ(0, pool.GetAllocatedBytes());
+  EXPECT_EQ(chunks[0], pool.Allocate(1));
+}
+
 }  // namespace bustub